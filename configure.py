@@ -19,7 +19,7 @@ extrasources = []
 includepaths = []
 
 gltf_sources = [
-  'accessor.c', 'buffer.c', 'extension.c', 'gltf.c', 'image.c', 'material.c', 'mesh.c', 'node.c', 'scene.c', 'stream.c', 'texture.c', 'version.c' ]
+  'accessor.c', 'animation.c', 'bounds.c', 'buffer.c', 'bvh.c', 'draco.c', 'extension.c', 'gltf.c', 'hierarchy.c', 'image.c', 'material.c', 'mesh.c', 'meshopt.c', 'morph.c', 'node.c', 'query.c', 'scene.c', 'skin.c', 'skinning.c', 'stream.c', 'texture.c', 'triangle.c', 'version.c', 'writer.c' ]
 
 gltf_lib = generator.lib(module = 'gltf', sources = gltf_sources + extrasources)
 #gltf_so = generator.sharedlib(module = 'gltf', sources = gltf_sources + extrasources)
@@ -32,7 +32,7 @@ if generator.skip_tests():
 
 includepaths = generator.test_includepaths()
 
-test_cases = []
+test_cases = ['gltf']
 if toolchain.is_monolithic() or target.is_ios() or target.is_android() or target.is_tizen():
   #Build one fat binary with all test cases
   test_resources = []
@@ -20,6 +20,7 @@
 #include <foundation/json.h>
 #include <foundation/array.h>
 #include <foundation/log.h>
+#include <foundation/math.h>
 #include <foundation/hashstrings.h>
 
 void
@@ -30,6 +31,7 @@ gltf_accessors_finalize(gltf_t* gltf) {
 static void
 gltf_accessor_initialize(gltf_accessor_t* accessor) {
 	memset(accessor, 0, sizeof(gltf_accessor_t));
+	accessor->buffer_view = GLTF_INVALID_INDEX;
 }
 
 static bool
@@ -53,8 +55,10 @@ gltf_accessor_parse_sparse_indices(gltf_t* gltf, const char* data, json_token_t*
 		else if ((identifier_hash == HASH_COMPONENTTYPE) &&
 		         !gltf_token_to_component_type(gltf, data, tokens, itoken, &indices->component_type))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			indices->extensions = json_token_value(data, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ACCESSOR_SPARSE_INDICES,
+		                                indices, &indices->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			indices->extras = json_token_value(data, tokens + itoken);
 
@@ -82,8 +86,10 @@ gltf_accessor_parse_sparse_values(gltf_t* gltf, const char* data, json_token_t*
 		else if ((identifier_hash == HASH_BYTEOFFSET) &&
 		         !gltf_token_to_integer(gltf, data, tokens, itoken, &values->byte_offset))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			values->extensions = json_token_value(data, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ACCESSOR_SPARSE_VALUES,
+		                                values, &values->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			values->extras = json_token_value(data, tokens + itoken);
 
@@ -113,8 +119,10 @@ gltf_accessor_parse_sparse(gltf_t* gltf, const char* data, json_token_t* tokens,
 		else if ((identifier_hash == HASH_VALUES) &&
 		         !gltf_accessor_parse_sparse_values(gltf, data, tokens, itoken, &sparse->values))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			sparse->extensions = json_token_value(data, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ACCESSOR_SPARSE,
+		                                sparse, &sparse->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			sparse->extras = json_token_value(data, tokens + itoken);
 
@@ -167,8 +175,10 @@ gltf_accessors_parse_accessor(gltf_t* gltf, const char* data, json_token_t* toke
 		else if ((identifier_hash == HASH_SPARSE) &&
 		         !gltf_accessor_parse_sparse(gltf, data, tokens, itoken, &accessor->sparse))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			accessor->extensions = json_token_value(data, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ACCESSOR,
+		                                accessor, &accessor->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			accessor->extras = json_token_value(data, tokens + itoken);
 
@@ -198,9 +208,272 @@ gltf_accessors_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_
 	while (iscene) {
 		if (!gltf_accessors_parse_accessor(gltf, data, tokens, iscene, gltf->accessors + icounter))
 			return false;
+		gltf->accessors[icounter].source = gltf_token_source(gltf, data, tokens, iscene);
+		gltf->accessors[icounter].dirty = false;
 		iscene = tokens[iscene].sibling;
 		++icounter;
 	}
 
 	return true;
 }
+
+uint
+gltf_component_type_size(gltf_component_type component_type) {
+	switch (component_type) {
+		case GLTF_COMPONENT_BYTE:
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return 1;
+		case GLTF_COMPONENT_SHORT:
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+			return 2;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+		case GLTF_COMPONENT_FLOAT:
+			return 4;
+		default:
+			break;
+	}
+	return 0;
+}
+
+uint
+gltf_data_type_component_count(gltf_data_type data_type) {
+	switch (data_type) {
+		case GLTF_DATA_SCALAR:
+			return 1;
+		case GLTF_DATA_VEC2:
+			return 2;
+		case GLTF_DATA_VEC3:
+			return 3;
+		case GLTF_DATA_VEC4:
+		case GLTF_DATA_MAT2:
+			return 4;
+		case GLTF_DATA_MAT3:
+			return 9;
+		case GLTF_DATA_MAT4:
+			return 16;
+		default:
+			break;
+	}
+	return 0;
+}
+
+//! Get the number of rows in each column of an element, equal to component count for non-matrix types
+static uint
+gltf_data_type_row_count(gltf_data_type data_type) {
+	switch (data_type) {
+		case GLTF_DATA_MAT2:
+			return 2;
+		case GLTF_DATA_MAT3:
+			return 3;
+		case GLTF_DATA_MAT4:
+			return 4;
+		default:
+			break;
+	}
+	return gltf_data_type_component_count(data_type);
+}
+
+//! Get the byte offset of each component in an element, matrix columns are aligned to four bytes
+static uint
+gltf_accessor_component_offsets(const gltf_accessor_t* accessor, uint* offsets) {
+	uint component_size = gltf_component_type_size(accessor->component_type);
+	uint component_count = gltf_data_type_component_count(accessor->type);
+	uint row_count = gltf_data_type_row_count(accessor->type);
+	uint column_size = (row_count * component_size + 3) & ~3U;
+	if (row_count == component_count)
+		column_size = row_count * component_size;
+	for (uint icomp = 0; icomp < component_count; ++icomp)
+		offsets[icomp] = ((icomp / row_count) * column_size) + ((icomp % row_count) * component_size);
+	return (component_count / row_count) * column_size;
+}
+
+static float
+gltf_accessor_component_float(const void* data, gltf_component_type component_type, bool normalized) {
+	switch (component_type) {
+		case GLTF_COMPONENT_BYTE:
+			return normalized ? math_max((float)*(const int8_t*)data / 127.0f, -1.0f) : (float)*(const int8_t*)data;
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return normalized ? (float)*(const uint8_t*)data / 255.0f : (float)*(const uint8_t*)data;
+		case GLTF_COMPONENT_SHORT:
+			return normalized ? math_max((float)*(const int16_t*)data / 32767.0f, -1.0f) :
+			                    (float)*(const int16_t*)data;
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+			return normalized ? (float)*(const uint16_t*)data / 65535.0f : (float)*(const uint16_t*)data;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+			return (float)*(const uint32_t*)data;
+		case GLTF_COMPONENT_FLOAT:
+			return *(const float*)data;
+		default:
+			break;
+	}
+	return 0;
+}
+
+static uint
+gltf_accessor_component_uint(const void* data, gltf_component_type component_type) {
+	switch (component_type) {
+		case GLTF_COMPONENT_BYTE:
+			return (uint)*(const int8_t*)data;
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return *(const uint8_t*)data;
+		case GLTF_COMPONENT_SHORT:
+			return (uint)*(const int16_t*)data;
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+			return *(const uint16_t*)data;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+			return *(const uint32_t*)data;
+		case GLTF_COMPONENT_FLOAT:
+			return (uint)*(const float*)data;
+		default:
+			break;
+	}
+	return 0;
+}
+
+//! Get data of elements stored in a buffer view, validating the range of count elements
+static const void*
+gltf_accessor_view_data(gltf_t* gltf, uint buffer_view, uint byte_offset, uint count, uint element_size,
+                        uint* stride) {
+	uint view_size = 0;
+	const void* data = gltf_buffer_view_data(gltf, buffer_view, &view_size);
+	if (!data)
+		return nullptr;
+	uint view_stride = gltf->buffer_views[buffer_view].byte_stride;
+	*stride = view_stride ? view_stride : element_size;
+	if (count && (((size_t)byte_offset + ((size_t)(count - 1) * (*stride)) + element_size) > view_size)) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Accessor data outside buffer view %u"), buffer_view);
+		return nullptr;
+	}
+	return pointer_offset_const(data, byte_offset);
+}
+
+//! Read sparse substitution indices, returning an array which must be deallocated by the caller
+static uint*
+gltf_accessor_sparse_indices(gltf_t* gltf, const gltf_accessor_t* accessor) {
+	const gltf_accessor_sparse_t* sparse = &accessor->sparse;
+	uint component_size = gltf_component_type_size(sparse->indices.component_type);
+	uint stride = 0;
+	const void* data = gltf_accessor_view_data(gltf, sparse->indices.buffer_view, sparse->indices.byte_offset,
+	                                           sparse->count, component_size, &stride);
+	if (!data || !component_size)
+		return nullptr;
+	uint* indices = nullptr;
+	array_resize(indices, sparse->count);
+	for (uint iindex = 0; iindex < sparse->count; ++iindex) {
+		indices[iindex] = gltf_accessor_component_uint(pointer_offset_const(data, component_size * iindex),
+		                                               sparse->indices.component_type);
+		if (indices[iindex] >= accessor->count) {
+			log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Accessor sparse index %u out of range"),
+			           indices[iindex]);
+			array_deallocate(indices);
+			return nullptr;
+		}
+	}
+	return indices;
+}
+
+bool
+gltf_accessor_read_float(gltf_t* gltf, uint iaccessor, float* values, uint components) {
+	if (iaccessor >= array_count(gltf->accessors))
+		return false;
+	const gltf_accessor_t* accessor = gltf->accessors + iaccessor;
+	uint offsets[16];
+	uint element_size = gltf_accessor_component_offsets(accessor, offsets);
+	uint component_count = gltf_data_type_component_count(accessor->type);
+	uint copy_count = (components < component_count) ? components : component_count;
+	if (!element_size)
+		return false;
+
+	uint stride = 0;
+	const void* data = nullptr;
+	if (accessor->buffer_view == GLTF_INVALID_INDEX) {
+		// Accessors without a buffer view are zero initialized, with any values given by sparse substitution
+		memset(values, 0, sizeof(float) * components * accessor->count);
+	} else {
+		data = gltf_accessor_view_data(gltf, accessor->buffer_view, accessor->byte_offset, accessor->count,
+		                               element_size, &stride);
+		if (!data)
+			return false;
+		for (uint ielement = 0; ielement < accessor->count; ++ielement) {
+			const void* element = pointer_offset_const(data, (size_t)stride * ielement);
+			float* value = values + ((size_t)components * ielement);
+			for (uint icomp = 0; icomp < copy_count; ++icomp)
+				value[icomp] = gltf_accessor_component_float(pointer_offset_const(element, offsets[icomp]),
+				                                             accessor->component_type, accessor->normalized);
+			for (uint icomp = copy_count; icomp < components; ++icomp)
+				value[icomp] = 0;
+		}
+	}
+
+	if (!accessor->sparse.count)
+		return true;
+	uint* indices = gltf_accessor_sparse_indices(gltf, accessor);
+	data = gltf_accessor_view_data(gltf, accessor->sparse.values.buffer_view, accessor->sparse.values.byte_offset,
+	                               accessor->sparse.count, element_size, &stride);
+	if (!indices || !data) {
+		array_deallocate(indices);
+		return false;
+	}
+	for (uint isparse = 0; isparse < accessor->sparse.count; ++isparse) {
+		const void* element = pointer_offset_const(data, (size_t)element_size * isparse);
+		float* value = values + ((size_t)components * indices[isparse]);
+		for (uint icomp = 0; icomp < copy_count; ++icomp)
+			value[icomp] = gltf_accessor_component_float(pointer_offset_const(element, offsets[icomp]),
+			                                             accessor->component_type, accessor->normalized);
+	}
+	array_deallocate(indices);
+	return true;
+}
+
+bool
+gltf_accessor_read_uint(gltf_t* gltf, uint iaccessor, uint* values, uint components) {
+	if (iaccessor >= array_count(gltf->accessors))
+		return false;
+	const gltf_accessor_t* accessor = gltf->accessors + iaccessor;
+	uint offsets[16];
+	uint element_size = gltf_accessor_component_offsets(accessor, offsets);
+	uint component_count = gltf_data_type_component_count(accessor->type);
+	uint copy_count = (components < component_count) ? components : component_count;
+	if (!element_size)
+		return false;
+
+	uint stride = 0;
+	const void* data = nullptr;
+	if (accessor->buffer_view == GLTF_INVALID_INDEX) {
+		// Accessors without a buffer view are zero initialized, with any values given by sparse substitution
+		memset(values, 0, sizeof(uint) * components * accessor->count);
+	} else {
+		data = gltf_accessor_view_data(gltf, accessor->buffer_view, accessor->byte_offset, accessor->count,
+		                               element_size, &stride);
+		if (!data)
+			return false;
+		for (uint ielement = 0; ielement < accessor->count; ++ielement) {
+			const void* element = pointer_offset_const(data, (size_t)stride * ielement);
+			uint* value = values + ((size_t)components * ielement);
+			for (uint icomp = 0; icomp < copy_count; ++icomp)
+				value[icomp] = gltf_accessor_component_uint(pointer_offset_const(element, offsets[icomp]),
+				                                            accessor->component_type);
+			for (uint icomp = copy_count; icomp < components; ++icomp)
+				value[icomp] = 0;
+		}
+	}
+
+	if (!accessor->sparse.count)
+		return true;
+	uint* indices = gltf_accessor_sparse_indices(gltf, accessor);
+	data = gltf_accessor_view_data(gltf, accessor->sparse.values.buffer_view, accessor->sparse.values.byte_offset,
+	                               accessor->sparse.count, element_size, &stride);
+	if (!indices || !data) {
+		array_deallocate(indices);
+		return false;
+	}
+	for (uint isparse = 0; isparse < accessor->sparse.count; ++isparse) {
+		const void* element = pointer_offset_const(data, (size_t)element_size * isparse);
+		uint* value = values + ((size_t)components * indices[isparse]);
+		for (uint icomp = 0; icomp < copy_count; ++icomp)
+			value[icomp] =
+			    gltf_accessor_component_uint(pointer_offset_const(element, offsets[icomp]), accessor->component_type);
+	}
+	array_deallocate(indices);
+	return true;
+}
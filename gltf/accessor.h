@@ -21,3 +21,29 @@ gltf_accessors_finalize(gltf_t* gltf);
 
 GLTF_API bool
 gltf_accessors_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
+
+GLTF_API uint
+gltf_component_type_size(gltf_component_type component_type);
+
+GLTF_API uint
+gltf_data_type_component_count(gltf_data_type data_type);
+
+/*! Read all elements of an accessor as floats, applying normalization and sparse substitution
+\param gltf glTF data structure
+\param accessor Accessor index
+\param values Destination, must hold components values for each element in the accessor
+\param components Number of values stored per element, excess accessor components are dropped and
+missing components are set to zero
+\return true if success, false if error */
+GLTF_API bool
+gltf_accessor_read_float(gltf_t* gltf, uint accessor, float* values, uint components);
+
+/*! Read all elements of an accessor as unsigned integers, applying sparse substitution
+\param gltf glTF data structure
+\param accessor Accessor index
+\param values Destination, must hold components values for each element in the accessor
+\param components Number of values stored per element, excess accessor components are dropped and
+missing components are set to zero
+\return true if success, false if error */
+GLTF_API bool
+gltf_accessor_read_uint(gltf_t* gltf, uint accessor, uint* values, uint components);
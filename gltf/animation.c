@@ -0,0 +1,543 @@
+/* animation.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "animation.h"
+#include "hashstrings.h"
+
+#include <foundation/memory.h>
+#include <foundation/json.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+#include <foundation/hashstrings.h>
+
+#include <vector/vector.h>
+
+#include <math.h>
+
+static void
+gltf_animation_finalize(gltf_animation_t* animation) {
+	array_deallocate(animation->channels);
+	array_deallocate(animation->samplers);
+}
+
+void
+gltf_animations_finalize(gltf_t* gltf) {
+	for (uint ianim = 0, animation_count = array_count(gltf->animations); ianim < animation_count; ++ianim)
+		gltf_animation_finalize(gltf->animations + ianim);
+	array_deallocate(gltf->animations);
+}
+
+static bool
+gltf_animation_parse_sampler(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken,
+                             gltf_animation_sampler_t* sampler) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation sampler has invalid type"));
+		return false;
+	}
+
+	memset(sampler, 0, sizeof(gltf_animation_sampler_t));
+	sampler->input = GLTF_INVALID_INDEX;
+	sampler->output = GLTF_INVALID_INDEX;
+	sampler->interpolation = GLTF_INTERPOLATION_LINEAR;
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		if (string_equal(STRING_ARGS(identifier), STRING_CONST("input"))) {
+			if (!gltf_token_to_integer(gltf, data, tokens, itoken, &sampler->input))
+				return false;
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("output"))) {
+			if (!gltf_token_to_integer(gltf, data, tokens, itoken, &sampler->output))
+				return false;
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("interpolation")) &&
+		           (tokens[itoken].type == JSON_STRING)) {
+			string_const_t value = json_token_value(data, tokens + itoken);
+			if (string_equal(STRING_ARGS(value), STRING_CONST("STEP")))
+				sampler->interpolation = GLTF_INTERPOLATION_STEP;
+			else if (string_equal(STRING_ARGS(value), STRING_CONST("CUBICSPLINE")))
+				sampler->interpolation = GLTF_INTERPOLATION_CUBICSPLINE;
+		} else if (identifier_hash == HASH_EXTENSIONS) {
+			if (!gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ANIMATION_SAMPLER,
+			                           sampler, &sampler->extensions))
+				return false;
+		} else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING)) {
+			sampler->extras = json_token_value(data, tokens + itoken);
+		}
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+static bool
+gltf_animation_parse_target(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken,
+                            gltf_animation_channel_t* channel) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation channel target has invalid type"));
+		return false;
+	}
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		if (string_equal(STRING_ARGS(identifier), STRING_CONST("node"))) {
+			if (!gltf_token_to_integer(gltf, data, tokens, itoken, &channel->node))
+				return false;
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("path")) &&
+		           (tokens[itoken].type == JSON_STRING)) {
+			string_const_t value = json_token_value(data, tokens + itoken);
+			channel->path_name = value;
+			if (string_equal(STRING_ARGS(value), STRING_CONST("translation")))
+				channel->path = GLTF_ANIMATION_TRANSLATION;
+			else if (string_equal(STRING_ARGS(value), STRING_CONST("rotation")))
+				channel->path = GLTF_ANIMATION_ROTATION;
+			else if (string_equal(STRING_ARGS(value), STRING_CONST("scale")))
+				channel->path = GLTF_ANIMATION_SCALE;
+			else if (string_equal(STRING_ARGS(value), STRING_CONST("weights")))
+				channel->path = GLTF_ANIMATION_WEIGHTS;
+			else
+				channel->path = GLTF_ANIMATION_PATH_UNKNOWN;
+		}
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+static bool
+gltf_animation_parse_channel(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken,
+                             gltf_animation_channel_t* channel) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation channel has invalid type"));
+		return false;
+	}
+
+	memset(channel, 0, sizeof(gltf_animation_channel_t));
+	channel->sampler = GLTF_INVALID_INDEX;
+	channel->node = GLTF_INVALID_INDEX;
+	channel->path = GLTF_ANIMATION_PATH_UNKNOWN;
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		if ((identifier_hash == HASH_SAMPLER) && !gltf_token_to_integer(gltf, data, tokens, itoken, &channel->sampler))
+			return false;
+		else if ((identifier_hash == HASH_TARGET) && !gltf_animation_parse_target(gltf, data, tokens, itoken, channel))
+			return false;
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ANIMATION_CHANNEL,
+		                                channel, &channel->extensions))
+			return false;
+		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
+			channel->extras = json_token_value(data, tokens + itoken);
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+static bool
+gltf_animations_parse_animation(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken,
+                                gltf_animation_t* animation) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation has invalid type"));
+		return false;
+	}
+
+	memset(animation, 0, sizeof(gltf_animation_t));
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING)) {
+			animation->name = json_token_value(data, tokens + itoken);
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("channels"))) {
+			if ((tokens[itoken].type != JSON_ARRAY) || (tokens[itoken].value_length > GLTF_MAX_INDEX)) {
+				log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation channels has invalid type"));
+				return false;
+			}
+			array_resize(animation->channels, tokens[itoken].value_length);
+			uint ichannel = 0;
+			for (size_t ivalue = tokens[itoken].child; ivalue; ivalue = tokens[ivalue].sibling) {
+				if (!gltf_animation_parse_channel(gltf, data, tokens, ivalue, animation->channels + ichannel++))
+					return false;
+			}
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("samplers"))) {
+			if ((tokens[itoken].type != JSON_ARRAY) || (tokens[itoken].value_length > GLTF_MAX_INDEX)) {
+				log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation samplers has invalid type"));
+				return false;
+			}
+			array_resize(animation->samplers, tokens[itoken].value_length);
+			uint isampler = 0;
+			for (size_t ivalue = tokens[itoken].child; ivalue; ivalue = tokens[ivalue].sibling) {
+				if (!gltf_animation_parse_sampler(gltf, data, tokens, ivalue, animation->samplers + isampler++))
+					return false;
+			}
+		} else if (identifier_hash == HASH_EXTENSIONS) {
+			if (!gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_ANIMATION,
+			                           animation, &animation->extensions))
+				return false;
+		} else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING)) {
+			animation->extras = json_token_value(data, tokens + itoken);
+		}
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+bool
+gltf_animations_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken) {
+	if (tokens[itoken].type != JSON_ARRAY) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Main animations attribute has invalid type"));
+		return false;
+	}
+
+	size_t animations_count = tokens[itoken].value_length;
+	if (animations_count > GLTF_MAX_INDEX)
+		return false;
+
+	gltf_animations_finalize(gltf);
+	array_resize(gltf->animations, animations_count);
+	if (animations_count)
+		memset(gltf->animations, 0, sizeof(gltf_animation_t) * animations_count);
+
+	uint icounter = 0;
+	size_t ianim = tokens[itoken].child;
+	while (ianim) {
+		if (!gltf_animations_parse_animation(gltf, data, tokens, ianim, gltf->animations + icounter))
+			return false;
+		gltf->animations[icounter].source = gltf_token_source(gltf, data, tokens, ianim);
+		gltf->animations[icounter].dirty = false;
+		ianim = tokens[ianim].sibling;
+		++icounter;
+	}
+
+	return true;
+}
+
+void
+gltf_animation_curves_initialize(gltf_animation_curves_t* curves) {
+	memset(curves, 0, sizeof(gltf_animation_curves_t));
+}
+
+void
+gltf_animation_curves_finalize(gltf_animation_curves_t* curves) {
+	array_deallocate(curves->node);
+	array_deallocate(curves->path);
+	array_deallocate(curves->interpolation);
+	array_deallocate(curves->components);
+	array_deallocate(curves->key_count);
+	array_deallocate(curves->key_offset);
+	array_deallocate(curves->value_offset);
+	array_deallocate(curves->output_offset);
+	array_deallocate(curves->times);
+	array_deallocate(curves->values);
+	gltf_animation_curves_initialize(curves);
+}
+
+//! Read keyframes of a sampler into the curve arrays, returning false if accessors are invalid
+static bool
+gltf_animation_curves_read(gltf_animation_curves_t* curves, gltf_t* gltf, const gltf_animation_sampler_t* sampler,
+                           uint value_components, uint* key_offset, uint* value_offset) {
+	const gltf_accessor_t* input = gltf->accessors + sampler->input;
+	const gltf_accessor_t* output = gltf->accessors + sampler->output;
+
+	*key_offset = array_count(curves->times);
+	array_resize(curves->times, *key_offset + input->count);
+	if (!gltf_accessor_read_float(gltf, sampler->input, curves->times + *key_offset, 1))
+		return false;
+
+	*value_offset = array_count(curves->values);
+	array_resize(curves->values, *value_offset + (output->count * value_components));
+	if (!gltf_accessor_read_float(gltf, sampler->output, curves->values + *value_offset, value_components))
+		return false;
+
+	for (uint ikey = 1; ikey < input->count; ++ikey) {
+		if (curves->times[*key_offset + ikey] < curves->times[*key_offset + ikey - 1]) {
+			log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation keyframe times not increasing"));
+			return false;
+		}
+	}
+	if (input->count && (curves->times[*key_offset + input->count - 1] > curves->duration))
+		curves->duration = curves->times[*key_offset + input->count - 1];
+	return true;
+}
+
+bool
+gltf_animation_curves_build(gltf_animation_curves_t* curves, gltf_t* gltf, uint ianimation) {
+	gltf_animation_curves_finalize(curves);
+	if (ianimation >= array_count(gltf->animations))
+		return false;
+
+	const gltf_animation_t* animation = gltf->animations + ianimation;
+	uint sampler_count = array_count(animation->samplers);
+	uint accessor_count = array_count(gltf->accessors);
+	uint node_count = array_count(gltf->nodes);
+
+	// Channels sharing a sampler share the keyframe data
+	uint* sampler_offset = nullptr;
+	array_resize(sampler_offset, sampler_count * 2);
+	for (uint isampler = 0; isampler < sampler_count * 2; ++isampler)
+		sampler_offset[isampler] = GLTF_INVALID_INDEX;
+
+	bool success = true;
+	for (uint ichannel = 0, channel_count = array_count(animation->channels); ichannel < channel_count; ++ichannel) {
+		const gltf_animation_channel_t* channel = animation->channels + ichannel;
+		if ((channel->path == GLTF_ANIMATION_PATH_UNKNOWN) || (channel->node >= node_count))
+			continue;
+
+		const gltf_animation_sampler_t* sampler =
+		    (channel->sampler < sampler_count) ? (animation->samplers + channel->sampler) : nullptr;
+		if (!sampler || (sampler->input >= accessor_count) || (sampler->output >= accessor_count) ||
+		    !gltf->accessors[sampler->input].count) {
+			log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Animation channel %u has invalid sampler"),
+			           ichannel);
+			success = false;
+			break;
+		}
+
+		uint key_count = gltf->accessors[sampler->input].count;
+		uint output_count = gltf->accessors[sampler->output].count;
+		uint value_components = (channel->path == GLTF_ANIMATION_ROTATION) ? 4 : 3;
+		uint components = value_components;
+		uint keyframe_size = (sampler->interpolation == GLTF_INTERPOLATION_CUBICSPLINE) ? 3 : 1;
+		if (channel->path == GLTF_ANIMATION_WEIGHTS) {
+			// Weights are scalars with one value for each morph target per keyframe
+			value_components = 1;
+			components = output_count / (key_count * keyframe_size);
+		}
+		if (!components || ((key_count * keyframe_size * components) != (output_count * value_components))) {
+			log_errorf(HASH_GLTF, ERROR_INVALID_VALUE,
+			           STRING_CONST("Animation channel %u output does not match keyframe count"), ichannel);
+			success = false;
+			break;
+		}
+
+		uint* offset = sampler_offset + (channel->sampler * 2);
+		if ((offset[0] == GLTF_INVALID_INDEX) &&
+		    !gltf_animation_curves_read(curves, gltf, sampler, value_components, offset, offset + 1)) {
+			success = false;
+			break;
+		}
+
+		array_push(curves->node, channel->node);
+		array_push(curves->path, channel->path);
+		array_push(curves->interpolation, sampler->interpolation);
+		array_push(curves->components, components);
+		array_push(curves->key_count, key_count);
+		array_push(curves->key_offset, offset[0]);
+		array_push(curves->value_offset, offset[1]);
+		array_push(curves->output_offset, curves->output_size);
+		curves->output_size += components;
+		++curves->channel_count;
+	}
+
+	array_deallocate(sampler_offset);
+	if (!success)
+		gltf_animation_curves_finalize(curves);
+	return success;
+}
+
+//! Find the last keyframe at or before the given time, stepping forward from the cursor when time
+//! advances and searching when time moves backwards
+static FOUNDATION_FORCEINLINE uint
+gltf_animation_find_key(const float* times, uint key_count, float time, uint cursor) {
+	if ((cursor < key_count) && (times[cursor] <= time)) {
+		while (((cursor + 1) < key_count) && (times[cursor + 1] <= time))
+			++cursor;
+		return cursor;
+	}
+	uint low = 0;
+	uint high = key_count;
+	while ((high - low) > 1) {
+		uint mid = (low + high) / 2;
+		if (times[mid] <= time)
+			low = mid;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+//! Load up to four components of a keyframe value, unused lanes are zero
+static FOUNDATION_FORCEINLINE vector_t
+gltf_animation_load(const float* value, uint components) {
+	return vector(value[0], (components > 1) ? value[1] : 0, (components > 2) ? value[2] : 0,
+	              (components > 3) ? value[3] : 0);
+}
+
+static FOUNDATION_FORCEINLINE void
+gltf_animation_store(vector_t value, uint components, float* result) {
+	result[0] = vector_x(value);
+	if (components > 1)
+		result[1] = vector_y(value);
+	if (components > 2)
+		result[2] = vector_z(value);
+	if (components > 3)
+		result[3] = vector_w(value);
+}
+
+static FOUNDATION_FORCEINLINE float
+gltf_animation_dot(vector_t lhs, vector_t rhs) {
+	vector_t product = vector_mul(lhs, rhs);
+	return vector_x(product) + vector_y(product) + vector_z(product) + vector_w(product);
+}
+
+static FOUNDATION_FORCEINLINE vector_t
+gltf_animation_normalize(vector_t value) {
+	float length_sqr = gltf_animation_dot(value, value);
+	return vector_scale(value, (length_sqr > 0) ? (1.0f / sqrtf(length_sqr)) : 0);
+}
+
+static vector_t
+gltf_animation_slerp(vector_t from, vector_t to, float factor) {
+	float cosine = gltf_animation_dot(from, to);
+	float sign = 1.0f;
+	if (cosine < 0) {
+		cosine = -cosine;
+		sign = -1.0f;
+	}
+	float from_scale = 1.0f - factor;
+	float to_scale = factor;
+	if (cosine < 0.9995f) {
+		float angle = acosf(cosine);
+		float inv_sine = 1.0f / sinf(angle);
+		from_scale = sinf(from_scale * angle) * inv_sine;
+		to_scale = sinf(to_scale * angle) * inv_sine;
+	}
+	to_scale *= sign;
+	vector_t result = vector_muladd(from, vector_uniform(from_scale), vector_mul(to, vector_uniform(to_scale)));
+	return gltf_animation_normalize(result);
+}
+
+static void
+gltf_animation_sample_channel(const gltf_animation_curves_t* curves, uint ichannel, float time, uint* cursor,
+                              float* FOUNDATION_RESTRICT result) {
+	const float* times = curves->times + curves->key_offset[ichannel];
+	const float* values = curves->values + curves->value_offset[ichannel];
+	uint key_count = curves->key_count[ichannel];
+	uint components = curves->components[ichannel];
+	gltf_interpolation interpolation = curves->interpolation[ichannel];
+	bool cubic = (interpolation == GLTF_INTERPOLATION_CUBICSPLINE);
+	// Cubic spline keyframes store in-tangent, value and out-tangent
+	uint stride = cubic ? (components * 3) : components;
+	uint base = cubic ? components : 0;
+
+	uint key = gltf_animation_find_key(times, key_count, time, *cursor);
+	*cursor = key;
+	if ((time <= times[0]) || ((key + 1) >= key_count) || (interpolation == GLTF_INTERPOLATION_STEP)) {
+		const float* value = values + (key * stride) + base;
+		for (uint icomp = 0; icomp < components; ++icomp)
+			result[icomp] = value[icomp];
+		return;
+	}
+
+	float delta = times[key + 1] - times[key];
+	float factor = (delta > 0) ? ((time - times[key]) / delta) : 0;
+	const float* from = values + (key * stride) + base;
+	const float* to = values + ((key + 1) * stride) + base;
+	bool rotation = (curves->path[ichannel] == GLTF_ANIMATION_ROTATION);
+	if (!cubic && rotation) {
+		gltf_animation_store(gltf_animation_slerp(gltf_animation_load(from, 4), gltf_animation_load(to, 4), factor),
+		                     4, result);
+		return;
+	}
+
+	// Hermite spline with the out-tangent of the first and in-tangent of the second keyframe, linear
+	// interpolation is the same blend with only the two keyframe values weighted
+	const float* out_tangent = from + components;
+	const float* in_tangent = to - components;
+	float from_weight = 1.0f - factor;
+	float to_weight = factor;
+	float out_weight = 0;
+	float in_weight = 0;
+	if (cubic) {
+		float factor2 = factor * factor;
+		float factor3 = factor2 * factor;
+		from_weight = (2.0f * factor3) - (3.0f * factor2) + 1.0f;
+		out_weight = (factor3 - (2.0f * factor2) + factor) * delta;
+		to_weight = (-2.0f * factor3) + (3.0f * factor2);
+		in_weight = (factor3 - factor2) * delta;
+	}
+	vector_t vfrom_weight = vector_uniform(from_weight);
+	vector_t vto_weight = vector_uniform(to_weight);
+	vector_t vout_weight = vector_uniform(out_weight);
+	vector_t vin_weight = vector_uniform(in_weight);
+	// Four components per vector, morph target weight channels have any number of components
+	for (uint icomp = 0; icomp < components; icomp += 4) {
+		uint count = ((components - icomp) < 4) ? (components - icomp) : 4;
+		vector_t value = vector_mul(gltf_animation_load(from + icomp, count), vfrom_weight);
+		value = vector_muladd(gltf_animation_load(to + icomp, count), vto_weight, value);
+		if (cubic) {
+			value = vector_muladd(gltf_animation_load(out_tangent + icomp, count), vout_weight, value);
+			value = vector_muladd(gltf_animation_load(in_tangent + icomp, count), vin_weight, value);
+		}
+		if (rotation)
+			value = gltf_animation_normalize(value);
+		gltf_animation_store(value, count, result + icomp);
+	}
+}
+
+void
+gltf_animation_curves_sample(const gltf_animation_curves_t* curves, float time, uint* cursors, float* output) {
+	for (uint ichannel = 0; ichannel < curves->channel_count; ++ichannel)
+		gltf_animation_sample_channel(curves, ichannel, time, cursors + ichannel,
+		                              output + curves->output_offset[ichannel]);
+}
+
+void
+gltf_animation_curves_sample_batch(const gltf_animation_curves_t* curves, const float* times, uint count,
+                                   uint* cursors, float* output) {
+	for (uint iinst = 0; iinst < count; ++iinst)
+		gltf_animation_curves_sample(curves, times[iinst], cursors + ((size_t)curves->channel_count * iinst),
+		                             output + ((size_t)curves->output_size * iinst));
+}
+
+void
+gltf_animation_curves_apply(const gltf_animation_curves_t* curves, const float* output,
+                            gltf_hierarchy_t* hierarchy) {
+	for (uint ichannel = 0; ichannel < curves->channel_count; ++ichannel) {
+		uint entry = hierarchy->entry[curves->node[ichannel]];
+		if ((entry == GLTF_INVALID_INDEX) || hierarchy->has_matrix[entry])
+			continue;
+		const float* value = output + curves->output_offset[ichannel];
+		switch (curves->path[ichannel]) {
+			case GLTF_ANIMATION_TRANSLATION:
+				for (uint icomp = 0; icomp < 3; ++icomp)
+					hierarchy->translation[icomp][entry] = value[icomp];
+				break;
+			case GLTF_ANIMATION_ROTATION:
+				for (uint icomp = 0; icomp < 4; ++icomp)
+					hierarchy->rotation[icomp][entry] = value[icomp];
+				break;
+			case GLTF_ANIMATION_SCALE:
+				for (uint icomp = 0; icomp < 3; ++icomp)
+					hierarchy->scale[icomp][entry] = value[icomp];
+				break;
+			case GLTF_ANIMATION_WEIGHTS:
+			case GLTF_ANIMATION_PATH_UNKNOWN:
+			default:
+				break;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+/* animation.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file animation.h
+    Animation parsing and keyframe sampling */
+
+#include "gltf.h"
+
+GLTF_API void
+gltf_animations_finalize(gltf_t* gltf);
+
+GLTF_API bool
+gltf_animations_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
+
+/*! Initialize empty animation curves
+\param curves Animation curves */
+GLTF_API void
+gltf_animation_curves_initialize(gltf_animation_curves_t* curves);
+
+/*! Release all memory held by animation curves
+\param curves Animation curves */
+GLTF_API void
+gltf_animation_curves_finalize(gltf_animation_curves_t* curves);
+
+/*! Read keyframe times and values of all channels of an animation into animation curves. Channels
+with a path defined by an extension or without a target node are skipped.
+\param curves Animation curves, previous content is released
+\param gltf glTF data structure
+\param animation Animation index
+\return true if success, false if error */
+GLTF_API bool
+gltf_animation_curves_build(gltf_animation_curves_t* curves, gltf_t* gltf, uint animation);
+
+/*! Sample all channels at the given time. Times before the first or after the last keyframe are
+clamped. Rotations are interpolated with spherical linear interpolation and normalized.
+\param curves Animation curves
+\param time Time in seconds
+\param cursors Keyframe cursor of each channel, initialized to zero and retained between calls.
+Advancing time only steps the cursors forward, while earlier times search for the keyframe.
+\param output Destination, must hold output_size values */
+GLTF_API void
+gltf_animation_curves_sample(const gltf_animation_curves_t* curves, float time, uint* cursors, float* output);
+
+/*! Sample all channels for a set of animation instances, each with its own time and cursors
+\param curves Animation curves
+\param times Time in seconds of each instance
+\param count Number of instances
+\param cursors Keyframe cursors, channel_count consecutive cursors for each instance
+\param output Destination, output_size consecutive values for each instance */
+GLTF_API void
+gltf_animation_curves_sample_batch(const gltf_animation_curves_t* curves, const float* times, uint count,
+                                   uint* cursors, float* output);
+
+/*! Store sampled translation, rotation and scale values in the local transforms of a hierarchy.
+Entries with a matrix transform and weights channels are left untouched. Local and world
+transforms must be updated afterwards.
+\param curves Animation curves
+\param output Sampled values
+\param hierarchy Hierarchy */
+GLTF_API void
+gltf_animation_curves_apply(const gltf_animation_curves_t* curves, const float* output,
+                            gltf_hierarchy_t* hierarchy);
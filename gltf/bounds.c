@@ -0,0 +1,220 @@
+/* bounds.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "bounds.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/math.h>
+
+#include <vector/vector.h>
+
+#include <float.h>
+#include <math.h>
+
+static void
+gltf_bounds_clear(gltf_bounds_t* bounds) {
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		bounds->min[icomp] = FLT_MAX;
+		bounds->max[icomp] = -FLT_MAX;
+		bounds->center[icomp] = 0;
+	}
+	bounds->radius = 0;
+}
+
+bool
+gltf_bounds_is_empty(const gltf_bounds_t* bounds) {
+	return bounds->min[0] > bounds->max[0];
+}
+
+static void
+gltf_bounds_merge(gltf_bounds_t* bounds, const gltf_bounds_t* other) {
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		bounds->min[icomp] = (other->min[icomp] < bounds->min[icomp]) ? other->min[icomp] : bounds->min[icomp];
+		bounds->max[icomp] = (other->max[icomp] > bounds->max[icomp]) ? other->max[icomp] : bounds->max[icomp];
+	}
+}
+
+//! Update the bounding sphere to enclose the axis aligned box
+static void
+gltf_bounds_finalize_sphere(gltf_bounds_t* bounds) {
+	if (gltf_bounds_is_empty(bounds))
+		return;
+	float length_sqr = 0;
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		float extent = (bounds->max[icomp] - bounds->min[icomp]) * 0.5f;
+		bounds->center[icomp] = bounds->min[icomp] + extent;
+		length_sqr += extent * extent;
+	}
+	bounds->radius = sqrtf(length_sqr);
+}
+
+void
+gltf_bounds_transform(gltf_bounds_t* result, const gltf_bounds_t* bounds, const matrix_t* transform) {
+	if (gltf_bounds_is_empty(bounds)) {
+		gltf_bounds_clear(result);
+		return;
+	}
+	float center[3], extent[3];
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		center[icomp] = (bounds->max[icomp] + bounds->min[icomp]) * 0.5f;
+		extent[icomp] = (bounds->max[icomp] - bounds->min[icomp]) * 0.5f;
+	}
+	// Transform the center and project the extent on the absolute value of each transform row
+	vector_t zero = vector_zero();
+	vector_t world_center = vector_muladd(transform->row[0], vector_uniform(center[0]), transform->row[3]);
+	world_center = vector_muladd(transform->row[1], vector_uniform(center[1]), world_center);
+	world_center = vector_muladd(transform->row[2], vector_uniform(center[2]), world_center);
+	vector_t world_extent = vector_mul(vector_max(transform->row[0], vector_sub(zero, transform->row[0])),
+	                                   vector_uniform(extent[0]));
+	world_extent = vector_muladd(vector_max(transform->row[1], vector_sub(zero, transform->row[1])),
+	                             vector_uniform(extent[1]), world_extent);
+	world_extent = vector_muladd(vector_max(transform->row[2], vector_sub(zero, transform->row[2])),
+	                             vector_uniform(extent[2]), world_extent);
+	vector_t vmin = vector_sub(world_center, world_extent);
+	vector_t vmax = vector_add(world_center, world_extent);
+	result->min[0] = vector_x(vmin);
+	result->min[1] = vector_y(vmin);
+	result->min[2] = vector_z(vmin);
+	result->max[0] = vector_x(vmax);
+	result->max[1] = vector_y(vmax);
+	result->max[2] = vector_z(vmax);
+	gltf_bounds_finalize_sphere(result);
+}
+
+//! Convert an accessor bound value to a float, applying normalization of integer components
+static float
+gltf_bounds_value(const gltf_accessor_t* accessor, real value) {
+	if (!accessor->normalized)
+		return (float)value;
+	switch (accessor->component_type) {
+		case GLTF_COMPONENT_BYTE:
+			return math_max((float)value / 127.0f, -1.0f);
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return (float)value / 255.0f;
+		case GLTF_COMPONENT_SHORT:
+			return math_max((float)value / 32767.0f, -1.0f);
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+			return (float)value / 65535.0f;
+		case GLTF_COMPONENT_UNSIGNED_INT:
+		case GLTF_COMPONENT_FLOAT:
+		default:
+			break;
+	}
+	return (float)value;
+}
+
+static void
+gltf_bounds_allocate(gltf_bounds_t** array, uint count) {
+	array_resize(*array, count);
+	for (uint ibounds = 0; ibounds < count; ++ibounds)
+		gltf_bounds_clear(*array + ibounds);
+}
+
+bool
+gltf_bounds_compute(gltf_t* gltf) {
+	uint accessor_count = array_count(gltf->accessors);
+	uint mesh_count = array_count(gltf->meshes);
+	uint node_count = array_count(gltf->nodes);
+	uint scene_count = array_count(gltf->scenes);
+
+	gltf_bounds_allocate(&gltf->mesh_bounds, mesh_count);
+	for (uint imesh = 0; imesh < mesh_count; ++imesh) {
+		gltf_mesh_t* mesh = gltf->meshes + imesh;
+		for (uint iprim = 0, primitive_count = array_count(mesh->primitives); iprim < primitive_count; ++iprim) {
+			gltf_primitive_t* primitive = mesh->primitives + iprim;
+			gltf_bounds_clear(&primitive->bounds);
+			uint iaccessor = primitive->attributes[GLTF_POSITION];
+			if (iaccessor >= accessor_count)
+				continue;
+			const gltf_accessor_t* accessor = gltf->accessors + iaccessor;
+			if (!accessor->count || (accessor->type != GLTF_DATA_VEC3))
+				continue;
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				primitive->bounds.min[icomp] = gltf_bounds_value(accessor, accessor->min[icomp]);
+				primitive->bounds.max[icomp] = gltf_bounds_value(accessor, accessor->max[icomp]);
+			}
+			gltf_bounds_finalize_sphere(&primitive->bounds);
+			gltf_bounds_merge(gltf->mesh_bounds + imesh, &primitive->bounds);
+		}
+		gltf_bounds_finalize_sphere(gltf->mesh_bounds + imesh);
+	}
+
+	gltf_hierarchy_t hierarchy;
+	gltf_hierarchy_initialize(&hierarchy);
+	if (!gltf_hierarchy_build(&hierarchy, gltf, GLTF_INVALID_INDEX))
+		return false;
+
+	// Children follow their parents, so walking the entries in reverse completes the bounds of
+	// every node before they are merged into the parent
+	gltf_bounds_allocate(&gltf->node_bounds, node_count);
+	for (uint ientry = hierarchy.count; ientry-- > 0;) {
+		uint inode = hierarchy.node[ientry];
+		gltf_bounds_t* node_bounds = gltf->node_bounds + inode;
+		uint imesh = gltf->nodes[inode].mesh;
+		if (imesh < mesh_count) {
+			gltf_bounds_t mesh_bounds;
+			gltf_bounds_node_mesh(gltf, inode, hierarchy.world + ientry, &mesh_bounds);
+			gltf_bounds_merge(node_bounds, &mesh_bounds);
+		}
+		gltf_bounds_finalize_sphere(node_bounds);
+		if (hierarchy.parent[ientry] != GLTF_INVALID_INDEX)
+			gltf_bounds_merge(gltf->node_bounds + hierarchy.node[hierarchy.parent[ientry]], node_bounds);
+	}
+
+	gltf_bounds_allocate(&gltf->scene_bounds, scene_count);
+	for (uint iscene = 0; iscene < scene_count; ++iscene) {
+		const gltf_scene_t* scene = gltf->scenes + iscene;
+		for (uint iroot = 0, root_count = array_count(scene->nodes); iroot < root_count; ++iroot) {
+			if (scene->nodes[iroot] < node_count)
+				gltf_bounds_merge(gltf->scene_bounds + iscene, gltf->node_bounds + scene->nodes[iroot]);
+		}
+		gltf_bounds_finalize_sphere(gltf->scene_bounds + iscene);
+	}
+
+	gltf_hierarchy_finalize(&hierarchy);
+	return true;
+}
+
+bool
+gltf_bounds_node_mesh(gltf_t* gltf, uint inode, const matrix_t* world, gltf_bounds_t* result) {
+	gltf_bounds_clear(result);
+	const gltf_node_t* node = gltf->nodes + inode;
+	if ((node->mesh >= array_count(gltf->mesh_bounds)) || gltf_bounds_is_empty(gltf->mesh_bounds + node->mesh))
+		return true;
+	if (!gltf_node_is_instanced(node)) {
+		gltf_bounds_transform(result, gltf->mesh_bounds + node->mesh, world);
+		return true;
+	}
+
+	uint instance_count = gltf_node_instance_count(gltf, node);
+	matrix_t* instances = memory_allocate(HASH_GLTF, sizeof(matrix_t) * math_max(instance_count, 1U), 16,
+	                                      MEMORY_TEMPORARY);
+	bool success = gltf_node_instance_matrices(gltf, node, world, instances);
+	for (uint iinst = 0; success && (iinst < instance_count); ++iinst) {
+		gltf_bounds_t instance_bounds;
+		gltf_bounds_transform(&instance_bounds, gltf->mesh_bounds + node->mesh, instances + iinst);
+		gltf_bounds_merge(result, &instance_bounds);
+	}
+	gltf_bounds_finalize_sphere(result);
+	memory_deallocate(instances);
+	return success;
+}
+
+void
+gltf_bounds_finalize(gltf_t* gltf) {
+	array_deallocate(gltf->mesh_bounds);
+	array_deallocate(gltf->node_bounds);
+	array_deallocate(gltf->scene_bounds);
+}
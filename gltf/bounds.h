@@ -0,0 +1,57 @@
+/* bounds.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file bounds.h
+    Bounding volumes from accessor bounds */
+
+#include "gltf.h"
+
+/*! Compute bounds of all primitives, meshes, nodes and scenes from the minimum and maximum values
+of the POSITION accessors, without reading vertex data. Primitive and mesh bounds are stored in
+mesh space, node bounds include all descendants and together with scene bounds are stored in
+world space. Bounding spheres enclose the axis aligned boxes.
+\param gltf glTF data structure
+\return true if success, false if the nodes do not form a valid hierarchy */
+GLTF_API bool
+gltf_bounds_compute(gltf_t* gltf);
+
+/*! Compute world space bounds of the mesh of a node, enclosing all instances if the node has
+EXT_mesh_gpu_instancing attributes. Requires mesh bounds computed by gltf_bounds_compute.
+\param gltf glTF data structure
+\param node Node index
+\param world Node world transform
+\param result Bounds, empty if node has no mesh
+\return true if success, false if instance attributes could not be read */
+GLTF_API bool
+gltf_bounds_node_mesh(gltf_t* gltf, uint node, const matrix_t* world, gltf_bounds_t* result);
+
+/*! Release computed bounds
+\param gltf glTF data structure */
+GLTF_API void
+gltf_bounds_finalize(gltf_t* gltf);
+
+/*! Query if bounds are empty
+\param bounds Bounds
+\return true if bounds are empty, false if not */
+GLTF_API bool
+gltf_bounds_is_empty(const gltf_bounds_t* bounds);
+
+/*! Transform bounds by a matrix, giving the axis aligned box enclosing the transformed box
+\param result Transformed bounds
+\param bounds Source bounds
+\param transform Transform matrix */
+GLTF_API void
+gltf_bounds_transform(gltf_bounds_t* result, const gltf_bounds_t* bounds, const matrix_t* transform);
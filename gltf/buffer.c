@@ -20,17 +20,24 @@
 #include <foundation/json.h>
 #include <foundation/array.h>
 #include <foundation/log.h>
+#include <foundation/stream.h>
+#include <foundation/virtualarray.h>
+#include <foundation/fs.h>
+#include <foundation/string.h>
 #include <foundation/hashstrings.h>
 
 void
 gltf_buffers_finalize(gltf_t* gltf) {
-	if (gltf->buffers)
+	if (gltf->buffers) {
+		for (uint ibuffer = 0, buffers_count = array_count(gltf->buffers); ibuffer < buffers_count; ++ibuffer)
+			memory_deallocate(gltf->buffers[ibuffer].data);
 		array_deallocate(gltf->buffers);
+	}
 }
 
 static void
 gltf_buffer_initialize(gltf_buffer_t* buffer) {
-	FOUNDATION_UNUSED(buffer);
+	memset(buffer, 0, sizeof(gltf_buffer_t));
 }
 
 static bool
@@ -51,8 +58,10 @@ gltf_buffers_parse_buffer(gltf_t* gltf, const char* data, json_token_t* tokens,
 		else if ((identifier_hash == HASH_BYTELENGTH) &&
 		         !gltf_token_to_integer(gltf, data, tokens, itoken, &buffer->byte_length))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			buffer->extensions = json_token_value(data, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_BUFFER,
+		                                buffer, &buffer->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			buffer->extras = json_token_value(data, tokens + itoken);
 
@@ -83,6 +92,8 @@ gltf_buffers_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t
 	while (ibuffer) {
 		if (!gltf_buffers_parse_buffer(gltf, data, tokens, ibuffer, gltf->buffers + icounter))
 			return false;
+		gltf->buffers[icounter].source = gltf_token_source(gltf, data, tokens, ibuffer);
+		gltf->buffers[icounter].dirty = false;
 		ibuffer = tokens[ibuffer].sibling;
 		++icounter;
 	}
@@ -90,6 +101,189 @@ gltf_buffers_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t
 	return true;
 }
 
+const void*
+gltf_buffer_data(gltf_t* gltf, uint ibuffer) {
+	if (ibuffer >= array_count(gltf->buffers))
+		return nullptr;
+
+	gltf_buffer_t* buffer = gltf->buffers + ibuffer;
+	if (buffer->data || !buffer->byte_length)
+		return buffer->data;
+
+	stream_t* stream = gltf_stream_open(gltf, STRING_ARGS(buffer->uri), STREAM_IN | STREAM_BINARY);
+	if (!stream) {
+		log_errorf(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Unable to open buffer %u: %.*s"), ibuffer,
+		           STRING_FORMAT(buffer->uri));
+		return nullptr;
+	}
+
+	void* data = memory_allocate(HASH_GLTF, buffer->byte_length, 0, MEMORY_PERSISTENT);
+	size_t read = stream_read(stream, data, buffer->byte_length);
+	stream_deallocate(stream);
+	if (read != buffer->byte_length) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Unable to read buffer %u: %.*s"), ibuffer,
+		           STRING_FORMAT(buffer->uri));
+		memory_deallocate(data);
+		return nullptr;
+	}
+
+	buffer->data = data;
+	return data;
+}
+
+uint
+gltf_buffer_add(gltf_t* gltf, string_const_t name, void* data, uint size) {
+	gltf_buffer_t buffer;
+	gltf_buffer_initialize(&buffer);
+	buffer.name = name;
+	buffer.byte_length = size;
+	buffer.data = data;
+	array_push(gltf->buffers, buffer);
+	return array_count(gltf->buffers) - 1;
+}
+
+void
+gltf_buffer_output_finalize(gltf_t* gltf) {
+	for (uint ibuffer = 0, buffers_count = array_count(gltf->output_buffers); ibuffer < buffers_count; ++ibuffer)
+		virtualarray_deallocate(gltf->output_buffers[ibuffer]);
+	array_deallocate(gltf->output_buffers);
+
+	// When embedded in a GLB the first streamed buffer file is temporary, copied in gltf_write
+	bool remove_temporary = (gltf->file_type == GLTF_FILE_GLB_EMBED) && array_count(gltf->output_streams);
+	string_t temporary_path =
+	    remove_temporary ? string_clone_string(stream_path(gltf->output_streams[0])) : string(0, 0);
+	for (uint ibuffer = 0, buffers_count = array_count(gltf->output_streams); ibuffer < buffers_count; ++ibuffer)
+		stream_deallocate(gltf->output_streams[ibuffer]);
+	array_deallocate(gltf->output_streams);
+	if (remove_temporary)
+		fs_remove_file(STRING_ARGS(temporary_path));
+	string_deallocate(temporary_path.str);
+
+	virtualarray_deallocate(gltf->output_staging);
+	array_deallocate(gltf->output_pending);
+	array_deallocate(gltf->output_sizes);
+	string_deallocate(gltf->output_path.str);
+
+	gltf->output_buffers = nullptr;
+	gltf->output_streams = nullptr;
+	gltf->output_staging = nullptr;
+	gltf->output_pending = nullptr;
+	gltf->output_sizes = nullptr;
+	gltf->output_path = string(0, 0);
+}
+
+bool
+gltf_buffer_output_stream(gltf_t* gltf, const char* path, size_t length) {
+	if (array_count(gltf->output_sizes)) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE,
+		          STRING_CONST("Streaming export must be enabled before any data is added"));
+		return false;
+	}
+	string_deallocate(gltf->output_path.str);
+	gltf->output_path = string_clone(path, length);
+	return true;
+}
+
+static stream_t*
+gltf_buffer_output_stream_open(gltf_t* gltf, uint ibuffer) {
+	char path_buffer[BUILD_MAX_PATHLEN];
+	string_t path;
+	if (ibuffer)
+		path = string_format(path_buffer, sizeof(path_buffer), STRING_CONST("%.*s.%u.bin"),
+		                     STRING_FORMAT(gltf->output_path), ibuffer);
+	else
+		path = string_format(path_buffer, sizeof(path_buffer), STRING_CONST("%.*s.bin"),
+		                     STRING_FORMAT(gltf->output_path));
+	stream_t* stream =
+	    stream_open(STRING_ARGS(path), STREAM_IN | STREAM_OUT | STREAM_BINARY | STREAM_CREATE | STREAM_TRUNCATE);
+	if (!stream)
+		log_errorf(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Failed to open output buffer stream: %.*s"),
+		           STRING_FORMAT(path));
+	return stream;
+}
+
+bool
+gltf_buffer_output_allocate(gltf_t* gltf, size_t size, uint* buffer, size_t* offset, void** data) {
+	if (size > GLTF_MAX_OUTPUT_BUFFER_SIZE) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE,
+		           STRING_CONST("Data size %" PRIsize " exceeds maximum size of a single buffer"), size);
+		return false;
+	}
+
+	bool streaming = (gltf->output_path.length > 0);
+	uint buffers_count = array_count(gltf->output_sizes);
+	if (!buffers_count || ((gltf->output_sizes[buffers_count - 1] + size) > GLTF_MAX_OUTPUT_BUFFER_SIZE)) {
+		if (streaming) {
+			stream_t* stream = gltf_buffer_output_stream_open(gltf, buffers_count);
+			if (!stream)
+				return false;
+			array_push(gltf->output_streams, stream);
+		} else {
+			virtualarray_t* output = virtualarray_allocate(1, GLTF_MAX_OUTPUT_BUFFER_SIZE);
+			array_push(gltf->output_buffers, output);
+		}
+		array_push(gltf->output_sizes, 0);
+		++buffers_count;
+	}
+
+	uint ibuffer = buffers_count - 1;
+	*buffer = ibuffer;
+	*offset = gltf->output_sizes[ibuffer];
+	gltf->output_sizes[ibuffer] += size;
+
+	// Streamed data is staged until flushed, keeping only the data of the current mesh in memory
+	virtualarray_t* output;
+	if (streaming) {
+		if (!gltf->output_staging)
+			gltf->output_staging = virtualarray_allocate(1, GLTF_MAX_OUTPUT_BUFFER_SIZE * 2);
+		output = gltf->output_staging;
+		gltf_output_region_t region = {ibuffer, size};
+		array_push(gltf->output_pending, region);
+	} else {
+		output = gltf->output_buffers[ibuffer];
+	}
+	size_t staged = output->count;
+	virtualarray_resize(output, staged + size);
+	*data = pointer_offset(output->storage, staged);
+	return true;
+}
+
+bool
+gltf_buffer_output_flush(gltf_t* gltf) {
+	if (!gltf->output_staging)
+		return true;
+
+	bool success = true;
+	size_t offset = 0;
+	for (uint iregion = 0, regions_count = array_count(gltf->output_pending); iregion < regions_count; ++iregion) {
+		const gltf_output_region_t* region = gltf->output_pending + iregion;
+		stream_t* stream = gltf->output_streams[region->buffer];
+		if (stream_write(stream, pointer_offset(gltf->output_staging->storage, offset), region->size) !=
+		    region->size) {
+			log_errorf(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Failed to write output buffer %u"),
+			           region->buffer);
+			success = false;
+		}
+		offset += region->size;
+	}
+
+	// On failure the staged data is dropped and the buffers rewound to the end of the last successful flush
+	if (!success) {
+		for (uint iregion = 0, regions_count = array_count(gltf->output_pending); iregion < regions_count; ++iregion)
+			gltf->output_sizes[gltf->output_pending[iregion].buffer] -= gltf->output_pending[iregion].size;
+		for (uint iregion = 0, regions_count = array_count(gltf->output_pending); iregion < regions_count; ++iregion) {
+			uint ibuffer = gltf->output_pending[iregion].buffer;
+			stream_seek(gltf->output_streams[ibuffer], (ssize_t)gltf->output_sizes[ibuffer], STREAM_SEEK_BEGIN);
+		}
+	}
+	array_clear(gltf->output_pending);
+
+	// Release staging memory rather than keeping the largest mesh resident
+	virtualarray_deallocate(gltf->output_staging);
+	gltf->output_staging = nullptr;
+	return success;
+}
+
 void
 gltf_buffer_views_finalize(gltf_t* gltf) {
 	if (gltf->buffer_views)
@@ -98,6 +292,7 @@ gltf_buffer_views_finalize(gltf_t* gltf) {
 
 static void
 gltf_buffer_view_initialize(gltf_buffer_view_t* buffer_view) {
+	memset(buffer_view, 0, sizeof(gltf_buffer_view_t));
 	buffer_view->buffer = GLTF_INVALID_INDEX;
 }
 
@@ -130,8 +325,10 @@ gltf_buffer_view_parse_view(gltf_t* gltf, const char* data, json_token_t* tokens
 		else if ((identifier_hash == HASH_TARGET) &&
 		         !gltf_token_to_integer(gltf, data, tokens, itoken, &buffer_view->target))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			buffer_view->extensions = json_token_value(data, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_BUFFER_VIEW,
+		                                buffer_view, &buffer_view->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			buffer_view->extras = json_token_value(data, tokens + itoken);
 
@@ -162,9 +359,46 @@ gltf_buffer_views_parse(gltf_t* gltf, const char* data, json_token_t* tokens, si
 	while (iview) {
 		if (!gltf_buffer_view_parse_view(gltf, data, tokens, iview, gltf->buffer_views + icounter))
 			return false;
+		gltf->buffer_views[icounter].source = gltf_token_source(gltf, data, tokens, iview);
+		gltf->buffer_views[icounter].dirty = false;
 		iview = tokens[iview].sibling;
 		++icounter;
 	}
 
 	return true;
 }
+
+const void*
+gltf_buffer_view_data(gltf_t* gltf, uint iview, uint* size) {
+	if (iview >= array_count(gltf->buffer_views))
+		return nullptr;
+
+	const gltf_buffer_view_t* buffer_view = gltf->buffer_views + iview;
+	const void* data = gltf_buffer_data(gltf, buffer_view->buffer);
+	if (!data)
+		return nullptr;
+
+	const gltf_buffer_t* buffer = gltf->buffers + buffer_view->buffer;
+	if (((size_t)buffer_view->byte_offset + buffer_view->byte_length) > buffer->byte_length) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Buffer view %u outside buffer %u"), iview,
+		           buffer_view->buffer);
+		return nullptr;
+	}
+
+	if (size)
+		*size = buffer_view->byte_length;
+	return pointer_offset_const(data, buffer_view->byte_offset);
+}
+
+uint
+gltf_buffer_view_add(gltf_t* gltf, uint buffer, uint offset, uint length, uint stride, uint target) {
+	gltf_buffer_view_t buffer_view;
+	memset(&buffer_view, 0, sizeof(buffer_view));
+	buffer_view.buffer = buffer;
+	buffer_view.byte_offset = offset;
+	buffer_view.byte_length = length;
+	buffer_view.byte_stride = stride;
+	buffer_view.target = target;
+	array_push(gltf->buffer_views, buffer_view);
+	return array_count(gltf->buffer_views) - 1;
+}
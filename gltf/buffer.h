@@ -22,8 +22,53 @@ gltf_buffers_finalize(gltf_t* gltf);
 GLTF_API bool
 gltf_buffers_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
 
+GLTF_API const void*
+gltf_buffer_data(gltf_t* gltf, uint buffer);
+
+GLTF_API uint
+gltf_buffer_add(gltf_t* gltf, string_const_t name, void* data, uint size);
+
+GLTF_API void
+gltf_buffer_output_finalize(gltf_t* gltf);
+
+/*! Enable streaming export, where output buffer data is written to buffer files as each
+mesh is added instead of accumulated in memory. Buffer files are named <path>.bin,
+<path>.1.bin and so on. When writing an embedded GLB the first buffer file is temporary
+and removed when the glTF data structure is finalized. Must be called before adding data.
+\param gltf glTF data structure
+\param path Base path of buffer files, usually the output path without extension
+\param length Length of path
+\return true if success, false if data has already been added */
+GLTF_API bool
+gltf_buffer_output_stream(gltf_t* gltf, const char* path, size_t length);
+
+/*! Allocate space in the output buffers used during writing. Rolls over into a new output
+buffer if the current one cannot hold the requested size within GLTF_MAX_OUTPUT_BUFFER_SIZE.
+\param gltf glTF data structure
+\param size Number of bytes to allocate
+\param buffer Receives index of the buffer holding the allocated space
+\param offset Receives byte offset of the allocated space within the buffer
+\param data Receives pointer to allocated space, valid until next flush
+\return true if success, false if error */
+GLTF_API bool
+gltf_buffer_output_allocate(gltf_t* gltf, size_t size, uint* buffer, size_t* offset, void** data);
+
+/*! Write allocated data to the buffer files in streaming export mode, no-op otherwise. If
+writing fails the data allocated since the last flush is discarded and the buffer sizes restored,
+so the caller must drop any buffer views referencing it.
+\param gltf glTF data structure
+\return true if success, false if error */
+GLTF_API bool
+gltf_buffer_output_flush(gltf_t* gltf);
+
 GLTF_API void
 gltf_buffer_views_finalize(gltf_t* gltf);
 
 GLTF_API bool
 gltf_buffer_views_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
+
+GLTF_API const void*
+gltf_buffer_view_data(gltf_t* gltf, uint buffer_view, uint* size);
+
+GLTF_API uint
+gltf_buffer_view_add(gltf_t* gltf, uint buffer, uint offset, uint length, uint stride, uint target);
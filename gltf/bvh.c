@@ -0,0 +1,554 @@
+/* bvh.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "bvh.h"
+#include "bounds.h"
+#include "hierarchy.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/math.h>
+#include <foundation/thread.h>
+#include <foundation/system.h>
+
+#include <float.h>
+
+//! Number of bins evaluated for each split
+#define GLTF_BVH_BIN_COUNT 16
+//! Maximum number of items in a leaf, unless all item centroids coincide
+#define GLTF_BVH_LEAF_SIZE 4
+//! Minimum number of items to build subtrees in parallel
+#define GLTF_BVH_PARALLEL_THRESHOLD 16384
+//! Maximum number of threads building subtrees in parallel
+#define GLTF_BVH_MAX_THREADS 16
+
+typedef struct gltf_bvh_task_t {
+	//! Node index
+	uint node;
+	//! First item
+	uint start;
+	//! One past last item
+	uint end;
+} gltf_bvh_task_t;
+
+typedef struct gltf_bvh_bin_t {
+	float min[3];
+	float max[3];
+	uint count;
+} gltf_bvh_bin_t;
+
+typedef struct gltf_bvh_builder_t {
+	//! Item bounds, permuted along with items
+	gltf_bounds_t* bounds;
+	//! Item identifiers
+	uint* items;
+	//! Subtrees deferred to parallel build
+	gltf_bvh_task_t* tasks;
+	//! Node array of each deferred subtree, with subtree root node first
+	gltf_bvh_node_t** subtrees;
+} gltf_bvh_builder_t;
+
+typedef struct gltf_bvh_worker_t {
+	//! Builder
+	gltf_bvh_builder_t* builder;
+	//! First task index
+	uint first;
+	//! Task index stride
+	uint stride;
+	//! Thread
+	thread_t thread;
+} gltf_bvh_worker_t;
+
+void
+gltf_bvh_initialize(gltf_bvh_t* bvh) {
+	memset(bvh, 0, sizeof(gltf_bvh_t));
+}
+
+void
+gltf_bvh_finalize(gltf_bvh_t* bvh) {
+	array_deallocate(bvh->nodes);
+	memory_deallocate(bvh->items);
+	memory_deallocate(bvh->bounds);
+	gltf_bvh_initialize(bvh);
+}
+
+static FOUNDATION_FORCEINLINE float
+gltf_bvh_centroid(const gltf_bounds_t* bounds, uint axis) {
+	return (bounds->min[axis] + bounds->max[axis]) * 0.5f;
+}
+
+static FOUNDATION_FORCEINLINE float
+gltf_bvh_half_area(const float* min, const float* max) {
+	float dx = max[0] - min[0];
+	float dy = max[1] - min[1];
+	float dz = max[2] - min[2];
+	return (dx * dy) + (dy * dz) + (dz * dx);
+}
+
+static void
+gltf_bvh_swap(gltf_bvh_builder_t* builder, uint first, uint second) {
+	gltf_bounds_t bounds = builder->bounds[first];
+	builder->bounds[first] = builder->bounds[second];
+	builder->bounds[second] = bounds;
+	uint item = builder->items[first];
+	builder->items[first] = builder->items[second];
+	builder->items[second] = item;
+}
+
+//! Partition the item range with a binned surface area heuristic, return the index of the first item in
+//! the right half
+static uint
+gltf_bvh_split(gltf_bvh_builder_t* builder, uint start, uint end, const float* centroid_min,
+               const float* centroid_max) {
+	uint axis = 0;
+	for (uint icomp = 1; icomp < 3; ++icomp) {
+		if ((centroid_max[icomp] - centroid_min[icomp]) > (centroid_max[axis] - centroid_min[axis]))
+			axis = icomp;
+	}
+	float extent = centroid_max[axis] - centroid_min[axis];
+	if (extent <= 0)
+		return start + ((end - start) / 2);
+
+	gltf_bvh_bin_t bins[GLTF_BVH_BIN_COUNT];
+	for (uint ibin = 0; ibin < GLTF_BVH_BIN_COUNT; ++ibin) {
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			bins[ibin].min[icomp] = FLT_MAX;
+			bins[ibin].max[icomp] = -FLT_MAX;
+		}
+		bins[ibin].count = 0;
+	}
+
+	float scale = ((float)GLTF_BVH_BIN_COUNT * (1.0f - FLT_EPSILON)) / extent;
+	float origin = centroid_min[axis];
+	for (uint iitem = start; iitem < end; ++iitem) {
+		const gltf_bounds_t* bounds = builder->bounds + iitem;
+		uint ibin = (uint)((gltf_bvh_centroid(bounds, axis) - origin) * scale);
+		if (ibin >= GLTF_BVH_BIN_COUNT)
+			ibin = GLTF_BVH_BIN_COUNT - 1;
+		gltf_bvh_bin_t* bin = bins + ibin;
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			bin->min[icomp] = (bounds->min[icomp] < bin->min[icomp]) ? bounds->min[icomp] : bin->min[icomp];
+			bin->max[icomp] = (bounds->max[icomp] > bin->max[icomp]) ? bounds->max[icomp] : bin->max[icomp];
+		}
+		++bin->count;
+	}
+
+	// Sweep from the right to get the cost of each right half, then from the left to find the cheapest split
+	float right_cost[GLTF_BVH_BIN_COUNT];
+	gltf_bvh_bin_t accumulated = bins[GLTF_BVH_BIN_COUNT - 1];
+	for (uint ibin = GLTF_BVH_BIN_COUNT - 1; ibin > 0; --ibin) {
+		if (ibin < (GLTF_BVH_BIN_COUNT - 1)) {
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				accumulated.min[icomp] = math_min(accumulated.min[icomp], bins[ibin].min[icomp]);
+				accumulated.max[icomp] = math_max(accumulated.max[icomp], bins[ibin].max[icomp]);
+			}
+			accumulated.count += bins[ibin].count;
+		}
+		right_cost[ibin] =
+		    accumulated.count ? gltf_bvh_half_area(accumulated.min, accumulated.max) * (float)accumulated.count : 0;
+	}
+
+	uint best_bin = 0;
+	float best_cost = FLT_MAX;
+	accumulated = bins[0];
+	for (uint ibin = 0; ibin < (GLTF_BVH_BIN_COUNT - 1); ++ibin) {
+		if (ibin) {
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				accumulated.min[icomp] = math_min(accumulated.min[icomp], bins[ibin].min[icomp]);
+				accumulated.max[icomp] = math_max(accumulated.max[icomp], bins[ibin].max[icomp]);
+			}
+			accumulated.count += bins[ibin].count;
+		}
+		float left_cost =
+		    accumulated.count ? gltf_bvh_half_area(accumulated.min, accumulated.max) * (float)accumulated.count : 0;
+		float cost = left_cost + right_cost[ibin + 1];
+		if (cost < best_cost) {
+			best_cost = cost;
+			best_bin = ibin;
+		}
+	}
+
+	uint left = start;
+	uint right = end;
+	while (left < right) {
+		uint ibin = (uint)((gltf_bvh_centroid(builder->bounds + left, axis) - origin) * scale);
+		if (ibin <= best_bin)
+			++left;
+		else
+			gltf_bvh_swap(builder, left, --right);
+	}
+	if ((left == start) || (left == end))
+		return start + ((end - start) / 2);
+	return left;
+}
+
+//! Build the subtree of the given root node, optionally deferring subtrees with at most defer_size
+//! items to the task list of the builder
+static void
+gltf_bvh_build_subtree(gltf_bvh_builder_t* builder, gltf_bvh_node_t** nodes, uint root, uint start, uint end,
+                       uint defer_size) {
+	gltf_bvh_task_t* stack = nullptr;
+	gltf_bvh_task_t task = {root, start, end};
+	array_push(stack, task);
+	while (array_count(stack)) {
+		task = stack[array_count(stack) - 1];
+		array_pop(stack);
+
+		float centroid_min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float centroid_max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+		gltf_bvh_node_t* node = *nodes + task.node;
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			node->min[icomp] = FLT_MAX;
+			node->max[icomp] = -FLT_MAX;
+		}
+		for (uint iitem = task.start; iitem < task.end; ++iitem) {
+			const gltf_bounds_t* bounds = builder->bounds + iitem;
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				float centroid = gltf_bvh_centroid(bounds, icomp);
+				node->min[icomp] = math_min(node->min[icomp], bounds->min[icomp]);
+				node->max[icomp] = math_max(node->max[icomp], bounds->max[icomp]);
+				centroid_min[icomp] = math_min(centroid_min[icomp], centroid);
+				centroid_max[icomp] = math_max(centroid_max[icomp], centroid);
+			}
+		}
+
+		uint count = task.end - task.start;
+		if (count <= GLTF_BVH_LEAF_SIZE) {
+			node->offset = task.start;
+			node->count = count;
+			continue;
+		}
+		if (count <= defer_size) {
+			array_push(builder->tasks, task);
+			continue;
+		}
+
+		uint mid = gltf_bvh_split(builder, task.start, task.end, centroid_min, centroid_max);
+		uint children = array_count(*nodes);
+		node->offset = children;
+		node->count = 0;
+
+		gltf_bvh_node_t child = {{0}, 0, {0}, 0};
+		array_push(*nodes, child);
+		array_push(*nodes, child);
+		gltf_bvh_task_t left = {children, task.start, mid};
+		gltf_bvh_task_t right = {children + 1, mid, task.end};
+		array_push(stack, right);
+		array_push(stack, left);
+	}
+	array_deallocate(stack);
+}
+
+static void*
+gltf_bvh_build_worker(void* arg) {
+	gltf_bvh_worker_t* worker = arg;
+	gltf_bvh_builder_t* builder = worker->builder;
+	for (uint itask = worker->first, task_count = array_count(builder->tasks); itask < task_count;
+	     itask += worker->stride) {
+		gltf_bvh_task_t* task = builder->tasks + itask;
+		gltf_bvh_node_t root = {{0}, 0, {0}, 0};
+		array_push(builder->subtrees[itask], root);
+		gltf_bvh_build_subtree(builder, builder->subtrees + itask, 0, task->start, task->end, 0);
+	}
+	return nullptr;
+}
+
+bool
+gltf_bvh_build(gltf_bvh_t* bvh, const gltf_bounds_t* bounds, const uint* items, uint count) {
+	gltf_bvh_finalize(bvh);
+	if (!count)
+		return true;
+
+	bvh->item_count = count;
+	bvh->items = memory_allocate(HASH_GLTF, sizeof(uint) * count, 0, MEMORY_PERSISTENT);
+	bvh->bounds = memory_allocate(HASH_GLTF, sizeof(gltf_bounds_t) * count, 0, MEMORY_PERSISTENT);
+	memcpy(bvh->bounds, bounds, sizeof(gltf_bounds_t) * count);
+	for (uint iitem = 0; iitem < count; ++iitem)
+		bvh->items[iitem] = items ? items[iitem] : iitem;
+
+	gltf_bvh_builder_t builder;
+	memset(&builder, 0, sizeof(builder));
+	builder.bounds = bvh->bounds;
+	builder.items = bvh->items;
+
+	uint thread_count = (uint)system_hardware_threads();
+	if (thread_count > GLTF_BVH_MAX_THREADS)
+		thread_count = GLTF_BVH_MAX_THREADS;
+	uint defer_size = 0;
+	if ((count >= GLTF_BVH_PARALLEL_THRESHOLD) && (thread_count > 1))
+		defer_size = count / (thread_count * 4);
+
+	gltf_bvh_node_t root = {{0}, 0, {0}, 0};
+	array_reserve(bvh->nodes, (count / GLTF_BVH_LEAF_SIZE) * 2 + 1);
+	array_push(bvh->nodes, root);
+	gltf_bvh_build_subtree(&builder, &bvh->nodes, 0, 0, count, defer_size);
+
+	uint task_count = array_count(builder.tasks);
+	if (task_count) {
+		// Deferred subtrees cover disjoint item ranges and are built into separate node arrays
+		builder.subtrees = memory_allocate(HASH_GLTF, sizeof(gltf_bvh_node_t*) * task_count, 0,
+		                                   MEMORY_TEMPORARY | MEMORY_ZERO_INITIALIZED);
+		if (thread_count > task_count)
+			thread_count = task_count;
+		gltf_bvh_worker_t workers[GLTF_BVH_MAX_THREADS];
+		for (uint iworker = 0; iworker < thread_count; ++iworker) {
+			workers[iworker].builder = &builder;
+			workers[iworker].first = iworker;
+			workers[iworker].stride = thread_count;
+		}
+		for (uint iworker = 1; iworker < thread_count; ++iworker) {
+			thread_initialize(&workers[iworker].thread, gltf_bvh_build_worker, workers + iworker,
+			                  STRING_CONST("gltf_bvh"), THREAD_PRIORITY_NORMAL, 0);
+			thread_start(&workers[iworker].thread);
+		}
+		gltf_bvh_build_worker(workers);
+		for (uint iworker = 1; iworker < thread_count; ++iworker) {
+			thread_join(&workers[iworker].thread);
+			thread_finalize(&workers[iworker].thread);
+		}
+
+		// Splice subtrees into the main node array, the subtree root replaces the deferred node and the
+		// remaining nodes are appended with child offsets rebased
+		for (uint itask = 0; itask < task_count; ++itask) {
+			gltf_bvh_node_t* subtree = builder.subtrees[itask];
+			uint base = array_count(bvh->nodes);
+			uint subtree_count = array_count(subtree);
+			for (uint inode = 0; inode < subtree_count; ++inode) {
+				if (!subtree[inode].count)
+					subtree[inode].offset = base + subtree[inode].offset - 1;
+			}
+			bvh->nodes[builder.tasks[itask].node] = subtree[0];
+			if (subtree_count > 1) {
+				array_resize(bvh->nodes, base + subtree_count - 1);
+				memcpy(bvh->nodes + base, subtree + 1, sizeof(gltf_bvh_node_t) * (subtree_count - 1));
+			}
+			array_deallocate(subtree);
+		}
+		memory_deallocate(builder.subtrees);
+	}
+	array_deallocate(builder.tasks);
+
+	bvh->node_count = array_count(bvh->nodes);
+	return true;
+}
+
+bool
+gltf_bvh_build_scene(gltf_bvh_t* bvh, gltf_t* gltf, uint scene) {
+	gltf_bvh_finalize(bvh);
+	if (!gltf_bounds_compute(gltf))
+		return false;
+
+	gltf_hierarchy_t hierarchy;
+	gltf_hierarchy_initialize(&hierarchy);
+	if (!gltf_hierarchy_build(&hierarchy, gltf, scene))
+		return false;
+
+	gltf_bounds_t* bounds = nullptr;
+	uint* items = nullptr;
+	uint mesh_count = array_count(gltf->meshes);
+	for (uint ientry = 0; ientry < hierarchy.count; ++ientry) {
+		uint inode = hierarchy.node[ientry];
+		uint imesh = gltf->nodes[inode].mesh;
+		if ((imesh >= mesh_count) || gltf_bounds_is_empty(gltf->mesh_bounds + imesh))
+			continue;
+		gltf_bounds_t node_bounds;
+		if (!gltf_bounds_node_mesh(gltf, inode, hierarchy.world + ientry, &node_bounds) ||
+		    gltf_bounds_is_empty(&node_bounds))
+			continue;
+		array_push(bounds, node_bounds);
+		array_push(items, inode);
+	}
+
+	bool success = gltf_bvh_build(bvh, bounds, items, array_count(items));
+
+	array_deallocate(bounds);
+	array_deallocate(items);
+	gltf_hierarchy_finalize(&hierarchy);
+	return success;
+}
+
+//! Intersect a ray with a box, return entry distance or a negative value if missed
+static FOUNDATION_FORCEINLINE float
+gltf_bvh_ray_box(const float* min, const float* max, const float* origin, const float* inv_direction,
+                 float distance) {
+	float tnear = 0;
+	float tfar = distance;
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		float t0 = (min[icomp] - origin[icomp]) * inv_direction[icomp];
+		float t1 = (max[icomp] - origin[icomp]) * inv_direction[icomp];
+		if (t0 > t1) {
+			float swap = t0;
+			t0 = t1;
+			t1 = swap;
+		}
+		tnear = (t0 > tnear) ? t0 : tnear;
+		tfar = (t1 < tfar) ? t1 : tfar;
+	}
+	return (tnear <= tfar) ? tnear : -1.0f;
+}
+
+void
+gltf_bvh_query_rays(const gltf_bvh_t* bvh, const gltf_bvh_ray_t* rays, uint count, gltf_bvh_hit_t* hits,
+                    gltf_bvh_intersect_fn intersect, void* context) {
+	uint* stack = nullptr;
+	for (uint iray = 0; iray < count; ++iray) {
+		const gltf_bvh_ray_t* ray = rays + iray;
+		gltf_bvh_hit_t* hit = hits + iray;
+		hit->item = GLTF_INVALID_INDEX;
+		hit->distance = ray->distance;
+		if (!bvh->node_count)
+			continue;
+
+		float inv_direction[3];
+		for (uint icomp = 0; icomp < 3; ++icomp)
+			inv_direction[icomp] = 1.0f / ray->direction[icomp];
+
+		array_clear(stack);
+		if (gltf_bvh_ray_box(bvh->nodes[0].min, bvh->nodes[0].max, ray->origin, inv_direction, hit->distance) >= 0)
+			array_push(stack, 0);
+		while (array_count(stack)) {
+			const gltf_bvh_node_t* node = bvh->nodes + stack[array_count(stack) - 1];
+			array_pop(stack);
+			if (node->count) {
+				for (uint iitem = node->offset, end = node->offset + node->count; iitem < end; ++iitem) {
+					if (intersect) {
+						if (intersect(context, bvh->items[iitem], ray, &hit->distance))
+							hit->item = bvh->items[iitem];
+						continue;
+					}
+					const gltf_bounds_t* bounds = bvh->bounds + iitem;
+					float t = gltf_bvh_ray_box(bounds->min, bounds->max, ray->origin, inv_direction, hit->distance);
+					if ((t >= 0) && (t < hit->distance)) {
+						hit->distance = t;
+						hit->item = bvh->items[iitem];
+					}
+				}
+				continue;
+			}
+			// Visit the closer child first, culling children beyond the closest hit so far
+			const gltf_bvh_node_t* left = bvh->nodes + node->offset;
+			const gltf_bvh_node_t* right = left + 1;
+			float tleft = gltf_bvh_ray_box(left->min, left->max, ray->origin, inv_direction, hit->distance);
+			float tright = gltf_bvh_ray_box(right->min, right->max, ray->origin, inv_direction, hit->distance);
+			if ((tleft >= 0) && (tright >= 0)) {
+				bool left_first = (tleft <= tright);
+				array_push(stack, left_first ? node->offset + 1 : node->offset);
+				array_push(stack, left_first ? node->offset : node->offset + 1);
+			} else if (tleft >= 0) {
+				array_push(stack, node->offset);
+			} else if (tright >= 0) {
+				array_push(stack, node->offset + 1);
+			}
+		}
+	}
+	array_deallocate(stack);
+}
+
+typedef enum gltf_bvh_frustum_class {
+	GLTF_BVH_OUTSIDE,
+	GLTF_BVH_INTERSECT,
+	GLTF_BVH_INSIDE
+} gltf_bvh_frustum_class;
+
+static gltf_bvh_frustum_class
+gltf_bvh_frustum_classify(const float* min, const float* max, const float (*planes)[4], uint plane_count) {
+	gltf_bvh_frustum_class result = GLTF_BVH_INSIDE;
+	for (uint iplane = 0; iplane < plane_count; ++iplane) {
+		const float* plane = planes[iplane];
+		// Corners furthest along and against the plane normal
+		float inner = plane[3];
+		float outer = plane[3];
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			if (plane[icomp] >= 0) {
+				inner += plane[icomp] * max[icomp];
+				outer += plane[icomp] * min[icomp];
+			} else {
+				inner += plane[icomp] * min[icomp];
+				outer += plane[icomp] * max[icomp];
+			}
+		}
+		if (inner < 0)
+			return GLTF_BVH_OUTSIDE;
+		if (outer < 0)
+			result = GLTF_BVH_INTERSECT;
+	}
+	return result;
+}
+
+uint*
+gltf_bvh_query_frustum(const gltf_bvh_t* bvh, const float (*planes)[4], uint plane_count, uint* result) {
+	if (!bvh->node_count)
+		return result;
+	// Stack entries hold the node index shifted up one bit, with the low bit set when the node is known
+	// to be completely inside and needs no further tests
+	uint* stack = nullptr;
+	array_push(stack, 0);
+	while (array_count(stack)) {
+		uint entry = stack[array_count(stack) - 1];
+		array_pop(stack);
+		const gltf_bvh_node_t* node = bvh->nodes + (entry >> 1);
+		bool inside = (entry & 1);
+		if (!inside) {
+			gltf_bvh_frustum_class volume = gltf_bvh_frustum_classify(node->min, node->max, planes, plane_count);
+			if (volume == GLTF_BVH_OUTSIDE)
+				continue;
+			inside = (volume == GLTF_BVH_INSIDE);
+		}
+		if (node->count) {
+			for (uint iitem = node->offset, end = node->offset + node->count; iitem < end; ++iitem) {
+				const gltf_bounds_t* bounds = bvh->bounds + iitem;
+				if (inside || (gltf_bvh_frustum_classify(bounds->min, bounds->max, planes, plane_count) !=
+				               GLTF_BVH_OUTSIDE))
+					array_push(result, bvh->items[iitem]);
+			}
+		} else {
+			array_push(stack, (node->offset << 1) | (inside ? 1 : 0));
+			array_push(stack, ((node->offset + 1) << 1) | (inside ? 1 : 0));
+		}
+	}
+	array_deallocate(stack);
+	return result;
+}
+
+static FOUNDATION_FORCEINLINE bool
+gltf_bvh_box_overlap(const float* min, const float* max, const float* other_min, const float* other_max) {
+	return (min[0] <= other_max[0]) && (max[0] >= other_min[0]) && (min[1] <= other_max[1]) &&
+	       (max[1] >= other_min[1]) && (min[2] <= other_max[2]) && (max[2] >= other_min[2]);
+}
+
+uint*
+gltf_bvh_query_box(const gltf_bvh_t* bvh, const float* min, const float* max, uint* result) {
+	if (!bvh->node_count)
+		return result;
+	uint* stack = nullptr;
+	array_push(stack, 0);
+	while (array_count(stack)) {
+		const gltf_bvh_node_t* node = bvh->nodes + stack[array_count(stack) - 1];
+		array_pop(stack);
+		if (!gltf_bvh_box_overlap(node->min, node->max, min, max))
+			continue;
+		if (node->count) {
+			for (uint iitem = node->offset, end = node->offset + node->count; iitem < end; ++iitem) {
+				const gltf_bounds_t* bounds = bvh->bounds + iitem;
+				if (gltf_bvh_box_overlap(bounds->min, bounds->max, min, max))
+					array_push(result, bvh->items[iitem]);
+			}
+		} else {
+			array_push(stack, node->offset);
+			array_push(stack, node->offset + 1);
+		}
+	}
+	array_deallocate(stack);
+	return result;
+}
@@ -0,0 +1,86 @@
+/* bvh.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file bvh.h
+    Bounding volume hierarchy and spatial queries */
+
+#include "gltf.h"
+
+/*! Exact intersection test of a ray with an item, called for items whose bounds are hit
+\param context User context
+\param item Item identifier
+\param ray Ray
+\param distance Closest distance found so far, updated if the item is hit closer
+\return true if item was hit closer than the given distance, false if not */
+typedef bool (*gltf_bvh_intersect_fn)(void* context, uint item, const gltf_bvh_ray_t* ray, float* distance);
+
+/*! Initialize an empty bounding volume hierarchy
+\param bvh Bounding volume hierarchy */
+GLTF_API void
+gltf_bvh_initialize(gltf_bvh_t* bvh);
+
+/*! Release all memory held by a bounding volume hierarchy
+\param bvh Bounding volume hierarchy */
+GLTF_API void
+gltf_bvh_finalize(gltf_bvh_t* bvh);
+
+/*! Build a bounding volume hierarchy over a set of items using binned surface area heuristic
+splits. Large inputs build subtrees in parallel.
+\param bvh Bounding volume hierarchy, previous content is released
+\param bounds Bounds of each item
+\param items Identifier of each item, or null to use the item index as identifier
+\param count Number of items
+\return true if success, false if error */
+GLTF_API bool
+gltf_bvh_build(gltf_bvh_t* bvh, const gltf_bounds_t* bounds, const uint* items, uint count);
+
+/*! Build a bounding volume hierarchy over the world space bounds of all nodes with a mesh in a
+scene. Computes bounds for the glTF data structure.
+\param bvh Bounding volume hierarchy, previous content is released. Item identifiers are node indices
+\param gltf glTF data structure
+\param scene Scene index, or GLTF_INVALID_INDEX to use all nodes without a parent as roots
+\return true if success, false if error */
+GLTF_API bool
+gltf_bvh_build_scene(gltf_bvh_t* bvh, gltf_t* gltf, uint scene);
+
+/*! Find the closest item hit by each of a set of rays
+\param bvh Bounding volume hierarchy
+\param rays Rays
+\param count Number of rays
+\param hits Closest hit for each ray
+\param intersect Exact item intersection test, or null to intersect item bounds
+\param context User context passed to intersection test */
+GLTF_API void
+gltf_bvh_query_rays(const gltf_bvh_t* bvh, const gltf_bvh_ray_t* rays, uint count, gltf_bvh_hit_t* hits,
+                    gltf_bvh_intersect_fn intersect, void* context);
+
+/*! Find all items with bounds intersecting a frustum or other convex volume
+\param bvh Bounding volume hierarchy
+\param planes Planes (a, b, c, d) with inside where a*x + b*y + c*z + d >= 0
+\param plane_count Number of planes
+\param result Array of item identifiers to append to
+\return Array of item identifiers */
+GLTF_API uint*
+gltf_bvh_query_frustum(const gltf_bvh_t* bvh, const float (*planes)[4], uint plane_count, uint* result);
+
+/*! Find all items with bounds overlapping a box
+\param bvh Bounding volume hierarchy
+\param min Minimum corner of box
+\param max Maximum corner of box
+\param result Array of item identifiers to append to
+\return Array of item identifiers */
+GLTF_API uint*
+gltf_bvh_query_box(const gltf_bvh_t* bvh, const float* min, const float* max, uint* result);
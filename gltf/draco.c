@@ -0,0 +1,2761 @@
+/* draco.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "draco.h"
+#include "hashstrings.h"
+
+#include <foundation/memory.h>
+#include <foundation/json.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+#include <foundation/hashstrings.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+// Decoder for the Draco mesh bitstream (version 2.x) as referenced by KHR_draco_mesh_compression.
+// Mesh connectivity is either sequential or Edgebreaker (standard and valence traversal, bitstream
+// version 2.2). Attributes are decoded with the generic, integer, quantization and normal decoders,
+// with entropy coded values and all prediction schemes except the deprecated texture coordinate
+// scheme. The structure and arithmetic follow the reference decoder, since predictions must match
+// the encoder bit for bit.
+
+#define GLTF_DRACO_MESH_SEQUENTIAL 0
+#define GLTF_DRACO_MESH_EDGEBREAKER 1
+#define GLTF_DRACO_TRIANGULAR_MESH 1
+#define GLTF_DRACO_METADATA_FLAG 0x8000
+#define GLTF_DRACO_MAX_COMPONENTS 16
+#define GLTF_DRACO_MAX_PARALLELOGRAMS 4
+#define GLTF_DRACO_MAX_PRIORITY 3
+
+//! Bitstream version as (major << 8) | minor
+#define GLTF_DRACO_VERSION(major, minor) (((major) << 8) | (minor))
+
+enum gltf_draco_data_type {
+	GLTF_DRACO_DT_INVALID = 0,
+	GLTF_DRACO_DT_INT8,
+	GLTF_DRACO_DT_UINT8,
+	GLTF_DRACO_DT_INT16,
+	GLTF_DRACO_DT_UINT16,
+	GLTF_DRACO_DT_INT32,
+	GLTF_DRACO_DT_UINT32,
+	GLTF_DRACO_DT_INT64,
+	GLTF_DRACO_DT_UINT64,
+	GLTF_DRACO_DT_FLOAT32,
+	GLTF_DRACO_DT_FLOAT64,
+	GLTF_DRACO_DT_BOOL
+};
+
+enum gltf_draco_attribute_type {
+	GLTF_DRACO_POSITION = 0,
+	GLTF_DRACO_NORMAL,
+	GLTF_DRACO_COLOR,
+	GLTF_DRACO_TEX_COORD,
+	GLTF_DRACO_GENERIC
+};
+
+enum gltf_draco_attribute_decoder {
+	GLTF_DRACO_DECODER_GENERIC = 0,
+	GLTF_DRACO_DECODER_INTEGER,
+	GLTF_DRACO_DECODER_QUANTIZATION,
+	GLTF_DRACO_DECODER_NORMALS
+};
+
+enum gltf_draco_traversal {
+	GLTF_DRACO_TRAVERSAL_STANDARD = 0,
+	GLTF_DRACO_TRAVERSAL_PREDICTIVE,
+	GLTF_DRACO_TRAVERSAL_VALENCE
+};
+
+enum gltf_draco_sequencer {
+	GLTF_DRACO_SEQUENCER_DEPTH_FIRST = 0,
+	GLTF_DRACO_SEQUENCER_PREDICTION_DEGREE
+};
+
+enum gltf_draco_symbol {
+	GLTF_DRACO_TOPOLOGY_C = 0,
+	GLTF_DRACO_TOPOLOGY_S = 1,
+	GLTF_DRACO_TOPOLOGY_L = 3,
+	GLTF_DRACO_TOPOLOGY_R = 5,
+	GLTF_DRACO_TOPOLOGY_E = 7,
+	GLTF_DRACO_TOPOLOGY_INVALID = 9
+};
+
+enum gltf_draco_prediction {
+	GLTF_DRACO_PREDICTION_NONE = -2,
+	GLTF_DRACO_PREDICTION_DIFFERENCE = 0,
+	GLTF_DRACO_PREDICTION_PARALLELOGRAM = 1,
+	GLTF_DRACO_PREDICTION_MULTI_PARALLELOGRAM = 2,
+	GLTF_DRACO_PREDICTION_TEX_COORDS_DEPRECATED = 3,
+	GLTF_DRACO_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM = 4,
+	GLTF_DRACO_PREDICTION_TEX_COORDS_PORTABLE = 5,
+	GLTF_DRACO_PREDICTION_GEOMETRIC_NORMAL = 6
+};
+
+enum gltf_draco_transform {
+	GLTF_DRACO_TRANSFORM_NONE = -1,
+	GLTF_DRACO_TRANSFORM_DELTA = 0,
+	GLTF_DRACO_TRANSFORM_WRAP = 1,
+	GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON = 2,
+	GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED = 3
+};
+
+typedef struct gltf_draco_reader_t gltf_draco_reader_t;
+typedef struct gltf_draco_bit_reader_t gltf_draco_bit_reader_t;
+typedef struct gltf_draco_rabs_t gltf_draco_rabs_t;
+typedef struct gltf_draco_rans_symbol_t gltf_draco_rans_symbol_t;
+typedef struct gltf_draco_rans_t gltf_draco_rans_t;
+typedef struct gltf_draco_table_t gltf_draco_table_t;
+typedef struct gltf_draco_encoding_t gltf_draco_encoding_t;
+typedef struct gltf_draco_seams_t gltf_draco_seams_t;
+typedef struct gltf_draco_split_t gltf_draco_split_t;
+typedef struct gltf_draco_traversal_t gltf_draco_traversal_t;
+typedef struct gltf_draco_attribute_t gltf_draco_attribute_t;
+typedef struct gltf_draco_attributes_decoder_t gltf_draco_attributes_decoder_t;
+typedef struct gltf_draco_octahedron_t gltf_draco_octahedron_t;
+typedef struct gltf_draco_prediction_t gltf_draco_prediction_t;
+typedef struct gltf_draco_decoder_t gltf_draco_decoder_t;
+
+struct gltf_draco_reader_t {
+	const uint8_t* data;
+	size_t size;
+	size_t offset;
+	uint version;
+};
+
+//! Least significant bit first reader of raw bit fields
+struct gltf_draco_bit_reader_t {
+	const uint8_t* data;
+	size_t size;
+	size_t bit_offset;
+};
+
+//! Binary rABS decoder with an 8 bit probability of zero
+struct gltf_draco_rabs_t {
+	const uint8_t* data;
+	uint offset;
+	uint state;
+	uint prob_zero;
+};
+
+struct gltf_draco_rans_symbol_t {
+	uint prob;
+	uint cum_prob;
+};
+
+//! rANS symbol decoder with a probability table and a symbol lookup table
+struct gltf_draco_rans_t {
+	const uint8_t* data;
+	uint offset;
+	uint state;
+	uint precision;
+	uint symbol_count;
+	gltf_draco_rans_symbol_t* symbols;
+	uint* lookup;
+};
+
+//! Corner table of a triangle mesh. Attribute tables with seams share the opposite corners of
+//! the mesh table and treat corners opposite to a seam edge as having no opposite corner
+struct gltf_draco_table_t {
+	//! Vertex of each corner
+	uint* corner_vertex;
+	//! Opposite corner of each corner, owned by the mesh table
+	uint* opposite;
+	//! Seam flag of the edge opposite to each corner, null for the mesh table
+	bool* seam;
+	//! Left most corner of each vertex (array)
+	uint* vertex_corner;
+	//! Number of corners
+	uint corner_count;
+};
+
+//! Order in which attribute values are encoded, from the traversal of a corner table
+struct gltf_draco_encoding_t {
+	//! Encoded value index of each vertex
+	uint* vertex_value;
+	//! Corner of each encoded value (array)
+	uint* value_corner;
+};
+
+//! Connectivity of an attribute with seams
+struct gltf_draco_seams_t {
+	//! Attributes decoder using the connectivity, -1 if not used
+	int decoder;
+	//! Corners opposite to seam edges (array)
+	uint* corners;
+	//! Seam flag of each mesh vertex
+	bool* vertex_seam;
+	gltf_draco_table_t table;
+	gltf_draco_encoding_t encoding;
+	//! Connectivity is used by the decoder, cleared for per vertex decoders
+	bool connectivity_used;
+};
+
+struct gltf_draco_split_t {
+	uint source_symbol;
+	uint split_symbol;
+	uint source_edge;
+};
+
+//! Edgebreaker traversal symbol source
+struct gltf_draco_traversal_t {
+	uint type;
+	gltf_draco_bit_reader_t symbols;
+	gltf_draco_rabs_t start_faces;
+	gltf_draco_rabs_t* seams;
+	//! Valence traversal state
+	uint* context_symbols[6];
+	uint context_counter[6];
+	int active_context;
+	uint last_symbol;
+	uint* valences;
+};
+
+struct gltf_draco_attribute_t {
+	uint type;
+	uint unique_id;
+	uint data_type;
+	uint components;
+	uint decoder;
+	bool normalized;
+	//! Portable integer values, quantized or octahedral coordinates for transformed attributes
+	int32_t* portable;
+	//! Components of portable values
+	uint portable_components;
+	//! Decoded values, float if is_float is set, otherwise int32
+	void* values;
+	bool is_float;
+	//! Number of decoded values
+	uint value_count;
+	//! Value index of each point (array), identity if null
+	uint* point_value;
+};
+
+struct gltf_draco_attributes_decoder_t {
+	//! Attribute connectivity index, -1 for the position connectivity
+	int seams;
+	//! Per corner decoder using attribute connectivity
+	bool corner;
+	uint sequencer;
+	//! First attribute and number of attributes
+	uint first;
+	uint count;
+	//! Point of each encoded value (array)
+	uint* point_ids;
+};
+
+struct gltf_draco_octahedron_t {
+	int32_t quantization_bits;
+	int32_t max_quantized_value;
+	int32_t max_value;
+	int32_t center_value;
+	float dequantization_scale;
+};
+
+struct gltf_draco_prediction_t {
+	int method;
+	int transform;
+	//! Mesh data, null table for non-mesh schemes
+	const gltf_draco_table_t* table;
+	const uint* vertex_value;
+	const uint* value_corner;
+	uint value_corner_count;
+	//! Wrap transform bounds
+	int32_t min_value;
+	int32_t max_value;
+	int32_t max_dif;
+	//! Normal octahedron transform
+	gltf_draco_octahedron_t octahedron;
+	//! Crease edge flags per parallelogram count (arrays)
+	bool* crease[GLTF_DRACO_MAX_PARALLELOGRAMS];
+	//! Texture coordinate orientations (array), consumed from the back
+	bool* orientations;
+	//! Normal flip flags
+	gltf_draco_rabs_t flip;
+	//! Parent position attribute and point of each value
+	const gltf_draco_attribute_t* position;
+	const uint* point_ids;
+};
+
+struct gltf_draco_decoder_t {
+	gltf_draco_reader_t reader;
+	uint method;
+	//! Decoded faces as point indices (array)
+	uint* indices;
+	uint point_count;
+	//! Edgebreaker connectivity
+	gltf_draco_table_t table;
+	gltf_draco_encoding_t position_encoding;
+	int position_decoder;
+	bool* vertex_hole;
+	gltf_draco_seams_t* seams;
+	gltf_draco_attribute_t* attributes;
+	gltf_draco_attributes_decoder_t* decoders;
+};
+
+static bool
+gltf_draco_read(gltf_draco_reader_t* reader, void* dest, size_t size) {
+	if (reader->size - reader->offset < size)
+		return false;
+	memcpy(dest, reader->data + reader->offset, size);
+	reader->offset += size;
+	return true;
+}
+
+static bool
+gltf_draco_read_u8(gltf_draco_reader_t* reader, uint* value) {
+	uint8_t byte;
+	if (!gltf_draco_read(reader, &byte, 1))
+		return false;
+	*value = byte;
+	return true;
+}
+
+static bool
+gltf_draco_read_u32(gltf_draco_reader_t* reader, uint* value) {
+	uint8_t bytes[4];
+	if (!gltf_draco_read(reader, bytes, 4))
+		return false;
+	*value = (uint)bytes[0] | ((uint)bytes[1] << 8) | ((uint)bytes[2] << 16) | ((uint)bytes[3] << 24);
+	return true;
+}
+
+static bool
+gltf_draco_read_i32(gltf_draco_reader_t* reader, int32_t* value) {
+	uint bits = 0;
+	if (!gltf_draco_read_u32(reader, &bits))
+		return false;
+	*value = (int32_t)bits;
+	return true;
+}
+
+static bool
+gltf_draco_read_varint64(gltf_draco_reader_t* reader, uint64_t* value) {
+	uint64_t result = 0;
+	for (uint shift = 0; shift < 64; shift += 7) {
+		uint8_t byte;
+		if (!gltf_draco_read(reader, &byte, 1))
+			return false;
+		result |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool
+gltf_draco_read_varint(gltf_draco_reader_t* reader, uint* value) {
+	uint64_t result = 0;
+	if (!gltf_draco_read_varint64(reader, &result) || (result > 0xFFFFFFFFULL))
+		return false;
+	*value = (uint)result;
+	return true;
+}
+
+static bool
+gltf_draco_read_count(gltf_draco_reader_t* reader, uint* value) {
+	// Counts are varint encoded from bitstream version 2.2
+	if (reader->version < GLTF_DRACO_VERSION(2, 2))
+		return gltf_draco_read_u32(reader, value);
+	return gltf_draco_read_varint(reader, value);
+}
+
+static uint
+gltf_draco_data_type_size(uint data_type) {
+	switch (data_type) {
+		case GLTF_DRACO_DT_INT8:
+		case GLTF_DRACO_DT_UINT8:
+		case GLTF_DRACO_DT_BOOL:
+			return 1;
+		case GLTF_DRACO_DT_INT16:
+		case GLTF_DRACO_DT_UINT16:
+			return 2;
+		case GLTF_DRACO_DT_INT32:
+		case GLTF_DRACO_DT_UINT32:
+		case GLTF_DRACO_DT_FLOAT32:
+			return 4;
+		case GLTF_DRACO_DT_INT64:
+		case GLTF_DRACO_DT_UINT64:
+		case GLTF_DRACO_DT_FLOAT64:
+			return 8;
+		default:
+			break;
+	}
+	return 0;
+}
+
+static void
+gltf_draco_bit_start(gltf_draco_bit_reader_t* bits, const gltf_draco_reader_t* reader) {
+	bits->data = reader->data + reader->offset;
+	bits->size = reader->size - reader->offset;
+	bits->bit_offset = 0;
+}
+
+static uint
+gltf_draco_bit_read(gltf_draco_bit_reader_t* bits, uint count) {
+	uint value = 0;
+	for (uint ibit = 0; ibit < count; ++ibit, ++bits->bit_offset) {
+		size_t byte = bits->bit_offset >> 3;
+		if (byte < bits->size)
+			value |= (uint)((bits->data[byte] >> (bits->bit_offset & 7)) & 1) << ibit;
+	}
+	return value;
+}
+
+//! Skip the reader past the bytes consumed by the bit reader
+static bool
+gltf_draco_bit_end(gltf_draco_bit_reader_t* bits, gltf_draco_reader_t* reader) {
+	size_t bytes = (bits->bit_offset + 7) >> 3;
+	if (bytes > reader->size - reader->offset)
+		return false;
+	reader->offset += bytes;
+	return true;
+}
+
+//! Read the initial coder state stored in the last one to four bytes of an ANS buffer
+static bool
+gltf_draco_ans_init(const uint8_t* data, uint size, uint base, bool allow_long, uint* offset, uint* state) {
+	if (!size)
+		return false;
+	uint prefix = data[size - 1] >> 6;
+	if (prefix == 0) {
+		*offset = size - 1;
+		*state = data[size - 1] & 0x3F;
+	} else if ((prefix == 1) && (size >= 2)) {
+		*offset = size - 2;
+		*state = ((uint)data[size - 2] | ((uint)data[size - 1] << 8)) & 0x3FFF;
+	} else if ((prefix == 2) && (size >= 3)) {
+		*offset = size - 3;
+		*state = ((uint)data[size - 3] | ((uint)data[size - 2] << 8) | ((uint)data[size - 1] << 16)) & 0x3FFFFF;
+	} else if ((prefix == 3) && allow_long && (size >= 4)) {
+		*offset = size - 4;
+		*state = ((uint)data[size - 4] | ((uint)data[size - 3] << 8) | ((uint)data[size - 2] << 16) |
+		          ((uint)data[size - 1] << 24)) &
+		         0x3FFFFFFF;
+	} else {
+		return false;
+	}
+	*state += base;
+	return (*state < base * 256);
+}
+
+static bool
+gltf_draco_rabs_start(gltf_draco_rabs_t* rabs, gltf_draco_reader_t* reader) {
+	uint size = 0;
+	memset(rabs, 0, sizeof(gltf_draco_rabs_t));
+	if (!gltf_draco_read_u8(reader, &rabs->prob_zero) || !gltf_draco_read_count(reader, &size) ||
+	    (size > reader->size - reader->offset))
+		return false;
+	rabs->data = reader->data + reader->offset;
+	reader->offset += size;
+	return gltf_draco_ans_init(rabs->data, size, 4096, false, &rabs->offset, &rabs->state);
+}
+
+static bool
+gltf_draco_rabs_read(gltf_draco_rabs_t* rabs) {
+	// Reading past the end of the data (or from a coder that was never started) yields zero bits
+	if (!rabs->data)
+		return false;
+	uint prob = 256 - rabs->prob_zero;
+	if ((rabs->state < 4096) && (rabs->offset > 0))
+		rabs->state = (rabs->state * 256) + rabs->data[--rabs->offset];
+	uint quotient = rabs->state / 256;
+	uint remainder = rabs->state % 256;
+	uint scaled = quotient * prob;
+	bool value = (remainder < prob);
+	if (value)
+		rabs->state = scaled + remainder;
+	else
+		rabs->state = rabs->state - scaled - prob;
+	return value;
+}
+
+static void
+gltf_draco_rans_finalize(gltf_draco_rans_t* rans) {
+	array_deallocate(rans->symbols);
+	array_deallocate(rans->lookup);
+}
+
+//! Read the probability table and the encoded data of a rANS symbol coder. The precision is
+//! derived from the maximum bit length of the unique symbols
+static bool
+gltf_draco_rans_start(gltf_draco_rans_t* rans, gltf_draco_reader_t* reader, uint max_bit_length) {
+	uint precision_bits = (3 * max_bit_length) / 2;
+	if (precision_bits < 12)
+		precision_bits = 12;
+	else if (precision_bits > 20)
+		precision_bits = 20;
+	rans->precision = 1U << precision_bits;
+
+	if (!gltf_draco_read_varint(reader, &rans->symbol_count) ||
+	    (rans->symbol_count > rans->precision))
+		return false;
+	array_resize(rans->symbols, rans->symbol_count);
+	for (uint isymbol = 0; isymbol < rans->symbol_count; ++isymbol) {
+		uint data = 0;
+		if (!gltf_draco_read_u8(reader, &data))
+			return false;
+		uint token = data & 3;
+		if (token == 3) {
+			// Run of zero probability symbols
+			uint run = data >> 2;
+			if (isymbol + run >= rans->symbol_count)
+				return false;
+			for (uint irun = 0; irun <= run; ++irun)
+				rans->symbols[isymbol + irun].prob = 0;
+			isymbol += run;
+		} else {
+			uint prob = data >> 2;
+			for (uint ibyte = 0; ibyte < token; ++ibyte) {
+				uint extra = 0;
+				if (!gltf_draco_read_u8(reader, &extra))
+					return false;
+				prob |= extra << ((8 * (ibyte + 1)) - 2);
+			}
+			rans->symbols[isymbol].prob = prob;
+		}
+	}
+
+	array_resize(rans->lookup, rans->precision);
+	uint cum_prob = 0;
+	for (uint isymbol = 0; isymbol < rans->symbol_count; ++isymbol) {
+		uint prob = rans->symbols[isymbol].prob;
+		rans->symbols[isymbol].cum_prob = cum_prob;
+		if (prob > rans->precision - cum_prob)
+			return false;
+		for (uint islot = cum_prob; islot < cum_prob + prob; ++islot)
+			rans->lookup[islot] = isymbol;
+		cum_prob += prob;
+	}
+	if (rans->symbol_count && (cum_prob != rans->precision))
+		return false;
+
+	uint64_t size = 0;
+	if (!gltf_draco_read_varint64(reader, &size) || (size > reader->size - reader->offset))
+		return false;
+	rans->data = reader->data + reader->offset;
+	reader->offset += (size_t)size;
+	if (!rans->symbol_count)
+		return true;
+	return gltf_draco_ans_init(rans->data, (uint)size, rans->precision * 4, true, &rans->offset, &rans->state);
+}
+
+static uint
+gltf_draco_rans_read(gltf_draco_rans_t* rans) {
+	uint base = rans->precision * 4;
+	while ((rans->state < base) && (rans->offset > 0))
+		rans->state = (rans->state * 256) + rans->data[--rans->offset];
+	uint quotient = rans->state / rans->precision;
+	uint remainder = rans->state % rans->precision;
+	uint symbol = rans->lookup[remainder];
+	rans->state = (quotient * rans->symbols[symbol].prob) + remainder - rans->symbols[symbol].cum_prob;
+	return symbol;
+}
+
+//! Decode entropy coded symbols, either as raw rANS coded values or as rANS coded bit lengths
+//! tagging raw bit fields for each group of components
+static bool
+gltf_draco_decode_symbols(gltf_draco_reader_t* reader, uint value_count, uint components, uint* values) {
+	if (!value_count)
+		return true;
+
+	uint scheme = 0;
+	if (!gltf_draco_read_u8(reader, &scheme) || (scheme > 1))
+		return false;
+
+	gltf_draco_rans_t rans;
+	memset(&rans, 0, sizeof(rans));
+	bool success = false;
+	if (scheme == 1) {
+		uint max_bit_length = 0;
+		if (!gltf_draco_read_u8(reader, &max_bit_length) || !max_bit_length || (max_bit_length > 18) ||
+		    !gltf_draco_rans_start(&rans, reader, max_bit_length) || !rans.symbol_count)
+			goto exit;
+		for (uint ivalue = 0; ivalue < value_count; ++ivalue)
+			values[ivalue] = gltf_draco_rans_read(&rans);
+	} else {
+		if (!components || !gltf_draco_rans_start(&rans, reader, 5) || !rans.symbol_count)
+			goto exit;
+		gltf_draco_bit_reader_t bits;
+		gltf_draco_bit_start(&bits, reader);
+		for (uint ivalue = 0; ivalue < value_count; ivalue += components) {
+			uint bit_length = gltf_draco_rans_read(&rans);
+			if (bit_length > 32)
+				goto exit;
+			for (uint icomp = 0; (icomp < components) && (ivalue + icomp < value_count); ++icomp)
+				values[ivalue + icomp] = gltf_draco_bit_read(&bits, bit_length);
+		}
+		if (!gltf_draco_bit_end(&bits, reader))
+			goto exit;
+	}
+	success = true;
+
+exit:
+	gltf_draco_rans_finalize(&rans);
+	return success;
+}
+
+static uint
+gltf_draco_next(uint corner) {
+	if (corner == GLTF_INVALID_INDEX)
+		return corner;
+	return ((corner % 3) == 2) ? (corner - 2) : (corner + 1);
+}
+
+static uint
+gltf_draco_previous(uint corner) {
+	if (corner == GLTF_INVALID_INDEX)
+		return corner;
+	return ((corner % 3) == 0) ? (corner + 2) : (corner - 1);
+}
+
+static uint
+gltf_draco_opposite(const gltf_draco_table_t* table, uint corner) {
+	if ((corner == GLTF_INVALID_INDEX) || (table->seam && table->seam[corner]))
+		return GLTF_INVALID_INDEX;
+	return table->opposite[corner];
+}
+
+static uint
+gltf_draco_vertex(const gltf_draco_table_t* table, uint corner) {
+	if (corner == GLTF_INVALID_INDEX)
+		return corner;
+	return table->corner_vertex[corner];
+}
+
+static uint
+gltf_draco_left_most(const gltf_draco_table_t* table, uint vertex) {
+	if (vertex >= array_count(table->vertex_corner))
+		return GLTF_INVALID_INDEX;
+	return table->vertex_corner[vertex];
+}
+
+static uint
+gltf_draco_swing_left(const gltf_draco_table_t* table, uint corner) {
+	return gltf_draco_next(gltf_draco_opposite(table, gltf_draco_next(corner)));
+}
+
+static uint
+gltf_draco_swing_right(const gltf_draco_table_t* table, uint corner) {
+	return gltf_draco_previous(gltf_draco_opposite(table, gltf_draco_previous(corner)));
+}
+
+static uint
+gltf_draco_left_corner(const gltf_draco_table_t* table, uint corner) {
+	return gltf_draco_opposite(table, gltf_draco_previous(corner));
+}
+
+static uint
+gltf_draco_right_corner(const gltf_draco_table_t* table, uint corner) {
+	return gltf_draco_opposite(table, gltf_draco_next(corner));
+}
+
+static bool
+gltf_draco_on_boundary(const gltf_draco_table_t* table, uint vertex) {
+	uint corner = gltf_draco_left_most(table, vertex);
+	return (corner == GLTF_INVALID_INDEX) || (gltf_draco_swing_left(table, corner) == GLTF_INVALID_INDEX);
+}
+
+static void
+gltf_draco_set_opposite(gltf_draco_table_t* table, uint corner, uint opposite) {
+	table->opposite[corner] = opposite;
+	table->opposite[opposite] = corner;
+}
+
+static uint
+gltf_draco_add_vertex(gltf_draco_table_t* table) {
+	uint corner = GLTF_INVALID_INDEX;
+	array_push(table->vertex_corner, corner);
+	return array_count(table->vertex_corner) - 1;
+}
+
+static void
+gltf_draco_table_finalize(gltf_draco_table_t* table, bool owns_opposite) {
+	memory_deallocate(table->corner_vertex);
+	if (owns_opposite)
+		memory_deallocate(table->opposite);
+	memory_deallocate(table->seam);
+	array_deallocate(table->vertex_corner);
+}
+
+static void
+gltf_draco_encoding_finalize(gltf_draco_encoding_t* encoding) {
+	memory_deallocate(encoding->vertex_value);
+	array_deallocate(encoding->value_corner);
+}
+
+static uint
+gltf_draco_traversal_symbol(gltf_draco_traversal_t* traversal) {
+	if (traversal->type == GLTF_DRACO_TRAVERSAL_STANDARD) {
+		uint symbol = gltf_draco_bit_read(&traversal->symbols, 1);
+		if (symbol != GLTF_DRACO_TOPOLOGY_C)
+			symbol |= gltf_draco_bit_read(&traversal->symbols, 2) << 1;
+		return symbol;
+	}
+
+	// Valence traversal codes symbols in contexts given by the valence of the active vertex,
+	// with the first symbol always starting a new component
+	static const uint symbol_map[] = {GLTF_DRACO_TOPOLOGY_C, GLTF_DRACO_TOPOLOGY_S, GLTF_DRACO_TOPOLOGY_L,
+	                                  GLTF_DRACO_TOPOLOGY_R, GLTF_DRACO_TOPOLOGY_E};
+	traversal->last_symbol = GLTF_DRACO_TOPOLOGY_E;
+	if (traversal->active_context >= 0) {
+		uint context = (uint)traversal->active_context;
+		if (!traversal->context_counter[context])
+			return GLTF_DRACO_TOPOLOGY_INVALID;
+		uint symbol = traversal->context_symbols[context][--traversal->context_counter[context]];
+		if (symbol >= sizeof(symbol_map) / sizeof(symbol_map[0]))
+			return GLTF_DRACO_TOPOLOGY_INVALID;
+		traversal->last_symbol = symbol_map[symbol];
+	}
+	return traversal->last_symbol;
+}
+
+static void
+gltf_draco_traversal_corner(gltf_draco_traversal_t* traversal, const gltf_draco_table_t* table, uint corner) {
+	if (traversal->type != GLTF_DRACO_TRAVERSAL_VALENCE)
+		return;
+
+	uint vertex[3] = {gltf_draco_vertex(table, corner), gltf_draco_vertex(table, gltf_draco_next(corner)),
+	                  gltf_draco_vertex(table, gltf_draco_previous(corner))};
+	uint increment[3] = {0, 1, 1};
+	if (traversal->last_symbol == GLTF_DRACO_TOPOLOGY_R) {
+		increment[0] = 1;
+		increment[2] = 2;
+	} else if (traversal->last_symbol == GLTF_DRACO_TOPOLOGY_L) {
+		increment[0] = 1;
+		increment[1] = 2;
+	} else if (traversal->last_symbol == GLTF_DRACO_TOPOLOGY_E) {
+		increment[0] = increment[1] = increment[2] = 2;
+	}
+	uint valence_count = array_count(traversal->valences);
+	for (uint ivertex = 0; ivertex < 3; ++ivertex) {
+		if (vertex[ivertex] < valence_count)
+			traversal->valences[vertex[ivertex]] += increment[ivertex];
+	}
+
+	uint valence = (vertex[1] < valence_count) ? traversal->valences[vertex[1]] : 0;
+	if (valence < 2)
+		valence = 2;
+	else if (valence > 7)
+		valence = 7;
+	traversal->active_context = (int)valence - 2;
+}
+
+static void
+gltf_draco_traversal_finalize(gltf_draco_traversal_t* traversal) {
+	array_deallocate(traversal->seams);
+	for (uint icontext = 0; icontext < 6; ++icontext)
+		array_deallocate(traversal->context_symbols[icontext]);
+	array_deallocate(traversal->valences);
+}
+
+static bool
+gltf_draco_decode_splits(gltf_draco_reader_t* reader, uint face_count, gltf_draco_split_t** splits) {
+	uint split_count = 0;
+	if (!gltf_draco_read_varint(reader, &split_count) || (split_count > face_count))
+		return false;
+	if (!split_count)
+		return true;
+
+	uint last_source = 0;
+	for (uint isplit = 0; isplit < split_count; ++isplit) {
+		uint source_delta = 0, split_delta = 0;
+		if (!gltf_draco_read_varint(reader, &source_delta) || !gltf_draco_read_varint(reader, &split_delta) ||
+		    (source_delta > GLTF_MAX_INDEX - last_source) || (split_delta > last_source + source_delta))
+			return false;
+		gltf_draco_split_t split;
+		split.source_symbol = last_source + source_delta;
+		split.split_symbol = split.source_symbol - split_delta;
+		split.source_edge = 0;
+		array_push(*splits, split);
+		last_source = split.source_symbol;
+	}
+
+	gltf_draco_bit_reader_t bits;
+	gltf_draco_bit_start(&bits, reader);
+	for (uint isplit = 0; isplit < split_count; ++isplit)
+		(*splits)[isplit].source_edge = gltf_draco_bit_read(&bits, 1);
+	return gltf_draco_bit_end(&bits, reader);
+}
+
+static bool
+gltf_draco_traversal_start(gltf_draco_traversal_t* traversal, gltf_draco_reader_t* reader, uint seam_count,
+                           uint face_count, uint vertex_count) {
+	if (traversal->type == GLTF_DRACO_TRAVERSAL_STANDARD) {
+		uint64_t size = 0;
+		if (!gltf_draco_read_varint64(reader, &size) || (size > reader->size - reader->offset))
+			return false;
+		gltf_draco_bit_start(&traversal->symbols, reader);
+		reader->offset += (size_t)size;
+	}
+
+	if (!gltf_draco_rabs_start(&traversal->start_faces, reader))
+		return false;
+	array_resize(traversal->seams, seam_count);
+	for (uint iseam = 0; iseam < seam_count; ++iseam) {
+		if (!gltf_draco_rabs_start(traversal->seams + iseam, reader))
+			return false;
+	}
+
+	traversal->active_context = -1;
+	if (traversal->type == GLTF_DRACO_TRAVERSAL_STANDARD)
+		return true;
+
+	uint split_symbol_count = 0, mode = 0;
+	if (!gltf_draco_read_varint(reader, &split_symbol_count) || (split_symbol_count >= vertex_count) ||
+	    !gltf_draco_read_u8(reader, &mode) || (mode != 0))
+		return false;
+	for (uint icontext = 0; icontext < 6; ++icontext) {
+		uint symbol_count = 0;
+		if (!gltf_draco_read_varint(reader, &symbol_count) || (symbol_count > face_count))
+			return false;
+		array_resize(traversal->context_symbols[icontext], symbol_count);
+		traversal->context_counter[icontext] = symbol_count;
+		if (!gltf_draco_decode_symbols(reader, symbol_count, 1, traversal->context_symbols[icontext]))
+			return false;
+	}
+	array_resize(traversal->valences, vertex_count);
+	if (vertex_count)
+		memset(traversal->valences, 0, sizeof(uint) * vertex_count);
+	return true;
+}
+
+//! Decode the Edgebreaker symbols into the corner table, returning the number of vertices or
+//! GLTF_INVALID_INDEX if the data is invalid
+static uint
+gltf_draco_decode_faces(gltf_draco_decoder_t* decoder, gltf_draco_traversal_t* traversal, gltf_draco_split_t* splits,
+                        uint symbol_count, uint max_vertex_count) {
+	gltf_draco_table_t* table = &decoder->table;
+	uint face_count = table->corner_count / 3;
+	uint* stack = nullptr;
+	uint* invalid_vertices = nullptr;
+	uint* split_corners = memory_allocate(HASH_GLTF, sizeof(uint) * (symbol_count ? symbol_count : 1), 0,
+	                                      MEMORY_TEMPORARY);
+	for (uint isymbol = 0; isymbol < symbol_count; ++isymbol)
+		split_corners[isymbol] = GLTF_INVALID_INDEX;
+	bool remove_invalid = (array_count(decoder->seams) == 0);
+	uint vertex_count = GLTF_INVALID_INDEX;
+	uint face = 0;
+
+	for (uint isymbol = 0; isymbol < symbol_count; ++isymbol, ++face) {
+		uint corner = face * 3;
+		bool check_split = false;
+		uint symbol = gltf_draco_traversal_symbol(traversal);
+		if (symbol == GLTF_DRACO_TOPOLOGY_C) {
+			if (!array_count(stack))
+				goto exit;
+			uint corner_a = stack[array_count(stack) - 1];
+			uint vertex_x = gltf_draco_vertex(table, gltf_draco_next(corner_a));
+			uint corner_b = gltf_draco_next(gltf_draco_left_most(table, vertex_x));
+			if ((corner_a == corner_b) || (corner_b == GLTF_INVALID_INDEX) ||
+			    (table->opposite[corner_a] != GLTF_INVALID_INDEX) || (table->opposite[corner_b] != GLTF_INVALID_INDEX))
+				goto exit;
+			gltf_draco_set_opposite(table, corner_a, corner + 1);
+			gltf_draco_set_opposite(table, corner_b, corner + 2);
+			uint vertex_a_prev = gltf_draco_vertex(table, gltf_draco_previous(corner_a));
+			uint vertex_b_next = gltf_draco_vertex(table, gltf_draco_next(corner_b));
+			if ((vertex_x == vertex_a_prev) || (vertex_x == vertex_b_next))
+				goto exit;
+			table->corner_vertex[corner] = vertex_x;
+			table->corner_vertex[corner + 1] = vertex_b_next;
+			table->corner_vertex[corner + 2] = vertex_a_prev;
+			table->vertex_corner[vertex_a_prev] = corner + 2;
+			decoder->vertex_hole[vertex_x] = false;
+			stack[array_count(stack) - 1] = corner;
+		} else if ((symbol == GLTF_DRACO_TOPOLOGY_R) || (symbol == GLTF_DRACO_TOPOLOGY_L)) {
+			if (!array_count(stack))
+				goto exit;
+			uint corner_a = stack[array_count(stack) - 1];
+			if (table->opposite[corner_a] != GLTF_INVALID_INDEX)
+				goto exit;
+			uint corner_opposite = corner + ((symbol == GLTF_DRACO_TOPOLOGY_R) ? 2 : 1);
+			uint corner_left = corner + ((symbol == GLTF_DRACO_TOPOLOGY_R) ? 1 : 0);
+			uint corner_right = corner + ((symbol == GLTF_DRACO_TOPOLOGY_R) ? 0 : 2);
+			gltf_draco_set_opposite(table, corner_opposite, corner_a);
+			uint vertex_new = gltf_draco_add_vertex(table);
+			if (array_count(table->vertex_corner) > max_vertex_count)
+				goto exit;
+			table->corner_vertex[corner_opposite] = vertex_new;
+			table->vertex_corner[vertex_new] = corner_opposite;
+			uint vertex_right = gltf_draco_vertex(table, gltf_draco_previous(corner_a));
+			table->corner_vertex[corner_right] = vertex_right;
+			table->vertex_corner[vertex_right] = corner_right;
+			table->corner_vertex[corner_left] = gltf_draco_vertex(table, gltf_draco_next(corner_a));
+			stack[array_count(stack) - 1] = corner;
+			check_split = true;
+		} else if (symbol == GLTF_DRACO_TOPOLOGY_S) {
+			if (!array_count(stack))
+				goto exit;
+			uint corner_b = stack[array_count(stack) - 1];
+			array_pop(stack);
+			// Corner a is either the next active edge or an edge created by a topology split
+			if (split_corners[isymbol] != GLTF_INVALID_INDEX)
+				array_push(stack, split_corners[isymbol]);
+			if (!array_count(stack))
+				goto exit;
+			uint corner_a = stack[array_count(stack) - 1];
+			if ((corner_a == corner_b) || (table->opposite[corner_a] != GLTF_INVALID_INDEX) ||
+			    (table->opposite[corner_b] != GLTF_INVALID_INDEX))
+				goto exit;
+			gltf_draco_set_opposite(table, corner_a, corner + 2);
+			gltf_draco_set_opposite(table, corner_b, corner + 1);
+			uint vertex_p = gltf_draco_vertex(table, gltf_draco_previous(corner_a));
+			table->corner_vertex[corner] = vertex_p;
+			table->corner_vertex[corner + 1] = gltf_draco_vertex(table, gltf_draco_next(corner_a));
+			uint vertex_b_prev = gltf_draco_vertex(table, gltf_draco_previous(corner_b));
+			table->corner_vertex[corner + 2] = vertex_b_prev;
+			table->vertex_corner[vertex_b_prev] = corner + 2;
+			uint corner_n = gltf_draco_next(corner_b);
+			uint vertex_n = gltf_draco_vertex(table, corner_n);
+			if (traversal->type == GLTF_DRACO_TRAVERSAL_VALENCE)
+				traversal->valences[vertex_p] += traversal->valences[vertex_n];
+			// Merge vertex n into vertex p
+			table->vertex_corner[vertex_p] = table->vertex_corner[vertex_n];
+			uint corner_first = corner_n;
+			while (corner_n != GLTF_INVALID_INDEX) {
+				table->corner_vertex[corner_n] = vertex_p;
+				corner_n = gltf_draco_swing_left(table, corner_n);
+				if (corner_n == corner_first)
+					goto exit;
+			}
+			table->vertex_corner[vertex_n] = GLTF_INVALID_INDEX;
+			if (remove_invalid)
+				array_push(invalid_vertices, vertex_n);
+			stack[array_count(stack) - 1] = corner;
+		} else if (symbol == GLTF_DRACO_TOPOLOGY_E) {
+			uint vertex_first = gltf_draco_add_vertex(table);
+			gltf_draco_add_vertex(table);
+			gltf_draco_add_vertex(table);
+			if (array_count(table->vertex_corner) > max_vertex_count)
+				goto exit;
+			for (uint icorner = 0; icorner < 3; ++icorner) {
+				table->corner_vertex[corner + icorner] = vertex_first + icorner;
+				table->vertex_corner[vertex_first + icorner] = corner + icorner;
+			}
+			array_push(stack, corner);
+			check_split = true;
+		} else {
+			goto exit;
+		}
+
+		gltf_draco_traversal_corner(traversal, table, stack[array_count(stack) - 1]);
+
+		if (check_split) {
+			// Split events are stored in encoder symbol order, which is the reverse of decoding order
+			uint encoder_symbol = symbol_count - isymbol - 1;
+			while (array_count(splits)) {
+				gltf_draco_split_t* split = splits + (array_count(splits) - 1);
+				if (split->source_symbol > encoder_symbol)
+					goto exit;
+				if (split->source_symbol != encoder_symbol)
+					break;
+				if (split->split_symbol >= symbol_count)
+					goto exit;
+				uint top = stack[array_count(stack) - 1];
+				split_corners[symbol_count - split->split_symbol - 1] =
+				    split->source_edge ? gltf_draco_next(top) : gltf_draco_previous(top);
+				array_pop(splits);
+			}
+		}
+	}
+	if (array_count(table->vertex_corner) > max_vertex_count)
+		goto exit;
+
+	// Remaining active edges either lie on a boundary or close an interior start face
+	while (array_count(stack)) {
+		uint corner = stack[array_count(stack) - 1];
+		array_pop(stack);
+		if (!gltf_draco_rabs_read(&traversal->start_faces))
+			continue;
+		if (face >= face_count)
+			goto exit;
+		uint vertex_n = gltf_draco_vertex(table, gltf_draco_next(corner));
+		uint corner_b = gltf_draco_next(gltf_draco_left_most(table, vertex_n));
+		uint vertex_x = gltf_draco_vertex(table, gltf_draco_next(corner_b));
+		uint corner_c = gltf_draco_next(gltf_draco_left_most(table, vertex_x));
+		if ((corner_b == GLTF_INVALID_INDEX) || (corner_c == GLTF_INVALID_INDEX) || (corner == corner_b) ||
+		    (corner == corner_c) || (corner_b == corner_c) || (table->opposite[corner] != GLTF_INVALID_INDEX) ||
+		    (table->opposite[corner_b] != GLTF_INVALID_INDEX) || (table->opposite[corner_c] != GLTF_INVALID_INDEX))
+			goto exit;
+		uint vertex_p = gltf_draco_vertex(table, gltf_draco_next(corner_c));
+		uint corner_new = 3 * face++;
+		gltf_draco_set_opposite(table, corner_new, corner);
+		gltf_draco_set_opposite(table, corner_new + 1, corner_b);
+		gltf_draco_set_opposite(table, corner_new + 2, corner_c);
+		table->corner_vertex[corner_new] = vertex_x;
+		table->corner_vertex[corner_new + 1] = vertex_p;
+		table->corner_vertex[corner_new + 2] = vertex_n;
+		decoder->vertex_hole[vertex_x] = decoder->vertex_hole[vertex_p] = decoder->vertex_hole[vertex_n] = false;
+	}
+	if (face != face_count)
+		goto exit;
+
+	// Move the last used vertices into the slots of vertices removed by merges
+	vertex_count = array_count(table->vertex_corner);
+	for (uint iinvalid = 0, invalid_count = array_count(invalid_vertices); iinvalid < invalid_count; ++iinvalid) {
+		uint vertex_invalid = invalid_vertices[iinvalid];
+		while (vertex_count && (table->vertex_corner[vertex_count - 1] == GLTF_INVALID_INDEX))
+			--vertex_count;
+		if (!vertex_count || (vertex_count - 1 < vertex_invalid))
+			continue;
+		uint vertex_source = vertex_count - 1;
+		uint corner_first = table->vertex_corner[vertex_source];
+		uint corner_walk = corner_first;
+		bool left = true;
+		while (corner_walk != GLTF_INVALID_INDEX) {
+			table->corner_vertex[corner_walk] = vertex_invalid;
+			if (left) {
+				corner_walk = gltf_draco_swing_left(table, corner_walk);
+				if (corner_walk == GLTF_INVALID_INDEX) {
+					corner_walk = gltf_draco_swing_right(table, corner_first);
+					left = false;
+				} else if (corner_walk == corner_first) {
+					corner_walk = GLTF_INVALID_INDEX;
+				}
+			} else {
+				corner_walk = gltf_draco_swing_right(table, corner_walk);
+			}
+		}
+		table->vertex_corner[vertex_invalid] = corner_first;
+		table->vertex_corner[vertex_source] = GLTF_INVALID_INDEX;
+		decoder->vertex_hole[vertex_invalid] = decoder->vertex_hole[vertex_source];
+		decoder->vertex_hole[vertex_source] = false;
+		--vertex_count;
+	}
+
+exit:
+	memory_deallocate(split_corners);
+	array_deallocate(invalid_vertices);
+	array_deallocate(stack);
+	return vertex_count;
+}
+
+//! Build the corner table of an attribute from the mesh corner table and the attribute seams
+static bool
+gltf_draco_seams_build(gltf_draco_seams_t* seams, const gltf_draco_table_t* mesh) {
+	uint corner_count = mesh->corner_count;
+	uint vertex_count = array_count(mesh->vertex_corner);
+	gltf_draco_table_t* table = &seams->table;
+	table->corner_count = corner_count;
+	table->opposite = mesh->opposite;
+	table->seam =
+	    memory_allocate(HASH_GLTF, sizeof(bool) * corner_count, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	table->corner_vertex = memory_allocate(HASH_GLTF, sizeof(uint) * corner_count, 0, MEMORY_PERSISTENT);
+	seams->vertex_seam = memory_allocate(HASH_GLTF, sizeof(bool) * (vertex_count ? vertex_count : 1), 0,
+	                                     MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	for (uint icorner = 0; icorner < corner_count; ++icorner)
+		table->corner_vertex[icorner] = GLTF_INVALID_INDEX;
+
+	for (uint iseam = 0, seam_count = array_count(seams->corners); iseam < seam_count; ++iseam) {
+		uint corner = seams->corners[iseam];
+		uint opposite = mesh->opposite[corner];
+		table->seam[corner] = true;
+		seams->vertex_seam[mesh->corner_vertex[gltf_draco_next(corner)]] = true;
+		seams->vertex_seam[mesh->corner_vertex[gltf_draco_previous(corner)]] = true;
+		if (opposite != GLTF_INVALID_INDEX) {
+			table->seam[opposite] = true;
+			seams->vertex_seam[mesh->corner_vertex[gltf_draco_next(opposite)]] = true;
+			seams->vertex_seam[mesh->corner_vertex[gltf_draco_previous(opposite)]] = true;
+		}
+	}
+
+	// Split mesh vertices into one attribute vertex per seam bounded wedge
+	uint value = 0;
+	for (uint ivertex = 0; ivertex < vertex_count; ++ivertex) {
+		uint corner = mesh->vertex_corner[ivertex];
+		if (corner == GLTF_INVALID_INDEX)
+			continue;
+		uint corner_first = corner;
+		if (seams->vertex_seam[ivertex]) {
+			uint corner_walk = gltf_draco_swing_left(table, corner_first);
+			while (corner_walk != GLTF_INVALID_INDEX) {
+				corner_first = corner_walk;
+				corner_walk = gltf_draco_swing_left(table, corner_walk);
+				if (corner_walk == corner)
+					return false;
+			}
+		}
+		value = gltf_draco_add_vertex(table);
+		table->vertex_corner[value] = corner_first;
+		table->corner_vertex[corner_first] = value;
+		uint corner_walk = gltf_draco_swing_right(mesh, corner_first);
+		while ((corner_walk != GLTF_INVALID_INDEX) && (corner_walk != corner_first)) {
+			if (table->seam[gltf_draco_next(corner_walk)]) {
+				value = gltf_draco_add_vertex(table);
+				table->vertex_corner[value] = corner_walk;
+			}
+			table->corner_vertex[corner_walk] = value;
+			corner_walk = gltf_draco_swing_right(mesh, corner_walk);
+		}
+	}
+	return true;
+}
+
+//! Assign point indices to corners, creating a new point wherever any attribute changes value
+//! around a vertex
+static bool
+gltf_draco_assign_points(gltf_draco_decoder_t* decoder) {
+	const gltf_draco_table_t* table = &decoder->table;
+	uint seam_count = array_count(decoder->seams);
+	array_resize(decoder->indices, table->corner_count);
+	decoder->point_count = 0;
+	for (uint ivertex = 0, vertex_count = array_count(table->vertex_corner); ivertex < vertex_count; ++ivertex) {
+		uint corner = table->vertex_corner[ivertex];
+		if (corner == GLTF_INVALID_INDEX)
+			continue;
+		// Interior vertices start at the first seam of any attribute, boundary vertices at the
+		// left most corner
+		uint corner_first = corner;
+		for (uint iseam = 0; !decoder->vertex_hole[ivertex] && (iseam < seam_count); ++iseam) {
+			const gltf_draco_seams_t* seams = decoder->seams + iseam;
+			if (!seams->vertex_seam[ivertex])
+				continue;
+			uint value = seams->table.corner_vertex[corner];
+			uint corner_walk = gltf_draco_swing_right(table, corner);
+			bool found = false;
+			while (corner_walk != corner) {
+				if (corner_walk == GLTF_INVALID_INDEX)
+					return false;
+				if (seams->table.corner_vertex[corner_walk] != value) {
+					corner_first = corner_walk;
+					found = true;
+					break;
+				}
+				corner_walk = gltf_draco_swing_right(table, corner_walk);
+			}
+			if (found)
+				break;
+		}
+
+		decoder->indices[corner_first] = decoder->point_count++;
+		uint corner_prev = corner_first;
+		uint corner_walk = gltf_draco_swing_right(table, corner_first);
+		while ((corner_walk != GLTF_INVALID_INDEX) && (corner_walk != corner_first)) {
+			bool changed = false;
+			for (uint iseam = 0; !changed && (iseam < seam_count); ++iseam) {
+				const gltf_draco_table_t* seam_table = &decoder->seams[iseam].table;
+				changed = (seam_table->corner_vertex[corner_walk] != seam_table->corner_vertex[corner_prev]);
+			}
+			decoder->indices[corner_walk] = changed ? decoder->point_count++ : decoder->indices[corner_prev];
+			corner_prev = corner_walk;
+			corner_walk = gltf_draco_swing_right(table, corner_walk);
+		}
+	}
+	return true;
+}
+
+static bool
+gltf_draco_decode_edgebreaker(gltf_draco_decoder_t* decoder, uint traversal_type) {
+	gltf_draco_reader_t* reader = &decoder->reader;
+	if (reader->version < GLTF_DRACO_VERSION(2, 2)) {
+		log_warn(HASH_GLTF, WARNING_UNSUPPORTED, STRING_CONST("Unsupported Draco Edgebreaker bitstream before 2.2"));
+		return false;
+	}
+	if (traversal_type == GLTF_DRACO_TRAVERSAL_PREDICTIVE) {
+		log_warn(HASH_GLTF, WARNING_UNSUPPORTED, STRING_CONST("Unsupported Draco predictive Edgebreaker traversal"));
+		return false;
+	}
+	if (traversal_type > GLTF_DRACO_TRAVERSAL_VALENCE)
+		return false;
+
+	uint vertex_count = 0, face_count = 0, seam_count = 0, symbol_count = 0, split_symbol_count = 0;
+	if (!gltf_draco_read_varint(reader, &vertex_count) || !gltf_draco_read_varint(reader, &face_count) ||
+	    !gltf_draco_read_u8(reader, &seam_count) || !gltf_draco_read_varint(reader, &symbol_count) ||
+	    !gltf_draco_read_varint(reader, &split_symbol_count) || (face_count > (GLTF_MAX_INDEX / 3)) ||
+	    (symbol_count > face_count) || (split_symbol_count > symbol_count) ||
+	    (vertex_count > GLTF_MAX_INDEX - split_symbol_count))
+		return false;
+
+	uint max_vertex_count = vertex_count + split_symbol_count;
+	gltf_draco_table_t* table = &decoder->table;
+	table->corner_count = face_count * 3;
+	size_t corner_size = sizeof(uint) * (table->corner_count ? table->corner_count : 1);
+	table->corner_vertex = memory_allocate(HASH_GLTF, corner_size, 0, MEMORY_PERSISTENT);
+	table->opposite = memory_allocate(HASH_GLTF, corner_size, 0, MEMORY_PERSISTENT);
+	for (uint icorner = 0; icorner < table->corner_count; ++icorner)
+		table->corner_vertex[icorner] = table->opposite[icorner] = GLTF_INVALID_INDEX;
+	decoder->vertex_hole = memory_allocate(HASH_GLTF, sizeof(bool) * (max_vertex_count ? max_vertex_count : 1), 0,
+	                                       MEMORY_PERSISTENT);
+	for (uint ivertex = 0; ivertex < max_vertex_count; ++ivertex)
+		decoder->vertex_hole[ivertex] = true;
+	array_resize(decoder->seams, seam_count);
+	if (seam_count)
+		memset(decoder->seams, 0, sizeof(gltf_draco_seams_t) * seam_count);
+	for (uint iseam = 0; iseam < seam_count; ++iseam) {
+		decoder->seams[iseam].decoder = -1;
+		decoder->seams[iseam].connectivity_used = true;
+	}
+
+	gltf_draco_split_t* splits = nullptr;
+	gltf_draco_traversal_t traversal;
+	memset(&traversal, 0, sizeof(traversal));
+	traversal.type = traversal_type;
+	bool success = false;
+
+	if (!gltf_draco_decode_splits(reader, face_count, &splits))
+		goto exit;
+
+	// The traversal data is read from a copy of the reader, the attribute data follows the end
+	// of the traversal data
+	gltf_draco_reader_t traversal_reader = *reader;
+	if (!gltf_draco_traversal_start(&traversal, &traversal_reader, seam_count, face_count, max_vertex_count))
+		goto exit;
+	uint point_count = gltf_draco_decode_faces(decoder, &traversal, splits, symbol_count, max_vertex_count);
+	if (point_count == GLTF_INVALID_INDEX)
+		goto exit;
+	reader->offset = traversal_reader.offset;
+
+	// Decode attribute seams for each edge, boundary edges are always seams
+	for (uint corner = 0; corner < table->corner_count; corner += 3) {
+		uint corners[3] = {corner, corner + 1, corner + 2};
+		for (uint icorner = 0; icorner < 3; ++icorner) {
+			uint opposite = table->opposite[corners[icorner]];
+			if ((opposite != GLTF_INVALID_INDEX) && ((opposite / 3) < (corner / 3)))
+				continue;
+			for (uint iseam = 0; iseam < seam_count; ++iseam) {
+				if ((opposite == GLTF_INVALID_INDEX) || gltf_draco_rabs_read(traversal.seams + iseam))
+					array_push(decoder->seams[iseam].corners, corners[icorner]);
+			}
+		}
+	}
+
+	for (uint iseam = 0; iseam < seam_count; ++iseam) {
+		if (!gltf_draco_seams_build(decoder->seams + iseam, table))
+			goto exit;
+	}
+
+	if (!seam_count) {
+		// Without attribute connectivity all vertices are points
+		array_resize(decoder->indices, table->corner_count);
+		if (table->corner_count)
+			memcpy(decoder->indices, table->corner_vertex, sizeof(uint) * table->corner_count);
+		decoder->point_count = point_count;
+	} else if (!gltf_draco_assign_points(decoder)) {
+		goto exit;
+	}
+	success = true;
+
+exit:
+	gltf_draco_traversal_finalize(&traversal);
+	array_deallocate(splits);
+	return success;
+}
+
+static bool
+gltf_draco_decode_sequential(gltf_draco_decoder_t* decoder) {
+	gltf_draco_reader_t* reader = &decoder->reader;
+	uint face_count = 0;
+	uint* point_count = &decoder->point_count;
+	if (!gltf_draco_read_count(reader, &face_count) || !gltf_draco_read_count(reader, point_count))
+		return false;
+
+	uint method = 0;
+	if (!gltf_draco_read_u8(reader, &method) || (face_count > (GLTF_MAX_INDEX / 3)))
+		return false;
+
+	// Bound the face count by the remaining data size like the reference decoder
+	if (face_count > (reader->size - reader->offset) / 3)
+		return false;
+
+	uint index_count = face_count * 3;
+	array_resize(decoder->indices, index_count);
+	uint* indices = decoder->indices;
+	if (method == 0) {
+		// Indices are coded as entropy coded differences to the previous index
+		if (!gltf_draco_decode_symbols(reader, index_count, 1, indices))
+			return false;
+		uint last = 0;
+		for (uint iindex = 0; iindex < index_count; ++iindex) {
+			uint diff = indices[iindex] >> 1;
+			if (indices[iindex] & 1) {
+				if (diff > last)
+					return false;
+				last -= diff;
+			} else {
+				if (diff > (uint)INT32_MAX - last)
+					return false;
+				last += diff;
+			}
+			if (last >= *point_count)
+				return false;
+			indices[iindex] = last;
+		}
+		return true;
+	}
+
+	for (uint iindex = 0; iindex < index_count; ++iindex) {
+		uint index = 0;
+		bool success;
+		if (*point_count < 256) {
+			success = gltf_draco_read_u8(reader, &index);
+		} else if (*point_count < (1 << 16)) {
+			uint8_t bytes[2];
+			success = gltf_draco_read(reader, bytes, 2);
+			index = (uint)bytes[0] | ((uint)bytes[1] << 8);
+		} else if ((*point_count < (1 << 21)) && (reader->version >= GLTF_DRACO_VERSION(2, 2))) {
+			success = gltf_draco_read_varint(reader, &index);
+		} else {
+			success = gltf_draco_read_u32(reader, &index);
+		}
+		if (!success || (index >= *point_count))
+			return false;
+		indices[iindex] = index;
+	}
+	return true;
+}
+
+//! State of a traversal generating the attribute value order of a corner table
+typedef struct gltf_draco_sequence_t {
+	const gltf_draco_table_t* table;
+	gltf_draco_encoding_t* encoding;
+	const uint* indices;
+	uint** point_ids;
+	bool* face_visited;
+	bool* vertex_visited;
+	uint* stack[GLTF_DRACO_MAX_PRIORITY];
+	uint* degree;
+	uint best_priority;
+} gltf_draco_sequence_t;
+
+static void
+gltf_draco_sequence_visit(gltf_draco_sequence_t* sequence, uint vertex, uint corner) {
+	sequence->vertex_visited[vertex] = true;
+	array_push(*sequence->point_ids, sequence->indices[corner]);
+	sequence->encoding->vertex_value[vertex] = array_count(sequence->encoding->value_corner);
+	array_push(sequence->encoding->value_corner, corner);
+}
+
+static bool
+gltf_draco_face_visited(const gltf_draco_sequence_t* sequence, uint corner) {
+	return (corner == GLTF_INVALID_INDEX) || sequence->face_visited[corner / 3];
+}
+
+static bool
+gltf_draco_sequence_depth_first(gltf_draco_sequence_t* sequence, uint corner) {
+	const gltf_draco_table_t* table = sequence->table;
+	if (gltf_draco_face_visited(sequence, corner))
+		return true;
+
+	uint* stack = sequence->stack[0];
+	array_clear(stack);
+	array_push(stack, corner);
+	uint vertex_next = gltf_draco_vertex(table, gltf_draco_next(corner));
+	uint vertex_prev = gltf_draco_vertex(table, gltf_draco_previous(corner));
+	if ((vertex_next == GLTF_INVALID_INDEX) || (vertex_prev == GLTF_INVALID_INDEX))
+		goto fail;
+	if (!sequence->vertex_visited[vertex_next])
+		gltf_draco_sequence_visit(sequence, vertex_next, gltf_draco_next(corner));
+	if (!sequence->vertex_visited[vertex_prev])
+		gltf_draco_sequence_visit(sequence, vertex_prev, gltf_draco_previous(corner));
+
+	while (array_count(stack)) {
+		corner = stack[array_count(stack) - 1];
+		if (gltf_draco_face_visited(sequence, corner)) {
+			array_pop(stack);
+			continue;
+		}
+		while (true) {
+			sequence->face_visited[corner / 3] = true;
+			uint vertex = gltf_draco_vertex(table, corner);
+			if (vertex == GLTF_INVALID_INDEX)
+				goto fail;
+			if (!sequence->vertex_visited[vertex]) {
+				bool on_boundary = gltf_draco_on_boundary(table, vertex);
+				gltf_draco_sequence_visit(sequence, vertex, corner);
+				if (!on_boundary) {
+					corner = gltf_draco_right_corner(table, corner);
+					continue;
+				}
+			}
+			uint corner_right = gltf_draco_right_corner(table, corner);
+			uint corner_left = gltf_draco_left_corner(table, corner);
+			bool right_visited = gltf_draco_face_visited(sequence, corner_right);
+			bool left_visited = gltf_draco_face_visited(sequence, corner_left);
+			if (right_visited && left_visited) {
+				array_pop(stack);
+				break;
+			} else if (right_visited) {
+				corner = corner_left;
+			} else if (left_visited) {
+				corner = corner_right;
+			} else {
+				// Traverse the right face first, then the left face
+				stack[array_count(stack) - 1] = corner_left;
+				array_push(stack, corner_right);
+				break;
+			}
+		}
+	}
+	sequence->stack[0] = stack;
+	return true;
+
+fail:
+	sequence->stack[0] = stack;
+	return false;
+}
+
+static uint
+gltf_draco_sequence_priority(gltf_draco_sequence_t* sequence, uint corner) {
+	uint vertex = gltf_draco_vertex(sequence->table, corner);
+	if (sequence->vertex_visited[vertex])
+		return 0;
+	return (++sequence->degree[vertex] > 1) ? 1 : 2;
+}
+
+static void
+gltf_draco_sequence_push(gltf_draco_sequence_t* sequence, uint corner, uint priority) {
+	array_push(sequence->stack[priority], corner);
+	if (priority < sequence->best_priority)
+		sequence->best_priority = priority;
+}
+
+static bool
+gltf_draco_sequence_prediction_degree(gltf_draco_sequence_t* sequence, uint corner) {
+	const gltf_draco_table_t* table = sequence->table;
+	gltf_draco_sequence_push(sequence, corner, 0);
+	sequence->best_priority = 0;
+
+	uint corners[3] = {gltf_draco_next(corner), gltf_draco_previous(corner), corner};
+	for (uint icorner = 0; icorner < 3; ++icorner) {
+		uint vertex = gltf_draco_vertex(table, corners[icorner]);
+		if (vertex == GLTF_INVALID_INDEX)
+			return false;
+		if (!sequence->vertex_visited[vertex])
+			gltf_draco_sequence_visit(sequence, vertex, corners[icorner]);
+	}
+
+	while (true) {
+		// Pop the next corner from the stack with the best priority
+		corner = GLTF_INVALID_INDEX;
+		for (uint ipriority = sequence->best_priority; ipriority < GLTF_DRACO_MAX_PRIORITY; ++ipriority) {
+			if (array_count(sequence->stack[ipriority])) {
+				corner = sequence->stack[ipriority][array_count(sequence->stack[ipriority]) - 1];
+				array_pop(sequence->stack[ipriority]);
+				sequence->best_priority = ipriority;
+				break;
+			}
+		}
+		if (corner == GLTF_INVALID_INDEX)
+			break;
+		if (gltf_draco_face_visited(sequence, corner))
+			continue;
+
+		while (true) {
+			sequence->face_visited[corner / 3] = true;
+			uint vertex = gltf_draco_vertex(table, corner);
+			if (vertex == GLTF_INVALID_INDEX)
+				return false;
+			if (!sequence->vertex_visited[vertex])
+				gltf_draco_sequence_visit(sequence, vertex, corner);
+
+			uint corner_right = gltf_draco_right_corner(table, corner);
+			uint corner_left = gltf_draco_left_corner(table, corner);
+			bool right_visited = gltf_draco_face_visited(sequence, corner_right);
+			bool left_visited = gltf_draco_face_visited(sequence, corner_left);
+			if (!left_visited) {
+				uint priority = gltf_draco_sequence_priority(sequence, corner_left);
+				if (right_visited && (priority <= sequence->best_priority)) {
+					corner = corner_left;
+					continue;
+				}
+				gltf_draco_sequence_push(sequence, corner_left, priority);
+			}
+			if (!right_visited) {
+				uint priority = gltf_draco_sequence_priority(sequence, corner_right);
+				if (priority <= sequence->best_priority) {
+					corner = corner_right;
+					continue;
+				}
+				gltf_draco_sequence_push(sequence, corner_right, priority);
+			}
+			break;
+		}
+	}
+	return true;
+}
+
+//! Generate the point order of an attributes decoder by traversing the given corner table, and
+//! record the encoded value index of each vertex and the corner of each encoded value
+static bool
+gltf_draco_sequence(const gltf_draco_decoder_t* decoder, const gltf_draco_table_t* table,
+                    gltf_draco_encoding_t* encoding, uint sequencer, uint** point_ids) {
+	uint vertex_count = array_count(table->vertex_corner);
+	uint face_count = table->corner_count / 3;
+	gltf_draco_encoding_finalize(encoding);
+	encoding->vertex_value =
+	    memory_allocate(HASH_GLTF, sizeof(uint) * (vertex_count ? vertex_count : 1), 0, MEMORY_PERSISTENT);
+	for (uint ivertex = 0; ivertex < vertex_count; ++ivertex)
+		encoding->vertex_value[ivertex] = GLTF_INVALID_INDEX;
+
+	gltf_draco_sequence_t sequence;
+	memset(&sequence, 0, sizeof(sequence));
+	sequence.table = table;
+	sequence.encoding = encoding;
+	sequence.indices = decoder->indices;
+	sequence.point_ids = point_ids;
+	sequence.face_visited = memory_allocate(HASH_GLTF, sizeof(bool) * (face_count ? face_count : 1), 0,
+	                                        MEMORY_TEMPORARY | MEMORY_ZERO_INITIALIZED);
+	sequence.vertex_visited = memory_allocate(HASH_GLTF, sizeof(bool) * (vertex_count ? vertex_count : 1), 0,
+	                                          MEMORY_TEMPORARY | MEMORY_ZERO_INITIALIZED);
+	if (sequencer == GLTF_DRACO_SEQUENCER_PREDICTION_DEGREE)
+		sequence.degree = memory_allocate(HASH_GLTF, sizeof(uint) * (vertex_count ? vertex_count : 1), 0,
+		                                  MEMORY_TEMPORARY | MEMORY_ZERO_INITIALIZED);
+
+	bool success = true;
+	for (uint iface = 0; success && (iface < face_count); ++iface) {
+		if (sequencer == GLTF_DRACO_SEQUENCER_PREDICTION_DEGREE)
+			success = gltf_draco_sequence_prediction_degree(&sequence, iface * 3);
+		else
+			success = gltf_draco_sequence_depth_first(&sequence, iface * 3);
+	}
+
+	memory_deallocate(sequence.face_visited);
+	memory_deallocate(sequence.vertex_visited);
+	memory_deallocate(sequence.degree);
+	for (uint ipriority = 0; ipriority < GLTF_DRACO_MAX_PRIORITY; ++ipriority)
+		array_deallocate(sequence.stack[ipriority]);
+	return success;
+}
+
+static bool
+gltf_draco_octahedron_initialize(gltf_draco_octahedron_t* octahedron, int32_t max_quantized_value) {
+	if ((max_quantized_value <= 0) || !(max_quantized_value & 1))
+		return false;
+	int32_t bits = 0;
+	while ((max_quantized_value >> bits) > 1)
+		++bits;
+	bits += 1;
+	if ((bits < 2) || (bits > 30))
+		return false;
+	octahedron->quantization_bits = bits;
+	octahedron->max_quantized_value = (1 << bits) - 1;
+	octahedron->max_value = octahedron->max_quantized_value - 1;
+	octahedron->center_value = octahedron->max_value / 2;
+	octahedron->dequantization_scale = 2.0f / (float)octahedron->max_value;
+	return true;
+}
+
+static int32_t
+gltf_draco_octahedron_mod(const gltf_draco_octahedron_t* octahedron, int32_t value) {
+	if (value > octahedron->center_value)
+		return value - octahedron->max_quantized_value;
+	if (value < -octahedron->center_value)
+		return value + octahedron->max_quantized_value;
+	return value;
+}
+
+//! Reflect a point centered at the origin between the inner and outer parts of the diamond
+static void
+gltf_draco_octahedron_invert(const gltf_draco_octahedron_t* octahedron, int32_t* s, int32_t* t) {
+	int32_t sign_s, sign_t;
+	if ((*s >= 0) && (*t >= 0)) {
+		sign_s = sign_t = 1;
+	} else if ((*s <= 0) && (*t <= 0)) {
+		sign_s = sign_t = -1;
+	} else {
+		sign_s = (*s > 0) ? 1 : -1;
+		sign_t = (*t > 0) ? 1 : -1;
+	}
+	uint32_t corner_s = (uint32_t)(sign_s * octahedron->center_value);
+	uint32_t corner_t = (uint32_t)(sign_t * octahedron->center_value);
+	uint32_t us = (uint32_t)*s, ut = (uint32_t)*t;
+	us = us + us - corner_s;
+	ut = ut + ut - corner_t;
+	if (sign_s * sign_t >= 0) {
+		uint32_t temp = us;
+		us = -ut;
+		ut = -temp;
+	} else {
+		uint32_t temp = us;
+		us = ut;
+		ut = temp;
+	}
+	*s = (int32_t)(us + corner_s) / 2;
+	*t = (int32_t)(ut + corner_t) / 2;
+}
+
+static void
+gltf_draco_octahedron_rotate(int32_t* s, int32_t* t, int rotation) {
+	int32_t rs = *s, rt = *t;
+	if (rotation == 1) {
+		rs = *t;
+		rt = -*s;
+	} else if (rotation == 2) {
+		rs = -*s;
+		rt = -*t;
+	} else if (rotation == 3) {
+		rs = -*t;
+		rt = *s;
+	}
+	*s = rs;
+	*t = rt;
+}
+
+//! Scale an integer vector to the octahedron with L1 norm equal to the center value
+static void
+gltf_draco_octahedron_canonicalize(const gltf_draco_octahedron_t* octahedron, int32_t* vec) {
+	int64_t center = octahedron->center_value;
+	int64_t abs_sum = llabs((int64_t)vec[0]) + llabs((int64_t)vec[1]) + llabs((int64_t)vec[2]);
+	if (!abs_sum) {
+		vec[0] = (int32_t)center;
+		return;
+	}
+	vec[0] = (int32_t)(((int64_t)vec[0] * center) / abs_sum);
+	vec[1] = (int32_t)(((int64_t)vec[1] * center) / abs_sum);
+	int32_t rest = (int32_t)(center - llabs((int64_t)vec[0]) - llabs((int64_t)vec[1]));
+	vec[2] = (vec[2] >= 0) ? rest : -rest;
+}
+
+static void
+gltf_draco_octahedron_coords(const gltf_draco_octahedron_t* octahedron, const int32_t* vec, int32_t* out) {
+	int32_t center = octahedron->center_value;
+	int32_t max_value = octahedron->max_value;
+	int32_t s, t;
+	if (vec[0] >= 0) {
+		s = vec[1] + center;
+		t = vec[2] + center;
+	} else {
+		s = (vec[1] < 0) ? abs(vec[2]) : (max_value - abs(vec[2]));
+		t = (vec[2] < 0) ? abs(vec[1]) : (max_value - abs(vec[1]));
+	}
+	if (((s == 0) && (t == 0)) || ((s == 0) && (t == max_value)) || ((s == max_value) && (t == 0))) {
+		s = t = max_value;
+	} else if ((s == 0) && (t > center)) {
+		t = center - (t - center);
+	} else if ((s == max_value) && (t < center)) {
+		t = center + (center - t);
+	} else if ((t == max_value) && (s < center)) {
+		s = center + (center - s);
+	} else if ((t == 0) && (s > center)) {
+		s = center - (s - center);
+	}
+	out[0] = s;
+	out[1] = t;
+}
+
+//! Restore original values from predicted values and the corrections stored in values
+static void
+gltf_draco_prediction_restore(const gltf_draco_prediction_t* prediction, const int32_t* predicted, int32_t* values,
+                              uint components) {
+	if (prediction->transform == GLTF_DRACO_TRANSFORM_WRAP) {
+		for (uint icomp = 0; icomp < components; ++icomp) {
+			int32_t base = predicted[icomp];
+			if (base > prediction->max_value)
+				base = prediction->max_value;
+			else if (base < prediction->min_value)
+				base = prediction->min_value;
+			int32_t value = (int32_t)((uint32_t)base + (uint32_t)values[icomp]);
+			if (value > prediction->max_value)
+				value = (int32_t)((uint32_t)value - (uint32_t)prediction->max_dif);
+			else if (value < prediction->min_value)
+				value = (int32_t)((uint32_t)value + (uint32_t)prediction->max_dif);
+			values[icomp] = value;
+		}
+		return;
+	}
+
+	// Normal octahedron transforms, with the canonicalized variant rotating the prediction into
+	// the bottom left quadrant
+	const gltf_draco_octahedron_t* octahedron = &prediction->octahedron;
+	int32_t center = octahedron->center_value;
+	int32_t s = predicted[0] - center;
+	int32_t t = predicted[1] - center;
+	bool in_diamond = ((uint32_t)abs(s) + (uint32_t)abs(t)) <= (uint32_t)center;
+	if (!in_diamond)
+		gltf_draco_octahedron_invert(octahedron, &s, &t);
+	bool bottom_left = true;
+	int rotation = 0;
+	if (prediction->transform == GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED) {
+		bottom_left = ((s == 0) && (t == 0)) || ((s < 0) && (t <= 0));
+		if (s == 0)
+			rotation = (t == 0) ? 0 : ((t > 0) ? 3 : 1);
+		else if (s > 0)
+			rotation = (t >= 0) ? 2 : 1;
+		else
+			rotation = (t <= 0) ? 0 : 3;
+		if (!bottom_left)
+			gltf_draco_octahedron_rotate(&s, &t, rotation);
+	}
+	s = gltf_draco_octahedron_mod(octahedron, s + values[0]);
+	t = gltf_draco_octahedron_mod(octahedron, t + values[1]);
+	if (!bottom_left)
+		gltf_draco_octahedron_rotate(&s, &t, (4 - rotation) % 4);
+	if (!in_diamond)
+		gltf_draco_octahedron_invert(octahedron, &s, &t);
+	values[0] = s + center;
+	values[1] = t + center;
+}
+
+static bool
+gltf_draco_prediction_transform_data(gltf_draco_prediction_t* prediction, gltf_draco_reader_t* reader) {
+	if (prediction->transform == GLTF_DRACO_TRANSFORM_WRAP) {
+		if (!gltf_draco_read_i32(reader, &prediction->min_value) ||
+		    !gltf_draco_read_i32(reader, &prediction->max_value) || (prediction->min_value > prediction->max_value))
+			return false;
+		int64_t dif = (int64_t)prediction->max_value - (int64_t)prediction->min_value;
+		if (dif >= INT32_MAX)
+			return false;
+		prediction->max_dif = (int32_t)dif + 1;
+		return true;
+	}
+
+	int32_t max_quantized_value = 0, center_value = 0;
+	if (!gltf_draco_read_i32(reader, &max_quantized_value))
+		return false;
+	if ((prediction->transform == GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED) ||
+	    (reader->version < GLTF_DRACO_VERSION(2, 2))) {
+		if (!gltf_draco_read_i32(reader, &center_value))
+			return false;
+	}
+	return gltf_draco_octahedron_initialize(&prediction->octahedron, max_quantized_value);
+}
+
+static bool
+gltf_draco_prediction_data(gltf_draco_prediction_t* prediction, gltf_draco_reader_t* reader) {
+	if (prediction->method == GLTF_DRACO_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM) {
+		for (uint icontext = 0; icontext < GLTF_DRACO_MAX_PARALLELOGRAMS; ++icontext) {
+			uint flag_count = 0;
+			if (!gltf_draco_read_varint(reader, &flag_count) || (flag_count > prediction->table->corner_count))
+				return false;
+			if (!flag_count)
+				continue;
+			gltf_draco_rabs_t rabs;
+			if (!gltf_draco_rabs_start(&rabs, reader))
+				return false;
+			array_resize(prediction->crease[icontext], flag_count);
+			for (uint iflag = 0; iflag < flag_count; ++iflag)
+				prediction->crease[icontext][iflag] = gltf_draco_rabs_read(&rabs);
+		}
+	} else if (prediction->method == GLTF_DRACO_PREDICTION_TEX_COORDS_PORTABLE) {
+		int32_t orientation_count = 0;
+		gltf_draco_rabs_t rabs;
+		if (!gltf_draco_read_i32(reader, &orientation_count) || (orientation_count < 0) ||
+		    ((uint)orientation_count > prediction->table->corner_count) || !gltf_draco_rabs_start(&rabs, reader))
+			return false;
+		// Orientations are delta coded, a zero bit flips the previous orientation
+		bool orientation = true;
+		array_resize(prediction->orientations, (uint)orientation_count);
+		for (int32_t iorient = 0; iorient < orientation_count; ++iorient) {
+			if (!gltf_draco_rabs_read(&rabs))
+				orientation = !orientation;
+			prediction->orientations[iorient] = orientation;
+		}
+	} else if (prediction->method == GLTF_DRACO_PREDICTION_GEOMETRIC_NORMAL) {
+		return gltf_draco_prediction_transform_data(prediction, reader) &&
+		       gltf_draco_rabs_start(&prediction->flip, reader);
+	}
+	return gltf_draco_prediction_transform_data(prediction, reader);
+}
+
+static void
+gltf_draco_prediction_finalize(gltf_draco_prediction_t* prediction) {
+	for (uint icontext = 0; icontext < GLTF_DRACO_MAX_PARALLELOGRAMS; ++icontext)
+		array_deallocate(prediction->crease[icontext]);
+	array_deallocate(prediction->orientations);
+}
+
+static bool
+gltf_draco_parallelogram(const gltf_draco_prediction_t* prediction, uint value, uint corner, const int32_t* data,
+                         uint components, int32_t* predicted) {
+	const gltf_draco_table_t* table = prediction->table;
+	uint opposite = gltf_draco_opposite(table, corner);
+	if (opposite == GLTF_INVALID_INDEX)
+		return false;
+	uint value_opposite = prediction->vertex_value[gltf_draco_vertex(table, opposite)];
+	uint value_next = prediction->vertex_value[gltf_draco_vertex(table, gltf_draco_next(opposite))];
+	uint value_prev = prediction->vertex_value[gltf_draco_vertex(table, gltf_draco_previous(opposite))];
+	if ((value_opposite >= value) || (value_next >= value) || (value_prev >= value))
+		return false;
+	for (uint icomp = 0; icomp < components; ++icomp) {
+		int64_t next = data[(value_next * components) + icomp];
+		int64_t prev = data[(value_prev * components) + icomp];
+		int64_t opp = data[(value_opposite * components) + icomp];
+		predicted[icomp] = (int32_t)((next + prev) - opp);
+	}
+	return true;
+}
+
+static void
+gltf_draco_prediction_position(const gltf_draco_prediction_t* prediction, uint value, int64_t* position) {
+	const gltf_draco_attribute_t* attribute = prediction->position;
+	uint point = prediction->point_ids[value];
+	uint index = attribute->point_value ? attribute->point_value[point] : point;
+	for (uint icomp = 0; icomp < 3; ++icomp)
+		position[icomp] = attribute->portable[(index * 3) + icomp];
+}
+
+static uint64_t
+gltf_draco_int_sqrt(uint64_t number) {
+	if (!number)
+		return 0;
+	uint64_t reduced = number;
+	uint64_t root = 1;
+	while (reduced >= 2) {
+		root *= 2;
+		reduced /= 4;
+	}
+	do {
+		root = (root + (number / root)) / 2;
+	} while (root * root > number);
+	return root;
+}
+
+static int64_t
+gltf_draco_abs_max(const int64_t* values, uint count) {
+	int64_t result = 0;
+	for (uint ivalue = 0; ivalue < count; ++ivalue) {
+		int64_t value = llabs(values[ivalue]);
+		if (value > result)
+			result = value;
+	}
+	return result;
+}
+
+//! Predict texture coordinates from the positions of the triangle and the texture coordinates
+//! of the two other corners, falling back to delta prediction
+static bool
+gltf_draco_predict_tex_coord(gltf_draco_prediction_t* prediction, uint value, uint corner, const int32_t* data,
+                             int32_t* predicted) {
+	const gltf_draco_table_t* table = prediction->table;
+	uint value_next = prediction->vertex_value[gltf_draco_vertex(table, gltf_draco_next(corner))];
+	uint value_prev = prediction->vertex_value[gltf_draco_vertex(table, gltf_draco_previous(corner))];
+	if ((value_prev < value) && (value_next < value)) {
+		int64_t next_uv[2] = {data[value_next * 2], data[(value_next * 2) + 1]};
+		int64_t prev_uv[2] = {data[value_prev * 2], data[(value_prev * 2) + 1]};
+		if ((next_uv[0] == prev_uv[0]) && (next_uv[1] == prev_uv[1])) {
+			predicted[0] = (int32_t)prev_uv[0];
+			predicted[1] = (int32_t)prev_uv[1];
+			return true;
+		}
+		int64_t tip[3], next[3], prev[3], pn[3], cn[3];
+		gltf_draco_prediction_position(prediction, value, tip);
+		gltf_draco_prediction_position(prediction, value_next, next);
+		gltf_draco_prediction_position(prediction, value_prev, prev);
+		uint64_t pn_norm2 = 0;
+		int64_t cn_dot_pn = 0;
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			pn[icomp] = prev[icomp] - next[icomp];
+			cn[icomp] = tip[icomp] - next[icomp];
+			pn_norm2 += (uint64_t)(pn[icomp] * pn[icomp]);
+			cn_dot_pn = (int64_t)((uint64_t)cn_dot_pn + (uint64_t)(pn[icomp] * cn[icomp]));
+		}
+		if (pn_norm2) {
+			int64_t pn_uv[2] = {prev_uv[0] - next_uv[0], prev_uv[1] - next_uv[1]};
+			if ((gltf_draco_abs_max(next_uv, 2) > INT64_MAX / (int64_t)pn_norm2) ||
+			    (cn_dot_pn > INT64_MAX / gltf_draco_abs_max(pn_uv, 2)) ||
+			    (cn_dot_pn > INT64_MAX / gltf_draco_abs_max(pn, 3)))
+				return false;
+			int64_t x_uv[2], cx_uv[2] = {pn_uv[1], -pn_uv[0]};
+			uint64_t cx_norm2 = 0;
+			for (uint icomp = 0; icomp < 2; ++icomp)
+				x_uv[icomp] = (int64_t)((uint64_t)(next_uv[icomp] * (int64_t)pn_norm2) +
+				                        (uint64_t)(cn_dot_pn * pn_uv[icomp]));
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				int64_t x_pos = next[icomp] + ((cn_dot_pn * pn[icomp]) / (int64_t)pn_norm2);
+				int64_t cx = tip[icomp] - x_pos;
+				cx_norm2 += (uint64_t)(cx * cx);
+			}
+			uint64_t norm = gltf_draco_int_sqrt(cx_norm2 * pn_norm2);
+			uint orientation_count = array_count(prediction->orientations);
+			if (!orientation_count)
+				return false;
+			bool orientation = prediction->orientations[orientation_count - 1];
+			array_pop(prediction->orientations);
+			for (uint icomp = 0; icomp < 2; ++icomp) {
+				uint64_t scaled = (uint64_t)cx_uv[icomp] * norm;
+				uint64_t sum = orientation ? ((uint64_t)x_uv[icomp] + scaled) : ((uint64_t)x_uv[icomp] - scaled);
+				predicted[icomp] = (int32_t)((int64_t)sum / (int64_t)pn_norm2);
+			}
+			return true;
+		}
+	}
+
+	uint offset = 0;
+	if (value_prev < value)
+		offset = value_prev * 2;
+	if (value_next < value) {
+		offset = value_next * 2;
+	} else if (value > 0) {
+		offset = (value - 1) * 2;
+	} else {
+		predicted[0] = predicted[1] = 0;
+		return true;
+	}
+	predicted[0] = data[offset];
+	predicted[1] = data[offset + 1];
+	return true;
+}
+
+//! Predict a normal from the area weighted normals of the triangles around the vertex
+static bool
+gltf_draco_predict_normal(gltf_draco_prediction_t* prediction, uint corner, int32_t* predicted) {
+	const gltf_draco_table_t* table = prediction->table;
+	int64_t center[3], normal[3] = {0, 0, 0};
+	gltf_draco_prediction_position(prediction, prediction->vertex_value[gltf_draco_vertex(table, corner)], center);
+
+	uint corner_walk = corner;
+	bool left = true;
+	for (uint iwalk = 0; corner_walk != GLTF_INVALID_INDEX; ++iwalk) {
+		if (iwalk > table->corner_count)
+			return false;
+		int64_t next[3], prev[3];
+		uint next_vertex = gltf_draco_vertex(table, gltf_draco_next(corner_walk));
+		uint prev_vertex = gltf_draco_vertex(table, gltf_draco_previous(corner_walk));
+		gltf_draco_prediction_position(prediction, prediction->vertex_value[next_vertex], next);
+		gltf_draco_prediction_position(prediction, prediction->vertex_value[prev_vertex], prev);
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			next[icomp] -= center[icomp];
+			prev[icomp] -= center[icomp];
+		}
+		int64_t cross[3] = {(next[1] * prev[2]) - (next[2] * prev[1]), (next[2] * prev[0]) - (next[0] * prev[2]),
+		                    (next[0] * prev[1]) - (next[1] * prev[0])};
+		for (uint icomp = 0; icomp < 3; ++icomp)
+			normal[icomp] = (int64_t)((uint64_t)normal[icomp] + (uint64_t)cross[icomp]);
+
+		if (left) {
+			corner_walk = gltf_draco_swing_left(table, corner_walk);
+			if (corner_walk == GLTF_INVALID_INDEX) {
+				corner_walk = gltf_draco_swing_right(table, corner);
+				left = false;
+			} else if (corner_walk == corner) {
+				corner_walk = GLTF_INVALID_INDEX;
+			}
+		} else {
+			corner_walk = gltf_draco_swing_right(table, corner_walk);
+		}
+	}
+
+	// Scale down to keep the components within 29 bits
+	const int64_t upper_bound = 1 << 29;
+	int64_t abs_sum = 0;
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		int64_t value = llabs(normal[icomp]);
+		abs_sum = (abs_sum > INT64_MAX - value) ? INT64_MAX : (abs_sum + value);
+	}
+	if (abs_sum > upper_bound) {
+		int64_t quotient = abs_sum / upper_bound;
+		for (uint icomp = 0; icomp < 3; ++icomp)
+			normal[icomp] /= quotient;
+	}
+	for (uint icomp = 0; icomp < 3; ++icomp)
+		predicted[icomp] = (int32_t)normal[icomp];
+	return true;
+}
+
+static bool
+gltf_draco_prediction_decode(gltf_draco_prediction_t* prediction, int32_t* values, uint value_count,
+                             uint components) {
+	int32_t predicted[GLTF_DRACO_MAX_COMPONENTS * GLTF_DRACO_MAX_PARALLELOGRAMS];
+	int32_t sum[GLTF_DRACO_MAX_COMPONENTS];
+	memset(predicted, 0, sizeof(predicted));
+	if (!value_count)
+		return true;
+
+	if ((prediction->method == GLTF_DRACO_PREDICTION_DIFFERENCE) || !prediction->table) {
+		gltf_draco_prediction_restore(prediction, predicted, values, components);
+		for (uint ivalue = 1; ivalue < value_count; ++ivalue)
+			gltf_draco_prediction_restore(prediction, values + ((ivalue - 1) * components),
+			                              values + (ivalue * components), components);
+		return true;
+	}
+
+	if (array_count(prediction->value_corner) != value_count)
+		return false;
+
+	const gltf_draco_table_t* table = prediction->table;
+	uint crease_offset[GLTF_DRACO_MAX_PARALLELOGRAMS] = {0};
+	for (uint ivalue = 0; ivalue < value_count; ++ivalue) {
+		uint corner = prediction->value_corner[ivalue];
+		int32_t* value = values + (ivalue * components);
+		const int32_t* base = predicted;
+		bool use_previous = false;
+
+		if (prediction->method == GLTF_DRACO_PREDICTION_TEX_COORDS_PORTABLE) {
+			if (!gltf_draco_predict_tex_coord(prediction, ivalue, corner, values, predicted))
+				return false;
+		} else if (prediction->method == GLTF_DRACO_PREDICTION_GEOMETRIC_NORMAL) {
+			int32_t normal[3];
+			if (!gltf_draco_predict_normal(prediction, corner, normal))
+				return false;
+			gltf_draco_octahedron_canonicalize(&prediction->octahedron, normal);
+			if (gltf_draco_rabs_read(&prediction->flip)) {
+				for (uint icomp = 0; icomp < 3; ++icomp)
+					normal[icomp] = -normal[icomp];
+			}
+			gltf_draco_octahedron_coords(&prediction->octahedron, normal, predicted);
+		} else if (!ivalue) {
+			memset(predicted, 0, sizeof(int32_t) * components);
+		} else if (prediction->method == GLTF_DRACO_PREDICTION_PARALLELOGRAM) {
+			use_previous = !gltf_draco_parallelogram(prediction, ivalue, corner, values, components, predicted);
+		} else if (prediction->method == GLTF_DRACO_PREDICTION_MULTI_PARALLELOGRAM) {
+			uint count = 0;
+			memset(sum, 0, sizeof(sum));
+			for (uint corner_walk = corner; corner_walk != GLTF_INVALID_INDEX;) {
+				if (gltf_draco_parallelogram(prediction, ivalue, corner_walk, values, components, predicted)) {
+					for (uint icomp = 0; icomp < components; ++icomp)
+						sum[icomp] = (int32_t)((uint32_t)sum[icomp] + (uint32_t)predicted[icomp]);
+					++count;
+				}
+				corner_walk = gltf_draco_swing_right(table, corner_walk);
+				if (corner_walk == corner)
+					break;
+			}
+			for (uint icomp = 0; count && (icomp < components); ++icomp)
+				predicted[icomp] = sum[icomp] / (int32_t)count;
+			use_previous = !count;
+		} else {
+			// Constrained multi parallelogram, walking left then right from the corner and
+			// skipping parallelograms flagged as crossing a crease
+			uint count = 0;
+			bool first_pass = true;
+			for (uint corner_walk = corner; corner_walk != GLTF_INVALID_INDEX;) {
+				if (gltf_draco_parallelogram(prediction, ivalue, corner_walk, values, components,
+				                             predicted + (count * components))) {
+					if (++count == GLTF_DRACO_MAX_PARALLELOGRAMS)
+						break;
+				}
+				corner_walk = first_pass ? gltf_draco_swing_left(table, corner_walk) :
+				                           gltf_draco_swing_right(table, corner_walk);
+				if (corner_walk == corner)
+					break;
+				if ((corner_walk == GLTF_INVALID_INDEX) && first_pass) {
+					first_pass = false;
+					corner_walk = gltf_draco_swing_right(table, corner);
+				}
+			}
+			uint used = 0;
+			memset(sum, 0, sizeof(sum));
+			for (uint iparallel = 0; iparallel < count; ++iparallel) {
+				uint context = count - 1;
+				if (crease_offset[context] >= array_count(prediction->crease[context]))
+					return false;
+				if (prediction->crease[context][crease_offset[context]++])
+					continue;
+				++used;
+				for (uint icomp = 0; icomp < components; ++icomp)
+					sum[icomp] =
+					    (int32_t)((uint32_t)sum[icomp] + (uint32_t)predicted[(iparallel * components) + icomp]);
+			}
+			for (uint icomp = 0; used && (icomp < components); ++icomp)
+				predicted[icomp] = sum[icomp] / (int32_t)used;
+			use_previous = !used;
+		}
+
+		if (use_previous)
+			base = value - components;
+		gltf_draco_prediction_restore(prediction, base, value, components);
+	}
+	return true;
+}
+
+static bool
+gltf_draco_decode_generic(gltf_draco_reader_t* reader, gltf_draco_attribute_t* attribute) {
+	uint component_size = gltf_draco_data_type_size(attribute->data_type);
+	size_t value_count = (size_t)attribute->value_count * attribute->components;
+	if ((reader->size - reader->offset) / component_size < value_count)
+		return false;
+
+	attribute->is_float =
+	    (attribute->data_type == GLTF_DRACO_DT_FLOAT32) || (attribute->data_type == GLTF_DRACO_DT_FLOAT64);
+	attribute->values =
+	    memory_allocate(HASH_GLTF, sizeof(int32_t) * (value_count ? value_count : 1), 0, MEMORY_PERSISTENT);
+
+	const uint8_t* source = reader->data + reader->offset;
+	float* float_values = attribute->values;
+	int32_t* int_values = attribute->values;
+	for (size_t ivalue = 0; ivalue < value_count; ++ivalue, source += component_size) {
+		switch (attribute->data_type) {
+			case GLTF_DRACO_DT_INT8:
+				int_values[ivalue] = *(const int8_t*)source;
+				break;
+			case GLTF_DRACO_DT_UINT8:
+			case GLTF_DRACO_DT_BOOL:
+				int_values[ivalue] = *source;
+				break;
+			case GLTF_DRACO_DT_INT16: {
+				int16_t value;
+				memcpy(&value, source, sizeof(value));
+				int_values[ivalue] = value;
+				break;
+			}
+			case GLTF_DRACO_DT_UINT16: {
+				uint16_t value;
+				memcpy(&value, source, sizeof(value));
+				int_values[ivalue] = value;
+				break;
+			}
+			case GLTF_DRACO_DT_INT32:
+			case GLTF_DRACO_DT_UINT32:
+				memcpy(int_values + ivalue, source, sizeof(int32_t));
+				break;
+			case GLTF_DRACO_DT_FLOAT32:
+				memcpy(float_values + ivalue, source, sizeof(float));
+				break;
+			case GLTF_DRACO_DT_FLOAT64: {
+				double value;
+				memcpy(&value, source, sizeof(value));
+				float_values[ivalue] = (float)value;
+				break;
+			}
+			default:
+				return false;
+		}
+	}
+	reader->offset += value_count * component_size;
+	return true;
+}
+
+//! Find the decoded position attribute used as parent by texture coordinate and normal prediction
+static const gltf_draco_attribute_t*
+gltf_draco_position_attribute(const gltf_draco_decoder_t* decoder) {
+	for (uint iattrib = 0, attribute_count = array_count(decoder->attributes); iattrib < attribute_count; ++iattrib) {
+		const gltf_draco_attribute_t* attribute = decoder->attributes + iattrib;
+		if (attribute->type == GLTF_DRACO_POSITION)
+			return (attribute->portable && (attribute->portable_components == 3)) ? attribute : nullptr;
+	}
+	return nullptr;
+}
+
+static bool
+gltf_draco_decode_integer(gltf_draco_decoder_t* decoder, gltf_draco_attribute_t* attribute,
+                          const gltf_draco_table_t* table, const gltf_draco_encoding_t* encoding,
+                          const uint* point_ids) {
+	gltf_draco_reader_t* reader = &decoder->reader;
+	gltf_draco_prediction_t prediction;
+	memset(&prediction, 0, sizeof(prediction));
+	prediction.method = GLTF_DRACO_PREDICTION_NONE;
+	prediction.transform = GLTF_DRACO_TRANSFORM_NONE;
+
+	uint method = 0, transform = 0;
+	if (!gltf_draco_read_u8(reader, &method))
+		return false;
+	if ((int8_t)method != GLTF_DRACO_PREDICTION_NONE) {
+		if (((int8_t)method < GLTF_DRACO_PREDICTION_NONE) ||
+		    ((int8_t)method > GLTF_DRACO_PREDICTION_GEOMETRIC_NORMAL) || !gltf_draco_read_u8(reader, &transform) ||
+		    ((int8_t)transform < GLTF_DRACO_TRANSFORM_NONE) ||
+		    ((int8_t)transform > GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED))
+			return false;
+		prediction.method = (int8_t)method;
+		prediction.transform = (int8_t)transform;
+	}
+
+	// Like the reference decoder, attributes are decoded without prediction if the transform
+	// does not match the attribute decoder, and mesh prediction schemes without mesh connectivity
+	// or with a mismatching transform fall back to difference prediction
+	bool normals = (attribute->decoder == GLTF_DRACO_DECODER_NORMALS);
+	bool octahedron = (prediction.transform == GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON) ||
+	                  (prediction.transform == GLTF_DRACO_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED);
+	if (normals ? !octahedron : (prediction.transform != GLTF_DRACO_TRANSFORM_WRAP))
+		prediction.method = GLTF_DRACO_PREDICTION_NONE;
+	if (table && (prediction.method == GLTF_DRACO_PREDICTION_TEX_COORDS_DEPRECATED)) {
+		log_warn(HASH_GLTF, WARNING_UNSUPPORTED, STRING_CONST("Unsupported Draco deprecated texture prediction"));
+		return false;
+	}
+	bool mesh_scheme = table && ((prediction.method == GLTF_DRACO_PREDICTION_GEOMETRIC_NORMAL) == octahedron) &&
+	                   (prediction.method > GLTF_DRACO_PREDICTION_DIFFERENCE);
+	if (mesh_scheme) {
+		prediction.table = table;
+		prediction.vertex_value = encoding->vertex_value;
+		prediction.value_corner = encoding->value_corner;
+		prediction.point_ids = point_ids;
+		if ((prediction.method == GLTF_DRACO_PREDICTION_TEX_COORDS_PORTABLE) ||
+		    (prediction.method == GLTF_DRACO_PREDICTION_GEOMETRIC_NORMAL)) {
+			prediction.position = gltf_draco_position_attribute(decoder);
+			if (!prediction.position || (attribute->portable_components != 2))
+				return false;
+		}
+	} else if (prediction.method != GLTF_DRACO_PREDICTION_NONE) {
+		prediction.method = GLTF_DRACO_PREDICTION_DIFFERENCE;
+	}
+
+	uint components = attribute->portable_components;
+	size_t value_count = (size_t)attribute->value_count * components;
+	if (value_count > GLTF_MAX_INDEX)
+		return false;
+	attribute->portable =
+	    memory_allocate(HASH_GLTF, sizeof(int32_t) * (value_count ? value_count : 1), 0, MEMORY_PERSISTENT);
+	int32_t* values = attribute->portable;
+
+	uint compressed = 0;
+	bool success = false;
+	if (!gltf_draco_read_u8(reader, &compressed))
+		goto exit;
+	if (compressed) {
+		if (!gltf_draco_decode_symbols(reader, (uint)value_count, components, (uint*)values))
+			goto exit;
+	} else {
+		uint value_size = 0;
+		if (!gltf_draco_read_u8(reader, &value_size) || !value_size || (value_size > 4) ||
+		    ((reader->size - reader->offset) / value_size < value_count))
+			goto exit;
+		const uint8_t* source = reader->data + reader->offset;
+		for (size_t ivalue = 0; ivalue < value_count; ++ivalue) {
+			uint32_t symbol = 0;
+			for (uint ibyte = 0; ibyte < value_size; ++ibyte)
+				symbol |= (uint32_t)(*source++) << (ibyte * 8);
+			values[ivalue] = (int32_t)symbol;
+		}
+		reader->offset += value_count * value_size;
+	}
+
+	// Corrections are stored zigzag encoded, except for the always positive octahedron corrections
+	if ((prediction.method == GLTF_DRACO_PREDICTION_NONE) || !octahedron) {
+		for (size_t ivalue = 0; ivalue < value_count; ++ivalue) {
+			uint32_t symbol = (uint32_t)values[ivalue];
+			values[ivalue] = (int32_t)(symbol >> 1) ^ -(int32_t)(symbol & 1);
+		}
+	}
+
+	if (prediction.method != GLTF_DRACO_PREDICTION_NONE) {
+		if (!gltf_draco_prediction_data(&prediction, reader) ||
+		    !gltf_draco_prediction_decode(&prediction, values, attribute->value_count, components))
+			goto exit;
+	}
+	success = true;
+
+exit:
+	gltf_draco_prediction_finalize(&prediction);
+	return success;
+}
+
+//! Read transform data and produce the final values of an attribute from its portable values
+static bool
+gltf_draco_transform(gltf_draco_reader_t* reader, gltf_draco_attribute_t* attribute) {
+	size_t value_count = (size_t)attribute->value_count * attribute->components;
+	if (attribute->decoder == GLTF_DRACO_DECODER_GENERIC)
+		return true;
+
+	if (attribute->decoder == GLTF_DRACO_DECODER_INTEGER) {
+		attribute->is_float = false;
+		attribute->values =
+		    memory_allocate(HASH_GLTF, sizeof(int32_t) * (value_count ? value_count : 1), 0, MEMORY_PERSISTENT);
+		memcpy(attribute->values, attribute->portable, sizeof(int32_t) * value_count);
+		return true;
+	}
+
+	if (attribute->decoder == GLTF_DRACO_DECODER_QUANTIZATION) {
+		float min_value[GLTF_DRACO_MAX_COMPONENTS];
+		float range;
+		uint bits = 0;
+		if (!gltf_draco_read(reader, min_value, sizeof(float) * attribute->components) ||
+		    !gltf_draco_read(reader, &range, sizeof(float)) || !gltf_draco_read_u8(reader, &bits) || !bits ||
+		    (bits > 30))
+			return false;
+
+		float delta = range / (float)((1U << bits) - 1);
+		const int32_t* quantized = attribute->portable;
+		float* values =
+		    memory_allocate(HASH_GLTF, sizeof(float) * (value_count ? value_count : 1), 0, MEMORY_PERSISTENT);
+		for (uint ientry = 0, ivalue = 0; ientry < attribute->value_count; ++ientry) {
+			for (uint icomp = 0; icomp < attribute->components; ++icomp, ++ivalue)
+				values[ivalue] = ((float)quantized[ivalue] * delta) + min_value[icomp];
+		}
+		attribute->values = values;
+		attribute->is_float = true;
+		return true;
+	}
+
+	// Normals are stored as quantized octahedral coordinates
+	uint bits = 0;
+	gltf_draco_octahedron_t octahedron;
+	if (!gltf_draco_read_u8(reader, &bits) || (bits < 2) || (bits > 30) ||
+	    !gltf_draco_octahedron_initialize(&octahedron, (int32_t)((1U << bits) - 1)))
+		return false;
+	const int32_t* coords = attribute->portable;
+	float* values = memory_allocate(HASH_GLTF, sizeof(float) * (value_count ? value_count : 1), 0, MEMORY_PERSISTENT);
+	for (uint ientry = 0; ientry < attribute->value_count; ++ientry) {
+		float y = ((float)coords[ientry * 2] * octahedron.dequantization_scale) - 1.0f;
+		float z = ((float)coords[(ientry * 2) + 1] * octahedron.dequantization_scale) - 1.0f;
+		float x = 1.0f - fabsf(y) - fabsf(z);
+		float offset = (x < 0) ? -x : 0;
+		y += (y < 0) ? offset : -offset;
+		z += (z < 0) ? offset : -offset;
+		float length_sqr = (x * x) + (y * y) + (z * z);
+		float scale = (length_sqr < 1e-6f) ? 0 : (1.0f / sqrtf(length_sqr));
+		values[(ientry * 3) + 0] = x * scale;
+		values[(ientry * 3) + 1] = y * scale;
+		values[(ientry * 3) + 2] = z * scale;
+	}
+	attribute->values = values;
+	attribute->is_float = true;
+	return true;
+}
+
+//! Decode the values of all attributes of one attributes decoder
+static bool
+gltf_draco_decode_values(gltf_draco_decoder_t* decoder, uint idecoder) {
+	gltf_draco_reader_t* reader = &decoder->reader;
+	gltf_draco_attributes_decoder_t* attributes_decoder = decoder->decoders + idecoder;
+	gltf_draco_attribute_t* attributes = decoder->attributes + attributes_decoder->first;
+	uint attribute_count = attributes_decoder->count;
+	const gltf_draco_table_t* table = nullptr;
+	const gltf_draco_encoding_t* encoding = nullptr;
+
+	if (decoder->method == GLTF_DRACO_MESH_SEQUENTIAL) {
+		array_resize(attributes_decoder->point_ids, decoder->point_count);
+		for (uint ipoint = 0; ipoint < decoder->point_count; ++ipoint)
+			attributes_decoder->point_ids[ipoint] = ipoint;
+	} else {
+		// Values are ordered by a traversal of the mesh or attribute connectivity, and points map to
+		// the value of the vertex of their corners
+		gltf_draco_seams_t* seams =
+		    (attributes_decoder->seams >= 0) ? (decoder->seams + attributes_decoder->seams) : nullptr;
+		gltf_draco_encoding_t* sequence_encoding = seams ? &seams->encoding : &decoder->position_encoding;
+		table = attributes_decoder->corner ? &seams->table : &decoder->table;
+		encoding = sequence_encoding;
+		if (!gltf_draco_sequence(decoder, table, sequence_encoding, attributes_decoder->sequencer,
+		                         &attributes_decoder->point_ids))
+			return false;
+		uint point_count = decoder->point_count;
+		for (uint iattrib = 0; iattrib < attribute_count; ++iattrib) {
+			uint* point_value = memory_allocate(HASH_GLTF, sizeof(uint) * (point_count ? point_count : 1), 0,
+			                                    MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+			attributes[iattrib].point_value = point_value;
+			for (uint icorner = 0; icorner < table->corner_count; ++icorner) {
+				uint vertex = table->corner_vertex[icorner];
+				uint value = (vertex != GLTF_INVALID_INDEX) ? encoding->vertex_value[vertex] : GLTF_INVALID_INDEX;
+				if ((value >= array_count(attributes_decoder->point_ids)) ||
+				    (decoder->indices[icorner] >= decoder->point_count))
+					return false;
+				point_value[decoder->indices[icorner]] = value;
+			}
+		}
+	}
+
+	// Portable values of all attributes precede the transform data of all attributes
+	const uint* point_ids = attributes_decoder->point_ids;
+	for (uint iattrib = 0; iattrib < attribute_count; ++iattrib) {
+		gltf_draco_attribute_t* attribute = attributes + iattrib;
+		attribute->value_count = array_count(point_ids);
+		bool success;
+		if (attribute->decoder == GLTF_DRACO_DECODER_GENERIC)
+			success = gltf_draco_decode_generic(reader, attribute);
+		else
+			success = gltf_draco_decode_integer(decoder, attribute, table, encoding, point_ids);
+		if (!success)
+			return false;
+	}
+	for (uint iattrib = 0; iattrib < attribute_count; ++iattrib) {
+		if (!gltf_draco_transform(reader, attributes + iattrib))
+			return false;
+	}
+	return true;
+}
+
+static bool
+gltf_draco_decode_attributes(gltf_draco_decoder_t* decoder) {
+	gltf_draco_reader_t* reader = &decoder->reader;
+	uint decoder_count = 0;
+	if (!gltf_draco_read_u8(reader, &decoder_count))
+		return false;
+	array_resize(decoder->decoders, decoder_count);
+	if (decoder_count)
+		memset(decoder->decoders, 0, sizeof(gltf_draco_attributes_decoder_t) * decoder_count);
+
+	// Edgebreaker meshes identify the connectivity and traversal of each decoder up front
+	for (uint idecoder = 0; idecoder < decoder_count; ++idecoder) {
+		gltf_draco_attributes_decoder_t* attributes_decoder = decoder->decoders + idecoder;
+		attributes_decoder->seams = -1;
+		if (decoder->method != GLTF_DRACO_MESH_EDGEBREAKER)
+			continue;
+		uint seams = 0, type = 0, sequencer = 0;
+		if (!gltf_draco_read_u8(reader, &seams) || !gltf_draco_read_u8(reader, &type) ||
+		    !gltf_draco_read_u8(reader, &sequencer) || (type > 1) ||
+		    (sequencer > GLTF_DRACO_SEQUENCER_PREDICTION_DEGREE))
+			return false;
+		attributes_decoder->seams = (int8_t)seams;
+		attributes_decoder->corner = (type == 1);
+		attributes_decoder->sequencer = sequencer;
+		if (attributes_decoder->seams >= (int)array_count(decoder->seams))
+			return false;
+		if (attributes_decoder->seams >= 0) {
+			decoder->seams[attributes_decoder->seams].decoder = (int)idecoder;
+			if (!attributes_decoder->corner)
+				decoder->seams[attributes_decoder->seams].connectivity_used = false;
+		} else {
+			if (decoder->position_decoder >= 0)
+				return false;
+			decoder->position_decoder = (int)idecoder;
+		}
+		if (attributes_decoder->corner &&
+		    ((attributes_decoder->seams < 0) || (sequencer != GLTF_DRACO_SEQUENCER_DEPTH_FIRST)))
+			return false;
+	}
+
+	for (uint idecoder = 0; idecoder < decoder_count; ++idecoder) {
+		gltf_draco_attributes_decoder_t* attributes_decoder = decoder->decoders + idecoder;
+		uint attribute_count = 0;
+		if (reader->version < GLTF_DRACO_VERSION(2, 0)) {
+			if (!gltf_draco_read_u32(reader, &attribute_count))
+				return false;
+		} else if (!gltf_draco_read_varint(reader, &attribute_count)) {
+			return false;
+		}
+		if (!attribute_count || (attribute_count > (reader->size - reader->offset)))
+			return false;
+
+		attributes_decoder->first = array_count(decoder->attributes);
+		attributes_decoder->count = attribute_count;
+		for (uint iattrib = 0; iattrib < attribute_count; ++iattrib) {
+			gltf_draco_attribute_t attribute;
+			memset(&attribute, 0, sizeof(attribute));
+			uint normalized = 0;
+			bool success = gltf_draco_read_u8(reader, &attribute.type) &&
+			               gltf_draco_read_u8(reader, &attribute.data_type) &&
+			               gltf_draco_read_u8(reader, &attribute.components) &&
+			               gltf_draco_read_u8(reader, &normalized);
+			if (success && (reader->version < GLTF_DRACO_VERSION(1, 3))) {
+				uint8_t id[2];
+				success = gltf_draco_read(reader, id, 2);
+				attribute.unique_id = (uint)id[0] | ((uint)id[1] << 8);
+			} else if (success) {
+				success = gltf_draco_read_varint(reader, &attribute.unique_id);
+			}
+			attribute.normalized = (normalized != 0);
+			attribute.portable_components = attribute.components;
+			array_push(decoder->attributes, attribute);
+			if (!success || (attribute.type > GLTF_DRACO_GENERIC) || !attribute.components ||
+			    (attribute.components > GLTF_DRACO_MAX_COMPONENTS) || !gltf_draco_data_type_size(attribute.data_type))
+				return false;
+		}
+		for (uint iattrib = 0; iattrib < attribute_count; ++iattrib) {
+			gltf_draco_attribute_t* attribute = decoder->attributes + attributes_decoder->first + iattrib;
+			if (!gltf_draco_read_u8(reader, &attribute->decoder) || (attribute->decoder > GLTF_DRACO_DECODER_NORMALS))
+				return false;
+			bool is_float32 = (attribute->data_type == GLTF_DRACO_DT_FLOAT32);
+			if ((attribute->decoder == GLTF_DRACO_DECODER_QUANTIZATION) && !is_float32)
+				return false;
+			if (attribute->decoder == GLTF_DRACO_DECODER_NORMALS) {
+				if (!is_float32 || (attribute->components != 3))
+					return false;
+				attribute->portable_components = 2;
+			}
+		}
+	}
+
+	for (uint idecoder = 0; idecoder < decoder_count; ++idecoder) {
+		if (!gltf_draco_decode_values(decoder, idecoder))
+			return false;
+	}
+	return true;
+}
+
+//! Skip a metadata element with its entries and nested elements
+static bool
+gltf_draco_skip_metadata(gltf_draco_reader_t* reader, uint depth) {
+	uint entry_count = 0, child_count = 0;
+	if ((depth > 32) || !gltf_draco_read_varint(reader, &entry_count))
+		return false;
+	for (uint ientry = 0; ientry < entry_count; ++ientry) {
+		uint name_length = 0, data_size = 0;
+		if (!gltf_draco_read_u8(reader, &name_length) || (name_length > reader->size - reader->offset))
+			return false;
+		reader->offset += name_length;
+		if (!gltf_draco_read_varint(reader, &data_size) || !data_size || (data_size > reader->size - reader->offset))
+			return false;
+		reader->offset += data_size;
+	}
+	if (!gltf_draco_read_varint(reader, &child_count))
+		return false;
+	for (uint ichild = 0; ichild < child_count; ++ichild) {
+		uint name_length = 0;
+		if (!gltf_draco_read_u8(reader, &name_length) || (name_length > reader->size - reader->offset))
+			return false;
+		reader->offset += name_length;
+		if (!gltf_draco_skip_metadata(reader, depth + 1))
+			return false;
+	}
+	return true;
+}
+
+static void
+gltf_draco_decoder_finalize(gltf_draco_decoder_t* decoder) {
+	for (uint iattrib = 0, attribute_count = array_count(decoder->attributes); iattrib < attribute_count; ++iattrib) {
+		memory_deallocate(decoder->attributes[iattrib].portable);
+		memory_deallocate(decoder->attributes[iattrib].values);
+		memory_deallocate(decoder->attributes[iattrib].point_value);
+	}
+	for (uint idecoder = 0, decoder_count = array_count(decoder->decoders); idecoder < decoder_count; ++idecoder)
+		array_deallocate(decoder->decoders[idecoder].point_ids);
+	for (uint iseam = 0, seam_count = array_count(decoder->seams); iseam < seam_count; ++iseam) {
+		gltf_draco_seams_t* seams = decoder->seams + iseam;
+		array_deallocate(seams->corners);
+		memory_deallocate(seams->vertex_seam);
+		gltf_draco_table_finalize(&seams->table, false);
+		gltf_draco_encoding_finalize(&seams->encoding);
+	}
+	gltf_draco_table_finalize(&decoder->table, true);
+	gltf_draco_encoding_finalize(&decoder->position_encoding);
+	memory_deallocate(decoder->vertex_hole);
+	array_deallocate(decoder->attributes);
+	array_deallocate(decoder->decoders);
+	array_deallocate(decoder->seams);
+	array_deallocate(decoder->indices);
+}
+
+//! Store the values of each point, mapped to the decoded values through the point value map
+static void
+gltf_draco_store(void* dest, gltf_component_type component_type, bool normalized, const gltf_draco_attribute_t* source,
+                 uint point_count, uint components) {
+	const float* float_values = source->values;
+	const int32_t* int_values = source->values;
+	for (size_t ivalue = 0, value_count = (size_t)point_count * components; ivalue < value_count; ++ivalue) {
+		uint point = (uint)(ivalue / components);
+		size_t isource = ((size_t)(source->point_value ? source->point_value[point] : point) * components) +
+		                 (ivalue % components);
+		double value = source->is_float ? (double)float_values[isource] : (double)int_values[isource];
+		switch (component_type) {
+			case GLTF_COMPONENT_BYTE:
+				((int8_t*)dest)[ivalue] = (int8_t)((normalized && source->is_float) ? (value * 127.0) : value);
+				break;
+			case GLTF_COMPONENT_UNSIGNED_BYTE:
+				((uint8_t*)dest)[ivalue] = (uint8_t)((normalized && source->is_float) ? (value * 255.0) : value);
+				break;
+			case GLTF_COMPONENT_SHORT:
+				((int16_t*)dest)[ivalue] = (int16_t)((normalized && source->is_float) ? (value * 32767.0) : value);
+				break;
+			case GLTF_COMPONENT_UNSIGNED_SHORT:
+				((uint16_t*)dest)[ivalue] = (uint16_t)((normalized && source->is_float) ? (value * 65535.0) : value);
+				break;
+			case GLTF_COMPONENT_UNSIGNED_INT:
+				((uint32_t*)dest)[ivalue] = source->is_float ? (uint32_t)value : (uint32_t)int_values[isource];
+				break;
+			case GLTF_COMPONENT_FLOAT:
+			default:
+				((float*)dest)[ivalue] = (float)value;
+				break;
+		}
+	}
+}
+
+bool
+gltf_draco_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken, gltf_draco_t* draco) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Draco extension has invalid type"));
+		return false;
+	}
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		if ((identifier_hash == HASH_BUFFERVIEW) &&
+		    !gltf_token_to_integer(gltf, buffer, tokens, itoken, &draco->buffer_view))
+			return false;
+		if ((identifier_hash == HASH_ATTRIBUTES) && (tokens[itoken].type == JSON_OBJECT)) {
+			size_t iattrib = tokens[itoken].child;
+			while (iattrib) {
+				identifier = json_token_identifier(gltf->buffer, tokens + iattrib);
+				identifier_hash = string_hash(STRING_ARGS(identifier));
+				uint* unique_id = nullptr;
+				if (identifier_hash == HASH_POSITION)
+					unique_id = &draco->attributes[GLTF_POSITION];
+				else if (identifier_hash == HASH_NORMAL)
+					unique_id = &draco->attributes[GLTF_NORMAL];
+				else if (identifier_hash == HASH_TANGENT)
+					unique_id = &draco->attributes[GLTF_TANGENT];
+				else if (identifier_hash == HASH_TEXCOORD_0)
+					unique_id = &draco->attributes[GLTF_TEXCOORD_0];
+				else if (identifier_hash == HASH_TEXCOORD_1)
+					unique_id = &draco->attributes[GLTF_TEXCOORD_1];
+				else if (identifier_hash == HASH_COLOR_0)
+					unique_id = &draco->attributes[GLTF_COLOR_0];
+				else if (identifier_hash == HASH_JOINTS_0)
+					unique_id = &draco->attributes[GLTF_JOINTS_0];
+				else if (identifier_hash == HASH_WEIGHTS_0)
+					unique_id = &draco->attributes[GLTF_WEIGHTS_0];
+				if (unique_id && !gltf_token_to_integer(gltf, buffer, tokens, iattrib, unique_id))
+					return false;
+				iattrib = tokens[iattrib].sibling;
+			}
+		}
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+bool
+gltf_draco_decode_primitive(gltf_t* gltf, gltf_primitive_t* primitive) {
+	uint compressed_size = 0;
+	const void* compressed = gltf_buffer_view_data(gltf, primitive->draco.buffer_view, &compressed_size);
+	if (!compressed)
+		return false;
+
+	gltf_draco_reader_t reader = {compressed, compressed_size, 0, 0};
+	char magic[5];
+	uint major = 0, minor = 0, encoder_type = 0, method = 0;
+	uint8_t flags[2];
+	if (!gltf_draco_read(&reader, magic, 5) || !string_equal(magic, 5, STRING_CONST("DRACO")) ||
+	    !gltf_draco_read_u8(&reader, &major) || !gltf_draco_read_u8(&reader, &minor) ||
+	    !gltf_draco_read_u8(&reader, &encoder_type) || !gltf_draco_read_u8(&reader, &method) ||
+	    !gltf_draco_read(&reader, flags, 2)) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Invalid Draco header"));
+		return false;
+	}
+	reader.version = (major << 8) | minor;
+
+	if ((major != 2) || (encoder_type != GLTF_DRACO_TRIANGULAR_MESH) || (method > GLTF_DRACO_MESH_EDGEBREAKER)) {
+		log_warnf(HASH_GLTF, WARNING_UNSUPPORTED,
+		          STRING_CONST("Unsupported Draco bitstream (version %u.%u, encoder %u, method %u)"), major, minor,
+		          encoder_type, method);
+		return false;
+	}
+
+	gltf_draco_decoder_t decoder;
+	memset(&decoder, 0, sizeof(decoder));
+	decoder.reader = reader;
+	decoder.method = method;
+	decoder.position_decoder = -1;
+
+	// Metadata is not used, skip the attribute metadata and the geometry metadata
+	bool success = true;
+	if ((uint)(flags[0] | (flags[1] << 8)) & GLTF_DRACO_METADATA_FLAG) {
+		uint metadata_count = 0;
+		success = gltf_draco_read_varint(&decoder.reader, &metadata_count);
+		for (uint imetadata = 0; success && (imetadata < metadata_count); ++imetadata) {
+			uint attribute_id = 0;
+			success = gltf_draco_read_varint(&decoder.reader, &attribute_id) &&
+			          gltf_draco_skip_metadata(&decoder.reader, 0);
+		}
+		success = success && gltf_draco_skip_metadata(&decoder.reader, 0);
+	}
+
+	if (method == GLTF_DRACO_MESH_EDGEBREAKER) {
+		uint traversal_type = 0;
+		success = success && gltf_draco_read_u8(&decoder.reader, &traversal_type) &&
+		          gltf_draco_decode_edgebreaker(&decoder, traversal_type);
+	} else {
+		success = success && gltf_draco_decode_sequential(&decoder);
+	}
+	success = success && gltf_draco_decode_attributes(&decoder);
+	if (!success) {
+		log_warn(HASH_GLTF, WARNING_INVALID_VALUE, STRING_CONST("Unable to decode Draco primitive"));
+		goto exit;
+	}
+
+	const uint* indices = decoder.indices;
+	const gltf_draco_attribute_t* attributes = decoder.attributes;
+	uint point_count = decoder.point_count;
+
+	// Lay out decoded data as one tightly packed buffer view per accessor in a new buffer
+	uint accessor_map[GLTF_ATTRIBUTE_COUNT];
+	uint attribute_map[GLTF_ATTRIBUTE_COUNT];
+	size_t offset[GLTF_ATTRIBUTE_COUNT + 1];
+	size_t total_size = 0;
+	uint accessor_count = array_count(gltf->accessors);
+	for (uint isemantic = 0; isemantic < GLTF_ATTRIBUTE_COUNT; ++isemantic) {
+		accessor_map[isemantic] = GLTF_INVALID_INDEX;
+		attribute_map[isemantic] = GLTF_INVALID_INDEX;
+		uint iaccessor = primitive->attributes[isemantic];
+		if ((primitive->draco.attributes[isemantic] == GLTF_INVALID_INDEX) || (iaccessor >= accessor_count))
+			continue;
+		for (uint iattrib = 0, attribute_count = array_count(attributes); iattrib < attribute_count; ++iattrib) {
+			if (attributes[iattrib].unique_id == primitive->draco.attributes[isemantic])
+				attribute_map[isemantic] = iattrib;
+		}
+		const gltf_accessor_t* accessor = gltf->accessors + iaccessor;
+		if ((attribute_map[isemantic] == GLTF_INVALID_INDEX) || (accessor->count != point_count) ||
+		    (gltf_data_type_component_count(accessor->type) != attributes[attribute_map[isemantic]].components)) {
+			log_warn(HASH_GLTF, WARNING_INVALID_VALUE, STRING_CONST("Draco attribute does not match accessor"));
+			success = false;
+			goto exit;
+		}
+		accessor_map[isemantic] = iaccessor;
+		offset[isemantic] = total_size;
+		total_size += (size_t)point_count * gltf_component_type_size(accessor->component_type) *
+		              gltf_data_type_component_count(accessor->type);
+		total_size = (total_size + 3) & ~(size_t)3;
+	}
+
+	uint index_count = array_count(indices);
+	gltf_accessor_t* index_accessor =
+	    (primitive->indices < accessor_count) ? (gltf->accessors + primitive->indices) : nullptr;
+	if (index_accessor && (index_accessor->count != index_count)) {
+		log_warn(HASH_GLTF, WARNING_INVALID_VALUE, STRING_CONST("Draco indices does not match accessor"));
+		success = false;
+		goto exit;
+	}
+	offset[GLTF_ATTRIBUTE_COUNT] = total_size;
+	if (index_accessor)
+		total_size += (size_t)index_count * gltf_component_type_size(index_accessor->component_type);
+
+	if (total_size > GLTF_MAX_INDEX) {
+		success = false;
+		goto exit;
+	}
+
+	void* data = memory_allocate(HASH_GLTF, total_size ? total_size : 4, 0, MEMORY_PERSISTENT);
+	uint ibuffer = gltf_buffer_add(gltf, string_const(STRING_CONST("KHR_draco_mesh_compression")), data,
+	                               (uint)total_size);
+	for (uint isemantic = 0; isemantic < GLTF_ATTRIBUTE_COUNT; ++isemantic) {
+		if (accessor_map[isemantic] == GLTF_INVALID_INDEX)
+			continue;
+		gltf_accessor_t* accessor = gltf->accessors + accessor_map[isemantic];
+		uint component_count = gltf_data_type_component_count(accessor->type);
+		size_t size = (size_t)point_count * gltf_component_type_size(accessor->component_type) * component_count;
+		gltf_draco_store(pointer_offset(data, offset[isemantic]), accessor->component_type, accessor->normalized,
+		                 attributes + attribute_map[isemantic], point_count, component_count);
+		accessor->buffer_view = gltf_buffer_view_add(gltf, ibuffer, (uint)offset[isemantic], (uint)size, 0,
+		                                             GLTF_BUFFER_TARGET_ARRAY);
+		accessor->byte_offset = 0;
+		accessor->dirty = true;
+	}
+	if (index_accessor) {
+		gltf_draco_attribute_t index_source;
+		memset(&index_source, 0, sizeof(index_source));
+		index_source.values = decoder.indices;
+		size_t size = (size_t)index_count * gltf_component_type_size(index_accessor->component_type);
+		gltf_draco_store(pointer_offset(data, offset[GLTF_ATTRIBUTE_COUNT]), index_accessor->component_type, false,
+		                 &index_source, index_count, 1);
+		index_accessor->buffer_view = gltf_buffer_view_add(gltf, ibuffer, (uint)offset[GLTF_ATTRIBUTE_COUNT],
+		                                                   (uint)size, 0, GLTF_BUFFER_TARGET_ELEMENT_ARRAY);
+		index_accessor->byte_offset = 0;
+		index_accessor->dirty = true;
+	}
+
+	// Primitive is now an ordinary uncompressed primitive
+	primitive->draco.buffer_view = GLTF_INVALID_INDEX;
+
+exit:
+	gltf_draco_decoder_finalize(&decoder);
+
+	return success;
+}
+
+bool
+gltf_draco_decode(gltf_t* gltf) {
+	for (uint imesh = 0, meshes_count = array_count(gltf->meshes); imesh < meshes_count; ++imesh) {
+		gltf_mesh_t* mesh = gltf->meshes + imesh;
+		for (uint iprim = 0, primitives_count = array_count(mesh->primitives); iprim < primitives_count; ++iprim) {
+			gltf_primitive_t* primitive = mesh->primitives + iprim;
+			if (primitive->draco.buffer_view == GLTF_INVALID_INDEX)
+				continue;
+			if (gltf_draco_decode_primitive(gltf, primitive)) {
+				// Cached triangle hierarchy refers to the replaced accessors
+				gltf_triangle_bvh_deallocate(primitive->triangle_bvh);
+				primitive->triangle_bvh = nullptr;
+				mesh->dirty = true;
+			} else {
+				log_warnf(HASH_GLTF, WARNING_UNSUPPORTED, STRING_CONST("Draco primitive %u of mesh %u not decoded"),
+				          iprim, imesh);
+			}
+		}
+	}
+	return true;
+}
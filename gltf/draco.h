@@ -0,0 +1,34 @@
+/* draco.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+#include "gltf.h"
+
+GLTF_API bool
+gltf_draco_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken, gltf_draco_t* draco);
+
+/*! Decode all KHR_draco_mesh_compression primitives into ordinary buffer views and
+accessors. Primitives that cannot be decoded are left untouched.
+\param gltf glTF data structure
+\return true if success, false if error */
+GLTF_API bool
+gltf_draco_decode(gltf_t* gltf);
+
+/*! Decode a single KHR_draco_mesh_compression primitive
+\param gltf glTF data structure
+\param primitive Primitive to decode
+\return true if success, false if error */
+GLTF_API bool
+gltf_draco_decode_primitive(gltf_t* gltf, gltf_primitive_t* primitive);
@@ -17,6 +17,7 @@
 #include "hashstrings.h"
 
 #include <foundation/memory.h>
+#include <foundation/array.h>
 #include <foundation/json.h>
 #include <foundation/log.h>
 #include <foundation/hashstrings.h>
@@ -61,3 +62,64 @@ gltf_extensions_required_parse(gltf_t* gltf, const char* data, json_token_t* tok
 	return gltf_extensions_array_parse(data, tokens, itoken, &gltf->extensions_required,
 	                                   &gltf->extensions_required_count);
 }
+
+void
+gltf_extension_register(gltf_t* gltf, const char* name, size_t length, gltf_extension_handler_fn handler,
+                        void* context) {
+	hash_t name_hash = string_hash(name, length);
+	for (uint ihandler = 0, handler_count = array_count(gltf->extension_handlers); ihandler < handler_count;
+	     ++ihandler) {
+		gltf_extension_handler_t* entry = gltf->extension_handlers + ihandler;
+		if (entry->name != name_hash)
+			continue;
+		if (handler) {
+			entry->handler = handler;
+			entry->context = context;
+		} else {
+			*entry = gltf->extension_handlers[handler_count - 1];
+			array_pop(gltf->extension_handlers);
+		}
+		return;
+	}
+	if (handler) {
+		gltf_extension_handler_t entry = {name_hash, handler, context};
+		array_push(gltf->extension_handlers, entry);
+	}
+}
+
+bool
+gltf_extensions_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken,
+                      gltf_extension_owner owner, void* object, string_const_t* source) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Extensions attribute has invalid type"));
+		return false;
+	}
+	if (source)
+		*source = gltf_token_source(gltf, data, tokens, itoken);
+
+	uint handler_count = array_count(gltf->extension_handlers);
+	if (!handler_count)
+		return true;
+
+	// Extensions are matched by name hash against the few registered handlers as the object is parsed
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(data, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		for (uint ihandler = 0; ihandler < handler_count; ++ihandler) {
+			const gltf_extension_handler_t* handler = gltf->extension_handlers + ihandler;
+			if (handler->name != identifier_hash)
+				continue;
+			if (!handler->handler(gltf, data, tokens, itoken, owner, object, handler->context)) {
+				log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Extension %.*s failed to parse"),
+				           STRING_FORMAT(identifier));
+				return false;
+			}
+			break;
+		}
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
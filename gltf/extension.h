@@ -21,3 +21,28 @@ gltf_extensions_used_parse(gltf_t* gltf, const char* buffer, json_token_t* token
 
 GLTF_API bool
 gltf_extensions_required_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
+
+/*! Register a handler called for each extension with the given name while parsing. A handler
+previously registered for the same name is replaced.
+\param gltf glTF data structure
+\param name Extension name
+\param length Length of extension name
+\param handler Handler, null to unregister
+\param context Context passed to the handler */
+GLTF_API void
+gltf_extension_register(gltf_t* gltf, const char* name, size_t length, gltf_extension_handler_fn handler,
+                        void* context);
+
+/*! Store the source text of an extensions object and call the registered handler of each
+extension it contains
+\param gltf glTF data structure
+\param buffer JSON text
+\param tokens JSON tokens
+\param itoken Token of the extensions object
+\param owner Type of the owning object
+\param object Owning object
+\param source Destination for the source text of the extensions object, null to ignore
+\return true if success, false if the extensions member is invalid or a handler failed */
+GLTF_API bool
+gltf_extensions_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
+                      gltf_extension_owner owner, void* object, string_const_t* source);
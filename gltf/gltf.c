@@ -16,6 +16,7 @@
 #include "hashstrings.h"
 
 #include <foundation/stream.h>
+#include <foundation/bufferstream.h>
 #include <foundation/memory.h>
 #include <foundation/json.h>
 #include <foundation/path.h>
@@ -23,6 +24,15 @@
 #include <foundation/virtualarray.h>
 #include <foundation/log.h>
 #include <foundation/hashstrings.h>
+#include <foundation/thread.h>
+#include <foundation/system.h>
+
+//! Minimum number of elements in the array sections of the document to serialize in parallel
+#define GLTF_WRITE_PARALLEL_THRESHOLD 4096
+//! Number of elements serialized by each parallel job
+#define GLTF_WRITE_CHUNK_SIZE 1024
+//! Maximum number of threads serializing in parallel
+#define GLTF_WRITE_MAX_THREADS 16
 
 #if FOUNDATION_COMPILER_CLANG
 #if __has_warning("-Wfloat-equal")
@@ -79,18 +89,24 @@ gltf_finalize(gltf_t* gltf) {
 		gltf_textures_finalize(gltf);
 		gltf_nodes_finalize(gltf);
 		gltf_scenes_finalize(gltf);
+		gltf_animations_finalize(gltf);
+		gltf_skins_finalize(gltf);
 		gltf_images_finalize(gltf);
 		gltf_buffer_views_finalize(gltf);
 		gltf_buffers_finalize(gltf);
 		gltf_accessors_finalize(gltf);
+		gltf_bounds_finalize(gltf);
 		memory_deallocate(gltf->extensions_used);
 		memory_deallocate(gltf->extensions_required);
+		array_deallocate(gltf->extension_handlers);
+		gltf_query_finalize(gltf);
 		memory_deallocate(gltf->buffer);
+		array_deallocate(gltf->source_members);
 		string_deallocate(gltf->base_path.str);
 		memory_deallocate(gltf->binary_chunk.data);
 		string_deallocate(gltf->binary_chunk.uri.str);
 		string_array_deallocate(gltf->string_array);
-		virtualarray_deallocate(gltf->output_buffer);
+		gltf_buffer_output_finalize(gltf);
 	}
 }
 
@@ -211,6 +227,56 @@ gltf_token_to_data_type(const gltf_t* gltf, const char* buffer, json_token_t* to
 	return true;
 }
 
+string_const_t
+gltf_token_source(const gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken) {
+	const json_token_t* token = tokens + itoken;
+	size_t size = gltf->buffer_size;
+	size_t start = token->value;
+	if ((token->type == JSON_STRING) && start && ((start + token->value_length) < size))
+		return string_const(buffer + start - 1, token->value_length + 2);
+	if ((token->type != JSON_OBJECT) && (token->type != JSON_ARRAY))
+		return string_const(buffer + start, token->value_length);
+
+	// Complex tokens only store the start offset, find the end by scanning for the matching close
+	char open = (token->type == JSON_OBJECT) ? '{' : '[';
+	if ((start < size) && (buffer[start] != open) && start && (buffer[start - 1] == open))
+		--start;
+	if ((start >= size) || (buffer[start] != open))
+		return string_const(0, 0);
+
+	uint depth = 0;
+	bool in_string = false;
+	for (size_t pos = start; pos < size; ++pos) {
+		char c = buffer[pos];
+		if (in_string) {
+			if (c == '\\')
+				++pos;
+			else if (c == '"')
+				in_string = false;
+		} else if (c == '"') {
+			in_string = true;
+		} else if ((c == '{') || (c == '[')) {
+			++depth;
+		} else if ((c == '}') || (c == ']')) {
+			if (!--depth)
+				return string_const(buffer + start, pos + 1 - start);
+		}
+	}
+	return string_const(0, 0);
+}
+
+//! Query if a top level member is written from parsed data
+static bool
+gltf_member_is_written(string_const_t identifier, hash_t identifier_hash) {
+	return (identifier_hash == HASH_ASSET) || (identifier_hash == HASH_SCENE) || (identifier_hash == HASH_SCENES) ||
+	       (identifier_hash == HASH_NODES) || (identifier_hash == HASH_MATERIALS) || (identifier_hash == HASH_MESHES) ||
+	       (identifier_hash == HASH_BUFFERS) || (identifier_hash == HASH_BUFFERVIEWS) ||
+	       (identifier_hash == HASH_ACCESSORS) || (identifier_hash == HASH_EXTENSIONSUSED) ||
+	       (identifier_hash == HASH_EXTENSIONSREQUIRED) ||
+	       string_equal(STRING_ARGS(identifier), STRING_CONST("animations")) ||
+	       string_equal(STRING_ARGS(identifier), STRING_CONST("skins"));
+}
+
 static bool
 gltf_parse_asset(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken) {
 	if (tokens[itoken].type != JSON_OBJECT) {
@@ -285,6 +351,9 @@ gltf_read(gltf_t* gltf, stream_t* stream) {
 
 	memory_deallocate(gltf->buffer);
 	gltf->buffer = memory_allocate(HASH_GLTF, json_size, 0, MEMORY_PERSISTENT);
+	gltf->buffer_size = json_size;
+	array_clear(gltf->source_members);
+	gltf_query_finalize(gltf);
 
 	size_t itoken = 0;
 	size_t token_count = 0;
@@ -357,12 +426,33 @@ gltf_read(gltf_t* gltf, stream_t* stream) {
 			success = gltf_extensions_used_parse(gltf, gltf->buffer, tokens, itoken);
 		else if (identifier_hash == HASH_EXTENSIONSREQUIRED)
 			success = gltf_extensions_required_parse(gltf, gltf->buffer, tokens, itoken);
+		else if (string_equal(STRING_ARGS(identifier), STRING_CONST("animations")))
+			success = gltf_animations_parse(gltf, gltf->buffer, tokens, itoken);
+		else if (string_equal(STRING_ARGS(identifier), STRING_CONST("skins")))
+			success = gltf_skins_parse(gltf, gltf->buffer, tokens, itoken);
+		else if (identifier_hash == HASH_EXTENSIONS)
+			success = gltf_extensions_parse(gltf, gltf->buffer, tokens, itoken, GLTF_EXTENSION_OWNER_ROOT, gltf,
+			                                nullptr);
+
+		if (!gltf_member_is_written(identifier, identifier_hash)) {
+			// Retain members unknown to the writer as source text, including the quoted identifier
+			string_const_t value = gltf_token_source(gltf, gltf->buffer, tokens, itoken);
+			if (value.length && (identifier.str > (const char*)gltf->buffer)) {
+				const char* member = identifier.str - 1;
+				array_push(gltf->source_members,
+				           string_const(member, (size_t)pointer_diff(value.str + value.length, member)));
+			}
+		}
 
 		if (!success)
 			break;
 		itoken = tokens[itoken].sibling;
 	}
 
+	// Replace compressed primitives with decoded data now that all views and accessors are known
+	if (success)
+		success = gltf_draco_decode(gltf);
+
 	if (success) {
 		log_infof(HASH_GLTF, STRING_CONST("Read %s file version %.*s - %.*s"),
 		          (gltf->file_type < GLTF_FILE_GLB) ? "glTF" : "GLB", STRING_FORMAT(gltf->asset.version),
@@ -389,6 +479,8 @@ gltf_read(gltf_t* gltf, stream_t* stream) {
 				log_infof(HASH_GLTF, STRING_CONST("      %u: type %u material %u"), iprim, prim->mode, prim->material);
 			}
 		}
+		log_infof(HASH_GLTF, STRING_CONST("  %u animations"), array_count(gltf->animations));
+		log_infof(HASH_GLTF, STRING_CONST("  %u skins"), array_count(gltf->skins));
 		log_infof(HASH_GLTF, STRING_CONST("  %u textures"), gltf->textures_count);
 		log_infof(HASH_GLTF, STRING_CONST("  %u images"), gltf->images_count);
 	} else {
@@ -396,107 +488,190 @@ gltf_read(gltf_t* gltf, stream_t* stream) {
 	}
 
 exit:
+	if (success && (gltf->flags & GLTF_FLAG_RETAIN_TOKENS))
+		gltf_query_retain(gltf, tokens, token_count);
 	memory_deallocate(tokens);
 	return success;
 }
 
-bool
-gltf_write(const gltf_t* gltf, stream_t* stream) {
-	stream_set_byteorder(stream, BYTEORDER_LITTLEENDIAN);
-
-	size_t file_size_offset = 8;
-	size_t json_size_offset = 12;
-	size_t json_start_offset = 20;
-	if ((gltf->file_type == GLTF_FILE_GLB) || (gltf->file_type == GLTF_FILE_GLB_EMBED)) {
-		// First write GLB header
-		gltf_glb_header_t glb_header;
-		glb_header.magic = 0x46546C67;
-		glb_header.version = 2;
-		glb_header.length = 0;
+static bool
+gltf_write_buffer_file(const char* path, size_t length, const void* data, size_t size) {
+	stream_t* buffer_stream = stream_open(path, length, STREAM_OUT | STREAM_BINARY | STREAM_CREATE | STREAM_TRUNCATE);
+	if (!buffer_stream) {
+		log_errorf(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Failed to open binary buffer stream: %.*s"),
+		           (int)length, path);
+		return false;
+	}
+	stream_write(buffer_stream, data, size);
+	stream_deallocate(buffer_stream);
+	return true;
+}
 
-		stream_set_binary(stream, true);
-		stream_write(stream, &glb_header, sizeof(glb_header));
+//! Copy streamed output buffer data to a stream, or base64 encoded to a writer if given
+static bool
+gltf_write_stream_copy(stream_t* stream, gltf_writer_t* writer, stream_t* source, size_t size) {
+	// Copy in fixed size blocks to keep memory bounded. Blocks are a multiple of three bytes so
+	// base64 encoded blocks form one sequence without intermediate padding
+	size_t block_size = 3 * 512 * 1024;
+	char* block = memory_allocate(HASH_GLTF, block_size, 0, MEMORY_TEMPORARY);
+	stream_flush(source);
+	stream_seek(source, 0, STREAM_SEEK_BEGIN);
+	size_t remain = size;
+	while (remain) {
+		size_t want = (remain < block_size) ? remain : block_size;
+		size_t read = 0;
+		while (read < want) {
+			size_t count = stream_read(source, block + read, want - read);
+			if (!count)
+				break;
+			read += count;
+		}
+		if (writer)
+			gltf_writer_base64(writer, block, read);
+		else
+			stream_write(stream, block, read);
+		remain -= read;
+		if (read < want)
+			break;
+	}
+	stream_seek(source, 0, STREAM_SEEK_END);
+	memory_deallocate(block);
+	if (remain) {
+		log_error(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Failed to read streamed output buffer"));
+		return false;
+	}
+	return true;
+}
 
-		// Now JSON chunk header (size, type)
-		stream_write_uint32(stream, 0);
-		stream_write_uint32(stream, 0x4E4F534A);
+//! Write the members of a source JSON object whose names are not in the skip list, each member on a new
+//! line at the given indent and separated by a comma from any previous member. Used to keep members that
+//! are not represented by fields when a dirty object is written from fields. Returns the member count
+//! including the count of members already written
+static uint
+gltf_write_source_members(const gltf_t* gltf, gltf_writer_t* writer, string_const_t source, const char* indent,
+                          size_t indent_length, const char* const* skip, uint skip_count, uint count) {
+	if (!source.length)
+		return count;
+
+	json_token_t local_tokens[64];
+	json_token_t* tokens = local_tokens;
+	size_t token_count = json_parse(source.str, source.length, tokens, sizeof(local_tokens) / sizeof(json_token_t));
+	if (token_count > (sizeof(local_tokens) / sizeof(json_token_t))) {
+		tokens = memory_allocate(HASH_GLTF, sizeof(json_token_t) * token_count, 0, MEMORY_TEMPORARY);
+		token_count = json_parse(source.str, source.length, tokens, token_count);
+	}
 
-		json_start_offset = stream_tell(stream);
+	if (token_count && (tokens[0].type == JSON_OBJECT)) {
+		for (size_t itoken = tokens[0].child; itoken; itoken = tokens[itoken].sibling) {
+			string_const_t identifier = json_token_identifier(source.str, tokens + itoken);
+			uint iskip = 0;
+			while ((iskip < skip_count) &&
+			       !string_equal(STRING_ARGS(identifier), skip[iskip], string_length(skip[iskip])))
+				++iskip;
+			if (iskip < skip_count)
+				continue;
+			string_const_t value = gltf_token_source(gltf, source.str, tokens, itoken);
+			if (!value.length)
+				continue;
+			if (count++)
+				gltf_writer_write(writer, STRING_CONST(","));
+			gltf_writer_write(writer, STRING_CONST("\n"));
+			gltf_writer_write(writer, indent, indent_length);
+			gltf_writer_format(writer, STRING_CONST("\"%.*s\": "), STRING_FORMAT(identifier));
+			gltf_writer_json(writer, STRING_ARGS(value));
+		}
 	}
 
-	stream_set_binary(stream, false);
+	if (tokens != local_tokens)
+		memory_deallocate(tokens);
+	return count;
+}
 
-	stream_write(stream, STRING_CONST("{\n"));
-	stream_write(stream, STRING_CONST("\t\"asset\": {\n"));
-	stream_write(stream, STRING_CONST("\t\t\"generator\": \"gltf_lib\",\n"));
-	stream_write(stream, STRING_CONST("\t\t\"version\": \"2.0\"\n"));
-	stream_write(stream, STRING_CONST("\t}"));
-
-	if (gltf->output_buffer && gltf->output_buffer->count) {
-		char path_buffer[BUILD_MAX_PATHLEN];
-		string_t buffer_uri = string(0, 0);
-		string_const_t buffer_relative_uri;
-
-		stream_write(stream, STRING_CONST(",\n\t\"buffers\": [\n"));
-		stream_write(stream, STRING_CONST("\t\t{\n"));
-		if (gltf->file_type == GLTF_FILE_GLB_EMBED) {
-			// Leave the buffer URI undefined as per GLB spec
-		} else if (gltf->file_type == GLTF_FILE_GLTF_EMBED) {
-			// TODO: Implement
+static void
+gltf_write_buffer_views(const gltf_t* gltf, gltf_writer_t* writer, const gltf_meshopt_view_t* meshopt_views, uint start,
+                        uint end) {
+	// Output buffers are written after the source buffers, preceded by one compressed buffer per output buffer
+	uint compressed_base = array_count(gltf->buffers);
+	uint output_base = compressed_base + ((meshopt_views != nullptr) ? array_count(gltf->output_sizes) : 0);
+	uint view_count = array_count(gltf->buffer_views);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"bufferViews\": [\n"));
+	for (uint iview = start; iview < end; ++iview) {
+		const gltf_buffer_view_t* buffer_view = gltf->buffer_views + iview;
+		bool meshopt = (meshopt_views != nullptr) && buffer_view->output;
+		if (!buffer_view->output && buffer_view->source.length && !buffer_view->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(buffer_view->source));
 		} else {
-			string_const_t base_uri = stream_path(stream);
-			base_uri = path_base_file_name_with_directory(STRING_ARGS(base_uri));
-			buffer_uri = string_concat(path_buffer, sizeof(path_buffer), STRING_ARGS(base_uri), STRING_CONST(".bin"));
-			buffer_relative_uri = path_file_name(STRING_ARGS(buffer_uri));
-			stream_write_format(stream, STRING_CONST("\t\t\t\"uri\": \"%.*s\",\n"), STRING_FORMAT(buffer_relative_uri));
-		}
-		stream_write_format(stream, STRING_CONST("\t\t\t\"byteLength\": %" PRIsize "\n"), gltf->output_buffer->count);
-		stream_write(stream, STRING_CONST("\t\t}\n"));
-		stream_write(stream, STRING_CONST("\t]"));
-
-		if ((gltf->file_type == GLTF_FILE_GLB) || (gltf->file_type == GLTF_FILE_GLTF)) {
-			stream_t* buffer_stream =
-			    stream_open(STRING_ARGS(buffer_uri), STREAM_OUT | STREAM_BINARY | STREAM_CREATE | STREAM_TRUNCATE);
-			if (stream) {
-				stream_write(buffer_stream, gltf->output_buffer->storage, gltf->output_buffer->count);
-				stream_deallocate(buffer_stream);
+			gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
+			if (meshopt && (meshopt_views[iview].mode == GLTF_MESHOPT_NONE)) {
+				// Uncompressed view stored directly in compressed buffer
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"buffer\": %u,\n"),
+				                   compressed_base + buffer_view->buffer);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"byteOffset\": %" PRIsize ",\n"),
+				                   meshopt_views[iview].byte_offset);
 			} else {
-				log_errorf(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL, STRING_CONST("Failed to open binary buffer stream: %.*s"),
-				           STRING_FORMAT(buffer_uri));
-				return false;
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"buffer\": %u,\n"),
+				                   buffer_view->output ? (output_base + buffer_view->buffer) : buffer_view->buffer);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"byteOffset\": %u,\n"), buffer_view->byte_offset);
 			}
+			if (buffer_view->target)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"target\": %u,\n"), buffer_view->target);
+			if (buffer_view->byte_stride)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"byteStride\": %u,\n"), buffer_view->byte_stride);
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"byteLength\": %u"), buffer_view->byte_length);
+			if (meshopt && (meshopt_views[iview].mode != GLTF_MESHOPT_NONE)) {
+				const gltf_meshopt_view_t* meshopt_view = meshopt_views + iview;
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"extensions\": {\n"));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t\t\"EXT_meshopt_compression\": {\n"));
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"buffer\": %u,\n"),
+				                   compressed_base + buffer_view->buffer);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"byteOffset\": %" PRIsize ",\n"),
+				                   meshopt_view->byte_offset);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"byteLength\": %" PRIsize ",\n"),
+				                   meshopt_view->byte_length);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"byteStride\": %u,\n"), meshopt_view->byte_stride);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"count\": %u,\n"), meshopt_view->count);
+				if (meshopt_view->mode == GLTF_MESHOPT_INDICES)
+					gltf_writer_write(writer, STRING_CONST("\t\t\t\t\t\"mode\": \"INDICES\"\n"));
+				else
+					gltf_writer_write(writer, STRING_CONST("\t\t\t\t\t\"mode\": \"ATTRIBUTES\"\n"));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t\t}\n\t\t\t}"));
+			}
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
 		}
+		if (iview < (view_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
 	}
+	if (end == view_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	if (array_count(gltf->buffer_views)) {
-		stream_write(stream, STRING_CONST(",\n\t\"bufferViews\": [\n"));
-		for (uint iview = 0, view_count = array_count(gltf->buffer_views); iview < view_count; ++iview) {
-			stream_write(stream, STRING_CONST("\t\t{\n"));
-			stream_write(stream, STRING_CONST("\t\t\t\"buffer\": 0,\n"));
-			stream_write_format(stream, STRING_CONST("\t\t\t\"byteOffset\": %u,\n"),
-			                    gltf->buffer_views[iview].byte_offset);
-			stream_write_format(stream, STRING_CONST("\t\t\t\"byteLength\": %u\n"),
-			                    gltf->buffer_views[iview].byte_length);
-			stream_write(stream, STRING_CONST("\t\t}"));
-			if (iview < (view_count - 1))
-				stream_write(stream, STRING_CONST(","));
-			stream_write(stream, STRING_CONST("\n"));
-		}
-		stream_write(stream, STRING_CONST("\t]"));
-	}
-
-	if (array_count(gltf->accessors)) {
-		stream_write(stream, STRING_CONST(",\n\t\"accessors\": [\n"));
-		for (uint iacc = 0, accessor_count = array_count(gltf->accessors); iacc < accessor_count; ++iacc) {
-			stream_write(stream, STRING_CONST("\t\t{\n"));
-			stream_write_format(stream, STRING_CONST("\t\t\t\"bufferView\": %u,\n"), gltf->accessors[iacc].buffer_view);
-			stream_write_format(stream, STRING_CONST("\t\t\t\"componentType\": %u,\n"),
-			                    gltf->accessors[iacc].component_type);
-			stream_write_format(stream, STRING_CONST("\t\t\t\"count\": %u,\n"), gltf->accessors[iacc].count);
+static void
+gltf_write_accessors(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* const member_names[] = {"bufferView", "byteOffset", "componentType", "count", "type",
+	                                           "normalized", "name", "min", "max"};
+	uint accessor_count = array_count(gltf->accessors);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"accessors\": [\n"));
+	for (uint iacc = start; iacc < end; ++iacc) {
+		const gltf_accessor_t* accessor = gltf->accessors + iacc;
+		if (accessor->source.length && !accessor->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(accessor->source));
+		} else {
+			gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
+			if (accessor->buffer_view != GLTF_INVALID_INDEX)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"bufferView\": %u,\n"), accessor->buffer_view);
+			if (accessor->byte_offset)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"byteOffset\": %u,\n"), accessor->byte_offset);
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"componentType\": %u,\n"), accessor->component_type);
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"count\": %u,\n"), accessor->count);
 
 			uint component_count = 0;
 			const char* typestr = "SCALAR";
-			switch (gltf->accessors[iacc].type) {
+			switch (accessor->type) {
 				case GLTF_DATA_VEC2:
 					typestr = "VEC2";
 					component_count = 2;
@@ -522,87 +697,193 @@ gltf_write(const gltf_t* gltf, stream_t* stream) {
 				default:
 					break;
 			}
-			stream_write_format(stream, STRING_CONST("\t\t\t\"type\": \"%s\""), typestr);
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"type\": \"%s\""), typestr);
 			if (component_count) {
-				stream_write(stream, STRING_CONST(",\n\t\t\t\"min\": [\n"));
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"min\": [\n"));
 				for (uint icomp = 0; icomp < component_count; ++icomp) {
-					stream_write(stream, STRING_CONST("\t\t\t\t"));
-					if (gltf->accessors[iacc].component_type == GLTF_COMPONENT_FLOAT)
-						stream_write_float32(stream, gltf->accessors[iacc].min[icomp]);
+					gltf_writer_write(writer, STRING_CONST("\t\t\t\t"));
+					if (accessor->component_type == GLTF_COMPONENT_FLOAT)
+						gltf_writer_float(writer, accessor->min[icomp]);
 					else
-						stream_write_uint32(stream, (uint)gltf->accessors[iacc].min[icomp]);
+						gltf_writer_uint(writer, (uint)accessor->min[icomp]);
 					if (icomp < (component_count - 1))
-						stream_write(stream, STRING_CONST(","));
-					stream_write(stream, STRING_CONST("\n"));
+						gltf_writer_write(writer, STRING_CONST(","));
+					gltf_writer_write(writer, STRING_CONST("\n"));
 				}
-				stream_write(stream, STRING_CONST("\t\t\t],\n\t\t\t\"max\": [\n"));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t],\n\t\t\t\"max\": [\n"));
 				for (uint icomp = 0; icomp < component_count; ++icomp) {
-					stream_write(stream, STRING_CONST("\t\t\t\t"));
-					if (gltf->accessors[iacc].component_type == GLTF_COMPONENT_FLOAT)
-						stream_write_float32(stream, gltf->accessors[iacc].max[icomp]);
+					gltf_writer_write(writer, STRING_CONST("\t\t\t\t"));
+					if (accessor->component_type == GLTF_COMPONENT_FLOAT)
+						gltf_writer_float(writer, accessor->max[icomp]);
 					else
-						stream_write_uint32(stream, (uint)gltf->accessors[iacc].max[icomp]);
+						gltf_writer_uint(writer, (uint)accessor->max[icomp]);
 					if (icomp < (component_count - 1))
-						stream_write(stream, STRING_CONST(","));
-					stream_write(stream, STRING_CONST("\n"));
+						gltf_writer_write(writer, STRING_CONST(","));
+					gltf_writer_write(writer, STRING_CONST("\n"));
 				}
-				stream_write(stream, STRING_CONST("\t\t\t]"));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t]"));
 			}
-			stream_write(stream, STRING_CONST("\n\t\t}"));
-			if (iacc < (accessor_count - 1))
-				stream_write(stream, STRING_CONST(","));
-			stream_write(stream, STRING_CONST("\n"));
+			if (accessor->normalized)
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"normalized\": true"));
+			if (accessor->name.length)
+				gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(accessor->name));
+			// Sparse storage, extensions and extras are kept from the source text, as are min and max if not
+			// written above
+			uint skip_count = component_count ? 9 : 7;
+			gltf_write_source_members(gltf, writer, accessor->source, STRING_CONST("\t\t\t"), member_names, skip_count,
+			                          1);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
 		}
-		stream_write(stream, STRING_CONST("\t]"));
+		if (iacc < (accessor_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
 	}
+	if (end == accessor_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	if (array_count(gltf->materials)) {
-		stream_write(stream, STRING_CONST(",\n\t\"materials\": ["));
-		for (uint imat = 0, material_count = array_count(gltf->materials); imat < material_count; ++imat) {
-			gltf_material_t* material = gltf->materials + imat;
-			if (imat > 0)
-				stream_write(stream, STRING_CONST(","));
-			stream_write(stream, STRING_CONST("\n\t\t{\n"));
+//! Write a texture info member with an optional scale or strength value, skipped if the index is invalid
+static void
+gltf_write_texture_info(gltf_writer_t* writer, const char* name, size_t length, const gltf_texture_info_t* texture,
+                        const char* indent, size_t indent_length, const char* value_name, size_t value_length,
+                        real value) {
+	if (texture->index == GLTF_INVALID_INDEX)
+		return;
+	gltf_writer_write(writer, STRING_CONST(",\n"));
+	gltf_writer_write(writer, indent, indent_length);
+	gltf_writer_format(writer, STRING_CONST("\"%.*s\": {\"index\": %u"), (int)length, name, texture->index);
+	if (texture->texcoord)
+		gltf_writer_format(writer, STRING_CONST(", \"texCoord\": %u"), texture->texcoord);
+	if (value_length && (value != 1)) {
+		gltf_writer_format(writer, STRING_CONST(", \"%.*s\": "), (int)value_length, value_name);
+		gltf_writer_float(writer, (float)value);
+	}
+	if (texture->extensions.length) {
+		gltf_writer_write(writer, STRING_CONST(", \"extensions\": "));
+		gltf_writer_json(writer, STRING_ARGS(texture->extensions));
+	}
+	if (texture->extras.length)
+		gltf_writer_format(writer, STRING_CONST(", \"extras\": \"%.*s\""), STRING_FORMAT(texture->extras));
+	gltf_writer_write(writer, STRING_CONST("}"));
+}
+
+static void
+gltf_write_materials(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* const member_names[] = {"name", "pbrMetallicRoughness", "normalTexture", "occlusionTexture",
+	                                           "emissiveTexture", "emissiveFactor", "alphaMode", "alphaCutoff",
+	                                           "doubleSided", "extensions"};
+	static const char* alpha_mode_names[] = {"OPAQUE", "MASK", "BLEND"};
+	uint material_count = array_count(gltf->materials);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"materials\": ["));
+	for (uint imat = start; imat < end; ++imat) {
+		gltf_material_t* material = gltf->materials + imat;
+		if (imat > 0)
+			gltf_writer_write(writer, STRING_CONST(","));
+		if (material->source.length && !material->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\n\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(material->source));
+		} else {
+			const gltf_pbr_metallic_roughness_t* metallic_roughness = &material->metallic_roughness;
+			gltf_writer_write(writer, STRING_CONST("\n\t\t{\n"));
 			string_const_t material_name = material->name;
 			if (!material_name.length)
 				material_name = string_const(STRING_CONST("<unnamed>"));
-			stream_write_format(stream, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(material_name));
-			stream_write(stream, STRING_CONST(",\n\t\t\t\"pbrMetallicRoughness\": {"));
-			stream_write_format(stream, STRING_CONST("\n\t\t\t\t\"baseColorFactor\": [%f, %f, %f, %f]"),
-			                    (double)material->metallic_roughness.base_color_factor[0],
-			                    (double)material->metallic_roughness.base_color_factor[1],
-			                    (double)material->metallic_roughness.base_color_factor[2],
-			                    (double)material->metallic_roughness.base_color_factor[3]);
-			stream_write(stream, STRING_CONST("\n\t\t\t}"));
-			stream_write(stream, STRING_CONST("\n\t\t}"));
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(material_name));
+			gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"pbrMetallicRoughness\": {"));
+			gltf_writer_format(writer, STRING_CONST("\n\t\t\t\t\"baseColorFactor\": [%f, %f, %f, %f]"),
+			                   (double)metallic_roughness->base_color_factor[0],
+			                   (double)metallic_roughness->base_color_factor[1],
+			                   (double)metallic_roughness->base_color_factor[2],
+			                   (double)metallic_roughness->base_color_factor[3]);
+			gltf_write_texture_info(writer, STRING_CONST("baseColorTexture"), &metallic_roughness->base_color_texture,
+			                        STRING_CONST("\t\t\t\t"), 0, 0, 0);
+			if (metallic_roughness->metallic_factor != 1) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\t\"metallicFactor\": "));
+				gltf_writer_float(writer, (float)metallic_roughness->metallic_factor);
+			}
+			if (metallic_roughness->roughness_factor != 1) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\t\"roughnessFactor\": "));
+				gltf_writer_float(writer, (float)metallic_roughness->roughness_factor);
+			}
+			gltf_write_texture_info(writer, STRING_CONST("metallicRoughnessTexture"),
+			                        &metallic_roughness->metallic_roughness_texture, STRING_CONST("\t\t\t\t"), 0, 0, 0);
+			if (metallic_roughness->extensions.length) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\t\"extensions\": "));
+				gltf_writer_json(writer, STRING_ARGS(metallic_roughness->extensions));
+			}
+			if (metallic_roughness->extras.length)
+				gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\t\"extras\": \"%.*s\""),
+				                   STRING_FORMAT(metallic_roughness->extras));
+			gltf_writer_write(writer, STRING_CONST("\n\t\t\t}"));
+			gltf_write_texture_info(writer, STRING_CONST("normalTexture"), &material->normal_texture,
+			                        STRING_CONST("\t\t\t"), STRING_CONST("scale"), material->normal_scale);
+			gltf_write_texture_info(writer, STRING_CONST("occlusionTexture"), &material->occlusion_texture,
+			                        STRING_CONST("\t\t\t"), STRING_CONST("strength"), material->occlusion_strength);
+			gltf_write_texture_info(writer, STRING_CONST("emissiveTexture"), &material->emissive_texture,
+			                        STRING_CONST("\t\t\t"), 0, 0, 0);
+			if ((material->emissive_factor[0] != 0) || (material->emissive_factor[1] != 0) ||
+			    (material->emissive_factor[2] != 0))
+				gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\"emissiveFactor\": [%f, %f, %f]"),
+				                   (double)material->emissive_factor[0], (double)material->emissive_factor[1],
+				                   (double)material->emissive_factor[2]);
+			if (material->alpha_mode != GLTF_ALPHA_MODE_OPAQUE)
+				gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\"alphaMode\": \"%s\""),
+				                   alpha_mode_names[material->alpha_mode]);
+			if ((material->alpha_mode == GLTF_ALPHA_MODE_MASK) && (material->alpha_cutoff != (real)0.5)) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"alphaCutoff\": "));
+				gltf_writer_float(writer, (float)material->alpha_cutoff);
+			}
+			if (material->double_sided)
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"doubleSided\": true"));
+			if (material->extensions.length) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"extensions\": "));
+				gltf_writer_json(writer, STRING_ARGS(material->extensions));
+			}
+			gltf_write_source_members(gltf, writer, material->source, STRING_CONST("\t\t\t"), member_names,
+			                          sizeof(member_names) / sizeof(member_names[0]), 1);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
 		}
-		stream_write(stream, STRING_CONST("\n\t]"));
 	}
+	if (end == material_count)
+		gltf_writer_write(writer, STRING_CONST("\n\t]"));
+}
 
-	if (array_count(gltf->meshes)) {
-		stream_write(stream, STRING_CONST(",\n\t\"meshes\": [\n"));
-		for (uint imesh = 0, meshes_count = array_count(gltf->meshes); imesh < meshes_count; ++imesh) {
-			gltf_mesh_t* mesh = gltf->meshes + imesh;
-			stream_write(stream, STRING_CONST("\t\t{\n"));
+static void
+gltf_write_meshes(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* const member_names[] = {"name", "primitives", "weights", "extensions"};
+	static const char* const primitive_member_names[] = {"attributes", "targets", "indices",
+	                                                     "material", "mode", "extensions"};
+	static const char* const primitive_extension_names[] = {"KHR_draco_mesh_compression"};
+	uint meshes_count = array_count(gltf->meshes);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"meshes\": [\n"));
+	for (uint imesh = start; imesh < end; ++imesh) {
+		gltf_mesh_t* mesh = gltf->meshes + imesh;
+		if (mesh->source.length && !mesh->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(mesh->source));
+		} else {
+			gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
 			string_const_t mesh_name = mesh->name;
 			if (!mesh_name.length)
 				mesh_name = string_const(STRING_CONST("<unnamed>"));
-			stream_write_format(stream, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(mesh_name));
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(mesh_name));
 			uint primitives_count = array_count(mesh->primitives);
 			if (primitives_count)
-				stream_write(stream, STRING_CONST(",\n\t\t\t\"primitives\": [\n"));
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"primitives\": [\n"));
 			for (uint iprim = 0; iprim < primitives_count; ++iprim) {
 				gltf_primitive_t* primitive = mesh->primitives + iprim;
-				stream_write(stream, STRING_CONST("\t\t\t\t{"));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t\t{"));
 				uint token_count = 0;
 				uint attrib_count = 0;
 				for (uint iattrib = 0; iattrib < GLTF_ATTRIBUTE_COUNT; ++iattrib) {
 					if (primitive->attributes[iattrib] == GLTF_INVALID_INDEX)
 						continue;
 					if (attrib_count == 0) {
-						stream_write(stream, STRING_CONST("\n\t\t\t\t\t\"attributes\": {\n"));
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t\"attributes\": {\n"));
 					} else {
-						stream_write(stream, STRING_CONST(",\n"));
+						gltf_writer_write(writer, STRING_CONST(",\n"));
 					}
 
 					const char* attrib_name = "POSITION";
@@ -631,52 +912,199 @@ gltf_write(const gltf_t* gltf, stream_t* stream) {
 						default:
 							break;
 					}
-					stream_write_format(stream, STRING_CONST("\t\t\t\t\t\t\"%s\": %u"), attrib_name,
-					                    primitive->attributes[iattrib]);
+					gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\t\"%s\": %u"), attrib_name,
+					                   primitive->attributes[iattrib]);
+					++attrib_count;
+				}
+				for (uint iattrib = 0, custom_count = array_count(primitive->attributes_custom);
+				     iattrib < custom_count; ++iattrib) {
+					const gltf_attribute_t* attribute = primitive->attributes_custom + iattrib;
+					if (attribute->accessor == GLTF_INVALID_INDEX)
+						continue;
+					if (attrib_count == 0)
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t\"attributes\": {\n"));
+					else
+						gltf_writer_write(writer, STRING_CONST(",\n"));
+					gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\t\"%.*s\": %u"),
+					                   STRING_FORMAT(attribute->semantic), attribute->accessor);
 					++attrib_count;
 				}
 				if (attrib_count) {
-					stream_write(stream, STRING_CONST("\n\t\t\t\t\t}"));
+					gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t}"));
+					++token_count;
+				}
+				uint target_count = array_count(primitive->targets);
+				if (target_count) {
+					if (token_count)
+						gltf_writer_write(writer, STRING_CONST(","));
+					gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t\"targets\": ["));
+					for (uint itarget = 0; itarget < target_count; ++itarget) {
+						const gltf_morph_target_t* target = primitive->targets + itarget;
+						uint accessors[3] = {target->position, target->normal, target->tangent};
+						const char* semantics[3] = {"POSITION", "NORMAL", "TANGENT"};
+						if (itarget)
+							gltf_writer_write(writer, STRING_CONST(","));
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t\t{"));
+						uint target_attrib_count = 0;
+						for (uint iattrib = 0; iattrib < 3; ++iattrib) {
+							if (accessors[iattrib] == GLTF_INVALID_INDEX)
+								continue;
+							if (target_attrib_count++)
+								gltf_writer_write(writer, STRING_CONST(", "));
+							gltf_writer_format(writer, STRING_CONST("\"%s\": %u"), semantics[iattrib],
+							                   accessors[iattrib]);
+						}
+						gltf_writer_write(writer, STRING_CONST("}"));
+					}
+					gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t]"));
 					++token_count;
 				}
 				if (primitive->indices != GLTF_INVALID_INDEX) {
 					if (token_count)
-						stream_write(stream, STRING_CONST(","));
-					stream_write_format(stream, STRING_CONST("\n\t\t\t\t\t\"indices\": %u"), primitive->indices);
+						gltf_writer_write(writer, STRING_CONST(","));
+					gltf_writer_format(writer, STRING_CONST("\n\t\t\t\t\t\"indices\": %u"), primitive->indices);
+					++token_count;
+				}
+				if (array_count(gltf->materials) && (primitive->material != GLTF_INVALID_INDEX)) {
+					if (token_count)
+						gltf_writer_write(writer, STRING_CONST(","));
+					gltf_writer_format(writer, STRING_CONST("\n\t\t\t\t\t\"material\": %u"), primitive->material);
 					++token_count;
 				}
-				if (array_count(gltf->materials)) {
+				if (primitive->mode != GLTF_TRIANGLES) {
 					if (token_count)
-						stream_write(stream, STRING_CONST(","));
-					stream_write_format(stream, STRING_CONST("\n\t\t\t\t\t\"material\": %u"), primitive->material);
+						gltf_writer_write(writer, STRING_CONST(","));
+					gltf_writer_format(writer, STRING_CONST("\n\t\t\t\t\t\"mode\": %u"), (uint)primitive->mode);
 					++token_count;
 				}
-				stream_write(stream, STRING_CONST("\n\t\t\t\t}"));
+				if (primitive->extensions.length) {
+					// Compressed data is dropped once decoded, as the attributes now reference decoded accessors
+					gltf_writer_t extensions_writer;
+					gltf_writer_initialize(&extensions_writer, nullptr);
+					extensions_writer.minify = writer->minify;
+					uint skip_count = (primitive->draco.buffer_view == GLTF_INVALID_INDEX) ? 1 : 0;
+					if (gltf_write_source_members(gltf, &extensions_writer, primitive->extensions,
+					                              STRING_CONST("\t\t\t\t\t\t"), primitive_extension_names, skip_count,
+					                              0)) {
+						if (token_count)
+							gltf_writer_write(writer, STRING_CONST(","));
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t\"extensions\": {"));
+						gltf_writer_append(writer, &extensions_writer);
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t}"));
+						++token_count;
+					}
+					gltf_writer_finalize(&extensions_writer);
+				}
+				// Extras and any other members are kept from the source text
+				uint primitive_member_count = sizeof(primitive_member_names) / sizeof(primitive_member_names[0]);
+				gltf_write_source_members(gltf, writer, primitive->source, STRING_CONST("\t\t\t\t\t"),
+				                          primitive_member_names, primitive_member_count, token_count);
+				gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t}"));
 				if (iprim < (primitives_count - 1))
-					stream_write(stream, STRING_CONST(","));
-				stream_write(stream, STRING_CONST("\n"));
+					gltf_writer_write(writer, STRING_CONST(","));
+				gltf_writer_write(writer, STRING_CONST("\n"));
 			}
 			if (primitives_count)
-				stream_write(stream, STRING_CONST("\t\t\t]\n"));
-			stream_write(stream, STRING_CONST("\n\t\t}"));
-			if (imesh < (meshes_count - 1))
-				stream_write(stream, STRING_CONST(","));
-			stream_write(stream, STRING_CONST("\n"));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t]"));
+			uint weight_count = array_count(mesh->weights);
+			if (weight_count) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"weights\": ["));
+				for (uint iweight = 0; iweight < weight_count; ++iweight) {
+					if (iweight)
+						gltf_writer_write(writer, STRING_CONST(", "));
+					gltf_writer_float(writer, (float)mesh->weights[iweight]);
+				}
+				gltf_writer_write(writer, STRING_CONST("]"));
+			}
+			if (mesh->extensions.length) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"extensions\": "));
+				gltf_writer_json(writer, STRING_ARGS(mesh->extensions));
+			}
+			gltf_write_source_members(gltf, writer, mesh->source, STRING_CONST("\t\t\t"), member_names,
+			                          sizeof(member_names) / sizeof(member_names[0]), 1);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
 		}
-		stream_write(stream, STRING_CONST("\t]"));
+		if (imesh < (meshes_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
 	}
+	if (end == meshes_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	if (array_count(gltf->nodes)) {
-		stream_write(stream, STRING_CONST(",\n\t\"nodes\": [\n"));
-		for (uint inode = 0, nodes_count = array_count(gltf->nodes); inode < nodes_count; ++inode) {
-			gltf_node_t* node = gltf->nodes + inode;
-			stream_write(stream, STRING_CONST("\t\t{\n"));
+static void
+gltf_write_node_vector(gltf_writer_t* writer, const char* name, size_t length, const real* values, uint count) {
+	gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\"%.*s\": ["), (int)length, name);
+	for (uint icomp = 0; icomp < count; ++icomp) {
+		if (icomp)
+			gltf_writer_write(writer, STRING_CONST(", "));
+		gltf_writer_float(writer, (float)values[icomp]);
+	}
+	gltf_writer_write(writer, STRING_CONST("]"));
+}
+
+static void
+gltf_write_node_instancing(gltf_writer_t* writer, const gltf_instancing_t* instancing) {
+	gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"extensions\": {\n"));
+	gltf_writer_write(writer, STRING_CONST("\t\t\t\t\"EXT_mesh_gpu_instancing\": {\n"));
+	gltf_writer_write(writer, STRING_CONST("\t\t\t\t\t\"attributes\": {"));
+	uint attribute_count = 0;
+	uint accessors[3] = {instancing->translation, instancing->rotation, instancing->scale};
+	const char* semantics[3] = {"TRANSLATION", "ROTATION", "SCALE"};
+	for (uint iattrib = 0; iattrib < 3; ++iattrib) {
+		if (accessors[iattrib] == GLTF_INVALID_INDEX)
+			continue;
+		if (attribute_count++)
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_format(writer, STRING_CONST("\n\t\t\t\t\t\t\"%s\": %u"), semantics[iattrib], accessors[iattrib]);
+	}
+	for (uint iattrib = 0, custom_count = array_count(instancing->attributes_custom); iattrib < custom_count;
+	     ++iattrib) {
+		const gltf_attribute_t* attribute = instancing->attributes_custom + iattrib;
+		if (attribute_count++)
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_format(writer, STRING_CONST("\n\t\t\t\t\t\t\"%.*s\": %u"), STRING_FORMAT(attribute->semantic),
+		                   attribute->accessor);
+	}
+	gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t\t}\n\t\t\t\t}\n\t\t\t}"));
+}
+
+static void
+gltf_write_nodes(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* const member_names[] = {"name", "mesh", "skin", "children", "matrix",
+	                                           "translation", "rotation", "scale", "extensions"};
+	uint nodes_count = array_count(gltf->nodes);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"nodes\": [\n"));
+	for (uint inode = start; inode < end; ++inode) {
+		gltf_node_t* node = gltf->nodes + inode;
+		if (node->source.length && !node->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(node->source));
+		} else {
+			gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
 			string_const_t node_name = node->name;
 			if (!node_name.length)
 				node_name = string_const(STRING_CONST("<unnamed>"));
-			stream_write_format(stream, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(node_name));
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(node_name));
 			if (node->mesh != GLTF_INVALID_INDEX)
-				stream_write_format(stream, STRING_CONST(",\n\t\t\t\"mesh\": %u"), node->mesh);
+				gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\"mesh\": %u"), node->mesh);
+			if (node->skin != GLTF_INVALID_INDEX)
+				gltf_writer_format(writer, STRING_CONST(",\n\t\t\t\"skin\": %u"), node->skin);
+			if (node->children_count) {
+				const uint* children = gltf_node_children(gltf, node);
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"children\": ["));
+				for (uint ichild = 0; ichild < node->children_count; ++ichild) {
+					if (ichild)
+						gltf_writer_write(writer, STRING_CONST(","));
+					if (!(ichild % 8))
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t"));
+					else
+						gltf_writer_write(writer, STRING_CONST(" "));
+					gltf_writer_uint(writer, children[ichild]);
+				}
+				gltf_writer_write(writer, STRING_CONST("\n\t\t\t]"));
+			}
 			bool has_matrix = node->transform.has_matrix;
 			bool identity_matrix = false;
 			if (has_matrix) {
@@ -692,110 +1120,749 @@ gltf_write(const gltf_t* gltf, stream_t* stream) {
 				}
 			}
 			if (has_matrix && !identity_matrix) {
-				stream_write(stream, STRING_CONST(",\n\t\t\t\"matrix\": [\n"));
-				stream_write_format(stream, STRING_CONST("\t\t\t\t%g, %g, %g, %g,\n"),
-				                    (double)node->transform.matrix[0][0], (double)node->transform.matrix[0][1],
-				                    (double)node->transform.matrix[0][2], (double)node->transform.matrix[0][3]);
-				stream_write_format(stream, STRING_CONST("\t\t\t\t%g, %g, %g, %g,\n"),
-				                    (double)node->transform.matrix[1][0], (double)node->transform.matrix[1][1],
-				                    (double)node->transform.matrix[1][2], (double)node->transform.matrix[1][3]);
-				stream_write_format(stream, STRING_CONST("\t\t\t\t%g, %g, %g, %g,\n"),
-				                    (double)node->transform.matrix[2][0], (double)node->transform.matrix[2][1],
-				                    (double)node->transform.matrix[2][2], (double)node->transform.matrix[2][3]);
-				stream_write_format(stream, STRING_CONST("\t\t\t\t%g, %g, %g, %g\n"),
-				                    (double)node->transform.matrix[3][0], (double)node->transform.matrix[3][1],
-				                    (double)node->transform.matrix[3][2], (double)node->transform.matrix[3][3]);
-				stream_write(stream, STRING_CONST("\t\t\t]"));
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"matrix\": [\n"));
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t%g, %g, %g, %g,\n"),
+				                   (double)node->transform.matrix[0][0], (double)node->transform.matrix[0][1],
+				                   (double)node->transform.matrix[0][2], (double)node->transform.matrix[0][3]);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t%g, %g, %g, %g,\n"),
+				                   (double)node->transform.matrix[1][0], (double)node->transform.matrix[1][1],
+				                   (double)node->transform.matrix[1][2], (double)node->transform.matrix[1][3]);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t%g, %g, %g, %g,\n"),
+				                   (double)node->transform.matrix[2][0], (double)node->transform.matrix[2][1],
+				                   (double)node->transform.matrix[2][2], (double)node->transform.matrix[2][3]);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t%g, %g, %g, %g\n"),
+				                   (double)node->transform.matrix[3][0], (double)node->transform.matrix[3][1],
+				                   (double)node->transform.matrix[3][2], (double)node->transform.matrix[3][3]);
+				gltf_writer_write(writer, STRING_CONST("\t\t\t]"));
+			} else if (!has_matrix) {
+				const gltf_transform_t* transform = &node->transform;
+				if ((transform->translation[0] != 0) || (transform->translation[1] != 0) ||
+				    (transform->translation[2] != 0))
+					gltf_write_node_vector(writer, STRING_CONST("translation"), transform->translation, 3);
+				if ((transform->rotation[0] != 0) || (transform->rotation[1] != 0) || (transform->rotation[2] != 0) ||
+				    (transform->rotation[3] != 1))
+					gltf_write_node_vector(writer, STRING_CONST("rotation"), transform->rotation, 4);
+				if ((transform->scale[0] != 1) || (transform->scale[1] != 1) || (transform->scale[2] != 1))
+					gltf_write_node_vector(writer, STRING_CONST("scale"), transform->scale, 3);
 			}
-			stream_write(stream, STRING_CONST("\n\t\t}"));
-			if (inode < (nodes_count - 1))
-				stream_write(stream, STRING_CONST(","));
-			stream_write(stream, STRING_CONST("\n"));
+			if (gltf_node_is_instanced(node)) {
+				gltf_write_node_instancing(writer, &node->instancing);
+			} else if (node->extensions.length) {
+				gltf_writer_write(writer, STRING_CONST(",\n\t\t\t\"extensions\": "));
+				gltf_writer_json(writer, STRING_ARGS(node->extensions));
+			}
+			// Camera, morph weights and extras are kept from the source text
+			gltf_write_source_members(gltf, writer, node->source, STRING_CONST("\t\t\t"), member_names,
+			                          sizeof(member_names) / sizeof(member_names[0]), 1);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
 		}
-		stream_write(stream, STRING_CONST("\t]"));
+		if (inode < (nodes_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
 	}
+	if (end == nodes_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	if (array_count(gltf->scenes)) {
-		stream_write(stream, STRING_CONST(",\n\t\"scenes\": [\n"));
-		for (uint iscene = 0, scenes_count = array_count(gltf->scenes); iscene < scenes_count; ++iscene) {
-			gltf_scene_t* scene = gltf->scenes + iscene;
-			stream_write(stream, STRING_CONST("\t\t{\n"));
+static void
+gltf_write_scenes(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* const member_names[] = {"name", "nodes"};
+	uint scenes_count = array_count(gltf->scenes);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"scenes\": [\n"));
+	for (uint iscene = start; iscene < end; ++iscene) {
+		gltf_scene_t* scene = gltf->scenes + iscene;
+		if (scene->source.length && !scene->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(scene->source));
+		} else {
+			gltf_writer_write(writer, STRING_CONST("\t\t{"));
 			uint token_count = 0;
 			if (scene->name.length) {
-				stream_write_format(stream, STRING_CONST("\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(scene->name));
+				gltf_writer_format(writer, STRING_CONST("\n\t\t\t\"name\": \"%.*s\""), STRING_FORMAT(scene->name));
 				++token_count;
 			}
 			if (array_count(scene->nodes)) {
 				if (token_count)
-					stream_write_format(stream, STRING_CONST(",\n"));
-				stream_write(stream, STRING_CONST("\t\t\t\"nodes\": ["));
+					gltf_writer_write(writer, STRING_CONST(","));
+				gltf_writer_write(writer, STRING_CONST("\n\t\t\t\"nodes\": ["));
 				for (uint inode = 0, nodes_count = array_count(scene->nodes); inode < nodes_count; ++inode) {
 					if (inode)
-						stream_write(stream, STRING_CONST(","));
+						gltf_writer_write(writer, STRING_CONST(","));
 					if (!(inode % 8))
-						stream_write(stream, STRING_CONST("\n\t\t\t\t"));
+						gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t"));
 					else
-						stream_write(stream, STRING_CONST(" "));
-					stream_write_uint32(stream, scene->nodes[inode]);
+						gltf_writer_write(writer, STRING_CONST(" "));
+					gltf_writer_uint(writer, scene->nodes[inode]);
 				}
-				stream_write(stream, STRING_CONST("\n\t\t\t]"));
+				gltf_writer_write(writer, STRING_CONST("\n\t\t\t]"));
 				++token_count;
 			}
-			if (token_count)
-				stream_write(stream, STRING_CONST("\n"));
-			stream_write(stream, STRING_CONST("\t\t}"));
-			if (iscene < (scenes_count - 1))
-				stream_write(stream, STRING_CONST(","));
-			stream_write(stream, STRING_CONST("\n"));
+			gltf_write_source_members(gltf, writer, scene->source, STRING_CONST("\t\t\t"), member_names,
+			                          sizeof(member_names) / sizeof(member_names[0]), token_count);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
 		}
-		stream_write(stream, STRING_CONST("\t]"));
+		if (iscene < (scenes_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
 	}
+	if (end == scenes_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	if (gltf->scene != GLTF_INVALID_INDEX) {
-		stream_write_format(stream, STRING_CONST(",\n\t\"scene\": %u\n"), gltf->scene);
+static void
+gltf_write_animations(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* path_names[] = {"translation", "rotation", "scale", "weights"};
+	static const char* interpolation_names[] = {"LINEAR", "STEP", "CUBICSPLINE"};
+	static const char* const member_names[] = {"name", "channels", "samplers"};
+	uint animations_count = array_count(gltf->animations);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"animations\": [\n"));
+	for (uint ianim = start; ianim < end; ++ianim) {
+		const gltf_animation_t* animation = gltf->animations + ianim;
+		if (animation->source.length && !animation->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(animation->source));
+		} else {
+			gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
+			if (animation->name.length)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"name\": \"%.*s\",\n"), STRING_FORMAT(animation->name));
+			gltf_writer_write(writer, STRING_CONST("\t\t\t\"channels\": [\n"));
+			for (uint ichannel = 0, channel_count = array_count(animation->channels); ichannel < channel_count;
+			     ++ichannel) {
+				const gltf_animation_channel_t* channel = animation->channels + ichannel;
+				string_const_t path = channel->path_name;
+				if (channel->path < GLTF_ANIMATION_PATH_UNKNOWN)
+					path = string_const(path_names[channel->path], string_length(path_names[channel->path]));
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t{\n\t\t\t\t\t\"sampler\": %u,\n"), channel->sampler);
+				gltf_writer_write(writer, STRING_CONST("\t\t\t\t\t\"target\": {\n"));
+				if (channel->node != GLTF_INVALID_INDEX)
+					gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\t\"node\": %u,\n"), channel->node);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\t\"path\": \"%.*s\"\n"), STRING_FORMAT(path));
+				gltf_writer_write(writer, STRING_CONST("\t\t\t\t\t}\n\t\t\t\t}"));
+				if (ichannel < (channel_count - 1))
+					gltf_writer_write(writer, STRING_CONST(","));
+				gltf_writer_write(writer, STRING_CONST("\n"));
+			}
+			gltf_writer_write(writer, STRING_CONST("\t\t\t],\n\t\t\t\"samplers\": [\n"));
+			for (uint isampler = 0, sampler_count = array_count(animation->samplers); isampler < sampler_count;
+			     ++isampler) {
+				const gltf_animation_sampler_t* sampler = animation->samplers + isampler;
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t{\n\t\t\t\t\t\"input\": %u,\n"), sampler->input);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"interpolation\": \"%s\",\n"),
+				                   interpolation_names[sampler->interpolation]);
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\t\t\"output\": %u\n\t\t\t\t}"), sampler->output);
+				if (isampler < (sampler_count - 1))
+					gltf_writer_write(writer, STRING_CONST(","));
+				gltf_writer_write(writer, STRING_CONST("\n"));
+			}
+			gltf_writer_write(writer, STRING_CONST("\t\t\t]"));
+			gltf_write_source_members(gltf, writer, animation->source, STRING_CONST("\t\t\t"), member_names,
+			                          sizeof(member_names) / sizeof(member_names[0]), 1);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
+		}
+		if (ianim < (animations_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
 	}
+	if (end == animations_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	stream_write(stream, STRING_CONST("\n}\n"));
+static void
+gltf_write_skins(const gltf_t* gltf, gltf_writer_t* writer, uint start, uint end) {
+	static const char* const member_names[] = {"name", "inverseBindMatrices", "skeleton", "joints"};
+	uint skins_count = array_count(gltf->skins);
+	if (!start)
+		gltf_writer_write(writer, STRING_CONST(",\n\t\"skins\": [\n"));
+	for (uint iskin = start; iskin < end; ++iskin) {
+		const gltf_skin_t* skin = gltf->skins + iskin;
+		if (skin->source.length && !skin->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(skin->source));
+		} else {
+			gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
+			if (skin->name.length)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"name\": \"%.*s\",\n"), STRING_FORMAT(skin->name));
+			if (skin->inverse_bind_matrices != GLTF_INVALID_INDEX)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"inverseBindMatrices\": %u,\n"),
+				                   skin->inverse_bind_matrices);
+			if (skin->skeleton != GLTF_INVALID_INDEX)
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"skeleton\": %u,\n"), skin->skeleton);
+			gltf_writer_write(writer, STRING_CONST("\t\t\t\"joints\": ["));
+			for (uint ijoint = 0, joint_count = array_count(skin->joints); ijoint < joint_count; ++ijoint) {
+				if (ijoint)
+					gltf_writer_write(writer, STRING_CONST(","));
+				if (!(ijoint % 8))
+					gltf_writer_write(writer, STRING_CONST("\n\t\t\t\t"));
+				else
+					gltf_writer_write(writer, STRING_CONST(" "));
+				gltf_writer_uint(writer, skin->joints[ijoint]);
+			}
+			gltf_writer_write(writer, STRING_CONST("\n\t\t\t]"));
+			gltf_write_source_members(gltf, writer, skin->source, STRING_CONST("\t\t\t"), member_names,
+			                          sizeof(member_names) / sizeof(member_names[0]), 1);
+			gltf_writer_write(writer, STRING_CONST("\n\t\t}"));
+		}
+		if (iskin < (skins_count - 1))
+			gltf_writer_write(writer, STRING_CONST(","));
+		gltf_writer_write(writer, STRING_CONST("\n"));
+	}
+	if (end == skins_count)
+		gltf_writer_write(writer, STRING_CONST("\t]"));
+}
 
-	if ((gltf->file_type == GLTF_FILE_GLB) || (gltf->file_type == GLTF_FILE_GLB_EMBED)) {
-		stream_set_binary(stream, true);
+//! Independently serializable JSON sections, in document order
+typedef enum gltf_write_section_id {
+	GLTF_WRITE_BUFFER_VIEWS = 0,
+	GLTF_WRITE_ACCESSORS,
+	GLTF_WRITE_MATERIALS,
+	GLTF_WRITE_MESHES,
+	GLTF_WRITE_NODES,
+	GLTF_WRITE_SCENES,
+	GLTF_WRITE_ANIMATIONS,
+	GLTF_WRITE_SKINS,
+	GLTF_WRITE_SECTION_COUNT
+} gltf_write_section_id;
+
+//! Range of elements in a section serialized into a separate writer
+typedef struct gltf_write_job_t {
+	//! Source data
+	const gltf_t* gltf;
+	//! Meshopt views, null if not compressed
+	const gltf_meshopt_view_t* meshopt_views;
+	//! Section
+	gltf_write_section_id section;
+	//! First element
+	uint start;
+	//! One past last element
+	uint end;
+	//! Writer retaining the output in memory
+	gltf_writer_t writer;
+} gltf_write_job_t;
+
+//! Set of jobs processed by a single thread
+typedef struct gltf_write_worker_t {
+	//! Jobs
+	gltf_write_job_t* jobs;
+	//! First job index
+	uint first;
+	//! Job index stride
+	uint stride;
+	//! Thread
+	thread_t thread;
+} gltf_write_worker_t;
+
+static uint
+gltf_write_section_count(const gltf_t* gltf, gltf_write_section_id section) {
+	switch (section) {
+		case GLTF_WRITE_BUFFER_VIEWS:
+			return array_count(gltf->buffer_views);
+		case GLTF_WRITE_ACCESSORS:
+			return array_count(gltf->accessors);
+		case GLTF_WRITE_MATERIALS:
+			return array_count(gltf->materials);
+		case GLTF_WRITE_MESHES:
+			return array_count(gltf->meshes);
+		case GLTF_WRITE_NODES:
+			return array_count(gltf->nodes);
+		case GLTF_WRITE_SCENES:
+			return array_count(gltf->scenes);
+		case GLTF_WRITE_ANIMATIONS:
+			return array_count(gltf->animations);
+		case GLTF_WRITE_SKINS:
+			return array_count(gltf->skins);
+		case GLTF_WRITE_SECTION_COUNT:
+		default:
+			break;
+	}
+	return 0;
+}
 
-		size_t current_offset = stream_tell(stream);
-		size_t json_chunk_length = current_offset - json_start_offset;
+static void
+gltf_write_section(const gltf_t* gltf, gltf_writer_t* writer, const gltf_meshopt_view_t* meshopt_views,
+                   gltf_write_section_id section, uint start, uint end) {
+	switch (section) {
+		case GLTF_WRITE_BUFFER_VIEWS:
+			gltf_write_buffer_views(gltf, writer, meshopt_views, start, end);
+			break;
+		case GLTF_WRITE_ACCESSORS:
+			gltf_write_accessors(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_MATERIALS:
+			gltf_write_materials(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_MESHES:
+			gltf_write_meshes(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_NODES:
+			gltf_write_nodes(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_SCENES:
+			gltf_write_scenes(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_ANIMATIONS:
+			gltf_write_animations(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_SKINS:
+			gltf_write_skins(gltf, writer, start, end);
+			break;
+		case GLTF_WRITE_SECTION_COUNT:
+		default:
+			break;
+	}
+}
 
-		if (json_chunk_length % 4) {
-			uint padding = 4 - (json_chunk_length % 4);
-			stream_write(stream, "    ", padding);
-			json_chunk_length += padding;
+static void*
+gltf_write_worker(void* arg) {
+	gltf_write_worker_t* worker = arg;
+	for (uint ijob = worker->first, job_count = array_count(worker->jobs); ijob < job_count; ijob += worker->stride) {
+		gltf_write_job_t* job = worker->jobs + ijob;
+		gltf_write_section(job->gltf, &job->writer, job->meshopt_views, job->section, job->start, job->end);
+	}
+	return nullptr;
+}
+
+/*! Write the array sections of the JSON document. Large documents are split in chunks which are
+serialized in parallel into separate writers and then appended in order, producing output identical
+to serial writing
+\param gltf Source data
+\param writer Destination writer
+\param meshopt_views Meshopt views, null if not compressed */
+static void
+gltf_write_sections(const gltf_t* gltf, gltf_writer_t* writer, const gltf_meshopt_view_t* meshopt_views) {
+	uint total_count = 0;
+	for (uint isection = 0; isection < GLTF_WRITE_SECTION_COUNT; ++isection)
+		total_count += gltf_write_section_count(gltf, (gltf_write_section_id)isection);
+
+	uint thread_count = (gltf->flags & GLTF_FLAG_WRITE_SINGLE_THREAD) ? 1 : (uint)system_hardware_threads();
+	if (thread_count > GLTF_WRITE_MAX_THREADS)
+		thread_count = GLTF_WRITE_MAX_THREADS;
+	if ((total_count < GLTF_WRITE_PARALLEL_THRESHOLD) || (thread_count < 2)) {
+		for (uint isection = 0; isection < GLTF_WRITE_SECTION_COUNT; ++isection) {
+			gltf_write_section_id section = (gltf_write_section_id)isection;
+			uint count = gltf_write_section_count(gltf, section);
+			if (count)
+				gltf_write_section(gltf, writer, meshopt_views, section, 0, count);
 		}
+		return;
+	}
 
-		if ((gltf->file_type == GLTF_FILE_GLB_EMBED) && gltf->output_buffer && gltf->output_buffer->count) {
-			uint chunk_size = (uint)gltf->output_buffer->count;
-			uint padding = 0;
-			if (chunk_size % 4)
-				padding = 4 - (chunk_size % 4);
-			chunk_size += padding;
+	gltf_write_job_t* jobs = nullptr;
+	for (uint isection = 0; isection < GLTF_WRITE_SECTION_COUNT; ++isection) {
+		gltf_write_section_id section = (gltf_write_section_id)isection;
+		uint count = gltf_write_section_count(gltf, section);
+		for (uint start = 0; start < count; start += GLTF_WRITE_CHUNK_SIZE) {
+			gltf_write_job_t job;
+			job.gltf = gltf;
+			job.meshopt_views = meshopt_views;
+			job.section = section;
+			job.start = start;
+			job.end = ((count - start) > GLTF_WRITE_CHUNK_SIZE) ? (start + GLTF_WRITE_CHUNK_SIZE) : count;
+			array_push(jobs, job);
+		}
+	}
 
-			// Write binary chunk header (size, type)
-			stream_write_uint32(stream, chunk_size);
-			stream_write_uint32(stream, 0x004E4942);
+	uint job_count = array_count(jobs);
+	for (uint ijob = 0; ijob < job_count; ++ijob) {
+		gltf_writer_initialize(&jobs[ijob].writer, nullptr);
+		jobs[ijob].writer.minify = writer->minify;
+	}
 
-			// Write binary chunk payload
-			stream_write(stream, gltf->output_buffer->storage, gltf->output_buffer->count);
+	if (thread_count > job_count)
+		thread_count = job_count;
 
-			if (padding)
-				stream_write(stream, "\0\0\0\0", padding);
+	// Jobs are interleaved across workers to balance the uneven cost of sections, the calling
+	// thread processes the first set of jobs
+	gltf_write_worker_t workers[GLTF_WRITE_MAX_THREADS];
+	for (uint iworker = 0; iworker < thread_count; ++iworker) {
+		workers[iworker].jobs = jobs;
+		workers[iworker].first = iworker;
+		workers[iworker].stride = thread_count;
+	}
+	for (uint iworker = 1; iworker < thread_count; ++iworker) {
+		thread_initialize(&workers[iworker].thread, gltf_write_worker, workers + iworker, STRING_CONST("gltf_write"),
+		                  THREAD_PRIORITY_NORMAL, 0);
+		thread_start(&workers[iworker].thread);
+	}
+	gltf_write_worker(workers);
+	for (uint iworker = 1; iworker < thread_count; ++iworker) {
+		thread_join(&workers[iworker].thread);
+		thread_finalize(&workers[iworker].thread);
+	}
+
+	for (uint ijob = 0; ijob < job_count; ++ijob) {
+		gltf_writer_append(writer, &jobs[ijob].writer);
+		gltf_writer_finalize(&jobs[ijob].writer);
+	}
+	array_deallocate(jobs);
+}
+
+/*! Write the list of used or required extensions, merging the extensions of the source data
+\param writer Writer
+\param name Name of list
+\param length Length of name
+\param meshopt Include EXT_meshopt_compression
+\param draco Include KHR_draco_mesh_compression if present in source list
+\param instancing Include EXT_mesh_gpu_instancing
+\param source Source extensions
+\param source_count Number of source extensions */
+static void
+gltf_write_extensions(gltf_writer_t* writer, const char* name, size_t length, bool meshopt, bool draco,
+                      bool instancing, const string_const_t* source, uint source_count) {
+	uint count = 0;
+	if (meshopt) {
+		gltf_writer_format(writer, STRING_CONST(",\n\t\"%.*s\": [\n"), (int)length, name);
+		gltf_writer_write(writer, STRING_CONST("\t\t\"EXT_meshopt_compression\""));
+		++count;
+	}
+	for (uint iext = 0; iext < source_count; ++iext) {
+		if (meshopt && string_equal(STRING_ARGS(source[iext]), STRING_CONST("EXT_meshopt_compression")))
+			continue;
+		if (!draco && string_equal(STRING_ARGS(source[iext]), STRING_CONST("KHR_draco_mesh_compression")))
+			continue;
+		if (count)
+			gltf_writer_write(writer, STRING_CONST(",\n"));
+		else
+			gltf_writer_format(writer, STRING_CONST(",\n\t\"%.*s\": [\n"), (int)length, name);
+		gltf_writer_format(writer, STRING_CONST("\t\t\"%.*s\""), STRING_FORMAT(source[iext]));
+		++count;
+		if (string_equal(STRING_ARGS(source[iext]), STRING_CONST("EXT_mesh_gpu_instancing")))
+			instancing = false;
+	}
+	if (instancing) {
+		if (count)
+			gltf_writer_write(writer, STRING_CONST(",\n"));
+		else
+			gltf_writer_format(writer, STRING_CONST(",\n\t\"%.*s\": [\n"), (int)length, name);
+		gltf_writer_write(writer, STRING_CONST("\t\t\"EXT_mesh_gpu_instancing\""));
+		++count;
+	}
+	if (count)
+		gltf_writer_write(writer, STRING_CONST("\n\t]"));
+}
+
+//! Open a stream reading the data of a buffer without uri, either held in memory like decoded Draco
+//! data or stored in the binary chunk of a source GLB file
+static stream_t*
+gltf_write_source_buffer_stream(const gltf_t* gltf, uint ibuffer) {
+	const gltf_buffer_t* buffer = gltf->buffers + ibuffer;
+	if (buffer->data)
+		return buffer_stream_allocate(buffer->data, STREAM_IN | STREAM_BINARY, buffer->byte_length,
+		                              buffer->byte_length, false, false);
+	if (!ibuffer)
+		return gltf_stream_open(gltf, nullptr, 0, STREAM_IN | STREAM_BINARY);
+	return nullptr;
+}
+
+/*! Write the entries of the buffers array, preceding the output buffers in the written buffer list.
+Buffers without uri have their data written to the GLB binary chunk if buffer 0 of a GLB file, as
+a data URI if embedding or otherwise to a buffer file numbered by buffer index.
+\param gltf glTF data structure
+\param writer Writer
+\param base_uri Output path without extension
+\param glb Writing a GLB file
+\return true if success, false if buffer data could not be written */
+static bool
+gltf_write_source_buffers(const gltf_t* gltf, gltf_writer_t* writer, string_const_t base_uri, bool glb) {
+	bool success = true;
+	for (uint ibuffer = 0, buffer_count = array_count(gltf->buffers); success && (ibuffer < buffer_count);
+	     ++ibuffer) {
+		const gltf_buffer_t* buffer = gltf->buffers + ibuffer;
+		if (ibuffer)
+			gltf_writer_write(writer, STRING_CONST(",\n"));
+		if (buffer->uri.length && buffer->source.length && !buffer->dirty) {
+			gltf_writer_write(writer, STRING_CONST("\t\t"));
+			gltf_writer_json(writer, STRING_ARGS(buffer->source));
+			continue;
 		}
 
-		size_t file_size = stream_tell(stream);
+		gltf_writer_write(writer, STRING_CONST("\t\t{\n"));
+		if (buffer->name.length)
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"name\": \"%.*s\",\n"), STRING_FORMAT(buffer->name));
+		if (buffer->extensions.length) {
+			gltf_writer_write(writer, STRING_CONST("\t\t\t\"extensions\": "));
+			gltf_writer_json(writer, STRING_ARGS(buffer->extensions));
+			gltf_writer_write(writer, STRING_CONST(",\n"));
+		}
+		if (buffer->uri.length) {
+			gltf_writer_format(writer, STRING_CONST("\t\t\t\"uri\": \"%.*s\",\n"), STRING_FORMAT(buffer->uri));
+		} else if (!glb || ibuffer) {
+			stream_t* source = gltf_write_source_buffer_stream(gltf, ibuffer);
+			if (!source) {
+				log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Buffer %u has no data to write"), ibuffer);
+				success = false;
+			} else if (gltf->file_type == GLTF_FILE_GLTF_EMBED) {
+				gltf_writer_write(writer, STRING_CONST("\t\t\t\"uri\": \"data:application/octet-stream;base64,"));
+				success = gltf_write_stream_copy(nullptr, writer, source, buffer->byte_length);
+				gltf_writer_write(writer, STRING_CONST("\",\n"));
+			} else {
+				char path_buffer[BUILD_MAX_PATHLEN];
+				string_t buffer_uri;
+				if (ibuffer)
+					buffer_uri = string_format(path_buffer, sizeof(path_buffer), STRING_CONST("%.*s.%u.bin"),
+					                           STRING_FORMAT(base_uri), ibuffer);
+				else
+					buffer_uri = string_format(path_buffer, sizeof(path_buffer), STRING_CONST("%.*s.bin"),
+					                           STRING_FORMAT(base_uri));
+				stream_t* buffer_stream =
+				    stream_open(STRING_ARGS(buffer_uri), STREAM_OUT | STREAM_BINARY | STREAM_CREATE | STREAM_TRUNCATE);
+				if (buffer_stream) {
+					success = gltf_write_stream_copy(buffer_stream, nullptr, source, buffer->byte_length);
+					stream_deallocate(buffer_stream);
+				} else {
+					log_errorf(HASH_GLTF, ERROR_SYSTEM_CALL_FAIL,
+					           STRING_CONST("Failed to open binary buffer stream: %.*s"), STRING_FORMAT(buffer_uri));
+					success = false;
+				}
+				string_const_t buffer_relative_uri = path_file_name(STRING_ARGS(buffer_uri));
+				gltf_writer_format(writer, STRING_CONST("\t\t\t\"uri\": \"%.*s\",\n"),
+				                   STRING_FORMAT(buffer_relative_uri));
+			}
+			stream_deallocate(source);
+		}
+		gltf_writer_format(writer, STRING_CONST("\t\t\t\"byteLength\": %u\n"), buffer->byte_length);
+		gltf_writer_write(writer, STRING_CONST("\t\t}"));
+	}
+	return success;
+}
+
+bool
+gltf_write(const gltf_t* gltf, stream_t* stream) {
+	stream_set_byteorder(stream, BYTEORDER_LITTLEENDIAN);
 
-		// Now fill in sizes
-		stream_seek(stream, (ssize_t)json_size_offset, STREAM_SEEK_BEGIN);
-		stream_write_uint32(stream, (uint)json_chunk_length);
+	// GLB JSON is retained in memory so all chunk sizes are known before writing, making the
+	// output strictly sequential and usable with non-seekable streams
+	bool glb = (gltf->file_type == GLTF_FILE_GLB) || (gltf->file_type == GLTF_FILE_GLB_EMBED);
+	stream_set_binary(stream, false);
 
-		stream_seek(stream, (ssize_t)file_size_offset, STREAM_SEEK_BEGIN);
-		stream_write_uint32(stream, (uint)file_size);
+	gltf_writer_t writer;
+	gltf_writer_initialize(&writer, glb ? nullptr : stream);
+	writer.minify = !(gltf->flags & GLTF_FLAG_JSON_PRETTY) && (glb || (gltf->flags & GLTF_FLAG_JSON_MINIFY));
+
+	gltf_writer_write(&writer, STRING_CONST("{\n"));
+	gltf_writer_write(&writer, STRING_CONST("\t\"asset\": {\n"));
+	gltf_writer_write(&writer, STRING_CONST("\t\t\"generator\": \"gltf_lib\",\n"));
+	gltf_writer_write(&writer, STRING_CONST("\t\t\"version\": \"2.0\"\n"));
+	gltf_writer_write(&writer, STRING_CONST("\t}"));
+
+	// In streaming export mode the output buffers already reside in the buffer files
+	const void* binary_data = nullptr;
+	size_t binary_size = 0;
+	bool streaming = (array_count(gltf->output_streams) > 0);
+	uint output_count = array_count(gltf->output_sizes);
+	if (output_count) {
+		binary_data = streaming ? nullptr : gltf->output_buffers[0]->storage;
+		binary_size = gltf->output_sizes[0];
 	}
 
-	return true;
+	// With meshopt compression the first buffers hold the compressed views of each output buffer and
+	// the following buffers are the uncompressed fallback output buffers referenced by the buffer views
+	bool success = true;
+	gltf_meshopt_view_t* meshopt_views = nullptr;
+	void* meshopt_buffer = nullptr;
+	size_t* meshopt_sizes = nullptr;
+	bool meshopt = (gltf->flags & GLTF_FLAG_MESHOPT_COMPRESSION) && binary_size;
+	if (meshopt && streaming) {
+		log_warn(HASH_GLTF, WARNING_UNSUPPORTED,
+		         STRING_CONST("Meshopt compression not supported in streaming export, writing uncompressed"));
+		meshopt = false;
+	}
+	bool meshopt_fallback = !(gltf->flags & GLTF_FLAG_MESHOPT_COMPRESSION_ONLY);
+	if (meshopt) {
+		if (!gltf_meshopt_compress(gltf, &meshopt_views, &meshopt_buffer, &meshopt_sizes)) {
+			success = false;
+			goto exit;
+		}
+		binary_data = meshopt_buffer;
+		binary_size = meshopt_sizes[0];
+	}
+
+	// Draco compressed primitives are decoded when reading, the extension is only retained by
+	// primitives which could not be decoded
+	bool draco = false;
+	for (uint imesh = 0, meshes_count = array_count(gltf->meshes); !draco && (imesh < meshes_count); ++imesh) {
+		const gltf_mesh_t* mesh = gltf->meshes + imesh;
+		for (uint iprim = 0, primitives_count = array_count(mesh->primitives); iprim < primitives_count; ++iprim) {
+			if (mesh->primitives[iprim].draco.buffer_view != GLTF_INVALID_INDEX)
+				draco = true;
+		}
+	}
+	// Instanced nodes still reference their mesh, so loaders without instancing support have a
+	// single instance fallback and the extension is not required
+	bool instancing = false;
+	for (uint inode = 0, nodes_count = array_count(gltf->nodes); !instancing && (inode < nodes_count); ++inode)
+		instancing = gltf_node_is_instanced(gltf->nodes + inode);
+	gltf_write_extensions(&writer, STRING_CONST("extensionsUsed"), meshopt, draco, instancing, gltf->extensions_used,
+	                      gltf->extensions_used_count);
+	gltf_write_extensions(&writer, STRING_CONST("extensionsRequired"), meshopt && !meshopt_fallback, draco, false,
+	                      gltf->extensions_required, gltf->extensions_required_count);
+
+	// Source buffers keep their indices, output buffers are appended and their views offset to match.
+	// The GLB binary chunk can only hold buffer 0, which is an output buffer if there are no source
+	// buffers, or otherwise a source buffer without uri.
+	uint source_buffer_count = array_count(gltf->buffers);
+	bool output_binary_chunk = (gltf->file_type == GLTF_FILE_GLB_EMBED) && !source_buffer_count;
+	bool source_binary_chunk = glb && source_buffer_count && !gltf->buffers[0].uri.length;
+	string_const_t base_uri = stream_path(stream);
+	base_uri = path_base_file_name_with_directory(STRING_ARGS(base_uri));
+	if (source_buffer_count || binary_size) {
+		gltf_writer_write(&writer, STRING_CONST(",\n\t\"buffers\": [\n"));
+		if (!gltf_write_source_buffers(gltf, &writer, base_uri, glb)) {
+			success = false;
+			goto exit;
+		}
+	}
+
+	if (binary_size) {
+		uint buffer_count = output_count * (meshopt ? 2 : 1);
+		const void* compressed_data = meshopt_buffer;
+		for (uint ibuffer = 0; success && (ibuffer < buffer_count); ++ibuffer) {
+			// Output buffer and stream index. Compressed buffers take the file name of their output buffer
+			bool fallback = meshopt && (ibuffer >= output_count);
+			uint ioutput = fallback ? (ibuffer - output_count) : ibuffer;
+			const void* data;
+			size_t size;
+			if (meshopt && !fallback) {
+				data = compressed_data;
+				size = meshopt_sizes[ioutput];
+				compressed_data = pointer_offset_const(compressed_data, size);
+			} else {
+				data = streaming ? nullptr : gltf->output_buffers[ioutput]->storage;
+				size = gltf->output_sizes[ioutput];
+			}
+
+			// Files following source buffers are numbered by written buffer index
+			uint ifile = source_buffer_count + ioutput;
+
+			if (source_buffer_count || ibuffer)
+				gltf_writer_write(&writer, STRING_CONST(",\n"));
+			gltf_writer_write(&writer, STRING_CONST("\t\t{\n"));
+			if ((ibuffer == 0) && output_binary_chunk) {
+				// Leave the buffer URI undefined as per GLB spec, only one binary chunk allowed
+			} else if (fallback && !meshopt_fallback) {
+				gltf_writer_write(&writer, STRING_CONST("\t\t\t\"extensions\": {\n"));
+				gltf_writer_write(&writer, STRING_CONST("\t\t\t\t\"EXT_meshopt_compression\": {\n"));
+				gltf_writer_write(&writer, STRING_CONST("\t\t\t\t\t\"fallback\": true\n"));
+				gltf_writer_write(&writer, STRING_CONST("\t\t\t\t}\n\t\t\t},\n"));
+			} else if (gltf->file_type == GLTF_FILE_GLTF_EMBED) {
+				gltf_writer_write(&writer, STRING_CONST("\t\t\t\"uri\": \"data:application/octet-stream;base64,"));
+				if (data)
+					gltf_writer_base64(&writer, data, size);
+				else
+					success = gltf_write_stream_copy(nullptr, &writer, gltf->output_streams[ioutput], size);
+				gltf_writer_write(&writer, STRING_CONST("\",\n"));
+			} else if (streaming) {
+				stream_t* buffer_stream = gltf->output_streams[ioutput];
+				stream_flush(buffer_stream);
+				string_const_t buffer_path = stream_path(buffer_stream);
+				string_const_t buffer_relative_uri = path_file_name(STRING_ARGS(buffer_path));
+				gltf_writer_format(&writer, STRING_CONST("\t\t\t\"uri\": \"%.*s\",\n"),
+				                   STRING_FORMAT(buffer_relative_uri));
+			} else {
+				// Additional buffers are stored in separate numbered files
+				char path_buffer[BUILD_MAX_PATHLEN];
+				string_t buffer_uri;
+				if (ifile)
+					buffer_uri = string_format(path_buffer, sizeof(path_buffer), STRING_CONST("%.*s%s.%u.bin"),
+					                           STRING_FORMAT(base_uri), fallback ? ".fallback" : "", ifile);
+				else
+					buffer_uri = string_format(path_buffer, sizeof(path_buffer), STRING_CONST("%.*s%s.bin"),
+					                           STRING_FORMAT(base_uri), fallback ? ".fallback" : "");
+				string_const_t buffer_relative_uri = path_file_name(STRING_ARGS(buffer_uri));
+				gltf_writer_format(&writer, STRING_CONST("\t\t\t\"uri\": \"%.*s\",\n"),
+				                   STRING_FORMAT(buffer_relative_uri));
+				success = gltf_write_buffer_file(STRING_ARGS(buffer_uri), data, size);
+			}
+			gltf_writer_format(&writer, STRING_CONST("\t\t\t\"byteLength\": %" PRIsize "\n"), size);
+			gltf_writer_write(&writer, STRING_CONST("\t\t}"));
+		}
+		if (!success)
+			goto exit;
+	}
+	if (source_buffer_count || binary_size)
+		gltf_writer_write(&writer, STRING_CONST("\n\t]"));
+
+	gltf_write_sections(gltf, &writer, meshopt ? meshopt_views : nullptr);
+
+	for (uint imember = 0, member_count = array_count(gltf->source_members); imember < member_count; ++imember) {
+		gltf_writer_write(&writer, STRING_CONST(",\n\t"));
+		gltf_writer_json(&writer, STRING_ARGS(gltf->source_members[imember]));
+	}
+
+	if (gltf->scene != GLTF_INVALID_INDEX) {
+		gltf_writer_format(&writer, STRING_CONST(",\n\t\"scene\": %u\n"), gltf->scene);
+	}
+
+	gltf_writer_write(&writer, STRING_CONST("\n}\n"));
+	if (glb) {
+		size_t json_length = writer.size;
+		uint json_padding = (json_length % 4) ? (uint)(4 - (json_length % 4)) : 0;
+		size_t json_chunk_length = json_length + json_padding;
+
+		size_t chunk_size = 0;
+		if (output_binary_chunk)
+			chunk_size = binary_size;
+		else if (source_binary_chunk)
+			chunk_size = gltf->buffers[0].byte_length;
+		bool binary_chunk = (chunk_size > 0);
+		uint binary_padding = (chunk_size % 4) ? (uint)(4 - (chunk_size % 4)) : 0;
+		size_t binary_chunk_length = binary_chunk ? (chunk_size + binary_padding) : 0;
+
+		size_t file_size = sizeof(gltf_glb_header_t) + 8 + json_chunk_length;
+		if (binary_chunk)
+			file_size += 8 + binary_chunk_length;
+		if (file_size > 0xFFFFFFFFULL) {
+			log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("GLB file size exceeds 4GiB"));
+			success = false;
+			goto exit;
+		}
+
+		stream_set_binary(stream, true);
+
+		gltf_glb_header_t glb_header;
+		glb_header.magic = 0x46546C67;
+		glb_header.version = 2;
+		glb_header.length = (uint32_t)file_size;
+		stream_write(stream, &glb_header, sizeof(glb_header));
+
+		// JSON chunk header (size, type) and payload
+		stream_write_uint32(stream, (uint32_t)json_chunk_length);
+		stream_write_uint32(stream, 0x4E4F534A);
+		stream_write(stream, writer.block, json_length);
+		if (json_padding)
+			stream_write(stream, "    ", json_padding);
+
+		if (binary_chunk) {
+			// Binary chunk header (size, type) and payload
+			stream_write_uint32(stream, (uint32_t)binary_chunk_length);
+			stream_write_uint32(stream, 0x004E4942);
+
+			if (source_binary_chunk) {
+				stream_t* source = gltf_write_source_buffer_stream(gltf, 0);
+				if (source)
+					success = gltf_write_stream_copy(stream, nullptr, source, chunk_size);
+				else
+					success = false;
+				stream_deallocate(source);
+			} else if (binary_data) {
+				stream_write(stream, binary_data, binary_size);
+			} else {
+				success = gltf_write_stream_copy(stream, nullptr, gltf->output_streams[0], binary_size);
+			}
+
+			if (binary_padding)
+				stream_write(stream, "\0\0\0\0", binary_padding);
+		}
+	} else {
+		gltf_writer_flush(&writer);
+	}
+
+exit:
+	gltf_writer_finalize(&writer);
+	memory_deallocate(meshopt_buffer);
+	array_deallocate(meshopt_views);
+	array_deallocate(meshopt_sizes);
+
+	return success;
 }
@@ -20,6 +20,9 @@
 #include <gltf/types.h>
 #include <gltf/hashstrings.h>
 #include <gltf/accessor.h>
+#include <gltf/animation.h>
+#include <gltf/skin.h>
+#include <gltf/skinning.h>
 #include <gltf/buffer.h>
 #include <gltf/extension.h>
 #include <gltf/node.h>
@@ -27,6 +30,15 @@
 #include <gltf/stream.h>
 #include <gltf/material.h>
 #include <gltf/mesh.h>
+#include <gltf/meshopt.h>
+#include <gltf/morph.h>
+#include <gltf/query.h>
+#include <gltf/draco.h>
+#include <gltf/hierarchy.h>
+#include <gltf/bounds.h>
+#include <gltf/bvh.h>
+#include <gltf/triangle.h>
+#include <gltf/writer.h>
 #include <gltf/image.h>
 #include <gltf/texture.h>
 
@@ -75,7 +87,8 @@ gltf_finalize(gltf_t* gltf);
 GLTF_API bool
 gltf_read(gltf_t* gltf, stream_t* stream);
 
-/*! Write glTF or glb data
+/*! Write glTF or glb data. Objects read from a file which are not marked dirty are copied
+verbatim from the source JSON text, as are top level members not handled by the writer
 \param gltf Source glTF data structure
 \param stream Target stream
 \return true if success, false if error */
@@ -108,5 +121,11 @@ bool
 gltf_token_to_component_type(const gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
                              gltf_component_type* value);
 
+/*! Get the source JSON text of a token, including quotes for strings and the full extent of
+objects and arrays
+\return Source text, empty if token could not be resolved */
+string_const_t
+gltf_token_source(const gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
+
 bool
 gltf_token_to_boolean(const gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken, bool* value);
@@ -0,0 +1,223 @@
+/* hierarchy.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "hierarchy.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+
+#include <vector/vector.h>
+
+// Matrices use the glTF column-major memory layout, where each matrix row holds one column of
+// the transform and the last row holds the translation. A world transform is the local transform
+// multiplied by the parent world transform in this layout.
+
+void
+gltf_hierarchy_initialize(gltf_hierarchy_t* hierarchy) {
+	memset(hierarchy, 0, sizeof(gltf_hierarchy_t));
+}
+
+void
+gltf_hierarchy_finalize(gltf_hierarchy_t* hierarchy) {
+	memory_deallocate(hierarchy->node);
+	memory_deallocate(hierarchy->parent);
+	memory_deallocate(hierarchy->entry);
+	memory_deallocate(hierarchy->has_matrix);
+	// All component arrays share one allocation
+	memory_deallocate(hierarchy->translation[0]);
+	memory_deallocate(hierarchy->local);
+	memory_deallocate(hierarchy->world);
+	gltf_hierarchy_initialize(hierarchy);
+}
+
+static bool
+gltf_hierarchy_add(gltf_hierarchy_t* hierarchy, uint node_count, uint node, uint parent) {
+	if ((node >= node_count) || (hierarchy->entry[node] != GLTF_INVALID_INDEX)) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Node %u is invalid or has multiple parents"), node);
+		return false;
+	}
+	uint ientry = hierarchy->count++;
+	hierarchy->entry[node] = ientry;
+	hierarchy->node[ientry] = node;
+	hierarchy->parent[ientry] = parent;
+	return true;
+}
+
+bool
+gltf_hierarchy_build(gltf_hierarchy_t* hierarchy, const gltf_t* gltf, uint scene) {
+	gltf_hierarchy_finalize(hierarchy);
+
+	uint node_count = array_count(gltf->nodes);
+	if ((scene != GLTF_INVALID_INDEX) && (scene >= array_count(gltf->scenes))) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Invalid scene index"));
+		return false;
+	}
+	if (!node_count)
+		return true;
+
+	hierarchy->node = memory_allocate(HASH_GLTF, sizeof(uint) * node_count, 0, MEMORY_PERSISTENT);
+	hierarchy->parent = memory_allocate(HASH_GLTF, sizeof(uint) * node_count, 0, MEMORY_PERSISTENT);
+	hierarchy->entry = memory_allocate(HASH_GLTF, sizeof(uint) * node_count, 0, MEMORY_PERSISTENT);
+	memset(hierarchy->entry, 0xFF, sizeof(uint) * node_count);
+
+	bool success = true;
+	if (scene != GLTF_INVALID_INDEX) {
+		const gltf_scene_t* root_scene = gltf->scenes + scene;
+		for (uint iroot = 0, root_count = array_count(root_scene->nodes); success && (iroot < root_count); ++iroot)
+			success = gltf_hierarchy_add(hierarchy, node_count, root_scene->nodes[iroot], GLTF_INVALID_INDEX);
+	} else {
+		// Use the entry array to flag nodes which are children before adding the remaining roots
+		for (uint inode = 0; inode < node_count; ++inode) {
+			const gltf_node_t* node = gltf->nodes + inode;
+			const uint* children = gltf_node_children(gltf, node);
+			for (uint ichild = 0; ichild < node->children_count; ++ichild) {
+				if (children[ichild] < node_count)
+					hierarchy->entry[children[ichild]] = 0;
+			}
+		}
+		for (uint inode = 0; inode < node_count; ++inode) {
+			if (hierarchy->entry[inode] == GLTF_INVALID_INDEX)
+				gltf_hierarchy_add(hierarchy, node_count, inode, GLTF_INVALID_INDEX);
+			else
+				hierarchy->entry[inode] = GLTF_INVALID_INDEX;
+		}
+	}
+
+	// Breadth first traversal, the node array doubles as the queue of entries to expand
+	for (uint ientry = 0; success && (ientry < hierarchy->count); ++ientry) {
+		const gltf_node_t* node = gltf->nodes + hierarchy->node[ientry];
+		const uint* children = gltf_node_children(gltf, node);
+		for (uint ichild = 0; success && (ichild < node->children_count); ++ichild)
+			success = gltf_hierarchy_add(hierarchy, node_count, children[ichild], ientry);
+	}
+	if (!success) {
+		gltf_hierarchy_finalize(hierarchy);
+		return false;
+	}
+
+	uint count = hierarchy->count;
+	if (!count)
+		return true;
+
+	hierarchy->has_matrix = memory_allocate(HASH_GLTF, sizeof(bool) * count, 0, MEMORY_PERSISTENT);
+	float* components = memory_allocate(HASH_GLTF, sizeof(float) * count * 10, 16, MEMORY_PERSISTENT);
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		hierarchy->translation[icomp] = components + (count * icomp);
+		hierarchy->rotation[icomp] = components + (count * (3 + icomp));
+		hierarchy->scale[icomp] = components + (count * (7 + icomp));
+	}
+	hierarchy->rotation[3] = components + (count * 6);
+	hierarchy->local = memory_allocate(HASH_GLTF, sizeof(matrix_t) * count, 16, MEMORY_PERSISTENT);
+	hierarchy->world = memory_allocate(HASH_GLTF, sizeof(matrix_t) * count, 16, MEMORY_PERSISTENT);
+
+	for (uint ientry = 0; ientry < count; ++ientry) {
+		const gltf_transform_t* transform = &gltf->nodes[hierarchy->node[ientry]].transform;
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			hierarchy->translation[icomp][ientry] = (float)transform->translation[icomp];
+			hierarchy->scale[icomp][ientry] = (float)transform->scale[icomp];
+		}
+		for (uint icomp = 0; icomp < 4; ++icomp)
+			hierarchy->rotation[icomp][ientry] = (float)transform->rotation[icomp];
+		hierarchy->has_matrix[ientry] = transform->has_matrix;
+		if (transform->has_matrix) {
+			for (uint irow = 0; irow < 4; ++irow) {
+				for (uint icol = 0; icol < 4; ++icol)
+					hierarchy->local[ientry].frow[irow][icol] = (float)transform->matrix[irow][icol];
+			}
+		}
+	}
+
+	gltf_hierarchy_update_local(hierarchy);
+	gltf_hierarchy_update_world(hierarchy);
+
+	return true;
+}
+
+void
+gltf_hierarchy_update_local(gltf_hierarchy_t* hierarchy) {
+	const float* FOUNDATION_RESTRICT tx = hierarchy->translation[0];
+	const float* FOUNDATION_RESTRICT ty = hierarchy->translation[1];
+	const float* FOUNDATION_RESTRICT tz = hierarchy->translation[2];
+	const float* FOUNDATION_RESTRICT rx = hierarchy->rotation[0];
+	const float* FOUNDATION_RESTRICT ry = hierarchy->rotation[1];
+	const float* FOUNDATION_RESTRICT rz = hierarchy->rotation[2];
+	const float* FOUNDATION_RESTRICT rw = hierarchy->rotation[3];
+	const float* FOUNDATION_RESTRICT sx = hierarchy->scale[0];
+	const float* FOUNDATION_RESTRICT sy = hierarchy->scale[1];
+	const float* FOUNDATION_RESTRICT sz = hierarchy->scale[2];
+	for (uint ientry = 0, count = hierarchy->count; ientry < count; ++ientry) {
+		if (hierarchy->has_matrix[ientry])
+			continue;
+
+		float xx = rx[ientry] * rx[ientry];
+		float yy = ry[ientry] * ry[ientry];
+		float zz = rz[ientry] * rz[ientry];
+		float xy = rx[ientry] * ry[ientry];
+		float xz = rx[ientry] * rz[ientry];
+		float yz = ry[ientry] * rz[ientry];
+		float wx = rw[ientry] * rx[ientry];
+		float wy = rw[ientry] * ry[ientry];
+		float wz = rw[ientry] * rz[ientry];
+
+		matrix_t* local = hierarchy->local + ientry;
+		local->frow[0][0] = (1.0f - 2.0f * (yy + zz)) * sx[ientry];
+		local->frow[0][1] = 2.0f * (xy + wz) * sx[ientry];
+		local->frow[0][2] = 2.0f * (xz - wy) * sx[ientry];
+		local->frow[0][3] = 0;
+		local->frow[1][0] = 2.0f * (xy - wz) * sy[ientry];
+		local->frow[1][1] = (1.0f - 2.0f * (xx + zz)) * sy[ientry];
+		local->frow[1][2] = 2.0f * (yz + wx) * sy[ientry];
+		local->frow[1][3] = 0;
+		local->frow[2][0] = 2.0f * (xz + wy) * sz[ientry];
+		local->frow[2][1] = 2.0f * (yz - wx) * sz[ientry];
+		local->frow[2][2] = (1.0f - 2.0f * (xx + yy)) * sz[ientry];
+		local->frow[2][3] = 0;
+		local->frow[3][0] = tx[ientry];
+		local->frow[3][1] = ty[ientry];
+		local->frow[3][2] = tz[ientry];
+		local->frow[3][3] = 1.0f;
+	}
+}
+
+void
+gltf_hierarchy_multiply(matrix_t* FOUNDATION_RESTRICT result, const matrix_t* FOUNDATION_RESTRICT first,
+                        const matrix_t* FOUNDATION_RESTRICT second) {
+	// Each result row is a linear combination of the second matrix rows
+	vector_t second_row0 = second->row[0];
+	vector_t second_row1 = second->row[1];
+	vector_t second_row2 = second->row[2];
+	vector_t second_row3 = second->row[3];
+	for (uint irow = 0; irow < 4; ++irow) {
+		const float* factor = first->frow[irow];
+		vector_t row = vector_mul(second_row0, vector_uniform(factor[0]));
+		row = vector_muladd(second_row1, vector_uniform(factor[1]), row);
+		row = vector_muladd(second_row2, vector_uniform(factor[2]), row);
+		result->row[irow] = vector_muladd(second_row3, vector_uniform(factor[3]), row);
+	}
+}
+
+void
+gltf_hierarchy_update_world(gltf_hierarchy_t* hierarchy) {
+	// Parents precede their children, so a single linear pass sees every parent world transform
+	// already computed
+	const uint* parent = hierarchy->parent;
+	for (uint ientry = 0, count = hierarchy->count; ientry < count; ++ientry) {
+		if (parent[ientry] == GLTF_INVALID_INDEX)
+			hierarchy->world[ientry] = hierarchy->local[ientry];
+		else
+			gltf_hierarchy_multiply(hierarchy->world + ientry, hierarchy->local + ientry,
+			                        hierarchy->world + parent[ientry]);
+	}
+}
@@ -0,0 +1,58 @@
+/* hierarchy.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file hierarchy.h
+    Flattened node hierarchy with batched transform evaluation */
+
+#include "gltf.h"
+
+/*! Initialize an empty hierarchy
+\param hierarchy Hierarchy */
+GLTF_API void
+gltf_hierarchy_initialize(gltf_hierarchy_t* hierarchy);
+
+/*! Release all memory held by a hierarchy
+\param hierarchy Hierarchy */
+GLTF_API void
+gltf_hierarchy_finalize(gltf_hierarchy_t* hierarchy);
+
+/*! Build a flattened hierarchy of all nodes reachable from the root nodes of a scene, ordered
+breadth first so parents precede their children. Local and world transforms are computed.
+\param hierarchy Hierarchy, previous content is released
+\param gltf glTF data structure
+\param scene Scene index, or GLTF_INVALID_INDEX to use all nodes without a parent as roots
+\return true if success, false if the scene is invalid or the nodes do not form a tree */
+GLTF_API bool
+gltf_hierarchy_build(gltf_hierarchy_t* hierarchy, const gltf_t* gltf, uint scene);
+
+/*! Compute local transform matrices from the translation, rotation and scale arrays for all
+entries not given by a matrix
+\param hierarchy Hierarchy */
+GLTF_API void
+gltf_hierarchy_update_local(gltf_hierarchy_t* hierarchy);
+
+/*! Compute world transform matrices from local transform matrices in a single pass
+\param hierarchy Hierarchy */
+GLTF_API void
+gltf_hierarchy_update_world(gltf_hierarchy_t* hierarchy);
+
+/*! Multiply two transform matrices, giving the transform applying the first matrix and then
+the second matrix. The result must not alias either source matrix.
+\param result Destination matrix
+\param first First transform
+\param second Second transform */
+GLTF_API void
+gltf_hierarchy_multiply(matrix_t* result, const matrix_t* first, const matrix_t* second);
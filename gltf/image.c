@@ -46,8 +46,10 @@ gltf_images_parse_image(gltf_t* gltf, const char* buffer, json_token_t* tokens,
 		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
 		if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING))
 			image->name = json_token_value(buffer, tokens + itoken);
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			image->extensions = json_token_value(buffer, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_IMAGE,
+		                                image, &image->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			image->extras = json_token_value(buffer, tokens + itoken);
 		else if ((identifier_hash == HASH_BUFFERVIEW) &&
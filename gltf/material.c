@@ -35,6 +35,8 @@ gltf_material_initialize(gltf_material_t* material) {
 		material->metallic_roughness.base_color_factor[ielem] = 1.0;
 	material->metallic_roughness.metallic_factor = 1.0;
 	material->metallic_roughness.roughness_factor = 1.0;
+	material->metallic_roughness.extensions = string_empty();
+	material->metallic_roughness.extras = string_empty();
 	material->normal_scale = 1.0;
 	material->occlusion_strength = 1.0;
 	material->emissive_factor[0] = material->emissive_factor[1] = material->emissive_factor[2] = 0;
@@ -43,6 +45,8 @@ gltf_material_initialize(gltf_material_t* material) {
 	material->double_sided = false;
 	material->extensions = string_empty();
 	material->extras = string_empty();
+	material->source = string_empty();
+	material->dirty = false;
 
 	gltf_texture_info_initialize(&material->metallic_roughness.base_color_texture);
 	gltf_texture_info_initialize(&material->metallic_roughness.metallic_roughness_texture);
@@ -82,8 +86,10 @@ gltf_material_parse_textureinfo(gltf_t* gltf, const char* buffer, json_token_t*
 		else if ((identifier_hash == HASH_TEXCOORD) &&
 		         !gltf_token_to_integer(gltf, buffer, tokens, itoken, &texture->texcoord))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			texture->extensions = json_token_value(buffer, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_TEXTURE_INFO,
+		                                texture, &texture->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			texture->extras = json_token_value(buffer, tokens + itoken);
 
@@ -143,8 +149,10 @@ gltf_material_parse_pbrmetallicroughness(gltf_t* gltf, const char* buffer, json_
 	while (itoken) {
 		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
 		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
-		if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			metallic_roughness->extensions = json_token_value(buffer, tokens + itoken);
+		if ((identifier_hash == HASH_EXTENSIONS) &&
+		    !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_PBR_METALLIC_ROUGHNESS,
+		                           metallic_roughness, &metallic_roughness->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			metallic_roughness->extras = json_token_value(buffer, tokens + itoken);
 		else if ((identifier_hash == HASH_BASECOLORTEXTURE) &&
@@ -185,8 +193,10 @@ gltf_materials_parse_material(gltf_t* gltf, const char* buffer, json_token_t* to
 		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
 		if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING))
 			material->name = json_token_value(buffer, tokens + itoken);
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			material->extensions = json_token_value(buffer, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_MATERIAL,
+		                                material, &material->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			material->extras = json_token_value(buffer, tokens + itoken);
 		else if ((identifier_hash == HASH_ALPHAMODE) && (tokens[itoken].type == JSON_STRING))
@@ -242,6 +252,8 @@ gltf_materials_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, siz
 	while (imat) {
 		if (!gltf_materials_parse_material(gltf, buffer, tokens, imat, gltf->materials + icounter))
 			return false;
+		gltf->materials[icounter].source = gltf_token_source(gltf, buffer, tokens, imat);
+		gltf->materials[icounter].dirty = false;
 		imat = tokens[imat].sibling;
 		++icounter;
 	}
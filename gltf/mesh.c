@@ -33,6 +33,9 @@ gltf_primitive_finalize(gltf_primitive_t* primitive) {
 	if (primitive->attributes_custom) {
 		array_deallocate(primitive->attributes_custom);
 	}
+	array_deallocate(primitive->targets);
+	gltf_triangle_bvh_deallocate(primitive->triangle_bvh);
+	primitive->triangle_bvh = nullptr;
 }
 
 static void
@@ -42,6 +45,7 @@ gltf_mesh_finalize(gltf_mesh_t* mesh) {
 			gltf_primitive_finalize(mesh->primitives + iprim);
 		array_deallocate(mesh->primitives);
 	}
+	array_deallocate(mesh->weights);
 }
 
 void
@@ -128,6 +132,73 @@ gltf_primitive_parse_attributes(gltf_t* gltf, const char* buffer, json_token_t*
 	return true;
 }
 
+static bool
+gltf_mesh_parse_primitive_target(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
+                                 gltf_morph_target_t* target) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Primitive target has invalid type"));
+		return false;
+	}
+
+	target->position = GLTF_INVALID_INDEX;
+	target->normal = GLTF_INVALID_INDEX;
+	target->tangent = GLTF_INVALID_INDEX;
+
+	// Other target attributes are allowed by the specification but not used by morph evaluation
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		if ((identifier_hash == HASH_POSITION) &&
+		    !gltf_token_to_integer(gltf, buffer, tokens, itoken, &target->position))
+			return false;
+		else if ((identifier_hash == HASH_NORMAL) &&
+		         !gltf_token_to_integer(gltf, buffer, tokens, itoken, &target->normal))
+			return false;
+		else if ((identifier_hash == HASH_TANGENT) &&
+		         !gltf_token_to_integer(gltf, buffer, tokens, itoken, &target->tangent))
+			return false;
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+static bool
+gltf_mesh_parse_primitive_targets(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
+                                  gltf_primitive_t* primitive) {
+	if ((tokens[itoken].type != JSON_ARRAY) || (tokens[itoken].value_length > GLTF_MAX_INDEX)) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Primitive targets has invalid type"));
+		return false;
+	}
+
+	array_resize(primitive->targets, tokens[itoken].value_length);
+	uint itarget = 0;
+	for (size_t ivalue = tokens[itoken].child; ivalue; ivalue = tokens[ivalue].sibling) {
+		if (!gltf_mesh_parse_primitive_target(gltf, buffer, tokens, ivalue, primitive->targets + itarget++))
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+gltf_mesh_parse_primitive_extensions(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
+                                     gltf_primitive_t* primitive) {
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		if (string_equal(STRING_ARGS(identifier), STRING_CONST("KHR_draco_mesh_compression")) &&
+		    !gltf_draco_parse(gltf, buffer, tokens, itoken, &primitive->draco))
+			return false;
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
 static int
 gltf_mesh_parse_primitive(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
                           gltf_primitive_t* primitive) {
@@ -136,10 +207,17 @@ gltf_mesh_parse_primitive(gltf_t* gltf, const char* buffer, json_token_t* tokens
 		return false;
 	}
 
+	memset(primitive, 0, sizeof(gltf_primitive_t));
 	primitive->mode = GLTF_TRIANGLES;
+	primitive->indices = GLTF_INVALID_INDEX;
+	primitive->material = GLTF_INVALID_INDEX;
 
-	for (int iattrib = 0; iattrib < GLTF_ATTRIBUTE_COUNT; ++iattrib)
+	for (int iattrib = 0; iattrib < GLTF_ATTRIBUTE_COUNT; ++iattrib) {
 		primitive->attributes[iattrib] = GLTF_INVALID_INDEX;
+		primitive->draco.attributes[iattrib] = GLTF_INVALID_INDEX;
+	}
+	primitive->draco.buffer_view = GLTF_INVALID_INDEX;
+	primitive->source = gltf_token_source(gltf, buffer, tokens, itoken);
 
 	itoken = tokens[itoken].child;
 	while (itoken) {
@@ -157,8 +235,17 @@ gltf_mesh_parse_primitive(gltf_t* gltf, const char* buffer, json_token_t* tokens
 		else if ((identifier_hash == HASH_MODE) &&
 		         !gltf_token_to_integer(gltf, buffer, tokens, itoken, (uint*)&primitive->mode))
 			return false;
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			primitive->extensions = json_token_value(buffer, tokens + itoken);
+		else if (string_equal(STRING_ARGS(identifier), STRING_CONST("targets")) &&
+		         !gltf_mesh_parse_primitive_targets(gltf, buffer, tokens, itoken, primitive))
+			return false;
+		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_OBJECT) &&
+		         !gltf_mesh_parse_primitive_extensions(gltf, buffer, tokens, itoken, primitive))
+			return false;
+		// Built in extensions are decoded above, registered handlers are called for all extensions
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_PRIMITIVE,
+		                                primitive, &primitive->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			primitive->extras = json_token_value(buffer, tokens + itoken);
 
@@ -203,18 +290,32 @@ gltf_meshes_parse_mesh(gltf_t* gltf, const char* buffer, json_token_t* tokens, s
 		return false;
 	}
 
+	memset(mesh, 0, sizeof(gltf_mesh_t));
+
 	itoken = tokens[itoken].child;
 	while (itoken) {
 		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
 		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
-		if ((identifier_hash == HASH_PRIMITIVES) && !gltf_mesh_parse_primitives(gltf, buffer, tokens, itoken, mesh))
-			return false;
-		else if (identifier_hash == HASH_NAME)
+		if (identifier_hash == HASH_PRIMITIVES) {
+			if (!gltf_mesh_parse_primitives(gltf, buffer, tokens, itoken, mesh))
+				return false;
+		} else if (identifier_hash == HASH_NAME) {
 			mesh->name = json_token_value(buffer, tokens + itoken);
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			mesh->extensions = json_token_value(buffer, tokens + itoken);
-		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("weights"))) {
+			if ((tokens[itoken].type != JSON_ARRAY) || (tokens[itoken].value_length > GLTF_MAX_INDEX)) {
+				log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Mesh weights has invalid type"));
+				return false;
+			}
+			array_resize(mesh->weights, tokens[itoken].value_length);
+			if (!gltf_token_to_real_array(gltf, buffer, tokens, itoken, mesh->weights, array_count(mesh->weights)))
+				return false;
+		} else if (identifier_hash == HASH_EXTENSIONS) {
+			if (!gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_MESH,
+			                           mesh, &mesh->extensions))
+				return false;
+		} else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING)) {
 			mesh->extras = json_token_value(buffer, tokens + itoken);
+		}
 
 		itoken = tokens[itoken].sibling;
 	}
@@ -243,6 +344,8 @@ gltf_meshes_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t
 	while (imesh) {
 		if (!gltf_meshes_parse_mesh(gltf, buffer, tokens, imesh, gltf->meshes + icounter))
 			return false;
+		gltf->meshes[icounter].source = gltf_token_source(gltf, buffer, tokens, imesh);
+		gltf->meshes[icounter].dirty = false;
 		imesh = tokens[imesh].sibling;
 		++icounter;
 	}
@@ -250,6 +353,44 @@ gltf_meshes_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t
 	return true;
 }
 
+//! Gather a vec3 attribute referenced by each vertex, walking the vertex buckets contiguously
+static void
+gltf_mesh_gather_attribute(const bucketarray_t* vertices, size_t index_offset, const bucketarray_t* source,
+                           float* component, uint step, vector_t* vmin, vector_t* vmax) {
+	vector_t local_min = *vmin;
+	vector_t local_max = *vmax;
+	size_t vertex_bucket_size = vertices->bucket_mask + 1;
+	for (size_t ivert = 0, ibucket = 0; ivert < vertices->count; ++ibucket) {
+		const mesh_vertex_t* mesh_vertex = vertices->bucket[ibucket];
+		size_t bucket_count = vertices->count - ivert;
+		if (bucket_count > vertex_bucket_size)
+			bucket_count = vertex_bucket_size;
+		for (size_t ielement = 0; ielement < bucket_count; ++ielement, ++mesh_vertex) {
+			size_t index = *(const uint*)pointer_offset_const(mesh_vertex, index_offset);
+			const vector_t* value = pointer_offset_const(source->bucket[index >> source->bucket_shift],
+			                                             source->element_size * (index & source->bucket_mask));
+			component[0] = vector_x(*value);
+			component[1] = vector_y(*value);
+			component[2] = vector_z(*value);
+			component += step;
+			local_min = vector_min(local_min, *value);
+			local_max = vector_max(local_max, *value);
+		}
+		ivert += bucket_count;
+	}
+	*vmin = local_min;
+	*vmax = local_max;
+}
+
+//! Get the glTF material of a triangle, or material_count if the material is invalid or not below material_count
+static FOUNDATION_FORCEINLINE uint
+gltf_mesh_triangle_material(const mesh_triangle_t* triangle, const uint* mesh_material_map, uint material_count) {
+	uint material = triangle->material;
+	if (mesh_material_map && (material != GLTF_INVALID_INDEX))
+		material = mesh_material_map[material];
+	return (material < material_count) ? material : material_count;
+}
+
 uint
 gltf_mesh_add_mesh(gltf_t* gltf, const mesh_t* mesh, uint* mesh_material_map) {
 	if (!mesh || !mesh->triangle.count || !mesh->vertex.count)
@@ -262,12 +403,48 @@ gltf_mesh_add_mesh(gltf_t* gltf, const mesh_t* mesh, uint* mesh_material_map) {
 
 	gltf_mesh.name = string_const(STRING_ARGS(mesh_name));
 
+	// In interleaved mode all vertex attributes share one strided buffer view
+	bool interleave = (gltf->flags & GLTF_FLAG_INTERLEAVED_VERTICES);
+	uint vertex_stride = sizeof(float) * 3;
+	if (interleave && mesh->normal.count)
+		vertex_stride += sizeof(float) * 3;
+
+	// Make sure we have output buffers with room for all vertex attributes and indices,
+	// where the indices might roll over into a new buffer
+	size_t vertex_size = sizeof(float) * 3 * mesh->vertex.count;
+	if (mesh->normal.count)
+		vertex_size *= 2;
+	uint output_buffer = 0;
+	uint index_buffer = 0;
+	size_t current_offset = 0;
+	size_t index_buffer_offset = 0;
+	void* vertex_data = nullptr;
+	void* index_data = nullptr;
+	if (!gltf_buffer_output_allocate(gltf, vertex_size, &output_buffer, &current_offset, &vertex_data) ||
+	    !gltf_buffer_output_allocate(gltf, sizeof(uint) * mesh->triangle.count * 3, &index_buffer,
+	                                 &index_buffer_offset, &index_data))
+		return GLTF_INVALID_INDEX;
+	size_t vertex_offset = current_offset;
+	uint accessors_count = array_count(gltf->accessors);
+	uint buffer_views_count = array_count(gltf->buffer_views);
+
 	// First setup the vertex attribute accessors
-	// Make sure we have an output buffer ready
-	if (!gltf->output_buffer)
-		gltf->output_buffer = virtualarray_allocate(1, 1024 * 1024 * 1024);
-	uint current_offset = (uint)gltf->output_buffer->count;
-	virtualarray_resize(gltf->output_buffer, current_offset + (sizeof(float) * mesh->vertex.count * 3));
+
+	uint interleaved_view = GLTF_INVALID_INDEX;
+	if (interleave) {
+		gltf_buffer_view_t buffer_view = {0};
+		buffer_view.buffer = output_buffer;
+		buffer_view.output = true;
+		buffer_view.byte_offset = (uint)current_offset;
+		buffer_view.byte_length = vertex_stride * (uint)mesh->vertex.count;
+		buffer_view.byte_stride = vertex_stride;
+		buffer_view.target = GLTF_BUFFER_TARGET_ARRAY;
+
+		interleaved_view = array_count(gltf->buffer_views);
+		array_push(gltf->buffer_views, buffer_view);
+	}
+	uint component_step = vertex_stride / sizeof(float);
+	uint attribute_offset = 0;
 
 	// Coordinates
 	uint coordinate_accessor = GLTF_INVALID_INDEX;
@@ -276,31 +453,30 @@ gltf_mesh_add_mesh(gltf_t* gltf, const mesh_t* mesh, uint* mesh_material_map) {
 		accessor.type = GLTF_DATA_VEC3;
 		accessor.component_type = GLTF_COMPONENT_FLOAT;
 		accessor.count = (uint)mesh->vertex.count;
-		accessor.byte_offset = 0;
-		accessor.buffer_view = array_count(gltf->buffer_views);
+		accessor.byte_offset = attribute_offset;
+		accessor.buffer_view = interleave ? interleaved_view : array_count(gltf->buffer_views);
 
 		gltf_buffer_view_t buffer_view = {0};
-		buffer_view.buffer = 0;
-		buffer_view.byte_offset = current_offset;
+		buffer_view.buffer = output_buffer;
+		buffer_view.output = true;
+		buffer_view.byte_offset = (uint)current_offset;
 		buffer_view.byte_length = sizeof(float) * accessor.count * 3;
+		buffer_view.target = GLTF_BUFFER_TARGET_ARRAY;
 
-		array_push(gltf->buffer_views, buffer_view);
+		if (!interleave)
+			array_push(gltf->buffer_views, buffer_view);
 
 		vector_t vmin = vector_uniform(REAL_MAX);
 		vector_t vmax = vector_uniform(-REAL_MAX);
-		float* vertex_component = pointer_offset(gltf->output_buffer->storage, buffer_view.byte_offset);
-		for (uint ivert = 0; ivert < mesh->vertex.count; ++ivert) {
-			const mesh_vertex_t* mesh_vertex = bucketarray_get_const(&mesh->vertex, ivert);
-			const mesh_coordinate_t* mesh_coordinate =
-			    bucketarray_get_const(&mesh->coordinate, mesh_vertex->coordinate);
-			*vertex_component++ = vector_x(*mesh_coordinate);
-			*vertex_component++ = vector_y(*mesh_coordinate);
-			*vertex_component++ = vector_z(*mesh_coordinate);
-			vmin = vector_min(vmin, *mesh_coordinate);
-			vmax = vector_max(vmax, *mesh_coordinate);
-		}
+		float* vertex_component =
+		    pointer_offset(vertex_data, (buffer_view.byte_offset - vertex_offset) + attribute_offset);
+		gltf_mesh_gather_attribute(&mesh->vertex, offsetof(mesh_vertex_t, coordinate), &mesh->coordinate,
+		                           vertex_component, component_step, &vmin, &vmax);
 
-		current_offset += buffer_view.byte_length;
+		if (interleave)
+			attribute_offset += sizeof(float) * 3;
+		else
+			current_offset += buffer_view.byte_length;
 
 		accessor.min[0] = vector_x(vmin);
 		accessor.min[1] = vector_y(vmin);
@@ -322,30 +498,30 @@ gltf_mesh_add_mesh(gltf_t* gltf, const mesh_t* mesh, uint* mesh_material_map) {
 		accessor.type = GLTF_DATA_VEC3;
 		accessor.component_type = GLTF_COMPONENT_FLOAT;
 		accessor.count = (uint)mesh->vertex.count;
-		accessor.byte_offset = 0;
-		accessor.buffer_view = array_count(gltf->buffer_views);
+		accessor.byte_offset = attribute_offset;
+		accessor.buffer_view = interleave ? interleaved_view : array_count(gltf->buffer_views);
 
 		gltf_buffer_view_t buffer_view = {0};
-		buffer_view.buffer = 0;
-		buffer_view.byte_offset = current_offset;
+		buffer_view.buffer = output_buffer;
+		buffer_view.output = true;
+		buffer_view.byte_offset = (uint)current_offset;
 		buffer_view.byte_length = sizeof(float) * accessor.count * 3;
+		buffer_view.target = GLTF_BUFFER_TARGET_ARRAY;
 
-		array_push(gltf->buffer_views, buffer_view);
+		if (!interleave)
+			array_push(gltf->buffer_views, buffer_view);
 
 		vector_t vmin = vector_uniform(REAL_MAX);
 		vector_t vmax = vector_uniform(-REAL_MAX);
-		float* normal_component = pointer_offset(gltf->output_buffer->storage, buffer_view.byte_offset);
-		for (uint ivert = 0; ivert < mesh->vertex.count; ++ivert) {
-			const mesh_vertex_t* mesh_vertex = bucketarray_get_const(&mesh->vertex, ivert);
-			const mesh_normal_t* mesh_normal = bucketarray_get_const(&mesh->normal, mesh_vertex->normal);
-			*normal_component++ = vector_x(*mesh_normal);
-			*normal_component++ = vector_y(*mesh_normal);
-			*normal_component++ = vector_z(*mesh_normal);
-			vmin = vector_min(vmin, *mesh_normal);
-			vmax = vector_max(vmax, *mesh_normal);
-		}
+		float* normal_component =
+		    pointer_offset(vertex_data, (buffer_view.byte_offset - vertex_offset) + attribute_offset);
+		gltf_mesh_gather_attribute(&mesh->vertex, offsetof(mesh_vertex_t, normal), &mesh->normal, normal_component,
+		                           component_step, &vmin, &vmax);
 
-		current_offset += buffer_view.byte_length;
+		if (interleave)
+			attribute_offset += sizeof(float) * 3;
+		else
+			current_offset += buffer_view.byte_length;
 
 		accessor.min[0] = vector_x(vmin);
 		accessor.min[1] = vector_y(vmin);
@@ -361,46 +537,44 @@ gltf_mesh_add_mesh(gltf_t* gltf, const mesh_t* mesh, uint* mesh_material_map) {
 	}
 
 	// Now create primitives and index accessors
-	// Make sure we have an output buffer ready
-	virtualarray_resize(gltf->output_buffer, current_offset + (sizeof(uint) * mesh->triangle.count * 3));
+	output_buffer = index_buffer;
+	current_offset = index_buffer_offset;
+
+	// Bucket triangles by material with a counting sort. Buckets are sized by the largest material id in the
+	// mesh, ids are kept even if the materials are not yet added to the document. Triangles with an invalid
+	// material go in a last bucket and get a primitive without material
+	uint material_count = 0;
+	for (uint itri = 0; itri < mesh->triangle.count; ++itri) {
+		const mesh_triangle_t* triangle = bucketarray_get_const(&mesh->triangle, itri);
+		uint material = gltf_mesh_triangle_material(triangle, mesh_material_map, GLTF_MAX_INDEX);
+		if ((material < GLTF_MAX_INDEX) && (material >= material_count))
+			material_count = material + 1;
+	}
 
-	uint triangle_restart = 0;
-	while (triangle_restart != GLTF_INVALID_INDEX) {
-		// One triangle index buffer per primitive
-		uint* index = pointer_offset(gltf->output_buffer->storage, current_offset);
+	// First pass counts triangles per material
+	uint* material_offset = memory_allocate(HASH_GLTF, sizeof(uint) * (material_count + 1), 0,
+	                                        MEMORY_TEMPORARY | MEMORY_ZERO_INITIALIZED);
+	for (uint itri = 0; itri < mesh->triangle.count; ++itri) {
+		const mesh_triangle_t* triangle = bucketarray_get_const(&mesh->triangle, itri);
+		++material_offset[gltf_mesh_triangle_material(triangle, mesh_material_map, material_count)];
+	}
 
-		// One primitive per material
+	// Create one primitive and index accessor per used material, converting counts to start offsets
+	uint index_offset = 0;
+	for (uint imaterial = 0; imaterial <= material_count; ++imaterial) {
+		uint triangle_count = material_offset[imaterial];
+		material_offset[imaterial] = index_offset;
+		if (!triangle_count)
+			continue;
+
+		// All primitives share the vertex attribute accessors
 		gltf_primitive_t primitive = {0};
-		for (int iattrib = 0; iattrib < GLTF_ATTRIBUTE_COUNT; ++iattrib)
+		for (int iattrib = 0; iattrib < GLTF_ATTRIBUTE_COUNT; ++iattrib) {
 			primitive.attributes[iattrib] = GLTF_INVALID_INDEX;
-
-		// Start at the first encountered remaining triangle
-		uint triangle_start = triangle_restart;
-		triangle_restart = GLTF_INVALID_INDEX;
-
-		const mesh_triangle_t* triangle = bucketarray_get_const(&mesh->triangle, triangle_start);
-		uint current_material = triangle->material;
-		uint triangle_count = 0;
-
-		for (uint itri = triangle_start; itri < mesh->triangle.count; ++itri) {
-			triangle = bucketarray_get_const(&mesh->triangle, itri);
-			if (triangle->material > current_material) {
-				// Defer to a new primitive, store start triangle index if not set
-				if (triangle_restart == GLTF_INVALID_INDEX)
-					triangle_restart = itri;
-			} else if (triangle->material < current_material) {
-				// Already processed
-			} else {
-				*index++ = triangle->vertex[0];
-				*index++ = triangle->vertex[1];
-				*index++ = triangle->vertex[2];
-				++triangle_count;
-			}
+			primitive.draco.attributes[iattrib] = GLTF_INVALID_INDEX;
 		}
-
-		// All triangles for this primitive collected, setup primitive and create index accessor
-		// All primitives share the vertex attribute accessors
-		primitive.material = mesh_material_map ? mesh_material_map[current_material] : current_material;
+		primitive.draco.buffer_view = GLTF_INVALID_INDEX;
+		primitive.material = (imaterial < material_count) ? imaterial : GLTF_INVALID_INDEX;
 		primitive.mode = GLTF_TRIANGLES;
 		primitive.attributes[GLTF_POSITION] = coordinate_accessor;
 		primitive.attributes[GLTF_NORMAL] = normal_accessor;
@@ -417,16 +591,40 @@ gltf_mesh_add_mesh(gltf_t* gltf, const mesh_t* mesh, uint* mesh_material_map) {
 
 		array_push(gltf->accessors, accessor);
 
+		// One triangle index buffer per primitive
 		gltf_buffer_view_t buffer_view = {0};
-		buffer_view.buffer = 0;
-		buffer_view.byte_offset = current_offset;
+		buffer_view.buffer = output_buffer;
+		buffer_view.output = true;
+		buffer_view.byte_offset = (uint)(current_offset + (sizeof(uint) * index_offset));
 		buffer_view.byte_length = sizeof(uint) * accessor.count;
+		buffer_view.target = GLTF_BUFFER_TARGET_ELEMENT_ARRAY;
 
 		array_push(gltf->buffer_views, buffer_view);
 
-		current_offset += buffer_view.byte_length;
+		index_offset += accessor.count;
+	}
+
+	// Second pass scatters triangle indices directly into the index buffer of each primitive
+	uint* index = index_data;
+	for (uint itri = 0; itri < mesh->triangle.count; ++itri) {
+		const mesh_triangle_t* triangle = bucketarray_get_const(&mesh->triangle, itri);
+		uint bucket = gltf_mesh_triangle_material(triangle, mesh_material_map, material_count);
+		uint* triangle_index = index + material_offset[bucket];
+		triangle_index[0] = triangle->vertex[0];
+		triangle_index[1] = triangle->vertex[1];
+		triangle_index[2] = triangle->vertex[2];
+		material_offset[bucket] += 3;
+	}
+
+	memory_deallocate(material_offset);
+
+	// In streaming export mode the data is now written to the buffer streams
+	if (!gltf_buffer_output_flush(gltf)) {
+		array_resize(gltf->accessors, accessors_count);
+		array_resize(gltf->buffer_views, buffer_views_count);
+		array_deallocate(gltf_mesh.primitives);
+		return GLTF_INVALID_INDEX;
 	}
-	FOUNDATION_ASSERT(current_offset == (uint)gltf->output_buffer->count);
 
 	array_push(gltf->meshes, gltf_mesh);
 
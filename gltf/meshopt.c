@@ -0,0 +1,371 @@
+/* meshopt.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "meshopt.h"
+#include "hashstrings.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/virtualarray.h>
+#include <foundation/log.h>
+#include <foundation/math.h>
+
+// Bitstream layout follows the EXT_meshopt_compression specification, attribute codec
+// version 0 and index sequence codec version 1
+
+#define GLTF_MESHOPT_VERTEX_HEADER 0xA0
+#define GLTF_MESHOPT_SEQUENCE_HEADER 0xD1
+#define GLTF_MESHOPT_BLOCK_SIZE_BYTES 8192
+#define GLTF_MESHOPT_BLOCK_MAX_SIZE 256
+#define GLTF_MESHOPT_GROUP_SIZE 16
+#define GLTF_MESHOPT_TAIL_MIN_SIZE 32
+
+static size_t
+gltf_meshopt_vertex_block_size(size_t vertex_size) {
+	size_t block_size = GLTF_MESHOPT_BLOCK_SIZE_BYTES / vertex_size;
+	block_size &= ~(size_t)(GLTF_MESHOPT_GROUP_SIZE - 1);
+	return (block_size < GLTF_MESHOPT_BLOCK_MAX_SIZE) ? block_size : GLTF_MESHOPT_BLOCK_MAX_SIZE;
+}
+
+size_t
+gltf_meshopt_encode_vertex_bound(size_t vertex_count, size_t vertex_size) {
+	size_t block_size = gltf_meshopt_vertex_block_size(vertex_size);
+	size_t block_count = (vertex_count + block_size - 1) / block_size;
+	size_t block_header_size = (block_size / GLTF_MESHOPT_GROUP_SIZE + 3) / 4;
+	size_t tail_size = (vertex_size < GLTF_MESHOPT_TAIL_MIN_SIZE) ? GLTF_MESHOPT_TAIL_MIN_SIZE : vertex_size;
+	return 1 + (block_count * vertex_size * (block_header_size + block_size)) + tail_size;
+}
+
+static size_t
+gltf_meshopt_group_measure(const uint8_t* group, uint bits) {
+	if (!bits) {
+		for (uint ibyte = 0; ibyte < GLTF_MESHOPT_GROUP_SIZE; ++ibyte) {
+			if (group[ibyte])
+				return SIZE_MAX;
+		}
+		return 0;
+	}
+	if (bits == 8)
+		return GLTF_MESHOPT_GROUP_SIZE;
+
+	// Packed values, plus one raw byte for each value not fitting (sentinel)
+	size_t size = (GLTF_MESHOPT_GROUP_SIZE * bits) / 8;
+	uint8_t sentinel = (uint8_t)((1 << bits) - 1);
+	for (uint ibyte = 0; ibyte < GLTF_MESHOPT_GROUP_SIZE; ++ibyte)
+		size += (group[ibyte] >= sentinel) ? 1 : 0;
+	return size;
+}
+
+static uint8_t*
+gltf_meshopt_group_encode(uint8_t* data, const uint8_t* group, uint bits) {
+	if (!bits)
+		return data;
+	if (bits == 8) {
+		memcpy(data, group, GLTF_MESHOPT_GROUP_SIZE);
+		return data + GLTF_MESHOPT_GROUP_SIZE;
+	}
+
+	uint values_per_byte = 8 / bits;
+	uint8_t sentinel = (uint8_t)((1 << bits) - 1);
+	for (uint ibyte = 0; ibyte < GLTF_MESHOPT_GROUP_SIZE; ibyte += values_per_byte) {
+		uint8_t packed = 0;
+		for (uint ivalue = 0; ivalue < values_per_byte; ++ivalue) {
+			uint8_t value = group[ibyte + ivalue];
+			packed = (uint8_t)((packed << bits) | ((value >= sentinel) ? sentinel : value));
+		}
+		*data++ = packed;
+	}
+	for (uint ibyte = 0; ibyte < GLTF_MESHOPT_GROUP_SIZE; ++ibyte) {
+		if (group[ibyte] >= sentinel)
+			*data++ = group[ibyte];
+	}
+	return data;
+}
+
+static uint8_t*
+gltf_meshopt_encode_bytes(uint8_t* data, const uint8_t* data_end, const uint8_t* bytes, size_t bytes_count) {
+	// Group modes are stored as 2 bits per group in header, 0 = all zero, 1 = 2 bits, 2 = 4 bits, 3 = raw
+	static const uint group_bits[4] = {0, 2, 4, 8};
+
+	size_t group_count = bytes_count / GLTF_MESHOPT_GROUP_SIZE;
+	size_t header_size = (group_count + 3) / 4;
+	if ((size_t)(data_end - data) < header_size)
+		return nullptr;
+
+	uint8_t* header = data;
+	memset(header, 0, header_size);
+	data += header_size;
+
+	for (size_t igroup = 0; igroup < group_count; ++igroup) {
+		if ((size_t)(data_end - data) < GLTF_MESHOPT_GROUP_SIZE)
+			return nullptr;
+
+		const uint8_t* group = bytes + (igroup * GLTF_MESHOPT_GROUP_SIZE);
+		uint best_mode = 3;
+		size_t best_size = GLTF_MESHOPT_GROUP_SIZE;
+		for (uint mode = 0; mode < 3; ++mode) {
+			size_t size = gltf_meshopt_group_measure(group, group_bits[mode]);
+			if (size < best_size) {
+				best_mode = mode;
+				best_size = size;
+			}
+		}
+
+		header[igroup / 4] |= (uint8_t)(best_mode << ((igroup % 4) * 2));
+		data = gltf_meshopt_group_encode(data, group, group_bits[best_mode]);
+	}
+
+	return data;
+}
+
+static uint8_t*
+gltf_meshopt_encode_vertex_block(uint8_t* data, const uint8_t* data_end, const uint8_t* vertices,
+                                 size_t vertex_count, size_t vertex_size, uint8_t* last_vertex) {
+	uint8_t bytes[GLTF_MESHOPT_BLOCK_MAX_SIZE];
+	size_t vertex_count_aligned = (vertex_count + GLTF_MESHOPT_GROUP_SIZE - 1) & ~(size_t)(GLTF_MESHOPT_GROUP_SIZE - 1);
+
+	for (size_t ibyte = 0; ibyte < vertex_size; ++ibyte) {
+		// Delta against previous vertex, zigzag encoded
+		uint8_t previous = last_vertex[ibyte];
+		const uint8_t* source = vertices + ibyte;
+		for (size_t ivertex = 0; ivertex < vertex_count; ++ivertex, source += vertex_size) {
+			uint8_t delta = (uint8_t)(*source - previous);
+			bytes[ivertex] = (uint8_t)(((int8_t)delta >> 7) ^ (delta << 1));
+			previous = *source;
+		}
+		for (size_t ivertex = vertex_count; ivertex < vertex_count_aligned; ++ivertex)
+			bytes[ivertex] = 0;
+
+		data = gltf_meshopt_encode_bytes(data, data_end, bytes, vertex_count_aligned);
+		if (!data)
+			return nullptr;
+	}
+
+	memcpy(last_vertex, vertices + (vertex_size * (vertex_count - 1)), vertex_size);
+	return data;
+}
+
+size_t
+gltf_meshopt_encode_vertex(void* buffer, size_t capacity, const void* vertices, size_t vertex_count,
+                           size_t vertex_size) {
+	if (!vertex_size || (vertex_size > 256) || (vertex_size % 4) || (capacity < 1))
+		return 0;
+
+	uint8_t* data = buffer;
+	const uint8_t* data_end = data + capacity;
+	const uint8_t* source = vertices;
+
+	*data++ = GLTF_MESHOPT_VERTEX_HEADER;
+
+	uint8_t first_vertex[256] = {0};
+	uint8_t last_vertex[256] = {0};
+	if (vertex_count)
+		memcpy(first_vertex, source, vertex_size);
+	memcpy(last_vertex, first_vertex, vertex_size);
+
+	size_t block_size = gltf_meshopt_vertex_block_size(vertex_size);
+	for (size_t ivertex = 0; ivertex < vertex_count; ivertex += block_size) {
+		size_t block_count = math_min(block_size, vertex_count - ivertex);
+		data = gltf_meshopt_encode_vertex_block(data, data_end, source + (ivertex * vertex_size), block_count,
+		                                        vertex_size, last_vertex);
+		if (!data)
+			return 0;
+	}
+
+	// Tail is the first vertex, zero padded in front to minimum tail size
+	size_t tail_size = (vertex_size < GLTF_MESHOPT_TAIL_MIN_SIZE) ? GLTF_MESHOPT_TAIL_MIN_SIZE : vertex_size;
+	if ((size_t)(data_end - data) < tail_size)
+		return 0;
+	if (vertex_size < tail_size) {
+		memset(data, 0, tail_size - vertex_size);
+		data += tail_size - vertex_size;
+	}
+	memcpy(data, first_vertex, vertex_size);
+	data += vertex_size;
+
+	return (size_t)pointer_diff(data, buffer);
+}
+
+size_t
+gltf_meshopt_encode_index_bound(size_t index_count) {
+	// Header, worst case five bytes per index and four byte tail
+	return 1 + (index_count * 5) + 4;
+}
+
+size_t
+gltf_meshopt_encode_index(void* buffer, size_t capacity, const void* indices, size_t index_count, size_t index_size) {
+	if (((index_size != 2) && (index_size != 4)) || (capacity < (1 + index_count + 4)))
+		return 0;
+
+	uint8_t* data = buffer;
+	const uint8_t* data_safe_end = data + capacity - 4;
+
+	*data++ = GLTF_MESHOPT_SEQUENCE_HEADER;
+
+	uint32_t last[2] = {0, 0};
+	uint current = 0;
+	for (size_t iindex = 0; iindex < index_count; ++iindex) {
+		if (data >= data_safe_end)
+			return 0;
+
+		uint32_t index = (index_size == 4) ? ((const uint32_t*)indices)[iindex] : ((const uint16_t*)indices)[iindex];
+
+		// Switch baseline when delta grows too large to fit in a single byte
+		int32_t baseline_delta = (int32_t)(index - last[current]);
+		if (((baseline_delta < 0) ? -baseline_delta : baseline_delta) >= 30)
+			current ^= 1;
+
+		uint32_t delta = index - last[current];
+		uint32_t value = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+		// Low bit encodes which baseline to reconstruct from
+		value = (value << 1) | current;
+		do {
+			*data++ = (uint8_t)((value & 127) | ((value > 127) ? 128 : 0));
+			value >>= 7;
+		} while (value);
+
+		last[current] = index;
+	}
+
+	if (data > data_safe_end)
+		return 0;
+	memset(data, 0, 4);
+	data += 4;
+
+	return (size_t)pointer_diff(data, buffer);
+}
+
+bool
+gltf_meshopt_compress(const gltf_t* gltf, gltf_meshopt_view_t** views, void** buffer, size_t** buffer_sizes) {
+	uint view_count = array_count(gltf->buffer_views);
+	gltf_meshopt_view_t* view_info = nullptr;
+	array_resize(view_info, view_count);
+	if (view_count)
+		memset(view_info, 0, sizeof(gltf_meshopt_view_t) * view_count);
+
+	// Find element stride of each view from the accessors referencing it
+	for (uint iacc = 0, accessor_count = array_count(gltf->accessors); iacc < accessor_count; ++iacc) {
+		const gltf_accessor_t* accessor = gltf->accessors + iacc;
+		if (accessor->buffer_view >= view_count)
+			continue;
+		const gltf_buffer_view_t* buffer_view = gltf->buffer_views + accessor->buffer_view;
+		if (!buffer_view->output)
+			continue;
+		gltf_meshopt_view_t* info = view_info + accessor->buffer_view;
+		uint stride = buffer_view->byte_stride;
+		if (!stride)
+			stride = gltf_component_type_size(accessor->component_type) *
+			         gltf_data_type_component_count(accessor->type);
+		if (info->byte_stride && (info->byte_stride != stride))
+			info->byte_stride = GLTF_INVALID_INDEX;
+		else
+			info->byte_stride = stride;
+
+		if ((buffer_view->target == GLTF_BUFFER_TARGET_ELEMENT_ARRAY) && (accessor->type == GLTF_DATA_SCALAR) &&
+		    ((accessor->component_type == GLTF_COMPONENT_UNSIGNED_INT) ||
+		     (accessor->component_type == GLTF_COMPONENT_UNSIGNED_SHORT)))
+			info->mode = GLTF_MESHOPT_INDICES;
+		else if (buffer_view->target == GLTF_BUFFER_TARGET_ARRAY)
+			info->mode = GLTF_MESHOPT_ATTRIBUTES;
+	}
+
+	size_t capacity = 0;
+	for (uint iview = 0; iview < view_count; ++iview) {
+		const gltf_buffer_view_t* buffer_view = gltf->buffer_views + iview;
+		gltf_meshopt_view_t* info = view_info + iview;
+		if (!buffer_view->output)
+			continue;
+		uint stride = info->byte_stride;
+		bool valid_stride = stride && (stride != GLTF_INVALID_INDEX) && !(buffer_view->byte_length % stride);
+		if (info->mode == GLTF_MESHOPT_ATTRIBUTES)
+			valid_stride = valid_stride && !(stride % 4) && (stride <= 256);
+		else if (info->mode == GLTF_MESHOPT_INDICES)
+			valid_stride = valid_stride && ((stride == 2) || (stride == 4));
+		if (!valid_stride)
+			info->mode = GLTF_MESHOPT_NONE;
+
+		if (info->mode != GLTF_MESHOPT_NONE)
+			info->count = buffer_view->byte_length / stride;
+
+		if (info->mode == GLTF_MESHOPT_ATTRIBUTES)
+			capacity += gltf_meshopt_encode_vertex_bound(info->count, stride);
+		else if (info->mode == GLTF_MESHOPT_INDICES)
+			capacity += gltf_meshopt_encode_index_bound(info->count);
+		else
+			capacity += buffer_view->byte_length;
+		capacity += 3;
+	}
+
+	// Each output buffer gets its own compressed buffer, bounding the compressed buffers by the output
+	// buffer size limit instead of growing one buffer with all data. They are stored back to back
+	uint output_count = array_count(gltf->output_buffers);
+	for (uint iview = 0; iview < view_count; ++iview) {
+		if (gltf->buffer_views[iview].output && (gltf->buffer_views[iview].buffer >= output_count)) {
+			log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Buffer view outside output buffer"));
+			array_deallocate(view_info);
+			return false;
+		}
+	}
+
+	size_t* sizes = nullptr;
+	array_resize(sizes, output_count);
+	uint8_t* compressed = memory_allocate(HASH_GLTF, capacity ? capacity : 4, 0, MEMORY_PERSISTENT);
+	size_t offset = 0;
+	for (uint ioutput = 0; ioutput < output_count; ++ioutput) {
+		const virtualarray_t* output = gltf->output_buffers[ioutput];
+		size_t buffer_offset = offset;
+		for (uint iview = 0; iview < view_count; ++iview) {
+			const gltf_buffer_view_t* buffer_view = gltf->buffer_views + iview;
+			gltf_meshopt_view_t* info = view_info + iview;
+			if (!buffer_view->output || (buffer_view->buffer != ioutput))
+				continue;
+			if ((size_t)buffer_view->byte_offset + buffer_view->byte_length > output->count) {
+				log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Buffer view outside output buffer"));
+				memory_deallocate(compressed);
+				array_deallocate(view_info);
+				array_deallocate(sizes);
+				return false;
+			}
+			const void* source = pointer_offset(output->storage, buffer_view->byte_offset);
+
+			size_t length = 0;
+			if (info->mode == GLTF_MESHOPT_ATTRIBUTES)
+				length = gltf_meshopt_encode_vertex(compressed + offset, capacity - offset, source, info->count,
+				                                    info->byte_stride);
+			else if (info->mode == GLTF_MESHOPT_INDICES)
+				length = gltf_meshopt_encode_index(compressed + offset, capacity - offset, source, info->count,
+				                                   info->byte_stride);
+			if (!length) {
+				info->mode = GLTF_MESHOPT_NONE;
+				length = buffer_view->byte_length;
+				memcpy(compressed + offset, source, length);
+			}
+
+			info->byte_offset = offset - buffer_offset;
+			info->byte_length = length;
+
+			// Keep all views four byte aligned
+			offset += length;
+			while (offset % 4)
+				compressed[offset++] = 0;
+		}
+		sizes[ioutput] = offset - buffer_offset;
+	}
+
+	*views = view_info;
+	*buffer = compressed;
+	*buffer_sizes = sizes;
+	return true;
+}
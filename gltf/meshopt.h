@@ -0,0 +1,66 @@
+/* meshopt.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file meshopt.h
+    EXT_meshopt_compression encoding */
+
+#include <gltf/types.h>
+
+/*! Get upper bound of encoded size for a vertex buffer
+\param vertex_count Number of vertices
+\param vertex_size Size of a vertex in bytes, must be a multiple of 4 and at most 256
+\return Maximum encoded size in bytes */
+GLTF_API size_t
+gltf_meshopt_encode_vertex_bound(size_t vertex_count, size_t vertex_size);
+
+/*! Encode a vertex buffer with the meshopt attribute codec
+\param buffer Destination buffer
+\param capacity Capacity of destination buffer
+\param vertices Source vertex data
+\param vertex_count Number of vertices
+\param vertex_size Size of a vertex in bytes, must be a multiple of 4 and at most 256
+\return Encoded size in bytes, 0 if destination buffer too small */
+GLTF_API size_t
+gltf_meshopt_encode_vertex(void* buffer, size_t capacity, const void* vertices, size_t vertex_count,
+                           size_t vertex_size);
+
+/*! Get upper bound of encoded size for an index sequence
+\param index_count Number of indices
+\return Maximum encoded size in bytes */
+GLTF_API size_t
+gltf_meshopt_encode_index_bound(size_t index_count);
+
+/*! Encode an index buffer with the meshopt index sequence codec
+\param buffer Destination buffer
+\param capacity Capacity of destination buffer
+\param indices Source index data
+\param index_count Number of indices
+\param index_size Size of an index in bytes, 2 or 4
+\return Encoded size in bytes, 0 if destination buffer too small */
+GLTF_API size_t
+gltf_meshopt_encode_index(void* buffer, size_t capacity, const void* indices, size_t index_count, size_t index_size);
+
+/*! Compress all vertex and index buffer views in the output buffers into one compressed
+buffer per output buffer. Views that cannot be compressed are copied verbatim to the compressed
+buffer. Views into source buffers are left in place and have no compressed description.
+\param gltf Source glTF data structure
+\param views Receives array of compressed view descriptions, one per buffer view, with offsets
+relative to the compressed buffer of the output buffer of the view
+\param buffer Receives the compressed buffers stored back to back, deallocate with memory_deallocate
+\param buffer_sizes Receives array of compressed buffer sizes, one per output buffer
+\return true if success, false if error */
+GLTF_API bool
+gltf_meshopt_compress(const gltf_t* gltf, gltf_meshopt_view_t** views, void** buffer, size_t** buffer_sizes);
@@ -0,0 +1,227 @@
+/* morph.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "morph.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+
+#include <vector/vector.h>
+
+#include <math.h>
+
+//! Number of vertices blended per block, keeping the destination block in cache across targets
+#define GLTF_MORPH_BLOCK_SIZE 256
+//! Maximum number of targets with nonzero weight tracked without allocation
+#define GLTF_MORPH_LOCAL_TARGETS 64
+
+void
+gltf_morph_initialize(gltf_morph_t* morph) {
+	memset(morph, 0, sizeof(gltf_morph_t));
+}
+
+void
+gltf_morph_finalize(gltf_morph_t* morph) {
+	memory_deallocate(morph->positions);
+	memory_deallocate(morph->normals);
+	memory_deallocate(morph->tangents);
+	for (uint itarget = 0; itarget < morph->target_count; ++itarget) {
+		if (morph->position_deltas)
+			memory_deallocate(morph->position_deltas[itarget]);
+		if (morph->normal_deltas)
+			memory_deallocate(morph->normal_deltas[itarget]);
+		if (morph->tangent_deltas)
+			memory_deallocate(morph->tangent_deltas[itarget]);
+	}
+	memory_deallocate(morph->position_deltas);
+	memory_deallocate(morph->normal_deltas);
+	memory_deallocate(morph->tangent_deltas);
+	gltf_morph_initialize(morph);
+}
+
+//! Read an attribute with the given number of components, leaving the destination null if not given
+static bool
+gltf_morph_read(gltf_t* gltf, uint accessor, uint vertex_count, uint components, float** values) {
+	if (accessor == GLTF_INVALID_INDEX)
+		return true;
+	if ((accessor >= array_count(gltf->accessors)) || (gltf->accessors[accessor].count != vertex_count)) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Morph attribute accessor %u is invalid"), accessor);
+		return false;
+	}
+	*values = memory_allocate(HASH_GLTF, sizeof(float) * components * vertex_count, 16, MEMORY_PERSISTENT);
+	return gltf_accessor_read_float(gltf, accessor, *values, components);
+}
+
+bool
+gltf_morph_build(gltf_morph_t* morph, gltf_t* gltf, uint imesh, uint iprim) {
+	gltf_morph_finalize(morph);
+	if ((imesh >= array_count(gltf->meshes)) || (iprim >= array_count(gltf->meshes[imesh].primitives)))
+		return false;
+
+	const gltf_primitive_t* primitive = gltf->meshes[imesh].primitives + iprim;
+	uint position = primitive->attributes[GLTF_POSITION];
+	if (position >= array_count(gltf->accessors)) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Primitive has no positions"));
+		return false;
+	}
+
+	uint vertex_count = gltf->accessors[position].count;
+	uint target_count = array_count(primitive->targets);
+	morph->vertex_count = vertex_count;
+	morph->target_count = target_count;
+	if (target_count) {
+		size_t table_size = sizeof(float*) * target_count;
+		morph->position_deltas = memory_allocate(HASH_GLTF, table_size, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+		morph->normal_deltas = memory_allocate(HASH_GLTF, table_size, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+		morph->tangent_deltas = memory_allocate(HASH_GLTF, table_size, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	}
+
+	bool success = gltf_morph_read(gltf, position, vertex_count, 3, &morph->positions) &&
+	               gltf_morph_read(gltf, primitive->attributes[GLTF_NORMAL], vertex_count, 3, &morph->normals) &&
+	               gltf_morph_read(gltf, primitive->attributes[GLTF_TANGENT], vertex_count, 4, &morph->tangents);
+	for (uint itarget = 0; success && (itarget < target_count); ++itarget) {
+		const gltf_morph_target_t* target = primitive->targets + itarget;
+		success = gltf_morph_read(gltf, target->position, vertex_count, 3, morph->position_deltas + itarget) &&
+		          gltf_morph_read(gltf, target->normal, vertex_count, 3, morph->normal_deltas + itarget) &&
+		          gltf_morph_read(gltf, target->tangent, vertex_count, 3, morph->tangent_deltas + itarget);
+	}
+
+	if (!success)
+		gltf_morph_finalize(morph);
+	return success;
+}
+
+//! Load four unaligned floats, compiles to a single unaligned vector load
+static FOUNDATION_FORCEINLINE vector_t
+gltf_morph_load(const float* values) {
+	vector_t result;
+	memcpy(&result, values, sizeof(vector_t));
+	return result;
+}
+
+//! Store a vector to four unaligned floats, compiles to a single unaligned vector store
+static FOUNDATION_FORCEINLINE void
+gltf_morph_store(float* values, vector_t value) {
+	memcpy(values, &value, sizeof(vector_t));
+}
+
+//! Blend one attribute for a block of vertices, first copying the base values and then accumulating
+//! each active target delta four floats at a time. Returns true if any target delta was added.
+static bool
+gltf_morph_blend_attribute(const float* base, uint base_components, float* const* deltas, const uint* active,
+                           const float* active_weight, uint active_count, uint start, uint count, float* output) {
+	float* FOUNDATION_RESTRICT block = output + ((size_t)start * base_components);
+	memcpy(block, base + ((size_t)start * base_components), sizeof(float) * base_components * count);
+	bool blended = false;
+	for (uint iactive = 0; iactive < active_count; ++iactive) {
+		const float* FOUNDATION_RESTRICT delta = deltas[active[iactive]];
+		if (!delta)
+			continue;
+		float weight = active_weight[iactive];
+		delta += (size_t)start * 3;
+		blended = true;
+		if (base_components == 3) {
+			// Packed three component values, blend as a flat float array
+			vector_t vweight = vector_uniform(weight);
+			uint value_count = count * 3;
+			uint ivalue = 0;
+			for (; ivalue + 4 <= value_count; ivalue += 4)
+				gltf_morph_store(block + ivalue, vector_muladd(gltf_morph_load(delta + ivalue), vweight,
+				                                               gltf_morph_load(block + ivalue)));
+			for (; ivalue < value_count; ++ivalue)
+				block[ivalue] += delta[ivalue] * weight;
+		} else {
+			// Tangent deltas have no handedness component, zero weight keeps w intact
+			vector_t vweight = vector(weight, weight, weight, 0);
+			for (uint ivertex = 0; ivertex < count; ++ivertex) {
+				float* value = block + (ivertex * 4);
+				const float* offset = delta + (ivertex * 3);
+				gltf_morph_store(value, vector_muladd(vector(offset[0], offset[1], offset[2], 0), vweight,
+				                                      gltf_morph_load(value)));
+			}
+		}
+	}
+	return blended;
+}
+
+//! Normalize the direction of each value in a block, leaving any fourth component and zero length
+//! values untouched
+static void
+gltf_morph_normalize(float* values, uint components, uint start, uint count) {
+	float* FOUNDATION_RESTRICT value = values + ((size_t)start * components);
+	for (uint ivalue = 0; ivalue < count; ++ivalue, value += components) {
+		float length_sqr = (value[0] * value[0]) + (value[1] * value[1]) + (value[2] * value[2]);
+		if (length_sqr > 0) {
+			float scale = 1.0f / sqrtf(length_sqr);
+			value[0] *= scale;
+			value[1] *= scale;
+			value[2] *= scale;
+		}
+	}
+}
+
+void
+gltf_morph_blend(const gltf_morph_t* morph, const float* weights, uint weight_count, uint start, uint end,
+                 float* positions, float* normals, float* tangents) {
+	if (end > morph->vertex_count)
+		end = morph->vertex_count;
+	if (start >= end)
+		return;
+	if (!morph->positions)
+		positions = nullptr;
+	if (!morph->normals)
+		normals = nullptr;
+	if (!morph->tangents)
+		tangents = nullptr;
+
+	// Gather targets with nonzero weight once so the vertex loops only touch contributing deltas
+	uint local_active[GLTF_MORPH_LOCAL_TARGETS];
+	float local_weight[GLTF_MORPH_LOCAL_TARGETS];
+	uint* active = local_active;
+	float* active_weight = local_weight;
+	uint target_count = (weight_count < morph->target_count) ? weight_count : morph->target_count;
+	if (target_count > GLTF_MORPH_LOCAL_TARGETS) {
+		active = memory_allocate(HASH_GLTF, sizeof(uint) * target_count, 0, MEMORY_TEMPORARY);
+		active_weight = memory_allocate(HASH_GLTF, sizeof(float) * target_count, 0, MEMORY_TEMPORARY);
+	}
+	uint active_count = 0;
+	for (uint itarget = 0; itarget < target_count; ++itarget) {
+		if (weights[itarget] != 0) {
+			active[active_count] = itarget;
+			active_weight[active_count++] = weights[itarget];
+		}
+	}
+
+	for (uint block = start; block < end; block += GLTF_MORPH_BLOCK_SIZE) {
+		uint count = end - block;
+		if (count > GLTF_MORPH_BLOCK_SIZE)
+			count = GLTF_MORPH_BLOCK_SIZE;
+		if (positions)
+			gltf_morph_blend_attribute(morph->positions, 3, morph->position_deltas, active, active_weight,
+			                           active_count, block, count, positions);
+		if (normals && gltf_morph_blend_attribute(morph->normals, 3, morph->normal_deltas, active, active_weight,
+		                                          active_count, block, count, normals))
+			gltf_morph_normalize(normals, 3, block, count);
+		if (tangents && gltf_morph_blend_attribute(morph->tangents, 4, morph->tangent_deltas, active, active_weight,
+		                                           active_count, block, count, tangents))
+			gltf_morph_normalize(tangents, 4, block, count);
+	}
+
+	if (active != local_active) {
+		memory_deallocate(active);
+		memory_deallocate(active_weight);
+	}
+}
@@ -0,0 +1,56 @@
+/* morph.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file morph.h
+    Morph target blending of primitive vertices */
+
+#include "gltf.h"
+
+/*! Initialize empty morph data
+\param morph Morph data */
+GLTF_API void
+gltf_morph_initialize(gltf_morph_t* morph);
+
+/*! Release all memory held by morph data
+\param morph Morph data */
+GLTF_API void
+gltf_morph_finalize(gltf_morph_t* morph);
+
+/*! Decode base positions, normals and tangents of a primitive along with the deltas of all
+morph targets. Targets given by sparse accessors, with or without a buffer view, are expanded.
+\param morph Morph data, previous content is released
+\param gltf glTF data structure
+\param mesh Mesh index
+\param primitive Primitive index in mesh
+\return true if success, false if attributes are missing or invalid */
+GLTF_API bool
+gltf_morph_build(gltf_morph_t* morph, gltf_t* gltf, uint mesh, uint primitive);
+
+/*! Blend the weighted target deltas onto the base attributes for a range of vertices. All
+targets are accumulated in a single pass over the destination, targets with a zero weight are
+skipped. Normals and tangent directions changed by any target are renormalized, the tangent
+handedness is kept from the base tangent.
+\param morph Morph data
+\param weights Weight of each target
+\param weight_count Number of weights, missing weights are treated as zero
+\param start First vertex
+\param end One past last vertex
+\param positions Destination of blended positions (x, y, z) indexed by vertex, null to skip
+\param normals Destination of blended normals (x, y, z) indexed by vertex, null to skip
+\param tangents Destination of blended tangents (x, y, z, w) indexed by vertex, null to skip */
+GLTF_API void
+gltf_morph_blend(const gltf_morph_t* morph, const float* weights, uint weight_count, uint start, uint end,
+                 float* positions, float* normals, float* tangents);
@@ -20,17 +20,17 @@
 #include <foundation/array.h>
 #include <foundation/log.h>
 #include <foundation/hashstrings.h>
+#include <foundation/math.h>
+
+#include <math.h>
+#include <stdlib.h>
 
 void
 gltf_nodes_finalize(gltf_t* gltf) {
-	if (gltf->nodes) {
-		for (uint inode = 0, nodes_count = array_count(gltf->nodes); inode < nodes_count; ++inode) {
-			gltf_node_t* node = gltf->nodes + inode;
-			if (node->children_ext)
-				memory_deallocate(node->children_ext);
-		}
-		array_deallocate(gltf->nodes);
-	}
+	for (uint inode = 0, node_count = array_count(gltf->nodes); inode < node_count; ++inode)
+		array_deallocate(gltf->nodes[inode].instancing.attributes_custom);
+	array_deallocate(gltf->nodes);
+	array_deallocate(gltf->node_children);
 }
 
 static void
@@ -38,7 +38,7 @@ gltf_transform_initialize(gltf_transform_t* transform) {
 	transform->scale[0] = transform->scale[1] = transform->scale[2] = 1.0;
 	transform->rotation[0] = transform->rotation[1] = transform->rotation[2] = 0.0;
 	transform->rotation[3] = 1.0;
-	transform->translation[0] = transform->translation[0] = transform->translation[0] = 0.0;
+	transform->translation[0] = transform->translation[1] = transform->translation[2] = 0.0;
 	memset(transform->matrix, 0, sizeof(transform->matrix));
 	transform->matrix[0][0] = 1.0;
 	transform->matrix[1][1] = 1.0;
@@ -49,13 +49,69 @@ gltf_transform_initialize(gltf_transform_t* transform) {
 
 static void
 gltf_node_initialize(gltf_node_t* node) {
+	memset(node, 0, sizeof(gltf_node_t));
 	node->mesh = GLTF_INVALID_INDEX;
-	node->children_count = 0;
-	node->children_ext = nullptr;
+	node->skin = GLTF_INVALID_INDEX;
+	node->instancing.translation = GLTF_INVALID_INDEX;
+	node->instancing.rotation = GLTF_INVALID_INDEX;
+	node->instancing.scale = GLTF_INVALID_INDEX;
 
 	gltf_transform_initialize(&node->transform);
 }
 
+static bool
+gltf_node_parse_instancing(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken,
+                           gltf_instancing_t* instancing) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Node instancing extension has invalid type"));
+		return false;
+	}
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		if ((string_hash(STRING_ARGS(identifier)) == HASH_ATTRIBUTES) && (tokens[itoken].type == JSON_OBJECT)) {
+			size_t iattrib = tokens[itoken].child;
+			while (iattrib) {
+				string_const_t semantic = json_token_identifier(gltf->buffer, tokens + iattrib);
+				uint* accessor = nullptr;
+				if (string_equal(STRING_ARGS(semantic), STRING_CONST("TRANSLATION"))) {
+					accessor = &instancing->translation;
+				} else if (string_equal(STRING_ARGS(semantic), STRING_CONST("ROTATION"))) {
+					accessor = &instancing->rotation;
+				} else if (string_equal(STRING_ARGS(semantic), STRING_CONST("SCALE"))) {
+					accessor = &instancing->scale;
+				} else {
+					gltf_attribute_t attribute = {semantic, GLTF_INVALID_INDEX};
+					array_push(instancing->attributes_custom, attribute);
+					accessor = &instancing->attributes_custom[array_count(instancing->attributes_custom) - 1].accessor;
+				}
+				if (!gltf_token_to_integer(gltf, data, tokens, iattrib, accessor))
+					return false;
+				iattrib = tokens[iattrib].sibling;
+			}
+		}
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+static bool
+gltf_node_parse_extensions(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken, gltf_node_t* node) {
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		if (string_equal(STRING_ARGS(identifier), STRING_CONST("EXT_mesh_gpu_instancing")) &&
+		    !gltf_node_parse_instancing(gltf, data, tokens, itoken, &node->instancing))
+			return false;
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
 static bool
 gltf_nodes_parse_node(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken, gltf_node_t* node) {
 	if (tokens[itoken].type != JSON_OBJECT)
@@ -70,17 +126,18 @@ gltf_nodes_parse_node(gltf_t* gltf, const char* data, json_token_t* tokens, size
 		if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING))
 			node->name = json_token_value(data, tokens + itoken);
 		else if (identifier_hash == HASH_CHILDREN) {
-			uint* children = node->children_base;
+			// Children are appended to the shared array, nodes are parsed in order so the ranges stay sorted
+			node->children_offset = array_count(gltf->node_children);
 			node->children_count = tokens[itoken].value_length;
-			if (node->children_count > GLTF_NODE_BASE_CHILDREN) {
-				node->children_ext =
-				    memory_allocate(HASH_GLTF, sizeof(uint) * node->children_count, 0, MEMORY_PERSISTENT);
-				children = node->children_ext;
-			}
-			if (!gltf_token_to_integer_array(gltf, data, tokens, itoken, children, node->children_count))
+			array_resize(gltf->node_children, node->children_offset + node->children_count);
+			if (!gltf_token_to_integer_array(gltf, data, tokens, itoken, gltf->node_children + node->children_offset,
+			                                 node->children_count))
 				return false;
 		} else if ((identifier_hash == HASH_MESH) && !gltf_token_to_integer(gltf, data, tokens, itoken, &node->mesh))
 			return false;
+		else if (string_equal(STRING_ARGS(identifier), STRING_CONST("skin")) &&
+		         !gltf_token_to_integer(gltf, data, tokens, itoken, &node->skin))
+			return false;
 
 		else if ((identifier_hash == HASH_SCALE) &&
 		         !gltf_token_to_real_array(gltf, data, tokens, itoken, (real*)node->transform.scale, 3))
@@ -95,8 +152,13 @@ gltf_nodes_parse_node(gltf_t* gltf, const char* data, json_token_t* tokens, size
 			node->transform.has_matrix = true;
 			if (!gltf_token_to_real_array(gltf, data, tokens, itoken, (real*)node->transform.matrix, 16))
 				return false;
-		} else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			node->extensions = json_token_value(data, tokens + itoken);
+		} else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_OBJECT) &&
+		           !gltf_node_parse_extensions(gltf, data, tokens, itoken, node))
+			return false;
+		// Built in extensions are decoded above, registered handlers are called for all extensions
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_NODE, node, &node->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			node->extras = json_token_value(data, tokens + itoken);
 
@@ -118,6 +180,7 @@ gltf_nodes_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t it
 		return false;
 
 	array_resize(gltf->nodes, nodes_count);
+	array_clear(gltf->node_children);
 
 	if (!nodes_count)
 		return true;
@@ -127,6 +190,8 @@ gltf_nodes_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t it
 	while (inode) {
 		if (!gltf_nodes_parse_node(gltf, data, tokens, inode, gltf->nodes + icounter))
 			return false;
+		gltf->nodes[icounter].source = gltf_token_source(gltf, data, tokens, inode);
+		gltf->nodes[icounter].dirty = false;
 		inode = tokens[inode].sibling;
 		++icounter;
 	}
@@ -136,7 +201,8 @@ gltf_nodes_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t it
 
 uint
 gltf_node_add(gltf_t* gltf, const char* name, size_t name_length, uint mesh_index, const matrix_t* transform) {
-	gltf_node_t gltf_node = {0};
+	gltf_node_t gltf_node;
+	gltf_node_initialize(&gltf_node);
 
 	string_t node_name = string_clone(name, name_length);
 	array_push(gltf->string_array, node_name);
@@ -156,3 +222,463 @@ gltf_node_add(gltf_t* gltf, const char* name, size_t name_length, uint mesh_inde
 
 	return (array_count(gltf->nodes) - 1);
 }
+
+const uint*
+gltf_node_children(const gltf_t* gltf, const gltf_node_t* node) {
+	return node->children_count ? (gltf->node_children + node->children_offset) : nullptr;
+}
+
+void
+gltf_node_add_child(gltf_t* gltf, uint parent, uint child) {
+	gltf_node_t* node = gltf->nodes + parent;
+	uint children_end = node->children_offset + node->children_count;
+	if (node->children_count && (children_end != array_count(gltf->node_children))) {
+		// Move the range to the end of the array so it can grow, leaving the previous range unused
+		uint offset = array_count(gltf->node_children);
+		array_resize(gltf->node_children, offset + node->children_count);
+		memcpy(gltf->node_children + offset, gltf->node_children + node->children_offset,
+		       sizeof(uint) * node->children_count);
+		node->children_offset = offset;
+	} else if (!node->children_count) {
+		node->children_offset = array_count(gltf->node_children);
+	}
+	array_push(gltf->node_children, child);
+	++node->children_count;
+	node->dirty = true;
+}
+
+bool
+gltf_node_is_instanced(const gltf_node_t* node) {
+	return (node->instancing.translation != GLTF_INVALID_INDEX) ||
+	       (node->instancing.rotation != GLTF_INVALID_INDEX) || (node->instancing.scale != GLTF_INVALID_INDEX);
+}
+
+uint
+gltf_node_instance_count(const gltf_t* gltf, const gltf_node_t* node) {
+	uint accessors[3] = {node->instancing.translation, node->instancing.rotation, node->instancing.scale};
+	for (uint iattrib = 0; iattrib < 3; ++iattrib) {
+		if (accessors[iattrib] < array_count(gltf->accessors))
+			return gltf->accessors[accessors[iattrib]].count;
+	}
+	return 0;
+}
+
+bool
+gltf_node_instance_matrices(gltf_t* gltf, const gltf_node_t* node, const matrix_t* transform, matrix_t* matrices) {
+	uint count = gltf_node_instance_count(gltf, node);
+	if (!count)
+		return true;
+
+	// Attributes default to the identity transform when not present
+	float* translation = memory_allocate(HASH_GLTF, sizeof(float) * 10 * count, 0, MEMORY_TEMPORARY);
+	float* rotation = translation + (3 * count);
+	float* scale = rotation + (4 * count);
+	for (uint iinst = 0; iinst < count; ++iinst) {
+		translation[(iinst * 3) + 0] = translation[(iinst * 3) + 1] = translation[(iinst * 3) + 2] = 0;
+		rotation[(iinst * 4) + 0] = rotation[(iinst * 4) + 1] = rotation[(iinst * 4) + 2] = 0;
+		rotation[(iinst * 4) + 3] = 1;
+		scale[(iinst * 3) + 0] = scale[(iinst * 3) + 1] = scale[(iinst * 3) + 2] = 1;
+	}
+
+	uint accessors[3] = {node->instancing.translation, node->instancing.rotation, node->instancing.scale};
+	float* values[3] = {translation, rotation, scale};
+	uint components[3] = {3, 4, 3};
+	for (uint iattrib = 0; iattrib < 3; ++iattrib) {
+		if (accessors[iattrib] == GLTF_INVALID_INDEX)
+			continue;
+		if ((accessors[iattrib] >= array_count(gltf->accessors)) ||
+		    (gltf->accessors[accessors[iattrib]].count != count) ||
+		    !gltf_accessor_read_float(gltf, accessors[iattrib], values[iattrib], components[iattrib])) {
+			log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Invalid node instance attribute accessor"));
+			memory_deallocate(translation);
+			return false;
+		}
+	}
+
+	for (uint iinst = 0; iinst < count; ++iinst) {
+		const float* t = translation + (iinst * 3);
+		const float* r = rotation + (iinst * 4);
+		const float* s = scale + (iinst * 3);
+		float xx = r[0] * r[0], yy = r[1] * r[1], zz = r[2] * r[2];
+		float xy = r[0] * r[1], xz = r[0] * r[2], yz = r[1] * r[2];
+		float wx = r[3] * r[0], wy = r[3] * r[1], wz = r[3] * r[2];
+		matrix_t local;
+		local.frow[0][0] = (1.0f - 2.0f * (yy + zz)) * s[0];
+		local.frow[0][1] = 2.0f * (xy + wz) * s[0];
+		local.frow[0][2] = 2.0f * (xz - wy) * s[0];
+		local.frow[0][3] = 0;
+		local.frow[1][0] = 2.0f * (xy - wz) * s[1];
+		local.frow[1][1] = (1.0f - 2.0f * (xx + zz)) * s[1];
+		local.frow[1][2] = 2.0f * (yz + wx) * s[1];
+		local.frow[1][3] = 0;
+		local.frow[2][0] = 2.0f * (xz + wy) * s[2];
+		local.frow[2][1] = 2.0f * (yz - wx) * s[2];
+		local.frow[2][2] = (1.0f - 2.0f * (xx + yy)) * s[2];
+		local.frow[2][3] = 0;
+		local.frow[3][0] = t[0];
+		local.frow[3][1] = t[1];
+		local.frow[3][2] = t[2];
+		local.frow[3][3] = 1.0f;
+
+		matrix_t* result = matrices + iinst;
+		if (!transform) {
+			*result = local;
+			continue;
+		}
+		// Instance transforms apply before the node transform
+		gltf_hierarchy_multiply(result, &local, transform);
+	}
+
+	memory_deallocate(translation);
+	return true;
+}
+
+//! Check if a node transform is a translation, rotation and scale without shear or projection,
+//! allowing a small deviation from orthogonal axes for rounding in stored matrices
+static bool
+gltf_transform_is_decomposable(const gltf_transform_t* transform) {
+	if (!transform->has_matrix)
+		return true;
+
+	const real(*column)[4] = transform->matrix;
+	if ((column[0][3] != 0) || (column[1][3] != 0) || (column[2][3] != 0) || (column[3][3] != 1))
+		return false;
+	for (uint iaxis = 0; iaxis < 3; ++iaxis) {
+		const real* axis = column[iaxis];
+		const real* other = column[(iaxis + 1) % 3];
+		real dot = (axis[0] * other[0]) + (axis[1] * other[1]) + (axis[2] * other[2]);
+		real axis_length_sqr = (axis[0] * axis[0]) + (axis[1] * axis[1]) + (axis[2] * axis[2]);
+		real other_length_sqr = (other[0] * other[0]) + (other[1] * other[1]) + (other[2] * other[2]);
+		if ((dot * dot) > (REAL_C(0.000001) * axis_length_sqr * other_length_sqr))
+			return false;
+	}
+	return true;
+}
+
+//! Decompose a node transform into translation, rotation quaternion and scale, the transform
+//! must be decomposable
+static void
+gltf_transform_decompose(const gltf_transform_t* transform, float* translation, float* rotation, float* scale) {
+	if (!transform->has_matrix) {
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			translation[icomp] = (float)transform->translation[icomp];
+			scale[icomp] = (float)transform->scale[icomp];
+		}
+		for (uint icomp = 0; icomp < 4; ++icomp)
+			rotation[icomp] = (float)transform->rotation[icomp];
+		return;
+	}
+
+	// Matrix is stored as columns, the first three columns are the scaled rotation axes
+	const real(*column)[4] = transform->matrix;
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		translation[icomp] = (float)column[3][icomp];
+		scale[icomp] = (float)math_sqrt((column[icomp][0] * column[icomp][0]) + (column[icomp][1] * column[icomp][1]) +
+		                                (column[icomp][2] * column[icomp][2]));
+	}
+	real determinant = column[0][0] * ((column[1][1] * column[2][2]) - (column[1][2] * column[2][1])) -
+	                   column[0][1] * ((column[1][0] * column[2][2]) - (column[1][2] * column[2][0])) +
+	                   column[0][2] * ((column[1][0] * column[2][1]) - (column[1][1] * column[2][0]));
+	if (determinant < 0)
+		scale[0] = -scale[0];
+
+	// Rotation matrix element m[row][col] is the row component of the normalized column axis
+	float m[3][3];
+	for (uint icol = 0; icol < 3; ++icol) {
+		float inv_scale = (scale[icol] != 0) ? (1.0f / scale[icol]) : 0;
+		for (uint irow = 0; irow < 3; ++irow)
+			m[irow][icol] = (float)column[icol][irow] * inv_scale;
+	}
+	float trace = m[0][0] + m[1][1] + m[2][2];
+	if (trace > 0) {
+		float s = sqrtf(trace + 1.0f) * 2.0f;
+		rotation[0] = (m[2][1] - m[1][2]) / s;
+		rotation[1] = (m[0][2] - m[2][0]) / s;
+		rotation[2] = (m[1][0] - m[0][1]) / s;
+		rotation[3] = 0.25f * s;
+	} else if ((m[0][0] > m[1][1]) && (m[0][0] > m[2][2])) {
+		float s = sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+		rotation[0] = 0.25f * s;
+		rotation[1] = (m[0][1] + m[1][0]) / s;
+		rotation[2] = (m[0][2] + m[2][0]) / s;
+		rotation[3] = (m[2][1] - m[1][2]) / s;
+	} else if (m[1][1] > m[2][2]) {
+		float s = sqrtf(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+		rotation[0] = (m[0][1] + m[1][0]) / s;
+		rotation[1] = 0.25f * s;
+		rotation[2] = (m[1][2] + m[2][1]) / s;
+		rotation[3] = (m[0][2] - m[2][0]) / s;
+	} else {
+		float s = sqrtf(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+		rotation[0] = (m[0][2] + m[2][0]) / s;
+		rotation[1] = (m[1][2] + m[2][1]) / s;
+		rotation[2] = 0.25f * s;
+		rotation[3] = (m[1][0] - m[0][1]) / s;
+	}
+	float length = sqrtf((rotation[0] * rotation[0]) + (rotation[1] * rotation[1]) +
+	                     (rotation[2] * rotation[2]) + (rotation[3] * rotation[3]));
+	for (uint icomp = 0; icomp < 4; ++icomp)
+		rotation[icomp] = (length > 0) ? (rotation[icomp] / length) : ((icomp == 3) ? 1.0f : 0);
+}
+
+//! Add a float accessor with its own buffer view over data in an output buffer
+static uint
+gltf_node_instance_accessor(gltf_t* gltf, uint buffer, size_t offset, const float* values, uint count,
+                            gltf_data_type type) {
+	uint components = gltf_data_type_component_count(type);
+	gltf_buffer_view_t buffer_view = {0};
+	buffer_view.buffer = buffer;
+	buffer_view.output = true;
+	buffer_view.byte_offset = (uint)offset;
+	buffer_view.byte_length = (uint)(sizeof(float) * components * count);
+
+	gltf_accessor_t accessor = {0};
+	accessor.type = type;
+	accessor.component_type = GLTF_COMPONENT_FLOAT;
+	accessor.count = count;
+	accessor.buffer_view = array_count(gltf->buffer_views);
+	for (uint icomp = 0; icomp < components; ++icomp) {
+		accessor.min[icomp] = REAL_MAX;
+		accessor.max[icomp] = -REAL_MAX;
+	}
+	for (uint iinst = 0; iinst < count; ++iinst) {
+		for (uint icomp = 0; icomp < components; ++icomp) {
+			real value = values[(iinst * components) + icomp];
+			accessor.min[icomp] = (value < accessor.min[icomp]) ? value : accessor.min[icomp];
+			accessor.max[icomp] = (value > accessor.max[icomp]) ? value : accessor.max[icomp];
+		}
+	}
+
+	array_push(gltf->buffer_views, buffer_view);
+	array_push(gltf->accessors, accessor);
+	return array_count(gltf->accessors) - 1;
+}
+
+typedef struct gltf_node_instance_t {
+	//! Mesh index
+	uint mesh;
+	//! Position in sibling list
+	uint position;
+} gltf_node_instance_t;
+
+static int
+gltf_node_instance_compare(const void* lhs, const void* rhs) {
+	const gltf_node_instance_t* first = lhs;
+	const gltf_node_instance_t* second = rhs;
+	if (first->mesh != second->mesh)
+		return (first->mesh < second->mesh) ? -1 : 1;
+	return (first->position < second->position) ? -1 : ((first->position > second->position) ? 1 : 0);
+}
+
+//! Convert the first node of a group of siblings into an instanced node holding the transforms of
+//! all nodes in the group
+static bool
+gltf_node_instance_group(gltf_t* gltf, const uint* siblings, const gltf_node_instance_t* group, uint count) {
+	uint buffer = 0;
+	size_t offset = 0;
+	void* data = nullptr;
+	if (!gltf_buffer_output_allocate(gltf, sizeof(float) * 10 * count, &buffer, &offset, &data))
+		return false;
+
+	float* translation = data;
+	float* rotation = translation + (3 * count);
+	float* scale = rotation + (4 * count);
+	for (uint iinst = 0; iinst < count; ++iinst)
+		gltf_transform_decompose(&gltf->nodes[siblings[group[iinst].position]].transform,
+		                         translation + (iinst * 3), rotation + (iinst * 4), scale + (iinst * 3));
+
+	uint accessors_count = array_count(gltf->accessors);
+	uint buffer_views_count = array_count(gltf->buffer_views);
+	uint translation_accessor = gltf_node_instance_accessor(gltf, buffer, offset, translation, count, GLTF_DATA_VEC3);
+	uint rotation_accessor = gltf_node_instance_accessor(gltf, buffer, offset + (sizeof(float) * 3 * count),
+	                                                     rotation, count, GLTF_DATA_VEC4);
+	uint scale_accessor = gltf_node_instance_accessor(gltf, buffer, offset + (sizeof(float) * 7 * count), scale,
+	                                                  count, GLTF_DATA_VEC3);
+	if (!gltf_buffer_output_flush(gltf)) {
+		array_resize(gltf->accessors, accessors_count);
+		array_resize(gltf->buffer_views, buffer_views_count);
+		return false;
+	}
+
+	gltf_node_t* node = gltf->nodes + siblings[group[0].position];
+	node->instancing.translation = translation_accessor;
+	node->instancing.rotation = rotation_accessor;
+	node->instancing.scale = scale_accessor;
+	gltf_transform_initialize(&node->transform);
+	node->dirty = true;
+	return true;
+}
+
+//! Collapse groups of sibling leaf nodes sharing a mesh, compacting the sibling list and flagging
+//! removed nodes in the remap array. Nodes flagged as locked are referenced elsewhere and kept.
+static bool
+gltf_node_collapse_siblings(gltf_t* gltf, uint* siblings, uint* count, uint min_count, uint* remap,
+                            const bool* locked, gltf_node_instance_t** candidates) {
+	uint mesh_count = array_count(gltf->meshes);
+	uint node_count = array_count(gltf->nodes);
+	array_clear(*candidates);
+	for (uint isibling = 0; isibling < *count; ++isibling) {
+		uint inode = siblings[isibling];
+		if (inode >= node_count)
+			continue;
+		const gltf_node_t* node = gltf->nodes + inode;
+		if ((node->mesh >= mesh_count) || node->children_count || gltf_node_is_instanced(node) ||
+		    (node->skin != GLTF_INVALID_INDEX) || node->extensions.length || node->extras.length || locked[inode] ||
+		    !gltf_transform_is_decomposable(&node->transform))
+			continue;
+		gltf_node_instance_t candidate = {node->mesh, isibling};
+		array_push(*candidates, candidate);
+	}
+
+	uint candidate_count = array_count(*candidates);
+	if (candidate_count < min_count)
+		return true;
+	qsort(*candidates, candidate_count, sizeof(gltf_node_instance_t), gltf_node_instance_compare);
+
+	bool collapsed = false;
+	for (uint igroup = 0; igroup < candidate_count;) {
+		uint iend = igroup + 1;
+		while ((iend < candidate_count) && ((*candidates)[iend].mesh == (*candidates)[igroup].mesh))
+			++iend;
+		if ((iend - igroup) >= min_count) {
+			if (!gltf_node_instance_group(gltf, siblings, *candidates + igroup, iend - igroup))
+				return false;
+			for (uint iinst = igroup + 1; iinst < iend; ++iinst)
+				remap[siblings[(*candidates)[iinst].position]] = GLTF_INVALID_INDEX;
+			collapsed = true;
+		}
+		igroup = iend;
+	}
+
+	if (collapsed) {
+		uint kept = 0;
+		for (uint isibling = 0; isibling < *count; ++isibling) {
+			if ((siblings[isibling] >= node_count) || (remap[siblings[isibling]] != GLTF_INVALID_INDEX))
+				siblings[kept++] = siblings[isibling];
+		}
+		*count = kept;
+	}
+	return true;
+}
+
+bool
+gltf_node_collapse_instances(gltf_t* gltf, uint min_count) {
+	uint node_count = array_count(gltf->nodes);
+	if (min_count < 2)
+		min_count = 2;
+
+	uint* remap = memory_allocate(HASH_GLTF, sizeof(uint) * math_max(node_count, 1U), 0, MEMORY_PERSISTENT);
+	for (uint inode = 0; inode < node_count; ++inode)
+		remap[inode] = inode;
+
+	// Animated nodes and skeleton nodes keep their own transform
+	bool* locked = memory_allocate(HASH_GLTF, sizeof(bool) * math_max(node_count, 1U), 0,
+	                               MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	for (uint ianim = 0, animation_count = array_count(gltf->animations); ianim < animation_count; ++ianim) {
+		const gltf_animation_t* animation = gltf->animations + ianim;
+		for (uint ichannel = 0, channel_count = array_count(animation->channels); ichannel < channel_count;
+		     ++ichannel) {
+			if (animation->channels[ichannel].node < node_count)
+				locked[animation->channels[ichannel].node] = true;
+		}
+	}
+	for (uint iskin = 0, skin_count = array_count(gltf->skins); iskin < skin_count; ++iskin) {
+		const gltf_skin_t* skin = gltf->skins + iskin;
+		for (uint ijoint = 0, joint_count = array_count(skin->joints); ijoint < joint_count; ++ijoint) {
+			if (skin->joints[ijoint] < node_count)
+				locked[skin->joints[ijoint]] = true;
+		}
+		if (skin->skeleton < node_count)
+			locked[skin->skeleton] = true;
+	}
+
+	bool success = true;
+	gltf_node_instance_t* candidates = nullptr;
+	for (uint iscene = 0, scene_count = array_count(gltf->scenes); success && (iscene < scene_count); ++iscene) {
+		gltf_scene_t* scene = gltf->scenes + iscene;
+		uint count = array_count(scene->nodes);
+		success = gltf_node_collapse_siblings(gltf, scene->nodes, &count, min_count, remap, locked, &candidates);
+		if (count != array_count(scene->nodes)) {
+			array_resize(scene->nodes, count);
+			scene->dirty = true;
+		}
+	}
+	for (uint inode = 0; success && (inode < node_count); ++inode) {
+		gltf_node_t* node = gltf->nodes + inode;
+		if (!node->children_count)
+			continue;
+		uint count = node->children_count;
+		success = gltf_node_collapse_siblings(gltf, gltf->node_children + node->children_offset, &count, min_count,
+		                                      remap, locked, &candidates);
+		if (count != node->children_count) {
+			node->children_count = count;
+			node->dirty = true;
+		}
+	}
+	array_deallocate(candidates);
+
+	// Compact the node array and rewrite references to moved nodes
+	uint kept = 0;
+	for (uint inode = 0; inode < node_count; ++inode) {
+		if (remap[inode] == GLTF_INVALID_INDEX) {
+			array_deallocate(gltf->nodes[inode].instancing.attributes_custom);
+			continue;
+		}
+		remap[inode] = kept;
+		if (kept != inode)
+			gltf->nodes[kept] = gltf->nodes[inode];
+		++kept;
+	}
+	if (kept != node_count) {
+		// Node bounds are indexed by node, release all computed bounds rather than keep them partially valid
+		gltf_bounds_finalize(gltf);
+		array_resize(gltf->nodes, kept);
+		for (uint inode = 0; inode < kept; ++inode) {
+			gltf_node_t* node = gltf->nodes + inode;
+			uint* children = gltf->node_children + node->children_offset;
+			for (uint ichild = 0; ichild < node->children_count; ++ichild) {
+				if ((children[ichild] < node_count) && (remap[children[ichild]] != children[ichild])) {
+					children[ichild] = remap[children[ichild]];
+					node->dirty = true;
+				}
+			}
+		}
+		for (uint iscene = 0, scene_count = array_count(gltf->scenes); iscene < scene_count; ++iscene) {
+			gltf_scene_t* scene = gltf->scenes + iscene;
+			for (uint iroot = 0, root_count = array_count(scene->nodes); iroot < root_count; ++iroot) {
+				if ((scene->nodes[iroot] < node_count) && (remap[scene->nodes[iroot]] != scene->nodes[iroot])) {
+					scene->nodes[iroot] = remap[scene->nodes[iroot]];
+					scene->dirty = true;
+				}
+			}
+		}
+		for (uint ianim = 0, animation_count = array_count(gltf->animations); ianim < animation_count; ++ianim) {
+			gltf_animation_t* animation = gltf->animations + ianim;
+			for (uint ichannel = 0, channel_count = array_count(animation->channels); ichannel < channel_count;
+			     ++ichannel) {
+				uint* target = &animation->channels[ichannel].node;
+				if ((*target < node_count) && (remap[*target] != *target)) {
+					*target = remap[*target];
+					animation->dirty = true;
+				}
+			}
+		}
+		for (uint iskin = 0, skin_count = array_count(gltf->skins); iskin < skin_count; ++iskin) {
+			gltf_skin_t* skin = gltf->skins + iskin;
+			for (uint ijoint = 0, joint_count = array_count(skin->joints); ijoint < joint_count; ++ijoint) {
+				if ((skin->joints[ijoint] < node_count) && (remap[skin->joints[ijoint]] != skin->joints[ijoint])) {
+					skin->joints[ijoint] = remap[skin->joints[ijoint]];
+					skin->dirty = true;
+				}
+			}
+			if ((skin->skeleton < node_count) && (remap[skin->skeleton] != skin->skeleton)) {
+				skin->skeleton = remap[skin->skeleton];
+				skin->dirty = true;
+			}
+		}
+	}
+
+	memory_deallocate(locked);
+	memory_deallocate(remap);
+	return success;
+}
@@ -24,3 +24,54 @@ gltf_nodes_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t
 
 GLTF_API uint
 gltf_node_add(gltf_t* gltf, const char* name, size_t name_length, uint mesh_index, const matrix_t* transform);
+
+/*! Get the child node indices of a node
+\param gltf glTF data structure
+\param node Node
+\return Array of node children_count child node indices, null if node has no children */
+GLTF_API const uint*
+gltf_node_children(const gltf_t* gltf, const gltf_node_t* node);
+
+/*! Add a child to a node. The child range of the node is moved to the end of the node children
+array if it is not already last, leaving the previous range unused.
+\param gltf glTF data structure
+\param parent Parent node index
+\param child Child node index */
+GLTF_API void
+gltf_node_add_child(gltf_t* gltf, uint parent, uint child);
+
+/*! Query if a node has EXT_mesh_gpu_instancing attributes
+\param node Node
+\return true if node is instanced, false if not */
+GLTF_API bool
+gltf_node_is_instanced(const gltf_node_t* node);
+
+/*! Get the number of EXT_mesh_gpu_instancing instances of a node
+\param gltf glTF data structure
+\param node Node
+\return Number of instances, zero if node is not instanced */
+GLTF_API uint
+gltf_node_instance_count(const gltf_t* gltf, const gltf_node_t* node);
+
+/*! Compute the transform of each EXT_mesh_gpu_instancing instance of a node
+\param gltf glTF data structure
+\param node Node
+\param transform Node world transform to apply after each instance transform, or null for
+instance transforms relative to the node
+\param matrices Destination, must hold gltf_node_instance_count matrices and not overlap the transform
+\return true if success, false if error */
+GLTF_API bool
+gltf_node_instance_matrices(gltf_t* gltf, const gltf_node_t* node, const matrix_t* transform, matrix_t* matrices);
+
+/*! Collapse sibling leaf nodes sharing a mesh into a single EXT_mesh_gpu_instancing node with
+translation, rotation and scale accessors in the output buffers. The first node of each group is
+kept and the remaining nodes are removed, with node indices in scenes and node children remapped.
+Nodes with children, extensions, extras or a matrix with shear or projection are left untouched.
+Computed bounds are released if any node is removed and must be recomputed.
+Instance data is added to the output buffers, so this is intended for data structures built with
+gltf_mesh_add_mesh and gltf_node_add.
+\param gltf glTF data structure
+\param min_count Minimum number of siblings sharing a mesh to collapse, at least two
+\return true if success, false if error */
+GLTF_API bool
+gltf_node_collapse_instances(gltf_t* gltf, uint min_count);
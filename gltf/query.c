@@ -0,0 +1,229 @@
+/* query.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "query.h"
+
+#include <foundation/memory.h>
+#include <foundation/json.h>
+#include <foundation/hashstrings.h>
+
+#define GLTF_QUERY_MAX_KEY_LENGTH 256
+
+void
+gltf_query_finalize(gltf_t* gltf) {
+	gltf_token_tree_t* tree = &gltf->token_tree;
+	memory_deallocate(tree->tokens);
+	memory_deallocate(tree->arrays);
+	memory_deallocate(tree->array_offset);
+	memory_deallocate(tree->elements);
+	memory_deallocate(tree->key_hash);
+	memset(tree, 0, sizeof(gltf_token_tree_t));
+}
+
+void
+gltf_query_retain(gltf_t* gltf, const json_token_t* tokens, size_t token_count) {
+	gltf_query_finalize(gltf);
+	if (!token_count || (token_count > GLTF_MAX_INDEX) || (tokens[0].type != JSON_OBJECT))
+		return;
+
+	gltf_token_tree_t* tree = &gltf->token_tree;
+	tree->count = (uint)token_count;
+	tree->tokens = memory_allocate(HASH_GLTF, sizeof(json_token_t) * token_count, 0, MEMORY_PERSISTENT);
+	memcpy(tree->tokens, tokens, sizeof(json_token_t) * token_count);
+
+	// Hash member names once so member lookups compare hashes before strings
+	tree->key_hash = memory_allocate(HASH_GLTF, sizeof(hash_t) * token_count, 0, MEMORY_PERSISTENT);
+	for (uint itoken = 0; itoken < tree->count; ++itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		tree->key_hash[itoken] = string_hash(STRING_ARGS(identifier));
+	}
+
+	// Index the elements of top level arrays to make lookups like a node by index constant time
+	uint array_count = 0;
+	uint element_count = 0;
+	for (uint itoken = tokens[0].child; itoken; itoken = tokens[itoken].sibling) {
+		if (tokens[itoken].type == JSON_ARRAY) {
+			++array_count;
+			element_count += tokens[itoken].value_length;
+		}
+	}
+	if (!array_count)
+		return;
+
+	tree->arrays = memory_allocate(HASH_GLTF, sizeof(uint) * array_count, 0, MEMORY_PERSISTENT);
+	tree->array_offset = memory_allocate(HASH_GLTF, sizeof(uint) * array_count, 0, MEMORY_PERSISTENT);
+	if (element_count)
+		tree->elements = memory_allocate(HASH_GLTF, sizeof(uint) * element_count, 0, MEMORY_PERSISTENT);
+
+	uint offset = 0;
+	for (uint itoken = tokens[0].child; itoken; itoken = tokens[itoken].sibling) {
+		if (tokens[itoken].type != JSON_ARRAY)
+			continue;
+		tree->arrays[tree->array_count] = itoken;
+		tree->array_offset[tree->array_count] = offset;
+		++tree->array_count;
+		uint ielement = tokens[itoken].child;
+		for (uint index = 0; ielement && (index < tokens[itoken].value_length); ++index) {
+			tree->elements[offset++] = ielement;
+			ielement = tokens[ielement].sibling;
+		}
+	}
+}
+
+static bool
+gltf_query_valid(const gltf_t* gltf, uint itoken) {
+	return gltf->token_tree.tokens && (itoken < gltf->token_tree.count);
+}
+
+uint
+gltf_query_member(const gltf_t* gltf, uint itoken, const char* key, size_t length) {
+	if (!gltf_query_valid(gltf, itoken))
+		return GLTF_INVALID_INDEX;
+	const json_token_t* tokens = gltf->token_tree.tokens;
+	const hash_t* key_hash = gltf->token_tree.key_hash;
+	if (tokens[itoken].type != JSON_OBJECT)
+		return GLTF_INVALID_INDEX;
+	hash_t hash = string_hash(key, length);
+	for (uint ichild = tokens[itoken].child; ichild; ichild = tokens[ichild].sibling) {
+		if (key_hash[ichild] != hash)
+			continue;
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + ichild);
+		if (string_equal(STRING_ARGS(identifier), key, length))
+			return ichild;
+	}
+	return GLTF_INVALID_INDEX;
+}
+
+uint
+gltf_query_member_hash(const gltf_t* gltf, uint itoken, hash_t key) {
+	if (!gltf_query_valid(gltf, itoken))
+		return GLTF_INVALID_INDEX;
+	const json_token_t* tokens = gltf->token_tree.tokens;
+	if (tokens[itoken].type != JSON_OBJECT)
+		return GLTF_INVALID_INDEX;
+	for (uint ichild = tokens[itoken].child; ichild; ichild = tokens[ichild].sibling) {
+		if (gltf->token_tree.key_hash[ichild] == key)
+			return ichild;
+	}
+	return GLTF_INVALID_INDEX;
+}
+
+uint
+gltf_query_element(const gltf_t* gltf, uint itoken, uint index) {
+	if (!gltf_query_valid(gltf, itoken))
+		return GLTF_INVALID_INDEX;
+	const gltf_token_tree_t* tree = &gltf->token_tree;
+	const json_token_t* tokens = tree->tokens;
+	if ((tokens[itoken].type != JSON_ARRAY) || (index >= tokens[itoken].value_length))
+		return GLTF_INVALID_INDEX;
+
+	for (uint iarray = 0; iarray < tree->array_count; ++iarray) {
+		if (tree->arrays[iarray] == itoken)
+			return tree->elements[tree->array_offset[iarray] + index];
+	}
+
+	uint ielement = tokens[itoken].child;
+	while (ielement && index--)
+		ielement = tokens[ielement].sibling;
+	return ielement ? ielement : GLTF_INVALID_INDEX;
+}
+
+uint
+gltf_query_object(const gltf_t* gltf, const char* member, size_t length, uint index) {
+	uint iarray = gltf_query_member(gltf, 0, member, length);
+	if (iarray == GLTF_INVALID_INDEX)
+		return GLTF_INVALID_INDEX;
+	return gltf_query_element(gltf, iarray, index);
+}
+
+uint
+gltf_query_pointer(const gltf_t* gltf, const char* pointer, size_t length) {
+	if (!gltf_query_valid(gltf, 0))
+		return GLTF_INVALID_INDEX;
+	if (length && (pointer[0] != '/'))
+		return GLTF_INVALID_INDEX;
+
+	const json_token_t* tokens = gltf->token_tree.tokens;
+	char key[GLTF_QUERY_MAX_KEY_LENGTH];
+	uint itoken = 0;
+	size_t offset = 0;
+	while (offset < length) {
+		// Decode the reference token, "~0" is '~' and "~1" is '/'
+		size_t key_length = 0;
+		for (++offset; (offset < length) && (pointer[offset] != '/'); ++offset) {
+			char c = pointer[offset];
+			if (c == '~') {
+				if (offset + 1 >= length)
+					return GLTF_INVALID_INDEX;
+				c = pointer[++offset];
+				if (c == '0')
+					c = '~';
+				else if (c == '1')
+					c = '/';
+				else
+					return GLTF_INVALID_INDEX;
+			}
+			if (key_length >= sizeof(key))
+				return GLTF_INVALID_INDEX;
+			key[key_length++] = c;
+		}
+
+		if (tokens[itoken].type == JSON_OBJECT) {
+			itoken = gltf_query_member(gltf, itoken, key, key_length);
+		} else if (tokens[itoken].type == JSON_ARRAY) {
+			// Array indices are decimal without leading zeros
+			if (!key_length || (key_length > 10) || ((key_length > 1) && (key[0] == '0')))
+				return GLTF_INVALID_INDEX;
+			uint64_t index = 0;
+			for (size_t ichar = 0; ichar < key_length; ++ichar) {
+				if ((key[ichar] < '0') || (key[ichar] > '9'))
+					return GLTF_INVALID_INDEX;
+				index = (index * 10) + (uint64_t)(key[ichar] - '0');
+			}
+			if (index >= GLTF_INVALID_INDEX)
+				return GLTF_INVALID_INDEX;
+			itoken = gltf_query_element(gltf, itoken, (uint)index);
+		} else {
+			return GLTF_INVALID_INDEX;
+		}
+		if (itoken == GLTF_INVALID_INDEX)
+			return GLTF_INVALID_INDEX;
+	}
+	return itoken;
+}
+
+json_type_t
+gltf_query_type(const gltf_t* gltf, uint itoken) {
+	if (!gltf_query_valid(gltf, itoken))
+		return JSON_UNDEFINED;
+	return gltf->token_tree.tokens[itoken].type;
+}
+
+string_const_t
+gltf_query_value(const gltf_t* gltf, uint itoken) {
+	if (!gltf_query_valid(gltf, itoken))
+		return string_const(0, 0);
+	const json_token_t* token = gltf->token_tree.tokens + itoken;
+	if ((token->type != JSON_STRING) && (token->type != JSON_PRIMITIVE))
+		return string_const(0, 0);
+	return json_token_value(gltf->buffer, token);
+}
+
+string_const_t
+gltf_query_source(const gltf_t* gltf, uint itoken) {
+	if (!gltf_query_valid(gltf, itoken))
+		return string_const(0, 0);
+	return gltf_token_source(gltf, gltf->buffer, gltf->token_tree.tokens, itoken);
+}
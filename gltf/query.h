@@ -0,0 +1,98 @@
+/* query.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+
+#pragma once
+
+/*! \file query.h
+    Queries into the JSON token tree retained after reading */
+
+#include "gltf.h"
+
+/*! Release the retained token tree
+\param gltf glTF data structure */
+GLTF_API void
+gltf_query_finalize(gltf_t* gltf);
+
+/*! Retain a compacted copy of the JSON tokens of the source text and index the elements of all
+top level arrays. Called by gltf_read if GLTF_FLAG_RETAIN_TOKENS is set.
+\param gltf glTF data structure
+\param tokens JSON tokens
+\param token_count Number of tokens */
+GLTF_API void
+gltf_query_retain(gltf_t* gltf, const json_token_t* tokens, size_t token_count);
+
+/*! Find a member of an object
+\param gltf glTF data structure
+\param itoken Token of the object
+\param key Member name
+\param length Length of member name
+\return Token of the member value, GLTF_INVALID_INDEX if not found */
+GLTF_API uint
+gltf_query_member(const gltf_t* gltf, uint itoken, const char* key, size_t length);
+
+/*! Find a member of an object by the hash of its name
+\param gltf glTF data structure
+\param itoken Token of the object
+\param key Hash of member name
+\return Token of the member value, GLTF_INVALID_INDEX if not found */
+GLTF_API uint
+gltf_query_member_hash(const gltf_t* gltf, uint itoken, hash_t key);
+
+/*! Get an element of an array. Constant time for top level arrays, linear in the index otherwise.
+\param gltf glTF data structure
+\param itoken Token of the array
+\param index Element index
+\return Token of the element, GLTF_INVALID_INDEX if out of range */
+GLTF_API uint
+gltf_query_element(const gltf_t* gltf, uint itoken, uint index);
+
+/*! Get an object in a top level array, like the node with a given index
+\param gltf glTF data structure
+\param member Name of the top level array member, like "nodes"
+\param length Length of member name
+\param index Object index
+\return Token of the object, GLTF_INVALID_INDEX if not found */
+GLTF_API uint
+gltf_query_object(const gltf_t* gltf, const char* member, size_t length, uint index);
+
+/*! Resolve a JSON pointer (RFC 6901) like "/nodes/3/extras/id" against the document root
+\param gltf glTF data structure
+\param pointer JSON pointer, empty string for the root
+\param length Length of pointer
+\return Token of the referenced value, GLTF_INVALID_INDEX if not found */
+GLTF_API uint
+gltf_query_pointer(const gltf_t* gltf, const char* pointer, size_t length);
+
+/*! Get the type of a token
+\param gltf glTF data structure
+\param itoken Token
+\return Token type, JSON_UNDEFINED if the token is invalid */
+GLTF_API json_type_t
+gltf_query_type(const gltf_t* gltf, uint itoken);
+
+/*! Get the value of a primitive or string token. Strings are returned without quotes and
+are not unescaped.
+\param gltf glTF data structure
+\param itoken Token
+\return Value, empty string if the token is invalid */
+GLTF_API string_const_t
+gltf_query_value(const gltf_t* gltf, uint itoken);
+
+/*! Get the complete source text of a token, including quotes, braces and brackets
+\param gltf glTF data structure
+\param itoken Token
+\return Source text, empty string if the token is invalid */
+GLTF_API string_const_t
+gltf_query_source(const gltf_t* gltf, uint itoken);
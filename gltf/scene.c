@@ -80,8 +80,10 @@ gltf_scenes_parse_scene(gltf_t* gltf, const char* buffer, json_token_t* tokens,
 			return false;
 		else if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING))
 			scene->name = json_token_value(buffer, tokens + itoken);
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			scene->extensions = json_token_value(buffer, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_SCENE,
+		                                scene, &scene->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			scene->extras = json_token_value(buffer, tokens + itoken);
 
@@ -112,6 +114,8 @@ gltf_scenes_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t
 	while (iscene) {
 		if (!gltf_scenes_parse_scene(gltf, buffer, tokens, iscene, gltf->scenes + icounter))
 			return false;
+		gltf->scenes[icounter].source = gltf_token_source(gltf, buffer, tokens, iscene);
+		gltf->scenes[icounter].dirty = false;
 		iscene = tokens[iscene].sibling;
 		++icounter;
 	}
@@ -144,4 +148,5 @@ void
 gltf_scene_add_node(gltf_t* gltf, gltf_scene_t* scene, uint node) {
 	FOUNDATION_UNUSED(gltf);
 	array_push(scene->nodes, node);
+	scene->dirty = true;
 }
@@ -0,0 +1,221 @@
+/* skin.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "skin.h"
+#include "hashstrings.h"
+
+#include <foundation/memory.h>
+#include <foundation/json.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+#include <foundation/hashstrings.h>
+
+// Matrices use the same layout as the hierarchy, so a joint matrix is the inverse bind matrix
+// multiplied by the joint world transform
+
+static void
+gltf_skin_finalize(gltf_skin_t* skin) {
+	array_deallocate(skin->joints);
+}
+
+void
+gltf_skins_finalize(gltf_t* gltf) {
+	for (uint iskin = 0, skin_count = array_count(gltf->skins); iskin < skin_count; ++iskin)
+		gltf_skin_finalize(gltf->skins + iskin);
+	array_deallocate(gltf->skins);
+}
+
+static bool
+gltf_skins_parse_skin(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken, gltf_skin_t* skin) {
+	if (tokens[itoken].type != JSON_OBJECT) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skin has invalid type"));
+		return false;
+	}
+
+	memset(skin, 0, sizeof(gltf_skin_t));
+	skin->inverse_bind_matrices = GLTF_INVALID_INDEX;
+	skin->skeleton = GLTF_INVALID_INDEX;
+
+	itoken = tokens[itoken].child;
+	while (itoken) {
+		string_const_t identifier = json_token_identifier(gltf->buffer, tokens + itoken);
+		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
+		if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING)) {
+			skin->name = json_token_value(data, tokens + itoken);
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("inverseBindMatrices"))) {
+			if (!gltf_token_to_integer(gltf, data, tokens, itoken, &skin->inverse_bind_matrices))
+				return false;
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("skeleton"))) {
+			if (!gltf_token_to_integer(gltf, data, tokens, itoken, &skin->skeleton))
+				return false;
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("joints"))) {
+			if ((tokens[itoken].type != JSON_ARRAY) || (tokens[itoken].value_length > GLTF_MAX_INDEX)) {
+				log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skin joints has invalid type"));
+				return false;
+			}
+			array_resize(skin->joints, tokens[itoken].value_length);
+			if (!gltf_token_to_integer_array(gltf, data, tokens, itoken, skin->joints, array_count(skin->joints)))
+				return false;
+		} else if (identifier_hash == HASH_EXTENSIONS) {
+			if (!gltf_extensions_parse(gltf, data, tokens, itoken, GLTF_EXTENSION_OWNER_SKIN, skin, &skin->extensions))
+				return false;
+		} else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING)) {
+			skin->extras = json_token_value(data, tokens + itoken);
+		}
+
+		itoken = tokens[itoken].sibling;
+	}
+
+	return true;
+}
+
+bool
+gltf_skins_parse(gltf_t* gltf, const char* data, json_token_t* tokens, size_t itoken) {
+	if (tokens[itoken].type != JSON_ARRAY) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Main skins attribute has invalid type"));
+		return false;
+	}
+
+	size_t skins_count = tokens[itoken].value_length;
+	if (skins_count > GLTF_MAX_INDEX)
+		return false;
+
+	gltf_skins_finalize(gltf);
+	array_resize(gltf->skins, skins_count);
+	if (skins_count)
+		memset(gltf->skins, 0, sizeof(gltf_skin_t) * skins_count);
+
+	uint icounter = 0;
+	size_t iskin = tokens[itoken].child;
+	while (iskin) {
+		if (!gltf_skins_parse_skin(gltf, data, tokens, iskin, gltf->skins + icounter))
+			return false;
+		gltf->skins[icounter].source = gltf_token_source(gltf, data, tokens, iskin);
+		gltf->skins[icounter].dirty = false;
+		iskin = tokens[iskin].sibling;
+		++icounter;
+	}
+
+	return true;
+}
+
+bool
+gltf_skin_inverse_bind_matrices(gltf_t* gltf, uint iskin, matrix_t* matrices) {
+	if (iskin >= array_count(gltf->skins))
+		return false;
+
+	const gltf_skin_t* skin = gltf->skins + iskin;
+	uint joint_count = array_count(skin->joints);
+	if (skin->inverse_bind_matrices == GLTF_INVALID_INDEX) {
+		for (uint ijoint = 0; ijoint < joint_count; ++ijoint) {
+			memset(matrices + ijoint, 0, sizeof(matrix_t));
+			for (uint idiag = 0; idiag < 4; ++idiag)
+				matrices[ijoint].frow[idiag][idiag] = 1.0f;
+		}
+		return true;
+	}
+
+	if ((skin->inverse_bind_matrices >= array_count(gltf->accessors)) ||
+	    (gltf->accessors[skin->inverse_bind_matrices].type != GLTF_DATA_MAT4) ||
+	    (gltf->accessors[skin->inverse_bind_matrices].count < joint_count)) {
+		log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skin %u has invalid inverse bind matrices"), iskin);
+		return false;
+	}
+
+	// Column-major accessor elements map directly onto the matrix layout
+	uint count = gltf->accessors[skin->inverse_bind_matrices].count;
+	if (count == joint_count)
+		return gltf_accessor_read_float(gltf, skin->inverse_bind_matrices, (float*)matrices, 16);
+
+	float* values = memory_allocate(HASH_GLTF, sizeof(float) * 16 * count, 0, MEMORY_TEMPORARY);
+	bool success = gltf_accessor_read_float(gltf, skin->inverse_bind_matrices, values, 16);
+	if (success)
+		memcpy(matrices, values, sizeof(matrix_t) * joint_count);
+	memory_deallocate(values);
+	return success;
+}
+
+void
+gltf_skin_palette_initialize(gltf_skin_palette_t* palette) {
+	memset(palette, 0, sizeof(gltf_skin_palette_t));
+}
+
+void
+gltf_skin_palette_finalize(gltf_skin_palette_t* palette) {
+	memory_deallocate(palette->entry);
+	memory_deallocate(palette->inverse_bind);
+	gltf_skin_palette_initialize(palette);
+}
+
+bool
+gltf_skin_palette_build(gltf_skin_palette_t* palette, gltf_t* gltf, uint iskin, const gltf_hierarchy_t* hierarchy) {
+	gltf_skin_palette_finalize(palette);
+	if (iskin >= array_count(gltf->skins))
+		return false;
+
+	const gltf_skin_t* skin = gltf->skins + iskin;
+	uint joint_count = array_count(skin->joints);
+	uint node_count = array_count(gltf->nodes);
+	if (!joint_count)
+		return true;
+
+	palette->entry = memory_allocate(HASH_GLTF, sizeof(uint) * joint_count, 0, MEMORY_PERSISTENT);
+	palette->inverse_bind = memory_allocate(HASH_GLTF, sizeof(matrix_t) * joint_count, 16, MEMORY_PERSISTENT);
+	palette->joint_count = joint_count;
+
+	for (uint ijoint = 0; ijoint < joint_count; ++ijoint) {
+		uint node = skin->joints[ijoint];
+		palette->entry[ijoint] = (node < node_count) ? hierarchy->entry[node] : GLTF_INVALID_INDEX;
+		if (palette->entry[ijoint] == GLTF_INVALID_INDEX) {
+			log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skin %u joint %u is not part of hierarchy"),
+			           iskin, ijoint);
+			gltf_skin_palette_finalize(palette);
+			return false;
+		}
+	}
+
+	if (!gltf_skin_inverse_bind_matrices(gltf, iskin, palette->inverse_bind)) {
+		gltf_skin_palette_finalize(palette);
+		return false;
+	}
+
+	return true;
+}
+
+void
+gltf_skin_palette_compute(const gltf_skin_palette_t* palette, const matrix_t* world, matrix_t* output) {
+	const uint* FOUNDATION_RESTRICT entry = palette->entry;
+	const matrix_t* FOUNDATION_RESTRICT inverse_bind = palette->inverse_bind;
+	for (uint ijoint = 0, joint_count = palette->joint_count; ijoint < joint_count; ++ijoint)
+		gltf_hierarchy_multiply(output + ijoint, inverse_bind + ijoint, world + entry[ijoint]);
+}
+
+void
+gltf_skin_palette_compute_batch(const gltf_skin_palette_t* palette, const matrix_t* world, uint world_stride,
+                                uint count, matrix_t* output) {
+	// Joint major order keeps the inverse bind matrix in cache across all instances
+	const uint* FOUNDATION_RESTRICT entry = palette->entry;
+	const matrix_t* FOUNDATION_RESTRICT inverse_bind = palette->inverse_bind;
+	uint joint_count = palette->joint_count;
+	for (uint ijoint = 0; ijoint < joint_count; ++ijoint) {
+		const matrix_t* joint_world = world + entry[ijoint];
+		matrix_t* joint_output = output + ijoint;
+		for (uint iinst = 0; iinst < count; ++iinst) {
+			gltf_hierarchy_multiply(joint_output, inverse_bind + ijoint, joint_world);
+			joint_world += world_stride;
+			joint_output += joint_count;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+/* skin.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file skin.h
+    Skin parsing and joint matrix palette computation */
+
+#include "gltf.h"
+
+GLTF_API void
+gltf_skins_finalize(gltf_t* gltf);
+
+GLTF_API bool
+gltf_skins_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken);
+
+/*! Read the inverse bind matrices of a skin, identity matrices are stored if the skin has no
+inverse bind matrices accessor
+\param gltf glTF data structure
+\param skin Skin index
+\param matrices Destination, must hold one matrix for each joint
+\return true if success, false if the skin or accessor is invalid */
+GLTF_API bool
+gltf_skin_inverse_bind_matrices(gltf_t* gltf, uint skin, matrix_t* matrices);
+
+/*! Initialize an empty joint matrix palette
+\param palette Palette */
+GLTF_API void
+gltf_skin_palette_initialize(gltf_skin_palette_t* palette);
+
+/*! Release all memory held by a joint matrix palette
+\param palette Palette */
+GLTF_API void
+gltf_skin_palette_finalize(gltf_skin_palette_t* palette);
+
+/*! Resolve the joints of a skin to hierarchy entries and read the inverse bind matrices
+\param palette Palette, previous content is released
+\param gltf glTF data structure
+\param skin Skin index
+\param hierarchy Hierarchy containing all joint nodes
+\return true if success, false if the skin is invalid or a joint is not part of the hierarchy */
+GLTF_API bool
+gltf_skin_palette_build(gltf_skin_palette_t* palette, gltf_t* gltf, uint skin, const gltf_hierarchy_t* hierarchy);
+
+/*! Compute the joint matrices of a skin instance from hierarchy world transforms. Joint matrices
+transform vertices from bind pose to world space, the transform of the skinned mesh node is
+ignored as mandated by the specification.
+\param palette Palette
+\param world World transforms of the hierarchy entries
+\param output Destination, must hold joint_count matrices */
+GLTF_API void
+gltf_skin_palette_compute(const gltf_skin_palette_t* palette, const matrix_t* world, matrix_t* output);
+
+/*! Compute the joint matrices of many skin instances sharing a hierarchy layout
+\param palette Palette
+\param world World transforms of all instances, world_stride consecutive matrices for each instance
+\param world_stride Number of world transforms of each instance, usually the hierarchy entry count
+\param count Number of instances
+\param output Destination, joint_count consecutive matrices for each instance */
+GLTF_API void
+gltf_skin_palette_compute_batch(const gltf_skin_palette_t* palette, const matrix_t* world, uint world_stride,
+                                uint count, matrix_t* output);
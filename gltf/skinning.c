@@ -0,0 +1,268 @@
+/* skinning.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "skinning.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+#include <foundation/thread.h>
+#include <foundation/system.h>
+
+#include <vector/vector.h>
+
+#include <math.h>
+
+//! Number of vertices processed by each parallel task
+#define GLTF_SKINNING_TASK_SIZE 8192
+//! Maximum number of threads deforming vertices in parallel
+#define GLTF_SKINNING_MAX_THREADS 16
+
+typedef struct gltf_skinning_worker_t {
+	//! Skinning data
+	const gltf_skinning_t* skinning;
+	//! Joint matrices
+	const matrix_t* matrices;
+	//! Destination positions
+	float* positions;
+	//! Destination normals
+	float* normals;
+	//! First task index
+	uint first;
+	//! Task index stride
+	uint stride;
+	//! Thread
+	thread_t thread;
+} gltf_skinning_worker_t;
+
+void
+gltf_skinning_initialize(gltf_skinning_t* skinning) {
+	memset(skinning, 0, sizeof(gltf_skinning_t));
+}
+
+void
+gltf_skinning_finalize(gltf_skinning_t* skinning) {
+	memory_deallocate(skinning->positions);
+	memory_deallocate(skinning->normals);
+	memory_deallocate(skinning->joints);
+	memory_deallocate(skinning->weights);
+	gltf_skinning_initialize(skinning);
+}
+
+static uint
+gltf_skinning_custom_attribute(const gltf_primitive_t* primitive, const char* semantic, size_t length) {
+	for (uint iattrib = 0, custom_count = array_count(primitive->attributes_custom); iattrib < custom_count;
+	     ++iattrib) {
+		if (string_equal(STRING_ARGS(primitive->attributes_custom[iattrib].semantic), semantic, length))
+			return primitive->attributes_custom[iattrib].accessor;
+	}
+	return GLTF_INVALID_INDEX;
+}
+
+//! Read a joints and weights attribute set into the given influence slots of all vertices
+static bool
+gltf_skinning_read_influences(gltf_skinning_t* skinning, gltf_t* gltf, uint joints_accessor, uint weights_accessor,
+                              uint set, uint joint_count) {
+	uint vertex_count = skinning->vertex_count;
+	uint* joints = memory_allocate(HASH_GLTF, sizeof(uint) * 4 * vertex_count, 0, MEMORY_TEMPORARY);
+	float* weights = memory_allocate(HASH_GLTF, sizeof(float) * 4 * vertex_count, 0, MEMORY_TEMPORARY);
+	bool success = gltf_accessor_read_uint(gltf, joints_accessor, joints, 4) &&
+	               gltf_accessor_read_float(gltf, weights_accessor, weights, 4);
+
+	uint influence_count = skinning->influence_count;
+	for (uint ivertex = 0; success && (ivertex < vertex_count); ++ivertex) {
+		uint16_t* vertex_joints = skinning->joints + (ivertex * influence_count) + (set * 4);
+		float* vertex_weights = skinning->weights + (ivertex * influence_count) + (set * 4);
+		for (uint icomp = 0; icomp < 4; ++icomp) {
+			uint joint = joints[(ivertex * 4) + icomp];
+			float weight = weights[(ivertex * 4) + icomp];
+			// Indices of unused influences are allowed to be out of range as long as the weight is zero
+			if ((joint >= joint_count) && (weight != 0)) {
+				log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skinned vertex %u has invalid joint %u"),
+				           ivertex, joint);
+				success = false;
+				break;
+			}
+			vertex_joints[icomp] = (joint < joint_count) ? (uint16_t)joint : 0;
+			vertex_weights[icomp] = weight;
+		}
+	}
+
+	memory_deallocate(joints);
+	memory_deallocate(weights);
+	return success;
+}
+
+bool
+gltf_skinning_build(gltf_skinning_t* skinning, gltf_t* gltf, uint imesh, uint iprim, uint joint_count) {
+	gltf_skinning_finalize(skinning);
+	if ((imesh >= array_count(gltf->meshes)) || (iprim >= array_count(gltf->meshes[imesh].primitives)))
+		return false;
+
+	const gltf_primitive_t* primitive = gltf->meshes[imesh].primitives + iprim;
+	uint accessor_count = array_count(gltf->accessors);
+	uint position = primitive->attributes[GLTF_POSITION];
+	uint normal = primitive->attributes[GLTF_NORMAL];
+	uint joints[2] = {primitive->attributes[GLTF_JOINTS_0],
+	                  gltf_skinning_custom_attribute(primitive, STRING_CONST("JOINTS_1"))};
+	uint weights[2] = {primitive->attributes[GLTF_WEIGHTS_0],
+	                   gltf_skinning_custom_attribute(primitive, STRING_CONST("WEIGHTS_1"))};
+	if ((position >= accessor_count) || (joints[0] >= accessor_count) || (weights[0] >= accessor_count)) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Primitive has no skinning attributes"));
+		return false;
+	}
+	if (joint_count > 65536) {
+		log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skin has too many joints"));
+		return false;
+	}
+
+	uint vertex_count = gltf->accessors[position].count;
+	uint set_count = ((joints[1] < accessor_count) && (weights[1] < accessor_count)) ? 2 : 1;
+	for (uint iset = 0; iset < set_count; ++iset) {
+		if ((gltf->accessors[joints[iset]].count != vertex_count) ||
+		    (gltf->accessors[weights[iset]].count != vertex_count)) {
+			log_error(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Skinning attribute count mismatch"));
+			return false;
+		}
+	}
+	if ((normal < accessor_count) && (gltf->accessors[normal].count != vertex_count))
+		normal = GLTF_INVALID_INDEX;
+	if (!vertex_count)
+		return true;
+
+	skinning->vertex_count = vertex_count;
+	skinning->influence_count = set_count * 4;
+	skinning->positions = memory_allocate(HASH_GLTF, sizeof(float) * 3 * vertex_count, 16, MEMORY_PERSISTENT);
+	if (normal < accessor_count)
+		skinning->normals = memory_allocate(HASH_GLTF, sizeof(float) * 3 * vertex_count, 16, MEMORY_PERSISTENT);
+	skinning->joints = memory_allocate(HASH_GLTF, sizeof(uint16_t) * skinning->influence_count * vertex_count, 16,
+	                                   MEMORY_PERSISTENT);
+	skinning->weights = memory_allocate(HASH_GLTF, sizeof(float) * skinning->influence_count * vertex_count, 16,
+	                                    MEMORY_PERSISTENT);
+
+	bool success = gltf_accessor_read_float(gltf, position, skinning->positions, 3);
+	if (success && skinning->normals)
+		success = gltf_accessor_read_float(gltf, normal, skinning->normals, 3);
+	for (uint iset = 0; success && (iset < set_count); ++iset)
+		success = gltf_skinning_read_influences(skinning, gltf, joints[iset], weights[iset], iset, joint_count);
+
+	if (!success)
+		gltf_skinning_finalize(skinning);
+	return success;
+}
+
+void
+gltf_skinning_deform(const gltf_skinning_t* skinning, const matrix_t* matrices, uint start, uint end,
+                     float* positions, float* normals) {
+	const float* FOUNDATION_RESTRICT source_position = skinning->positions;
+	const float* FOUNDATION_RESTRICT source_normal = skinning->normals;
+	const uint16_t* FOUNDATION_RESTRICT joints = skinning->joints;
+	const float* FOUNDATION_RESTRICT weights = skinning->weights;
+	uint influence_count = skinning->influence_count;
+	if (!source_normal)
+		normals = nullptr;
+	if (end > skinning->vertex_count)
+		end = skinning->vertex_count;
+
+	for (uint ivertex = start; ivertex < end; ++ivertex) {
+		// Blend the joint matrices one row vector at a time
+		vector_t blend[4] = {vector_zero(), vector_zero(), vector_zero(), vector_zero()};
+		const uint16_t* vertex_joints = joints + (ivertex * influence_count);
+		const float* vertex_weights = weights + (ivertex * influence_count);
+		for (uint iinfluence = 0; iinfluence < influence_count; ++iinfluence) {
+			float weight = vertex_weights[iinfluence];
+			if (weight == 0)
+				continue;
+			const matrix_t* joint = matrices + vertex_joints[iinfluence];
+			vector_t vweight = vector_uniform(weight);
+			blend[0] = vector_muladd(joint->row[0], vweight, blend[0]);
+			blend[1] = vector_muladd(joint->row[1], vweight, blend[1]);
+			blend[2] = vector_muladd(joint->row[2], vweight, blend[2]);
+			blend[3] = vector_muladd(joint->row[3], vweight, blend[3]);
+		}
+
+		const float* position = source_position + (ivertex * 3);
+		vector_t result = vector_muladd(blend[0], vector_uniform(position[0]), blend[3]);
+		result = vector_muladd(blend[1], vector_uniform(position[1]), result);
+		result = vector_muladd(blend[2], vector_uniform(position[2]), result);
+		float* output = positions + (ivertex * 3);
+		output[0] = vector_x(result);
+		output[1] = vector_y(result);
+		output[2] = vector_z(result);
+
+		if (normals) {
+			const float* normal = source_normal + (ivertex * 3);
+			result = vector_mul(blend[0], vector_uniform(normal[0]));
+			result = vector_muladd(blend[1], vector_uniform(normal[1]), result);
+			result = vector_muladd(blend[2], vector_uniform(normal[2]), result);
+			float length_sqr = vector_x(vector_dot3(result, result));
+			if (length_sqr > 0)
+				result = vector_scale(result, 1.0f / sqrtf(length_sqr));
+			output = normals + (ivertex * 3);
+			output[0] = vector_x(result);
+			output[1] = vector_y(result);
+			output[2] = vector_z(result);
+		}
+	}
+}
+
+static void*
+gltf_skinning_deform_worker(void* arg) {
+	gltf_skinning_worker_t* worker = arg;
+	uint vertex_count = worker->skinning->vertex_count;
+	uint task_count = (vertex_count + GLTF_SKINNING_TASK_SIZE - 1) / GLTF_SKINNING_TASK_SIZE;
+	for (uint itask = worker->first; itask < task_count; itask += worker->stride) {
+		uint start = itask * GLTF_SKINNING_TASK_SIZE;
+		gltf_skinning_deform(worker->skinning, worker->matrices, start, start + GLTF_SKINNING_TASK_SIZE,
+		                     worker->positions, worker->normals);
+	}
+	return nullptr;
+}
+
+void
+gltf_skinning_deform_parallel(const gltf_skinning_t* skinning, const matrix_t* matrices, float* positions,
+                              float* normals) {
+	uint task_count = (skinning->vertex_count + GLTF_SKINNING_TASK_SIZE - 1) / GLTF_SKINNING_TASK_SIZE;
+	uint thread_count = (uint)system_hardware_threads();
+	if (thread_count > GLTF_SKINNING_MAX_THREADS)
+		thread_count = GLTF_SKINNING_MAX_THREADS;
+	if (thread_count > task_count)
+		thread_count = task_count;
+	if (thread_count <= 1) {
+		gltf_skinning_deform(skinning, matrices, 0, skinning->vertex_count, positions, normals);
+		return;
+	}
+
+	// Vertex ranges are disjoint, so workers write to the destination buffers without synchronization
+	gltf_skinning_worker_t workers[GLTF_SKINNING_MAX_THREADS];
+	for (uint iworker = 0; iworker < thread_count; ++iworker) {
+		workers[iworker].skinning = skinning;
+		workers[iworker].matrices = matrices;
+		workers[iworker].positions = positions;
+		workers[iworker].normals = normals;
+		workers[iworker].first = iworker;
+		workers[iworker].stride = thread_count;
+	}
+	for (uint iworker = 1; iworker < thread_count; ++iworker) {
+		thread_initialize(&workers[iworker].thread, gltf_skinning_deform_worker, workers + iworker,
+		                  STRING_CONST("gltf_skinning"), THREAD_PRIORITY_NORMAL, 0);
+		thread_start(&workers[iworker].thread);
+	}
+	gltf_skinning_deform_worker(workers);
+	for (uint iworker = 1; iworker < thread_count; ++iworker) {
+		thread_join(&workers[iworker].thread);
+		thread_finalize(&workers[iworker].thread);
+	}
+}
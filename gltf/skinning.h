@@ -0,0 +1,63 @@
+/* skinning.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file skinning.h
+    Linear blend skinning of primitive vertices */
+
+#include "gltf.h"
+
+/*! Initialize empty skinning data
+\param skinning Skinning data */
+GLTF_API void
+gltf_skinning_initialize(gltf_skinning_t* skinning);
+
+/*! Release all memory held by skinning data
+\param skinning Skinning data */
+GLTF_API void
+gltf_skinning_finalize(gltf_skinning_t* skinning);
+
+/*! Decode bind pose positions, normals, joints and weights of a primitive. The JOINTS_0 and
+WEIGHTS_0 attributes are required, a JOINTS_1 and WEIGHTS_1 set is used if present. Any
+component type allowed for the attributes is accepted.
+\param skinning Skinning data, previous content is released
+\param gltf glTF data structure
+\param mesh Mesh index
+\param primitive Primitive index in mesh
+\param joint_count Number of joints in the skin, joint indices must be less than this
+\return true if success, false if attributes are missing or invalid */
+GLTF_API bool
+gltf_skinning_build(gltf_skinning_t* skinning, gltf_t* gltf, uint mesh, uint primitive, uint joint_count);
+
+/*! Deform a range of vertices with the given joint matrices. Normals are transformed by the
+blended matrix and normalized, which is exact for joints without non-uniform scale.
+\param skinning Skinning data
+\param matrices Joint matrices as computed by gltf_skin_palette_compute
+\param start First vertex
+\param end One past last vertex
+\param positions Destination of deformed positions (x, y, z) indexed by vertex
+\param normals Destination of deformed normals (x, y, z) indexed by vertex, null to skip normals */
+GLTF_API void
+gltf_skinning_deform(const gltf_skinning_t* skinning, const matrix_t* matrices, uint start, uint end,
+                     float* positions, float* normals);
+
+/*! Deform all vertices, splitting large primitives in vertex ranges processed by multiple threads
+\param skinning Skinning data
+\param matrices Joint matrices as computed by gltf_skin_palette_compute
+\param positions Destination of deformed positions (x, y, z) indexed by vertex
+\param normals Destination of deformed normals (x, y, z) indexed by vertex, null to skip normals */
+GLTF_API void
+gltf_skinning_deform_parallel(const gltf_skinning_t* skinning, const matrix_t* matrices, float* positions,
+                              float* normals);
@@ -56,8 +56,10 @@ gltf_textures_parse_texture(gltf_t* gltf, const char* buffer, json_token_t* toke
 		hash_t identifier_hash = string_hash(STRING_ARGS(identifier));
 		if ((identifier_hash == HASH_NAME) && (tokens[itoken].type == JSON_STRING))
 			texture->name = json_token_value(buffer, tokens + itoken);
-		else if ((identifier_hash == HASH_EXTENSIONS) && (tokens[itoken].type == JSON_STRING))
-			texture->extensions = json_token_value(buffer, tokens + itoken);
+		else if ((identifier_hash == HASH_EXTENSIONS) &&
+		         !gltf_extensions_parse(gltf, buffer, tokens, itoken, GLTF_EXTENSION_OWNER_TEXTURE,
+		                                texture, &texture->extensions))
+			return false;
 		else if ((identifier_hash == HASH_EXTRAS) && (tokens[itoken].type == JSON_STRING))
 			texture->extras = json_token_value(buffer, tokens + itoken);
 		else if ((identifier_hash == HASH_SAMPLER) &&
@@ -0,0 +1,455 @@
+/* triangle.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "triangle.h"
+#include "accessor.h"
+#include "bvh.h"
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/log.h>
+#include <foundation/thread.h>
+#include <foundation/system.h>
+
+#include <vector/vector.h>
+
+#include <float.h>
+#include <math.h>
+
+//! Minimum number of triangles to compute triangle bounds in parallel
+#define GLTF_TRIANGLE_BVH_PARALLEL_THRESHOLD 65536
+//! Maximum number of threads computing triangle bounds in parallel
+#define GLTF_TRIANGLE_BVH_MAX_THREADS 16
+
+typedef struct gltf_triangle_bvh_worker_t {
+	//! Triangle hierarchy
+	const gltf_triangle_bvh_t* triangles;
+	//! Bounds of each triangle
+	gltf_bounds_t* bounds;
+	//! First triangle
+	uint start;
+	//! One past last triangle
+	uint end;
+	//! Thread
+	thread_t thread;
+} gltf_triangle_bvh_worker_t;
+
+typedef struct gltf_triangle_bvh_collapse_t {
+	//! Binary node index
+	uint node;
+	//! Four wide node index
+	uint wide;
+} gltf_triangle_bvh_collapse_t;
+
+typedef struct gltf_triangle_bvh_entry_t {
+	//! Node index for internal nodes, first triangle for leaves
+	uint offset;
+	//! Number of triangles in leaf, zero for internal nodes
+	uint count;
+	//! Entry distance along ray
+	float distance;
+} gltf_triangle_bvh_entry_t;
+
+void
+gltf_triangle_bvh_initialize(gltf_triangle_bvh_t* triangles) {
+	memset(triangles, 0, sizeof(gltf_triangle_bvh_t));
+}
+
+void
+gltf_triangle_bvh_finalize(gltf_triangle_bvh_t* triangles) {
+	memory_deallocate(triangles->nodes);
+	memory_deallocate(triangles->positions);
+	memory_deallocate(triangles->indices);
+	memory_deallocate(triangles->triangles);
+	gltf_triangle_bvh_initialize(triangles);
+}
+
+void
+gltf_triangle_bvh_deallocate(gltf_triangle_bvh_t* triangles) {
+	if (!triangles)
+		return;
+	gltf_triangle_bvh_finalize(triangles);
+	memory_deallocate(triangles);
+}
+
+//! Convert the primitive vertex sequence to triangle list vertex indices
+static bool
+gltf_triangle_bvh_indices(gltf_triangle_bvh_t* triangles, gltf_t* gltf, const gltf_primitive_t* primitive,
+                          uint vertex_count) {
+	uint* sequence = nullptr;
+	uint sequence_count = vertex_count;
+	if (primitive->indices != GLTF_INVALID_INDEX) {
+		if (primitive->indices >= array_count(gltf->accessors))
+			return false;
+		sequence_count = gltf->accessors[primitive->indices].count;
+		sequence = memory_allocate(HASH_GLTF, sizeof(uint) * math_max(sequence_count, 1U), 0, MEMORY_PERSISTENT);
+		if (!gltf_accessor_read_uint(gltf, primitive->indices, sequence, 1)) {
+			memory_deallocate(sequence);
+			return false;
+		}
+	}
+
+	uint triangle_count = 0;
+	if (primitive->mode == GLTF_TRIANGLES)
+		triangle_count = sequence_count / 3;
+	else if (((primitive->mode == GLTF_TRIANGLE_STRIP) || (primitive->mode == GLTF_TRIANGLE_FAN)) &&
+	         (sequence_count > 2))
+		triangle_count = sequence_count - 2;
+
+	triangles->triangle_count = triangle_count;
+	triangles->indices =
+	    memory_allocate(HASH_GLTF, sizeof(uint) * 3 * math_max(triangle_count, 1U), 0, MEMORY_PERSISTENT);
+	for (uint itri = 0; itri < triangle_count; ++itri) {
+		uint* corner = triangles->indices + (itri * 3);
+		if (primitive->mode == GLTF_TRIANGLES) {
+			corner[0] = itri * 3;
+			corner[1] = (itri * 3) + 1;
+			corner[2] = (itri * 3) + 2;
+		} else if (primitive->mode == GLTF_TRIANGLE_STRIP) {
+			// Keep winding consistent by swapping the first two corners of odd triangles
+			corner[0] = itri + (itri & 1);
+			corner[1] = itri + 1 - (itri & 1);
+			corner[2] = itri + 2;
+		} else {
+			corner[0] = 0;
+			corner[1] = itri + 1;
+			corner[2] = itri + 2;
+		}
+		if (sequence) {
+			for (uint icorner = 0; icorner < 3; ++icorner)
+				corner[icorner] = sequence[corner[icorner]];
+		}
+	}
+	memory_deallocate(sequence);
+
+	for (uint iindex = 0, index_count = triangle_count * 3; iindex < index_count; ++iindex) {
+		if (triangles->indices[iindex] >= vertex_count) {
+			log_errorf(HASH_GLTF, ERROR_INVALID_VALUE, STRING_CONST("Primitive vertex index %u out of range"),
+			           triangles->indices[iindex]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void*
+gltf_triangle_bvh_bounds_worker(void* arg) {
+	gltf_triangle_bvh_worker_t* worker = arg;
+	const gltf_triangle_bvh_t* triangles = worker->triangles;
+	for (uint itri = worker->start; itri < worker->end; ++itri) {
+		const uint* corner = triangles->indices + (itri * 3);
+		const float* v0 = triangles->positions + (corner[0] * 3);
+		const float* v1 = triangles->positions + (corner[1] * 3);
+		const float* v2 = triangles->positions + (corner[2] * 3);
+		gltf_bounds_t* triangle_bounds = worker->bounds + itri;
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			triangle_bounds->min[icomp] = math_min(v0[icomp], math_min(v1[icomp], v2[icomp]));
+			triangle_bounds->max[icomp] = math_max(v0[icomp], math_max(v1[icomp], v2[icomp]));
+			triangle_bounds->center[icomp] = (triangle_bounds->min[icomp] + triangle_bounds->max[icomp]) * 0.5f;
+		}
+		triangle_bounds->radius = 0;
+	}
+	return nullptr;
+}
+
+//! Compute the bounds of all triangles, splitting large meshes in contiguous ranges across threads
+static void
+gltf_triangle_bvh_bounds(const gltf_triangle_bvh_t* triangles, gltf_bounds_t* bounds) {
+	uint triangle_count = triangles->triangle_count;
+	uint thread_count = (uint)system_hardware_threads();
+	if (thread_count > GLTF_TRIANGLE_BVH_MAX_THREADS)
+		thread_count = GLTF_TRIANGLE_BVH_MAX_THREADS;
+	if ((triangle_count < GLTF_TRIANGLE_BVH_PARALLEL_THRESHOLD) || !thread_count)
+		thread_count = 1;
+
+	gltf_triangle_bvh_worker_t workers[GLTF_TRIANGLE_BVH_MAX_THREADS];
+	for (uint iworker = 0; iworker < thread_count; ++iworker) {
+		workers[iworker].triangles = triangles;
+		workers[iworker].bounds = bounds;
+		workers[iworker].start = (uint)(((uint64_t)triangle_count * iworker) / thread_count);
+		workers[iworker].end = (uint)(((uint64_t)triangle_count * (iworker + 1)) / thread_count);
+	}
+	for (uint iworker = 1; iworker < thread_count; ++iworker) {
+		thread_initialize(&workers[iworker].thread, gltf_triangle_bvh_bounds_worker, workers + iworker,
+		                  STRING_CONST("gltf_triangle_bvh"), THREAD_PRIORITY_NORMAL, 0);
+		thread_start(&workers[iworker].thread);
+	}
+	gltf_triangle_bvh_bounds_worker(workers);
+	for (uint iworker = 1; iworker < thread_count; ++iworker) {
+		thread_join(&workers[iworker].thread);
+		thread_finalize(&workers[iworker].thread);
+	}
+}
+
+static FOUNDATION_FORCEINLINE float
+gltf_triangle_bvh_half_area(const gltf_bvh_node_t* node) {
+	float dx = node->max[0] - node->min[0];
+	float dy = node->max[1] - node->min[1];
+	float dz = node->max[2] - node->min[2];
+	return (dx * dy) + (dy * dz) + (dz * dx);
+}
+
+//! Collapse a binary hierarchy into four wide nodes. The children of each wide node are found by
+//! repeatedly opening the internal binary node with the largest surface area among the candidates.
+//! Every wide node consumes at least one internal binary node, bounding the node count.
+static void
+gltf_triangle_bvh_collapse(gltf_triangle_bvh_t* triangles, const gltf_bvh_t* bvh) {
+	triangles->nodes = memory_allocate(HASH_GLTF, sizeof(gltf_triangle_bvh_node_t) * bvh->node_count, 16,
+	                                   MEMORY_PERSISTENT);
+	triangles->node_count = 1;
+
+	gltf_triangle_bvh_collapse_t* stack = nullptr;
+	gltf_triangle_bvh_collapse_t root = {0, 0};
+	array_push(stack, root);
+	while (array_count(stack)) {
+		gltf_triangle_bvh_collapse_t task = stack[array_count(stack) - 1];
+		array_pop(stack);
+
+		uint candidate[4];
+		uint candidate_count = 0;
+		const gltf_bvh_node_t* node = bvh->nodes + task.node;
+		if (node->count) {
+			candidate[candidate_count++] = task.node;
+		} else {
+			candidate[candidate_count++] = node->offset;
+			candidate[candidate_count++] = node->offset + 1;
+		}
+		while (candidate_count < 4) {
+			uint open = candidate_count;
+			float open_area = -1.0f;
+			for (uint icand = 0; icand < candidate_count; ++icand) {
+				const gltf_bvh_node_t* child = bvh->nodes + candidate[icand];
+				float area = gltf_triangle_bvh_half_area(child);
+				if (!child->count && (area > open_area)) {
+					open = icand;
+					open_area = area;
+				}
+			}
+			if (open == candidate_count)
+				break;
+			uint children = bvh->nodes[candidate[open]].offset;
+			candidate[open] = children;
+			candidate[candidate_count++] = children + 1;
+		}
+
+		float min[3][4], max[3][4];
+		gltf_triangle_bvh_node_t* wide = triangles->nodes + task.wide;
+		for (uint ilane = 0; ilane < 4; ++ilane) {
+			if (ilane >= candidate_count) {
+				// Unused children have inverted bounds and are never entered
+				for (uint icomp = 0; icomp < 3; ++icomp) {
+					min[icomp][ilane] = FLT_MAX;
+					max[icomp][ilane] = -FLT_MAX;
+				}
+				wide->offset[ilane] = GLTF_INVALID_INDEX;
+				wide->count[ilane] = 0;
+				continue;
+			}
+			const gltf_bvh_node_t* child = bvh->nodes + candidate[ilane];
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				min[icomp][ilane] = child->min[icomp];
+				max[icomp][ilane] = child->max[icomp];
+			}
+			if (child->count) {
+				wide->offset[ilane] = child->offset;
+				wide->count[ilane] = child->count;
+			} else {
+				gltf_triangle_bvh_collapse_t subtree = {candidate[ilane], triangles->node_count++};
+				wide->offset[ilane] = subtree.wide;
+				wide->count[ilane] = 0;
+				array_push(stack, subtree);
+			}
+		}
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			wide->min[icomp] = vector(min[icomp][0], min[icomp][1], min[icomp][2], min[icomp][3]);
+			wide->max[icomp] = vector(max[icomp][0], max[icomp][1], max[icomp][2], max[icomp][3]);
+		}
+	}
+	array_deallocate(stack);
+}
+
+bool
+gltf_triangle_bvh_build(gltf_triangle_bvh_t* triangles, gltf_t* gltf, const gltf_primitive_t* primitive) {
+	gltf_triangle_bvh_finalize(triangles);
+
+	uint iposition = primitive->attributes[GLTF_POSITION];
+	if (iposition >= array_count(gltf->accessors))
+		return false;
+	uint vertex_count = gltf->accessors[iposition].count;
+	triangles->positions =
+	    memory_allocate(HASH_GLTF, sizeof(float) * 3 * math_max(vertex_count, 1U), 0, MEMORY_PERSISTENT);
+	if (!gltf_accessor_read_float(gltf, iposition, triangles->positions, 3) ||
+	    !gltf_triangle_bvh_indices(triangles, gltf, primitive, vertex_count)) {
+		gltf_triangle_bvh_finalize(triangles);
+		return false;
+	}
+
+	uint triangle_count = triangles->triangle_count;
+	if (!triangle_count)
+		return true;
+
+	// Bounds are computed in parallel for large meshes, and the binary build defers subtrees to threads
+	gltf_bounds_t* bounds =
+	    memory_allocate(HASH_GLTF, sizeof(gltf_bounds_t) * triangle_count, 0, MEMORY_TEMPORARY);
+	gltf_triangle_bvh_bounds(triangles, bounds);
+
+	gltf_bvh_t bvh;
+	gltf_bvh_initialize(&bvh);
+	bool success = gltf_bvh_build(&bvh, bounds, nullptr, triangle_count);
+	memory_deallocate(bounds);
+	if (!success) {
+		gltf_bvh_finalize(&bvh);
+		gltf_triangle_bvh_finalize(triangles);
+		return false;
+	}
+
+	gltf_triangle_bvh_collapse(triangles, &bvh);
+
+	// Store triangle corners in leaf order so each leaf reads one contiguous range
+	uint* indices = memory_allocate(HASH_GLTF, sizeof(uint) * 3 * triangle_count, 0, MEMORY_PERSISTENT);
+	for (uint itri = 0; itri < triangle_count; ++itri)
+		memcpy(indices + (itri * 3), triangles->indices + (bvh.items[itri] * 3), sizeof(uint) * 3);
+	memory_deallocate(triangles->indices);
+	triangles->indices = indices;
+	triangles->triangles = bvh.items;
+	bvh.items = nullptr;
+
+	gltf_bvh_finalize(&bvh);
+	return true;
+}
+
+//! Double sided ray and triangle intersection (Moller-Trumbore)
+static bool
+gltf_triangle_bvh_intersect(const float* positions, const uint* corner, const gltf_bvh_ray_t* ray, float* distance) {
+	const float* v0 = positions + (corner[0] * 3);
+	const float* v1 = positions + (corner[1] * 3);
+	const float* v2 = positions + (corner[2] * 3);
+
+	float edge1[3], edge2[3], origin[3];
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		edge1[icomp] = v1[icomp] - v0[icomp];
+		edge2[icomp] = v2[icomp] - v0[icomp];
+		origin[icomp] = ray->origin[icomp] - v0[icomp];
+	}
+	const float* direction = ray->direction;
+	float pvec[3] = {(direction[1] * edge2[2]) - (direction[2] * edge2[1]),
+	                 (direction[2] * edge2[0]) - (direction[0] * edge2[2]),
+	                 (direction[0] * edge2[1]) - (direction[1] * edge2[0])};
+	float determinant = (edge1[0] * pvec[0]) + (edge1[1] * pvec[1]) + (edge1[2] * pvec[2]);
+	if (fabsf(determinant) < FLT_MIN)
+		return false;
+	float inv_determinant = 1.0f / determinant;
+
+	float u = ((origin[0] * pvec[0]) + (origin[1] * pvec[1]) + (origin[2] * pvec[2])) * inv_determinant;
+	if ((u < 0) || (u > 1))
+		return false;
+	float qvec[3] = {(origin[1] * edge1[2]) - (origin[2] * edge1[1]), (origin[2] * edge1[0]) - (origin[0] * edge1[2]),
+	                 (origin[0] * edge1[1]) - (origin[1] * edge1[0])};
+	float v = ((direction[0] * qvec[0]) + (direction[1] * qvec[1]) + (direction[2] * qvec[2])) * inv_determinant;
+	if ((v < 0) || ((u + v) > 1))
+		return false;
+	float t = ((edge2[0] * qvec[0]) + (edge2[1] * qvec[1]) + (edge2[2] * qvec[2])) * inv_determinant;
+	if ((t < 0) || (t >= *distance))
+		return false;
+	*distance = t;
+	return true;
+}
+
+void
+gltf_triangle_bvh_query_rays(const gltf_triangle_bvh_t* triangles, const gltf_bvh_ray_t* rays, uint count,
+                             gltf_bvh_hit_t* hits) {
+	gltf_triangle_bvh_entry_t* stack = nullptr;
+	for (uint iray = 0; iray < count; ++iray) {
+		const gltf_bvh_ray_t* ray = rays + iray;
+		gltf_bvh_hit_t* hit = hits + iray;
+		hit->item = GLTF_INVALID_INDEX;
+		hit->distance = ray->distance;
+		if (!triangles->node_count)
+			continue;
+
+		vector_t origin[3], inv_direction[3];
+		for (uint icomp = 0; icomp < 3; ++icomp) {
+			origin[icomp] = vector_uniform(ray->origin[icomp]);
+			inv_direction[icomp] = vector_uniform(1.0f / ray->direction[icomp]);
+		}
+
+		array_clear(stack);
+		gltf_triangle_bvh_entry_t root = {0, 0, 0};
+		array_push(stack, root);
+		while (array_count(stack)) {
+			gltf_triangle_bvh_entry_t entry = stack[array_count(stack) - 1];
+			array_pop(stack);
+			if (entry.distance > hit->distance)
+				continue;
+			if (entry.count) {
+				const uint* corner = triangles->indices + (entry.offset * 3);
+				for (uint itri = entry.offset, end = entry.offset + entry.count; itri < end; ++itri, corner += 3) {
+					if (gltf_triangle_bvh_intersect(triangles->positions, corner, ray, &hit->distance))
+						hit->item = triangles->triangles[itri];
+				}
+				continue;
+			}
+
+			// Slab test against all four child boxes at once, one child per lane
+			const gltf_triangle_bvh_node_t* node = triangles->nodes + entry.offset;
+			vector_t tnear = vector_zero();
+			vector_t tfar = vector_uniform(hit->distance);
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				vector_t t0 = vector_mul(vector_sub(node->min[icomp], origin[icomp]), inv_direction[icomp]);
+				vector_t t1 = vector_mul(vector_sub(node->max[icomp], origin[icomp]), inv_direction[icomp]);
+				tnear = vector_max(tnear, vector_min(t0, t1));
+				tfar = vector_min(tfar, vector_max(t0, t1));
+			}
+			float near[4] = {vector_x(tnear), vector_y(tnear), vector_z(tnear), vector_w(tnear)};
+			float far[4] = {vector_x(tfar), vector_y(tfar), vector_z(tfar), vector_w(tfar)};
+
+			// Push children hit in order of decreasing distance so the closest child is visited first
+			gltf_triangle_bvh_entry_t child[4];
+			uint child_count = 0;
+			for (uint ilane = 0; ilane < 4; ++ilane) {
+				if ((node->offset[ilane] == GLTF_INVALID_INDEX) || !(near[ilane] <= far[ilane]))
+					continue;
+				uint slot = child_count++;
+				while (slot && (child[slot - 1].distance < near[ilane])) {
+					child[slot] = child[slot - 1];
+					--slot;
+				}
+				child[slot].offset = node->offset[ilane];
+				child[slot].count = node->count[ilane];
+				child[slot].distance = near[ilane];
+			}
+			for (uint ichild = 0; ichild < child_count; ++ichild)
+				array_push(stack, child[ichild]);
+		}
+	}
+	array_deallocate(stack);
+}
+
+const gltf_triangle_bvh_t*
+gltf_primitive_triangle_bvh(gltf_t* gltf, uint imesh, uint iprim) {
+	if ((imesh >= array_count(gltf->meshes)) || (iprim >= array_count(gltf->meshes[imesh].primitives)))
+		return nullptr;
+	gltf_primitive_t* primitive = gltf->meshes[imesh].primitives + iprim;
+	if (primitive->triangle_bvh)
+		return primitive->triangle_bvh;
+
+	gltf_triangle_bvh_t* triangles = memory_allocate(HASH_GLTF, sizeof(gltf_triangle_bvh_t), 0, MEMORY_PERSISTENT);
+	gltf_triangle_bvh_initialize(triangles);
+	if (!gltf_triangle_bvh_build(triangles, gltf, primitive)) {
+		gltf_triangle_bvh_deallocate(triangles);
+		return nullptr;
+	}
+	primitive->triangle_bvh = triangles;
+	return triangles;
+}
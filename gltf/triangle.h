@@ -0,0 +1,65 @@
+/* triangle.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file triangle.h
+    Triangle level bounding volume hierarchy and ray casting for mesh primitives */
+
+#include "gltf.h"
+
+/*! Initialize an empty triangle hierarchy
+\param triangles Triangle hierarchy */
+GLTF_API void
+gltf_triangle_bvh_initialize(gltf_triangle_bvh_t* triangles);
+
+/*! Release all memory held by a triangle hierarchy
+\param triangles Triangle hierarchy */
+GLTF_API void
+gltf_triangle_bvh_finalize(gltf_triangle_bvh_t* triangles);
+
+/*! Finalize and deallocate a triangle hierarchy allocated by gltf_primitive_triangle_bvh
+\param triangles Triangle hierarchy, may be null */
+GLTF_API void
+gltf_triangle_bvh_deallocate(gltf_triangle_bvh_t* triangles);
+
+/*! Build a triangle hierarchy from the POSITION and index accessors of a primitive. Triangle
+strips and fans are converted to triangle lists, other primitive modes produce an empty hierarchy.
+Large meshes compute triangle bounds and build subtrees in parallel, the binary hierarchy is then
+collapsed into four wide nodes.
+\param triangles Triangle hierarchy, previous content is released
+\param gltf glTF data structure
+\param primitive Primitive
+\return true if success, false if error */
+GLTF_API bool
+gltf_triangle_bvh_build(gltf_triangle_bvh_t* triangles, gltf_t* gltf, const gltf_primitive_t* primitive);
+
+/*! Find the closest triangle hit by each of a set of rays, testing all four child boxes of a node at
+once. Triangles are double sided.
+\param triangles Triangle hierarchy
+\param rays Rays in mesh space
+\param count Number of rays
+\param hits Closest hit for each ray, item is the triangle index */
+GLTF_API void
+gltf_triangle_bvh_query_rays(const gltf_triangle_bvh_t* triangles, const gltf_bvh_ray_t* rays, uint count,
+                             gltf_bvh_hit_t* hits);
+
+/*! Get the triangle hierarchy of a primitive, building and caching it in the primitive on first use.
+The cache is released when the mesh is finalized or the primitive is decoded.
+\param gltf glTF data structure
+\param mesh Mesh index
+\param primitive Primitive index in mesh
+\return Triangle hierarchy, null if error */
+GLTF_API const gltf_triangle_bvh_t*
+gltf_primitive_triangle_bvh(gltf_t* gltf, uint mesh, uint primitive);
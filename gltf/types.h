@@ -45,6 +45,13 @@
 #define GLTF_MAX_INDEX 0x7FFFFFFF
 #define GLTF_INVALID_INDEX 0xFFFFFFFF
 
+//! Maximum size of a single output buffer, leaving headroom for JSON within the 4GiB GLB size limit
+#if FOUNDATION_SIZE_POINTER == 4
+#define GLTF_MAX_OUTPUT_BUFFER_SIZE 0x40000000ULL
+#else
+#define GLTF_MAX_OUTPUT_BUFFER_SIZE 0xF0000000ULL
+#endif
+
 enum gltf_file_type {
 	GLTF_FILE_GLTF = 0,
 	GLTF_FILE_GLTF_EMBED,
@@ -85,6 +92,62 @@ enum gltf_attribute {
 	GLTF_ATTRIBUTE_COUNT
 };
 
+enum gltf_buffer_target { GLTF_BUFFER_TARGET_ARRAY = 34962, GLTF_BUFFER_TARGET_ELEMENT_ARRAY = 34963 };
+
+enum gltf_flag {
+	//! Compress vertex and index buffer views with EXT_meshopt_compression when writing
+	GLTF_FLAG_MESHOPT_COMPRESSION = 0x0001,
+	//! Omit the uncompressed fallback buffer when writing compressed buffer views
+	GLTF_FLAG_MESHOPT_COMPRESSION_ONLY = 0x0002,
+	//! Interleave all vertex attributes of a mesh in one strided buffer view when adding meshes
+	GLTF_FLAG_INTERLEAVED_VERTICES = 0x0004,
+	//! Write compact JSON without insignificant whitespace, default for GLB files
+	GLTF_FLAG_JSON_MINIFY = 0x0008,
+	//! Write indented JSON, default for glTF files and overrides GLTF_FLAG_JSON_MINIFY
+	GLTF_FLAG_JSON_PRETTY = 0x0010,
+	//! Retain the JSON token tree after reading for queries through gltf_query functions
+	GLTF_FLAG_RETAIN_TOKENS = 0x0020,
+	//! Serialize the JSON document on the calling thread only, even above the parallel threshold
+	GLTF_FLAG_WRITE_SINGLE_THREAD = 0x0040
+};
+
+enum gltf_meshopt_mode { GLTF_MESHOPT_NONE = 0, GLTF_MESHOPT_ATTRIBUTES, GLTF_MESHOPT_INDICES };
+
+enum gltf_animation_path {
+	GLTF_ANIMATION_TRANSLATION = 0,
+	GLTF_ANIMATION_ROTATION,
+	GLTF_ANIMATION_SCALE,
+	GLTF_ANIMATION_WEIGHTS,
+	//! Path defined by an extension, raw path kept in the channel
+	GLTF_ANIMATION_PATH_UNKNOWN
+};
+
+enum gltf_interpolation { GLTF_INTERPOLATION_LINEAR = 0, GLTF_INTERPOLATION_STEP, GLTF_INTERPOLATION_CUBICSPLINE };
+
+//! Type of object owning an extensions member
+enum gltf_extension_owner {
+	GLTF_EXTENSION_OWNER_ROOT = 0,
+	GLTF_EXTENSION_OWNER_ACCESSOR,
+	GLTF_EXTENSION_OWNER_ACCESSOR_SPARSE,
+	GLTF_EXTENSION_OWNER_ACCESSOR_SPARSE_INDICES,
+	GLTF_EXTENSION_OWNER_ACCESSOR_SPARSE_VALUES,
+	GLTF_EXTENSION_OWNER_ANIMATION,
+	GLTF_EXTENSION_OWNER_ANIMATION_CHANNEL,
+	GLTF_EXTENSION_OWNER_ANIMATION_SAMPLER,
+	GLTF_EXTENSION_OWNER_BUFFER,
+	GLTF_EXTENSION_OWNER_BUFFER_VIEW,
+	GLTF_EXTENSION_OWNER_IMAGE,
+	GLTF_EXTENSION_OWNER_MATERIAL,
+	GLTF_EXTENSION_OWNER_PBR_METALLIC_ROUGHNESS,
+	GLTF_EXTENSION_OWNER_TEXTURE_INFO,
+	GLTF_EXTENSION_OWNER_MESH,
+	GLTF_EXTENSION_OWNER_PRIMITIVE,
+	GLTF_EXTENSION_OWNER_NODE,
+	GLTF_EXTENSION_OWNER_SCENE,
+	GLTF_EXTENSION_OWNER_SKIN,
+	GLTF_EXTENSION_OWNER_TEXTURE
+};
+
 enum gltf_primitive_mode {
 	GLTF_POINTS = 0,
 	GLTF_LINES,
@@ -97,26 +160,50 @@ enum gltf_primitive_mode {
 
 typedef struct gltf_t gltf_t;
 typedef struct gltf_accessor_t gltf_accessor_t;
+typedef struct gltf_animation_t gltf_animation_t;
+typedef struct gltf_animation_channel_t gltf_animation_channel_t;
+typedef struct gltf_animation_curves_t gltf_animation_curves_t;
+typedef struct gltf_animation_sampler_t gltf_animation_sampler_t;
 typedef struct gltf_accessor_sparse_t gltf_accessor_sparse_t;
 typedef struct gltf_asset_t gltf_asset_t;
 typedef struct gltf_attribute_t gltf_attribute_t;
 typedef struct gltf_buffer_t gltf_buffer_t;
 typedef struct gltf_buffer_view_t gltf_buffer_view_t;
 typedef struct gltf_config_t gltf_config_t;
+typedef struct gltf_draco_t gltf_draco_t;
+typedef struct gltf_extension_handler_t gltf_extension_handler_t;
 typedef struct gltf_glb_header_t gltf_glb_header_t;
+typedef struct gltf_hierarchy_t gltf_hierarchy_t;
 typedef struct gltf_image_t gltf_image_t;
+typedef struct gltf_instancing_t gltf_instancing_t;
 typedef struct gltf_material_t gltf_material_t;
 typedef struct gltf_mesh_t gltf_mesh_t;
+typedef struct gltf_morph_t gltf_morph_t;
+typedef struct gltf_morph_target_t gltf_morph_target_t;
+typedef struct gltf_meshopt_view_t gltf_meshopt_view_t;
 typedef struct gltf_node_t gltf_node_t;
+typedef struct gltf_output_region_t gltf_output_region_t;
 typedef struct gltf_pbr_metallic_roughness_t gltf_pbr_metallic_roughness_t;
 typedef struct gltf_primitive_t gltf_primitive_t;
 typedef struct gltf_scene_t gltf_scene_t;
+typedef struct gltf_skin_t gltf_skin_t;
+typedef struct gltf_skin_palette_t gltf_skin_palette_t;
+typedef struct gltf_skinning_t gltf_skinning_t;
 typedef struct gltf_sparse_indices_t gltf_sparse_indices_t;
 typedef struct gltf_sparse_values_t gltf_sparse_values_t;
 typedef struct gltf_texture_info_t gltf_texture_info_t;
 typedef struct gltf_texture_t gltf_texture_t;
+typedef struct gltf_token_tree_t gltf_token_tree_t;
+typedef struct gltf_triangle_bvh_t gltf_triangle_bvh_t;
+typedef struct gltf_triangle_bvh_node_t gltf_triangle_bvh_node_t;
+typedef struct gltf_writer_t gltf_writer_t;
 typedef struct gltf_transform_t gltf_transform_t;
 typedef struct gltf_binary_chunk_t gltf_binary_chunk_t;
+typedef struct gltf_bounds_t gltf_bounds_t;
+typedef struct gltf_bvh_t gltf_bvh_t;
+typedef struct gltf_bvh_hit_t gltf_bvh_hit_t;
+typedef struct gltf_bvh_node_t gltf_bvh_node_t;
+typedef struct gltf_bvh_ray_t gltf_bvh_ray_t;
 
 typedef enum gltf_component_type gltf_component_type;
 typedef enum gltf_file_type gltf_file_type;
@@ -124,6 +211,25 @@ typedef enum gltf_data_type gltf_data_type;
 typedef enum gltf_alpha_mode gltf_alpha_mode;
 typedef enum gltf_attribute gltf_attribute;
 typedef enum gltf_primitive_mode gltf_primitive_mode;
+typedef enum gltf_buffer_target gltf_buffer_target;
+typedef enum gltf_meshopt_mode gltf_meshopt_mode;
+typedef enum gltf_animation_path gltf_animation_path;
+typedef enum gltf_interpolation gltf_interpolation;
+typedef enum gltf_extension_owner gltf_extension_owner;
+
+/*! Extension handler, called during parsing for each extension of an object matching the
+registered extension name
+\param gltf glTF data structure
+\param buffer JSON text
+\param tokens JSON tokens
+\param itoken Token of the extension value
+\param owner Type of the owning object
+\param object Owning object, the glTF data structure for root extensions. Objects in top level
+arrays can be converted to an index by subtracting the array base pointer.
+\param context Context given at registration
+\return true if success, false to abort parsing */
+typedef bool (*gltf_extension_handler_fn)(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
+                                          gltf_extension_owner owner, void* object, void* context);
 
 struct gltf_config_t {
 	size_t unused;
@@ -165,6 +271,158 @@ struct gltf_accessor_t {
 	gltf_accessor_sparse_t sparse;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
+};
+
+struct gltf_animation_sampler_t {
+	//! Accessor of keyframe times
+	uint input;
+	//! Accessor of keyframe values
+	uint output;
+	gltf_interpolation interpolation;
+	string_const_t extensions;
+	string_const_t extras;
+};
+
+struct gltf_animation_channel_t {
+	//! Sampler index in animation
+	uint sampler;
+	//! Target node, GLTF_INVALID_INDEX if not given
+	uint node;
+	gltf_animation_path path;
+	//! Raw target path, set for paths defined by extensions
+	string_const_t path_name;
+	string_const_t extensions;
+	string_const_t extras;
+};
+
+struct gltf_animation_t {
+	string_const_t name;
+	//! Array of channels
+	gltf_animation_channel_t* channels;
+	//! Array of samplers
+	gltf_animation_sampler_t* samplers;
+	string_const_t extensions;
+	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
+};
+
+struct gltf_animation_curves_t {
+	//! Number of channels
+	uint channel_count;
+	//! Target node of each channel
+	uint* node;
+	//! Target path of each channel
+	gltf_animation_path* path;
+	//! Interpolation of each channel
+	gltf_interpolation* interpolation;
+	//! Number of components in each channel value, the morph target count for weights
+	uint* components;
+	//! Number of keyframes of each channel
+	uint* key_count;
+	//! Offset of first keyframe time of each channel, channels sharing a sampler share keyframes
+	uint* key_offset;
+	//! Offset of first keyframe value of each channel
+	uint* value_offset;
+	//! Offset of each channel value in sampled output
+	uint* output_offset;
+	//! Number of floats in sampled output
+	uint output_size;
+	//! Keyframe times of all channels
+	float* times;
+	//! Keyframe values of all channels, cubic spline keyframes hold in-tangent, value and out-tangent
+	float* values;
+	//! Time of last keyframe of all channels
+	float duration;
+};
+
+struct gltf_skin_t {
+	string_const_t name;
+	//! Accessor of inverse bind matrices, GLTF_INVALID_INDEX if joints use identity matrices
+	uint inverse_bind_matrices;
+	//! Node used as skeleton root, GLTF_INVALID_INDEX if not given
+	uint skeleton;
+	//! Array of joint node indices
+	uint* joints;
+	string_const_t extensions;
+	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
+};
+
+struct gltf_skin_palette_t {
+	//! Number of joints
+	uint joint_count;
+	//! Hierarchy entry of each joint
+	uint* entry;
+	//! Inverse bind matrix of each joint
+	matrix_t* inverse_bind;
+};
+
+struct gltf_morph_t {
+	//! Number of vertices
+	uint vertex_count;
+	//! Number of morph targets
+	uint target_count;
+	//! Base positions (x, y, z), null if the primitive has no positions
+	float* positions;
+	//! Base normals (x, y, z), null if the primitive has no normals
+	float* normals;
+	//! Base tangents (x, y, z, w), null if the primitive has no tangents
+	float* tangents;
+	//! Position deltas (x, y, z) of each target, null for targets without position deltas
+	float** position_deltas;
+	//! Normal deltas (x, y, z) of each target, null for targets without normal deltas
+	float** normal_deltas;
+	//! Tangent deltas (x, y, z) of each target, null for targets without tangent deltas
+	float** tangent_deltas;
+};
+
+struct gltf_skinning_t {
+	//! Number of vertices
+	uint vertex_count;
+	//! Number of joint influences per vertex, four for each joints and weights attribute set
+	uint influence_count;
+	//! Bind pose positions (x, y, z)
+	float* positions;
+	//! Bind pose normals (x, y, z), null if the primitive has no normals
+	float* normals;
+	//! Palette joint indices, influence_count consecutive indices per vertex
+	uint16_t* joints;
+	//! Joint weights, influence_count consecutive weights per vertex
+	float* weights;
+};
+
+struct gltf_extension_handler_t {
+	//! Hash of extension name
+	hash_t name;
+	gltf_extension_handler_fn handler;
+	void* context;
+};
+
+struct gltf_token_tree_t {
+	//! JSON tokens of the source text, null if not retained
+	json_token_t* tokens;
+	//! Number of tokens
+	uint count;
+	//! Number of top level array members with an element index
+	uint array_count;
+	//! Token of each top level array member
+	uint* arrays;
+	//! Offset of the first element token of each top level array member in the elements array
+	uint* array_offset;
+	//! Element tokens of all top level array members
+	uint* elements;
+	//! Hash of the member name of each token, the empty string for tokens which are not object members
+	hash_t* key_hash;
 };
 
 struct gltf_asset_t {
@@ -181,6 +439,25 @@ struct gltf_buffer_view_t {
 	uint target;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
+	//! Buffer is an output buffer index rather than an index into the buffers array
+	bool output;
+};
+
+struct gltf_meshopt_view_t {
+	//! Offset of data in the compressed buffer of the output buffer
+	size_t byte_offset;
+	//! Length of data in compressed buffer
+	size_t byte_length;
+	//! Element stride in decompressed data
+	uint byte_stride;
+	//! Number of elements
+	uint count;
+	//! Compression mode, GLTF_MESHOPT_NONE if stored uncompressed
+	gltf_meshopt_mode mode;
 };
 
 struct gltf_buffer_t {
@@ -189,6 +466,12 @@ struct gltf_buffer_t {
 	uint byte_length;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Loaded or decoded buffer data, null if not loaded
+	void* data;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
 };
 
 struct gltf_texture_info_t {
@@ -211,35 +494,163 @@ struct gltf_attribute_t {
 	uint accessor;
 };
 
+struct gltf_bounds_t {
+	//! Minimum corner of axis aligned box, larger than maximum corner if bounds are empty
+	float min[3];
+	//! Maximum corner of axis aligned box
+	float max[3];
+	//! Center of bounding sphere
+	float center[3];
+	//! Radius of bounding sphere
+	float radius;
+};
+
+struct gltf_bvh_node_t {
+	//! Minimum corner of node bounds
+	float min[3];
+	//! Index of first of the two adjacent child nodes for internal nodes, index of first item for leaves
+	uint offset;
+	//! Maximum corner of node bounds
+	float max[3];
+	//! Number of items in leaf, zero for internal nodes
+	uint count;
+};
+
+struct gltf_bvh_t {
+	//! Nodes, root node first
+	gltf_bvh_node_t* nodes;
+	//! Number of nodes
+	uint node_count;
+	//! Item identifiers ordered by leaf
+	uint* items;
+	//! Bounds of items, in same order as item identifiers
+	gltf_bounds_t* bounds;
+	//! Number of items
+	uint item_count;
+};
+
+struct gltf_bvh_ray_t {
+	//! Ray origin
+	float origin[3];
+	//! Ray direction, does not need to be normalized
+	float direction[3];
+	//! Maximum distance along ray in units of direction length
+	float distance;
+};
+
+struct gltf_bvh_hit_t {
+	//! Identifier of closest item hit, GLTF_INVALID_INDEX if no item was hit
+	uint item;
+	//! Distance along ray in units of direction length
+	float distance;
+};
+
+struct gltf_triangle_bvh_node_t {
+	//! Minimum corner of the four child bounds, one vector per axis with one child per lane
+	vector_t min[3];
+	//! Maximum corner of the four child bounds, one vector per axis with one child per lane
+	vector_t max[3];
+	//! Node index of internal children, first triangle of leaf children, GLTF_INVALID_INDEX for unused children
+	uint offset[4];
+	//! Number of triangles in leaf children, zero for internal and unused children
+	uint count[4];
+};
+
+struct gltf_triangle_bvh_t {
+	//! Four wide nodes over triangle bounds, root node first
+	gltf_triangle_bvh_node_t* nodes;
+	//! Number of nodes
+	uint node_count;
+	//! Vertex positions, three floats per vertex
+	float* positions;
+	//! Vertex indices, three per triangle, triangles ordered by leaf
+	uint* indices;
+	//! Primitive triangle index of each triangle, ordered by leaf
+	uint* triangles;
+	//! Number of triangles
+	uint triangle_count;
+};
+
+struct gltf_draco_t {
+	//! Buffer view holding compressed data, GLTF_INVALID_INDEX if not compressed
+	uint buffer_view;
+	//! Draco attribute unique id for each attribute, GLTF_INVALID_INDEX if not present
+	uint attributes[GLTF_ATTRIBUTE_COUNT];
+};
+
+struct gltf_morph_target_t {
+	//! Accessor of position deltas, GLTF_INVALID_INDEX if not given
+	uint position;
+	//! Accessor of normal deltas, GLTF_INVALID_INDEX if not given
+	uint normal;
+	//! Accessor of tangent deltas, GLTF_INVALID_INDEX if not given
+	uint tangent;
+};
+
 struct gltf_primitive_t {
 	uint material;
 	uint indices;
 	uint attributes[GLTF_ATTRIBUTE_COUNT];
 	//! Array of custom attributes
 	gltf_attribute_t* attributes_custom;
+	//! Array of morph targets
+	gltf_morph_target_t* targets;
 	gltf_primitive_mode mode;
+	//! KHR_draco_mesh_compression data
+	gltf_draco_t draco;
+	//! Bounds from POSITION accessor in mesh space, computed by gltf_bounds_compute
+	gltf_bounds_t bounds;
+	//! Cached triangle hierarchy in mesh space, built on demand by gltf_primitive_triangle_bvh
+	gltf_triangle_bvh_t* triangle_bvh;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the primitive, empty if not read from a file
+	string_const_t source;
 };
 
 struct gltf_mesh_t {
 	string_const_t name;
 	//! Array of primitives
 	gltf_primitive_t* primitives;
+	//! Array of default morph target weights
+	real* weights;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
+};
+
+struct gltf_instancing_t {
+	//! Accessor of per-instance translations, GLTF_INVALID_INDEX if not present
+	uint translation;
+	//! Accessor of per-instance rotation quaternions, GLTF_INVALID_INDEX if not present
+	uint rotation;
+	//! Accessor of per-instance scales, GLTF_INVALID_INDEX if not present
+	uint scale;
+	//! Array of custom per-instance attributes
+	gltf_attribute_t* attributes_custom;
 };
 
-#define GLTF_NODE_BASE_CHILDREN 4
 struct gltf_node_t {
 	string_const_t name;
 	uint mesh;
+	//! Skin used by the mesh, GLTF_INVALID_INDEX if not skinned
+	uint skin;
 	gltf_transform_t transform;
+	//! EXT_mesh_gpu_instancing data, mesh is drawn once per instance if any attribute is present
+	gltf_instancing_t instancing;
+	//! Offset of first child index in the node children array of the glTF data structure
+	uint children_offset;
+	//! Number of children
 	uint children_count;
-	uint* children_ext;
-	uint children_base[GLTF_NODE_BASE_CHILDREN];
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
 };
 
 struct gltf_pbr_metallic_roughness_t {
@@ -266,6 +677,10 @@ struct gltf_material_t {
 	bool double_sided;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
 };
 
 struct gltf_image_t {
@@ -291,6 +706,33 @@ struct gltf_scene_t {
 	uint* nodes;
 	string_const_t extensions;
 	string_const_t extras;
+	//! Source JSON text of the object, empty if not read from a file
+	string_const_t source;
+	//! Object modified after reading, written from fields instead of copied from source text
+	bool dirty;
+};
+
+struct gltf_hierarchy_t {
+	//! Number of nodes
+	uint count;
+	//! Node index for each hierarchy entry, ordered so parents precede their children
+	uint* node;
+	//! Parent hierarchy entry for each entry, GLTF_INVALID_INDEX for root nodes
+	uint* parent;
+	//! Hierarchy entry for each node, GLTF_INVALID_INDEX if node is not part of the hierarchy
+	uint* entry;
+	//! Local transform is given by matrix instead of translation, rotation and scale
+	bool* has_matrix;
+	//! Translation component arrays (x, y, z)
+	float* translation[3];
+	//! Rotation quaternion component arrays (x, y, z, w)
+	float* rotation[4];
+	//! Scale component arrays (x, y, z)
+	float* scale[3];
+	//! Local transform matrices
+	matrix_t* local;
+	//! World transform matrices
+	matrix_t* world;
 };
 
 struct gltf_glb_header_t {
@@ -306,17 +748,47 @@ struct gltf_binary_chunk_t {
 	void* data;
 };
 
+struct gltf_writer_t {
+	//! Destination stream
+	stream_t* stream;
+	//! Block buffer
+	char* block;
+	//! Used size of block buffer
+	size_t size;
+	//! Capacity of block buffer
+	size_t capacity;
+	//! Strip whitespace from structural text, values are written verbatim
+	bool minify;
+};
+
+struct gltf_output_region_t {
+	//! Output buffer index
+	uint buffer;
+	//! Size of region in bytes
+	size_t size;
+};
+
 struct gltf_t {
 	string_t base_path;
 	gltf_file_type file_type;
+	//! Flags controlling reading and writing (gltf_flag)
+	uint flags;
 	gltf_binary_chunk_t binary_chunk;
 	void* buffer;
+	//! Size of source JSON text in buffer
+	size_t buffer_size;
+	//! Array of source JSON text of top level members not handled by the writer, copied verbatim when writing
+	string_const_t* source_members;
 
 	gltf_asset_t asset;
 	uint extensions_used_count;
 	string_const_t* extensions_used;
 	uint extensions_required_count;
 	string_const_t* extensions_required;
+	//! Array of extension handlers invoked during parsing
+	gltf_extension_handler_t* extension_handlers;
+	//! JSON token tree retained after reading if GLTF_FLAG_RETAIN_TOKENS is set
+	gltf_token_tree_t token_tree;
 	//! Array of accessors
 	gltf_accessor_t* accessors;
 	//! Array of buffer views
@@ -329,8 +801,20 @@ struct gltf_t {
 	gltf_scene_t* scenes;
 	//! Array of nodes
 	gltf_node_t* nodes;
+	//! Array of child node indices of all nodes, each node referencing a contiguous range
+	uint* node_children;
+	//! Bounds of each mesh in mesh space, computed by gltf_bounds_compute
+	gltf_bounds_t* mesh_bounds;
+	//! Bounds of each node including all descendants in world space, computed by gltf_bounds_compute
+	gltf_bounds_t* node_bounds;
+	//! Bounds of each scene in world space, computed by gltf_bounds_compute
+	gltf_bounds_t* scene_bounds;
 	//! Array of materials
 	gltf_material_t* materials;
+	//! Array of animations
+	gltf_animation_t* animations;
+	//! Array of skins
+	gltf_skin_t* skins;
 	//! Array of meshes
 	gltf_mesh_t* meshes;
 	gltf_texture_t* textures;
@@ -340,6 +824,16 @@ struct gltf_t {
 
 	//! String storage during writing
 	string_t* string_array;
-	//! Output storage for buffers during writing
-	virtualarray_t* output_buffer;
+	//! Array of output storage for buffers during writing, one per buffer, empty if streaming
+	virtualarray_t** output_buffers;
+	//! Array of output buffer sizes during writing, one per buffer
+	size_t* output_sizes;
+	//! Base path of output buffer files in streaming export mode, empty if not streaming
+	string_t output_path;
+	//! Array of streams receiving output buffer data in streaming export mode, one per buffer
+	stream_t** output_streams;
+	//! Staging storage for output data not yet flushed to the output streams
+	virtualarray_t* output_staging;
+	//! Array of staged output regions not yet flushed, in staging order
+	gltf_output_region_t* output_pending;
 };
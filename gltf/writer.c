@@ -0,0 +1,630 @@
+/* writer.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include "gltf.h"
+#include "writer.h"
+#include "hashstrings.h"
+
+#include <foundation/memory.h>
+#include <foundation/stream.h>
+#include <foundation/string.h>
+#include <foundation/math.h>
+
+#include <float.h>
+
+#define GLTF_WRITER_BLOCK_SIZE (256 * 1024)
+
+static const char gltf_writer_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354"
+    "555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+static const char gltf_writer_base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+//! Tables for shortest float formatting (Ryu), 5^-q and 5^i scaled to 59 and 61 significant bits
+#define GLTF_WRITER_POW5_INV_BITCOUNT 59
+#define GLTF_WRITER_POW5_BITCOUNT 61
+
+static const uint64_t gltf_writer_pow5_inv_split[31] = {
+    576460752303423489ULL, 461168601842738791ULL, 368934881474191033ULL, 295147905179352826ULL, 472236648286964522ULL,
+    377789318629571618ULL, 302231454903657294ULL, 483570327845851670ULL, 386856262276681336ULL, 309485009821345069ULL,
+    495176015714152110ULL, 396140812571321688ULL, 316912650057057351ULL, 507060240091291761ULL, 405648192073033409ULL,
+    324518553658426727ULL, 519229685853482763ULL, 415383748682786211ULL, 332306998946228969ULL, 531691198313966350ULL,
+    425352958651173080ULL, 340282366920938464ULL, 544451787073501542ULL, 435561429658801234ULL, 348449143727040987ULL,
+    557518629963265579ULL, 446014903970612463ULL, 356811923176489971ULL, 570899077082383953ULL, 456719261665907162ULL,
+    365375409332725730ULL};
+
+static const uint64_t gltf_writer_pow5_split[48] = {
+    1152921504606846976ULL, 1441151880758558720ULL, 1801439850948198400ULL, 2251799813685248000ULL,
+    1407374883553280000ULL, 1759218604441600000ULL, 2199023255552000000ULL, 1374389534720000000ULL,
+    1717986918400000000ULL, 2147483648000000000ULL, 1342177280000000000ULL, 1677721600000000000ULL,
+    2097152000000000000ULL, 1310720000000000000ULL, 1638400000000000000ULL, 2048000000000000000ULL,
+    1280000000000000000ULL, 1600000000000000000ULL, 2000000000000000000ULL, 1250000000000000000ULL,
+    1562500000000000000ULL, 1953125000000000000ULL, 1220703125000000000ULL, 1525878906250000000ULL,
+    1907348632812500000ULL, 1192092895507812500ULL, 1490116119384765625ULL, 1862645149230957031ULL,
+    1164153218269348144ULL, 1455191522836685180ULL, 1818989403545856475ULL, 2273736754432320594ULL,
+    1421085471520200371ULL, 1776356839400250464ULL, 2220446049250313080ULL, 1387778780781445675ULL,
+    1734723475976807094ULL, 2168404344971008868ULL, 1355252715606880542ULL, 1694065894508600678ULL,
+    2117582368135750847ULL, 1323488980084844279ULL, 1654361225106055349ULL, 2067951531382569187ULL,
+    1292469707114105741ULL, 1615587133892632177ULL, 2019483917365790221ULL, 1262177448353618888ULL};
+
+void
+gltf_writer_initialize(gltf_writer_t* writer, stream_t* stream) {
+	writer->stream = stream;
+	writer->size = 0;
+	writer->capacity = GLTF_WRITER_BLOCK_SIZE;
+	writer->minify = false;
+	writer->block = memory_allocate(HASH_GLTF, writer->capacity, 0, MEMORY_PERSISTENT);
+}
+
+void
+gltf_writer_finalize(gltf_writer_t* writer) {
+	gltf_writer_flush(writer);
+	memory_deallocate(writer->block);
+	writer->block = nullptr;
+	writer->capacity = 0;
+}
+
+void
+gltf_writer_flush(gltf_writer_t* writer) {
+	if (!writer->stream)
+		return;
+	if (writer->size)
+		stream_write(writer->stream, writer->block, writer->size);
+	writer->size = 0;
+}
+
+static void
+gltf_writer_reserve(gltf_writer_t* writer, size_t length) {
+	if ((writer->size + length) <= writer->capacity)
+		return;
+	if (writer->stream) {
+		gltf_writer_flush(writer);
+		if (length <= writer->capacity)
+			return;
+	}
+	// Grow block, without a stream all output is retained in memory
+	size_t capacity = writer->capacity * 2;
+	while (capacity < (writer->size + length))
+		capacity *= 2;
+	writer->block = memory_reallocate(writer->block, capacity, 0, writer->size, MEMORY_PERSISTENT);
+	writer->capacity = capacity;
+}
+
+static void
+gltf_writer_write_raw(gltf_writer_t* writer, const char* data, size_t length) {
+	gltf_writer_reserve(writer, length);
+	memcpy(writer->block + writer->size, data, length);
+	writer->size += length;
+}
+
+void
+gltf_writer_write(gltf_writer_t* writer, const char* data, size_t length) {
+	if (!writer->minify) {
+		gltf_writer_write_raw(writer, data, length);
+		return;
+	}
+
+	// Structural text never contains significant whitespace
+	size_t start = 0;
+	for (size_t pos = 0; pos < length; ++pos) {
+		char c = data[pos];
+		if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r')) {
+			if (pos > start)
+				gltf_writer_write_raw(writer, data + start, pos - start);
+			start = pos + 1;
+		}
+	}
+	if (length > start)
+		gltf_writer_write_raw(writer, data + start, length - start);
+}
+
+void
+gltf_writer_json(gltf_writer_t* writer, const char* data, size_t length) {
+	if (!writer->minify) {
+		gltf_writer_write_raw(writer, data, length);
+		return;
+	}
+
+	// Strip whitespace outside of string literals, keeping escaped quotes inside strings
+	bool in_string = false;
+	size_t start = 0;
+	for (size_t pos = 0; pos < length; ++pos) {
+		char c = data[pos];
+		if (in_string) {
+			if (c == '\\')
+				++pos;
+			else if (c == '"')
+				in_string = false;
+		} else if (c == '"') {
+			in_string = true;
+		} else if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r')) {
+			if (pos > start)
+				gltf_writer_write_raw(writer, data + start, pos - start);
+			start = pos + 1;
+		}
+	}
+	if (length > start)
+		gltf_writer_write_raw(writer, data + start, length - start);
+}
+
+void
+gltf_writer_append(gltf_writer_t* writer, const gltf_writer_t* source) {
+	gltf_writer_write_raw(writer, source->block, source->size);
+}
+
+//! Encode data as base64, padding a trailing partial group, return number of characters written
+static size_t
+gltf_writer_base64_encode(char* buffer, const uint8_t* data, size_t size) {
+	const char* alphabet = gltf_writer_base64_alphabet;
+	char* dest = buffer;
+	size_t full = size - (size % 3);
+	size_t offset = 0;
+	for (; offset < full; offset += 3) {
+		const uint8_t* group = data + offset;
+		uint32_t value = ((uint32_t)group[0] << 16) | ((uint32_t)group[1] << 8) | (uint32_t)group[2];
+		dest[0] = alphabet[value >> 18];
+		dest[1] = alphabet[(value >> 12) & 0x3F];
+		dest[2] = alphabet[(value >> 6) & 0x3F];
+		dest[3] = alphabet[value & 0x3F];
+		dest += 4;
+	}
+	if (offset < size) {
+		uint32_t value = (uint32_t)data[offset] << 16;
+		if ((offset + 1) < size)
+			value |= (uint32_t)data[offset + 1] << 8;
+		dest[0] = alphabet[value >> 18];
+		dest[1] = alphabet[(value >> 12) & 0x3F];
+		dest[2] = ((offset + 1) < size) ? alphabet[(value >> 6) & 0x3F] : '=';
+		dest[3] = '=';
+		dest += 4;
+	}
+	return (size_t)pointer_diff(dest, buffer);
+}
+
+void
+gltf_writer_base64(gltf_writer_t* writer, const void* data, size_t size) {
+	// Encode directly into the block in pieces that fill at most one block, so output is
+	// flushed to the stream as it is produced instead of materializing the encoded string
+	const size_t piece_size = (GLTF_WRITER_BLOCK_SIZE / 4) * 3;
+	const uint8_t* source = data;
+	while (size) {
+		size_t piece = (size > piece_size) ? piece_size : size;
+		gltf_writer_reserve(writer, ((piece + 2) / 3) * 4);
+		writer->size += gltf_writer_base64_encode(writer->block + writer->size, source, piece);
+		source += piece;
+		size -= piece;
+	}
+}
+
+static size_t
+gltf_writer_format_uint64(char* buffer, uint64_t value) {
+	char digits[20];
+	size_t offset = sizeof(digits);
+	while (value >= 100) {
+		size_t pair = (size_t)(value % 100) * 2;
+		value /= 100;
+		digits[--offset] = gltf_writer_digit_pairs[pair + 1];
+		digits[--offset] = gltf_writer_digit_pairs[pair];
+	}
+	if (value >= 10) {
+		digits[--offset] = gltf_writer_digit_pairs[(value * 2) + 1];
+		digits[--offset] = gltf_writer_digit_pairs[value * 2];
+	} else {
+		digits[--offset] = (char)('0' + value);
+	}
+	size_t length = sizeof(digits) - offset;
+	memcpy(buffer, digits + offset, length);
+	return length;
+}
+
+size_t
+gltf_writer_format_uint(char* buffer, uint value) {
+	return gltf_writer_format_uint64(buffer, value);
+}
+
+//! Number of factors of five in value
+static uint
+gltf_writer_pow5_factor(uint32_t value) {
+	uint count = 0;
+	while (value && !(value % 5)) {
+		value /= 5;
+		++count;
+	}
+	return count;
+}
+
+//! Multiply by a 64-bit fixed point factor and shift down, shift must be greater than 32
+static FOUNDATION_FORCEINLINE uint32_t
+gltf_writer_mul_shift(uint32_t value, uint64_t factor, int shift) {
+	uint64_t low = (uint64_t)value * (uint32_t)factor;
+	uint64_t high = (uint64_t)value * (uint32_t)(factor >> 32);
+	return (uint32_t)(((low >> 32) + high) >> (shift - 32));
+}
+
+//! Floor of log10(2^e)
+static FOUNDATION_FORCEINLINE int
+gltf_writer_log10_pow2(int e) {
+	return (int)(((uint32_t)e * 78913) >> 18);
+}
+
+//! Floor of log10(5^e)
+static FOUNDATION_FORCEINLINE int
+gltf_writer_log10_pow5(int e) {
+	return (int)(((uint32_t)e * 732923) >> 20);
+}
+
+//! Ceil of log2(5^e), one for e of zero
+static FOUNDATION_FORCEINLINE int
+gltf_writer_pow5_bits(int e) {
+	return (int)((((uint32_t)e * 1217359) >> 19) + 1);
+}
+
+/*! Compute the shortest decimal digits of a positive finite float which read back to the same
+value, using the Ryu algorithm by Ulf Adams (PLDI 2018). Ties between equally short candidates
+round to the one closest to the exact value.
+\param value Value
+\param exponent Receives decimal exponent of the last digit
+\return Decimal digits */
+static uint32_t
+gltf_writer_shortest_digits(float value, int* exponent) {
+	union {
+		float value;
+		uint32_t bits;
+	} cast;
+	cast.value = value;
+	uint32_t ieee_mantissa = cast.bits & ((1U << 23) - 1);
+	uint32_t ieee_exponent = (cast.bits >> 23) & 0xFF;
+
+	// Value is m2 * 2^e2, with two extra bits to represent the halfway points to the neighbours
+	int e2;
+	uint32_t m2;
+	if (!ieee_exponent) {
+		e2 = 1 - 127 - 23 - 2;
+		m2 = ieee_mantissa;
+	} else {
+		e2 = (int)ieee_exponent - 127 - 23 - 2;
+		m2 = (1U << 23) | ieee_mantissa;
+	}
+	bool accept_bounds = !(m2 & 1);
+
+	// Interval of values reading back to this float, lower bound is closer at powers of two
+	uint32_t mv = 4 * m2;
+	uint32_t mp = 4 * m2 + 2;
+	uint32_t mm_shift = (ieee_mantissa || (ieee_exponent <= 1)) ? 1 : 0;
+	uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+	// Convert interval to decimal, scaled so that only a few digits need to be removed
+	uint32_t vr, vp, vm;
+	int e10;
+	bool vm_trailing_zeros = false;
+	bool vr_trailing_zeros = false;
+	uint32_t last_removed_digit = 0;
+	if (e2 >= 0) {
+		int q = gltf_writer_log10_pow2(e2);
+		int k = GLTF_WRITER_POW5_INV_BITCOUNT + gltf_writer_pow5_bits(q) - 1;
+		int i = -e2 + q + k;
+		e10 = q;
+		vr = gltf_writer_mul_shift(mv, gltf_writer_pow5_inv_split[q], i);
+		vp = gltf_writer_mul_shift(mp, gltf_writer_pow5_inv_split[q], i);
+		vm = gltf_writer_mul_shift(mm, gltf_writer_pow5_inv_split[q], i);
+		if (q && ((vp - 1) / 10 <= vm / 10)) {
+			// Need the digit below the scaled range to round correctly
+			int l = GLTF_WRITER_POW5_INV_BITCOUNT + gltf_writer_pow5_bits(q - 1) - 1;
+			last_removed_digit = gltf_writer_mul_shift(mv, gltf_writer_pow5_inv_split[q - 1], -e2 + q - 1 + l) % 10;
+		}
+		if (q <= 9) {
+			// Only one of mp, mv and mm can be a multiple of five
+			if (!(mv % 5))
+				vr_trailing_zeros = (gltf_writer_pow5_factor(mv) >= (uint)q);
+			else if (accept_bounds)
+				vm_trailing_zeros = (gltf_writer_pow5_factor(mm) >= (uint)q);
+			else
+				vp -= (gltf_writer_pow5_factor(mp) >= (uint)q) ? 1 : 0;
+		}
+	} else {
+		int q = gltf_writer_log10_pow5(-e2);
+		int i = -e2 - q;
+		int k = gltf_writer_pow5_bits(i) - GLTF_WRITER_POW5_BITCOUNT;
+		int j = q - k;
+		e10 = q + e2;
+		vr = gltf_writer_mul_shift(mv, gltf_writer_pow5_split[i], j);
+		vp = gltf_writer_mul_shift(mp, gltf_writer_pow5_split[i], j);
+		vm = gltf_writer_mul_shift(mm, gltf_writer_pow5_split[i], j);
+		if (q && ((vp - 1) / 10 <= vm / 10)) {
+			j = q - 1 - (gltf_writer_pow5_bits(i + 1) - GLTF_WRITER_POW5_BITCOUNT);
+			last_removed_digit = gltf_writer_mul_shift(mv, gltf_writer_pow5_split[i + 1], j) % 10;
+		}
+		if (q <= 1) {
+			// mv has at least q trailing zero bits, so mv * 2^e2 is an integer
+			vr_trailing_zeros = true;
+			if (accept_bounds)
+				vm_trailing_zeros = (mm_shift == 1);
+			else
+				--vp;
+		} else if (q < 31) {
+			vr_trailing_zeros = !(mv & ((1U << (q - 1)) - 1));
+		}
+	}
+
+	// Remove digits as long as the interval still has a unique shortest representation
+	int removed = 0;
+	uint32_t output;
+	if (vm_trailing_zeros || vr_trailing_zeros) {
+		while (vp / 10 > vm / 10) {
+			vm_trailing_zeros &= !(vm % 10);
+			vr_trailing_zeros &= !last_removed_digit;
+			last_removed_digit = vr % 10;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++removed;
+		}
+		if (vm_trailing_zeros) {
+			while (!(vm % 10)) {
+				vr_trailing_zeros &= !last_removed_digit;
+				last_removed_digit = vr % 10;
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+				++removed;
+			}
+		}
+		// Exact halfway rounds to even
+		if (vr_trailing_zeros && (last_removed_digit == 5) && !(vr % 2))
+			last_removed_digit = 4;
+		output = vr + ((((vr == vm) && (!accept_bounds || !vm_trailing_zeros)) || (last_removed_digit >= 5)) ? 1 : 0);
+	} else {
+		while (vp / 10 > vm / 10) {
+			last_removed_digit = vr % 10;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++removed;
+		}
+		output = vr + (((vr == vm) || (last_removed_digit >= 5)) ? 1 : 0);
+	}
+
+	*exponent = e10 + removed;
+	return output;
+}
+
+size_t
+gltf_writer_format_float(char* buffer, float value) {
+	if (value != value)
+		value = 0;
+	else if (value > FLT_MAX)
+		value = FLT_MAX;
+	else if (value < -FLT_MAX)
+		value = -FLT_MAX;
+
+	if (value == 0) {
+		buffer[0] = '0';
+		return 1;
+	}
+
+	size_t offset = 0;
+	if (value < 0) {
+		buffer[offset++] = '-';
+		value = -value;
+	}
+
+	int exponent = 0;
+	uint32_t digits = gltf_writer_shortest_digits(value, &exponent);
+	while (!(digits % 10)) {
+		digits /= 10;
+		++exponent;
+	}
+
+	// Shortest representation has at most nine significant digits, make exponent refer to the first digit
+	char digit_buffer[10];
+	size_t digit_count = gltf_writer_format_uint(digit_buffer, digits);
+	exponent += (int)digit_count - 1;
+
+	if ((exponent >= -5) && (exponent < 9)) {
+		if (exponent < 0) {
+			buffer[offset++] = '0';
+			buffer[offset++] = '.';
+			for (int izero = -1; izero > exponent; --izero)
+				buffer[offset++] = '0';
+			memcpy(buffer + offset, digit_buffer, digit_count);
+			offset += digit_count;
+		} else {
+			size_t integer_count = (size_t)exponent + 1;
+			for (size_t idigit = 0; idigit < integer_count; ++idigit)
+				buffer[offset++] = (idigit < digit_count) ? digit_buffer[idigit] : '0';
+			if (digit_count > integer_count) {
+				buffer[offset++] = '.';
+				memcpy(buffer + offset, digit_buffer + integer_count, digit_count - integer_count);
+				offset += digit_count - integer_count;
+			}
+		}
+	} else {
+		buffer[offset++] = digit_buffer[0];
+		if (digit_count > 1) {
+			buffer[offset++] = '.';
+			memcpy(buffer + offset, digit_buffer + 1, digit_count - 1);
+			offset += digit_count - 1;
+		}
+		buffer[offset++] = 'e';
+		if (exponent < 0) {
+			buffer[offset++] = '-';
+			exponent = -exponent;
+		}
+		offset += gltf_writer_format_uint(buffer + offset, (uint)exponent);
+	}
+
+	return offset;
+}
+
+void
+gltf_writer_uint(gltf_writer_t* writer, uint value) {
+	gltf_writer_reserve(writer, 10);
+	writer->size += gltf_writer_format_uint(writer->block + writer->size, value);
+}
+
+void
+gltf_writer_float(gltf_writer_t* writer, float value) {
+	gltf_writer_reserve(writer, 16);
+	writer->size += gltf_writer_format_float(writer->block + writer->size, value);
+}
+
+typedef enum {
+	GLTF_WRITER_ARG_INT,
+	GLTF_WRITER_ARG_LONG,
+	GLTF_WRITER_ARG_LONGLONG,
+	GLTF_WRITER_ARG_SIZE
+} gltf_writer_arg_size;
+
+//! Parse length modifier and conversion of a format specifier, return conversion or 0 if unsupported
+static char
+gltf_writer_parse_specifier(const char* format, size_t length, size_t* offset, gltf_writer_arg_size* arg_size,
+                            bool* precision) {
+	size_t pos = *offset;
+	*arg_size = GLTF_WRITER_ARG_INT;
+	*precision = false;
+	if ((pos + 1 < length) && (format[pos] == '.') && (format[pos + 1] == '*')) {
+		*precision = true;
+		pos += 2;
+	}
+	if (pos >= length)
+		return 0;
+	if (format[pos] == 'z') {
+		*arg_size = GLTF_WRITER_ARG_SIZE;
+		++pos;
+	} else if (format[pos] == 'I') {
+		*arg_size = GLTF_WRITER_ARG_SIZE;
+		++pos;
+		if ((pos + 1 < length) && (format[pos] == '6') && (format[pos + 1] == '4')) {
+			*arg_size = GLTF_WRITER_ARG_LONGLONG;
+			pos += 2;
+		} else if ((pos + 1 < length) && (format[pos] == '3') && (format[pos + 1] == '2')) {
+			*arg_size = GLTF_WRITER_ARG_INT;
+			pos += 2;
+		}
+	} else if (format[pos] == 'l') {
+		*arg_size = GLTF_WRITER_ARG_LONG;
+		++pos;
+		if ((pos < length) && (format[pos] == 'l')) {
+			*arg_size = GLTF_WRITER_ARG_LONGLONG;
+			++pos;
+		}
+	}
+	if (pos >= length)
+		return 0;
+	char conversion = format[pos];
+	*offset = pos + 1;
+	if (*precision)
+		return (conversion == 's') ? conversion : 0;
+	if ((conversion == 'u') || (conversion == 'd') || (conversion == 'i'))
+		return conversion;
+	if (((conversion == 'f') || (conversion == 'g') || (conversion == 's')) && (*arg_size == GLTF_WRITER_ARG_INT))
+		return conversion;
+	if (conversion == '%')
+		return conversion;
+	return 0;
+}
+
+void
+gltf_writer_format(gltf_writer_t* writer, const char* format, size_t length, ...) {
+	va_list list;
+	va_start(list, length);
+
+	// Fast path handles the subset of specifiers used by the writer, with numbers formatted
+	// by the table driven integer and shortest float formatters
+	bool supported = true;
+	for (size_t pos = 0; supported && (pos < length);) {
+		if (format[pos++] != '%')
+			continue;
+		gltf_writer_arg_size arg_size;
+		bool precision;
+		supported = gltf_writer_parse_specifier(format, length, &pos, &arg_size, &precision) != 0;
+	}
+
+	if (!supported) {
+		size_t available = writer->capacity - writer->size;
+		va_list copy;
+		va_copy(copy, list);
+		string_t result = string_vformat(writer->block + writer->size, available, format, length, copy);
+		va_end(copy);
+		if (result.length + 1 >= available) {
+			// Possibly truncated, retry with a larger block
+			gltf_writer_reserve(writer, writer->capacity);
+			result = string_vformat(writer->block + writer->size, writer->capacity - writer->size, format, length,
+			                        list);
+		}
+		writer->size += result.length;
+		va_end(list);
+		return;
+	}
+
+	size_t start = 0;
+	for (size_t pos = 0; pos < length;) {
+		if (format[pos] != '%') {
+			++pos;
+			continue;
+		}
+		if (pos > start)
+			gltf_writer_write(writer, format + start, pos - start);
+		++pos;
+
+		gltf_writer_arg_size arg_size;
+		bool precision;
+		char conversion = gltf_writer_parse_specifier(format, length, &pos, &arg_size, &precision);
+		if (conversion == 's') {
+			size_t string_length = precision ? (size_t)va_arg(list, int) : 0;
+			const char* string_value = va_arg(list, const char*);
+			if (!precision)
+				string_length = string_value ? strlen(string_value) : 0;
+			gltf_writer_write_raw(writer, string_value, string_length);
+		} else if ((conversion == 'f') || (conversion == 'g')) {
+			gltf_writer_float(writer, (float)va_arg(list, double));
+		} else if (conversion == '%') {
+			gltf_writer_write(writer, "%", 1);
+		} else {
+			char buffer[24];
+			size_t offset = 0;
+			uint64_t value;
+			if (conversion == 'u') {
+				if (arg_size == GLTF_WRITER_ARG_SIZE)
+					value = va_arg(list, size_t);
+				else if (arg_size == GLTF_WRITER_ARG_LONGLONG)
+					value = va_arg(list, unsigned long long);
+				else if (arg_size == GLTF_WRITER_ARG_LONG)
+					value = va_arg(list, unsigned long);
+				else
+					value = va_arg(list, unsigned int);
+			} else {
+				int64_t signed_value;
+				if (arg_size == GLTF_WRITER_ARG_SIZE)
+					signed_value = (int64_t)va_arg(list, ssize_t);
+				else if (arg_size == GLTF_WRITER_ARG_LONGLONG)
+					signed_value = va_arg(list, long long);
+				else if (arg_size == GLTF_WRITER_ARG_LONG)
+					signed_value = va_arg(list, long);
+				else
+					signed_value = va_arg(list, int);
+				if (signed_value < 0)
+					buffer[offset++] = '-';
+				value = (signed_value < 0) ? (uint64_t)0 - (uint64_t)signed_value : (uint64_t)signed_value;
+			}
+			offset += gltf_writer_format_uint64(buffer + offset, value);
+			gltf_writer_write_raw(writer, buffer, offset);
+		}
+		start = pos;
+	}
+	if (length > start)
+		gltf_writer_write(writer, format + start, length - start);
+
+	va_end(list);
+}
@@ -0,0 +1,103 @@
+/* writer.h  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
+ *
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
+ *
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file writer.h
+    Buffered JSON text emitter */
+
+#include <gltf/types.h>
+
+/*! Initialize a writer emitting to the given stream
+\param writer Writer
+\param stream Destination stream, or null to retain all output in the writer block */
+GLTF_API void
+gltf_writer_initialize(gltf_writer_t* writer, stream_t* stream);
+
+/*! Flush any buffered data and release resources
+\param writer Writer */
+GLTF_API void
+gltf_writer_finalize(gltf_writer_t* writer);
+
+/*! Write all buffered data to the stream, no-op if the writer has no stream
+\param writer Writer */
+GLTF_API void
+gltf_writer_flush(gltf_writer_t* writer);
+
+/*! Write structural JSON text. Whitespace is stripped if the writer is set to minify output,
+so values containing significant whitespace must be written through gltf_writer_format
+\param writer Writer
+\param data Text
+\param length Length of text */
+GLTF_API void
+gltf_writer_write(gltf_writer_t* writer, const char* data, size_t length);
+
+/*! Write verbatim JSON text such as spans of a source document. Whitespace outside of string
+literals is stripped if the writer is set to minify output
+\param writer Writer
+\param data JSON text
+\param length Length of text */
+GLTF_API void
+gltf_writer_json(gltf_writer_t* writer, const char* data, size_t length);
+
+/*! Append all output retained in another writer verbatim, without minification
+\param writer Writer
+\param source Writer without stream holding the output to append */
+GLTF_API void
+gltf_writer_append(gltf_writer_t* writer, const gltf_writer_t* source);
+
+/*! Write data base64 encoded. Data can be written in several calls forming one encoded
+sequence as long as all but the last call have a size which is a multiple of three bytes
+\param writer Writer
+\param data Data
+\param size Size of data in bytes */
+GLTF_API void
+gltf_writer_base64(gltf_writer_t* writer, const void* data, size_t size);
+
+/*! Write formatted JSON text. Literal text is treated as structural text, while string and
+number arguments are written verbatim. Supports the %u, %d, %i, %s, %.*s, %f, %g and %%
+specifiers with z, l, ll and I length modifiers, other specifiers fall back to regular
+formatting without minification.
+\param writer Writer
+\param format Format string
+\param length Length of format string */
+GLTF_API void
+gltf_writer_format(gltf_writer_t* writer, const char* format, size_t length, ...);
+
+/*! Write an unsigned integer
+\param writer Writer
+\param value Value */
+GLTF_API void
+gltf_writer_uint(gltf_writer_t* writer, uint value);
+
+/*! Write a float with the shortest decimal representation that reads back to the same value.
+Non-finite values are clamped to a finite value as they have no JSON representation.
+\param writer Writer
+\param value Value */
+GLTF_API void
+gltf_writer_float(gltf_writer_t* writer, float value);
+
+/*! Format an unsigned integer
+\param buffer Destination buffer, must hold at least 10 characters
+\param value Value
+\return Number of characters written */
+GLTF_API size_t
+gltf_writer_format_uint(char* buffer, uint value);
+
+/*! Format a float with the shortest decimal representation that reads back to the same value
+\param buffer Destination buffer, must hold at least 16 characters
+\param value Value
+\return Number of characters written */
+GLTF_API size_t
+gltf_writer_format_float(char* buffer, float value);
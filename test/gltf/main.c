@@ -1,26 +1,30 @@
-/* main.c  -  Network library  -  Public Domain  -  2013 Mattias Jansson
+/* main.c  -  glTF library  -  Public Domain  -  2019 Mattias Jansson
  *
- * This library provides a network abstraction built on foundation streams. The latest source code
- * is always available at
+ * This library provides a cross-platform glTF I/O library in C11 providing
+ * glTF ascii/binary reading and writing functionality.
  *
- * https://github.com/mjansson/network_lib
+ * The latest source code maintained by Mattias Jansson is always available at
+ *
+ * https://github.com/mjansson/gltf_lib
  *
  * This library is put in the public domain; you can redistribute it and/or modify it without any
  * restrictions.
  *
  */
 
-#include <network/network.h>
+#include <gltf/gltf.h>
 
 #include <foundation/foundation.h>
+#include <mesh/mesh.h>
+#include <vector/vector.h>
 #include <test/test.h>
 
 static application_t
-test_socket_application(void) {
+test_gltf_application(void) {
 	application_t app;
 	memset(&app, 0, sizeof(app));
-	app.name = string_const(STRING_CONST("Network socket tests"));
-	app.short_name = string_const(STRING_CONST("test_socket"));
+	app.name = string_const(STRING_CONST("glTF tests"));
+	app.short_name = string_const(STRING_CONST("test_gltf"));
 	app.company = string_const(STRING_CONST(""));
 	app.flags = APPLICATION_UTILITY;
 	app.exception_handler = test_exception_handler;
@@ -28,217 +32,1708 @@ test_socket_application(void) {
 }
 
 static memory_system_t
-test_socket_memory_system(void) {
+test_gltf_memory_system(void) {
 	return memory_system_malloc();
 }
 
 static foundation_config_t
-test_socket_foundation_config(void) {
+test_gltf_foundation_config(void) {
 	foundation_config_t config;
 	memset(&config, 0, sizeof(config));
 	return config;
 }
 
 static int
-test_socket_initialize(void) {
-	network_config_t config;
+test_gltf_initialize(void) {
+	gltf_config_t config;
 	memset(&config, 0, sizeof(config));
-	log_set_suppress(HASH_NETWORK, ERRORLEVEL_INFO);
-	return network_module_initialize(config);
+	log_set_suppress(HASH_GLTF, ERRORLEVEL_INFO);
+	return gltf_module_initialize(config);
+}
+
+static void
+test_gltf_finalize(void) {
+	gltf_module_finalize();
+}
+
+static void
+test_draco_u8(uint8_t** bitstream, uint value) {
+	uint8_t byte = (uint8_t)value;
+	array_push(*bitstream, byte);
 }
 
 static void
-test_socket_finalize(void) {
-	network_module_finalize();
+test_draco_varint(uint8_t** bitstream, uint value) {
+	while (value >= 0x80) {
+		test_draco_u8(bitstream, (value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	test_draco_u8(bitstream, value);
+}
+
+static void
+test_draco_bytes(uint8_t** bitstream, const void* data, size_t size) {
+	const uint8_t* bytes = data;
+	for (size_t ibyte = 0; ibyte < size; ++ibyte)
+		test_draco_u8(bitstream, bytes[ibyte]);
+}
+
+//! Encode a triangle list as a Draco 2.2 sequential mesh with raw indices and a generic float
+//! position attribute with unique id 0
+static uint8_t*
+test_draco_encode_sequential(const float* positions, uint point_count, const uint* indices, uint index_count) {
+	uint8_t* bitstream = nullptr;
+	test_draco_bytes(&bitstream, "DRACO", 5);
+	test_draco_u8(&bitstream, 2);
+	test_draco_u8(&bitstream, 2);
+	test_draco_u8(&bitstream, 1);
+	test_draco_u8(&bitstream, 0);
+	test_draco_u8(&bitstream, 0);
+	test_draco_u8(&bitstream, 0);
+
+	test_draco_varint(&bitstream, index_count / 3);
+	test_draco_varint(&bitstream, point_count);
+	test_draco_u8(&bitstream, 1);
+	for (uint iindex = 0; iindex < index_count; ++iindex)
+		test_draco_u8(&bitstream, indices[iindex]);
+
+	test_draco_u8(&bitstream, 1);
+	test_draco_varint(&bitstream, 1);
+	test_draco_u8(&bitstream, 0);
+	test_draco_u8(&bitstream, 9);
+	test_draco_u8(&bitstream, 3);
+	test_draco_u8(&bitstream, 0);
+	test_draco_varint(&bitstream, 0);
+	test_draco_u8(&bitstream, 0);
+	test_draco_bytes(&bitstream, positions, sizeof(float) * 3 * point_count);
+	return bitstream;
+}
+
+//! Edgebreaker coded annulus with a hole and an octahedron with a texture seam, positions predicted by
+//! parallelogram, normals by geometric normal prediction and texture coordinates by portable prediction
+static const uint8_t test_draco_edgebreaker_standard[] = {
+	0x44, 0x52, 0x41, 0x43, 0x4f, 0x02, 0x02, 0x01, 0x01, 0x00, 0x00, 0x00, 0x16, 0x18, 0x02, 0x17, 0x03, 0x01, 0x0f,
+	0x0f, 0x00, 0x08, 0x6f, 0x95, 0xaf, 0x4f, 0xd7, 0xae, 0x4f, 0x17, 0x80, 0x02, 0x80, 0x70, 0xff, 0x02, 0xe9, 0x41,
+	0xdb, 0x04, 0x1a, 0x21, 0x74, 0x47, 0x03, 0xff, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x09,
+	0x03, 0x00, 0x00, 0x02, 0x01, 0x01, 0x09, 0x03, 0x00, 0x01, 0x03, 0x01, 0x03, 0x09, 0x02, 0x00, 0x02, 0x02, 0x01,
+	0x01, 0x01, 0x00, 0x08, 0x03, 0x4d, 0x17, 0x89, 0x0e, 0x07, 0xd1, 0x05, 0x75, 0x11, 0xe9, 0x02, 0x08, 0xdb, 0x01,
+	0x07, 0x20, 0xaa, 0x46, 0x9f, 0x86, 0x29, 0x68, 0xea, 0x44, 0x01, 0x14, 0x38, 0x51, 0x00, 0x05, 0x4e, 0xf4, 0x44,
+	0x01, 0xdf, 0x27, 0x26, 0x08, 0x60, 0x02, 0x82, 0x84, 0x01, 0x13, 0x04, 0x09, 0x03, 0x00, 0x00, 0x00, 0x00, 0x50,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x7f, 0x43,
+	0x08, 0x06, 0x03, 0x01, 0x01, 0x02, 0xff, 0x07, 0x91, 0x2e, 0xa1, 0x0b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xd1, 0x05, 0x08, 0xcc, 0xb1, 0x53, 0x39, 0xb6, 0xe3, 0x76,
+	0x49, 0xff, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0xff, 0x02, 0x7d, 0x41, 0x0a, 0x05, 0x01, 0x01, 0x01, 0x05,
+	0xb6, 0x06, 0xa1, 0x17, 0x39, 0x01, 0x03, 0x25, 0x06, 0x07, 0xed, 0x04, 0x2b, 0x39, 0x01, 0x07, 0x39, 0x01, 0x07,
+	0x39, 0x01, 0xff, 0x0b, 0x39, 0x01, 0xff, 0xa7, 0x39, 0x01, 0x39, 0x01, 0xff, 0x6b, 0x39, 0x01, 0xff, 0xa7, 0xb1,
+	0x03, 0x39, 0x01, 0x4f, 0x39, 0x01, 0x2b, 0x39, 0x01, 0x4b, 0x39, 0x01, 0x39, 0x01, 0x4b, 0x39, 0x01, 0xff, 0xef,
+	0xb1, 0x03, 0x07, 0x39, 0x01, 0x47, 0x39, 0x01, 0xff, 0xef, 0x39, 0x01, 0xff, 0x27, 0x39, 0x01, 0x1a, 0x78, 0x99,
+	0x95, 0xbd, 0xe7, 0x30, 0xd1, 0xdd, 0xea, 0x98, 0xe0, 0x62, 0x99, 0xb8, 0x12, 0x5b, 0xa1, 0xf9, 0xaa, 0xd6, 0x50,
+	0x7b, 0xf5, 0x8d, 0x0c, 0x81, 0x14, 0x00, 0x00, 0x00, 0x1a, 0x03, 0xdc, 0xfe, 0x58, 0x00, 0x00, 0x00, 0x00, 0x8e,
+	0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x7f, 0x3f, 0x0a
+};
+
+//! The same mesh coded with valence traversal, constrained multi parallelogram prediction and metadata
+static const uint8_t test_draco_edgebreaker_valence[] = {
+	0x44, 0x52, 0x41, 0x43, 0x4f, 0x02, 0x02, 0x01, 0x01, 0x00, 0x80, 0x01, 0x02, 0x01, 0x04, 0x6e, 0x61, 0x6d, 0x65,
+	0x03, 0x75, 0x76, 0x30, 0x01, 0x05, 0x63, 0x68, 0x69, 0x6c, 0x64, 0x01, 0x01, 0x6b, 0x02, 0x01, 0x02, 0x00, 0x00,
+	0x00, 0x02, 0x16, 0x18, 0x02, 0x17, 0x03, 0x01, 0x0f, 0x0f, 0x00, 0x80, 0x02, 0x80, 0x70, 0xff, 0x02, 0xe9, 0x41,
+	0xdb, 0x04, 0x1a, 0x21, 0x74, 0x47, 0x03, 0x00, 0x08, 0x00, 0x03, 0x03, 0x01, 0x18, 0x01, 0x28, 0x03, 0x00, 0xc2,
+	0xb4, 0xff, 0x1d, 0x05, 0x00, 0x04, 0x07, 0x69, 0x26, 0x99, 0x19, 0x03, 0xec, 0xac, 0x86, 0x9c, 0x0f, 0x07, 0x00,
+	0x04, 0x03, 0x71, 0x1b, 0x6d, 0x1b, 0x25, 0x09, 0x04, 0xcb, 0x7c, 0xdb, 0x80, 0x3b, 0x01, 0x02, 0x00, 0x03, 0x07,
+	0x01, 0x40, 0x01, 0x00, 0x0a, 0x00, 0x00, 0x03, 0xff, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x01, 0x00,
+	0x09, 0x03, 0x00, 0x00, 0x02, 0x01, 0x01, 0x09, 0x03, 0x00, 0x01, 0x03, 0x01, 0x03, 0x09, 0x02, 0x00, 0x02, 0x02,
+	0x04, 0x01, 0x01, 0x00, 0x08, 0x03, 0x89, 0x0e, 0xa1, 0x0b, 0x03, 0xe9, 0x02, 0x81, 0x11, 0x89, 0x0e, 0xe9, 0x02,
+	0x09, 0xc4, 0x06, 0x79, 0x16, 0xe4, 0x54, 0xa5, 0x7f, 0x82, 0x29, 0x68, 0xea, 0x44, 0x01, 0x14, 0x38, 0x01, 0x14,
+	0x05, 0x00, 0xd4, 0x1d, 0x7c, 0x9f, 0x98, 0x20, 0x80, 0x09, 0x28, 0x00, 0x20, 0x29, 0x05, 0x80, 0x27, 0x10, 0x20,
+	0x48, 0x18, 0x50, 0x00, 0x0c, 0x95, 0x04, 0x4d, 0x58, 0xcc, 0x80, 0x06, 0xab, 0x03, 0x56, 0xc7, 0x82, 0x00, 0x04,
+	0xc0, 0x03, 0x80, 0x89, 0x80, 0x00, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00,
+	0x80, 0xbf, 0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x7f, 0x43, 0x08, 0x06, 0x03, 0x01, 0x01, 0x02, 0xff, 0x07, 0x91,
+	0x2e, 0xa1, 0x0b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xef,
+	0xd1, 0x05, 0x08, 0xcc, 0xb1, 0x53, 0x39, 0xb6, 0xe3, 0x76, 0x49, 0xff, 0x03, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00,
+	0xff, 0x02, 0x7d, 0x41, 0x0a, 0x05, 0x01, 0x01, 0x01, 0x05, 0xb6, 0x06, 0xa1, 0x17, 0x39, 0x01, 0x03, 0x25, 0x06,
+	0x07, 0xed, 0x04, 0x2b, 0x39, 0x01, 0x07, 0x39, 0x01, 0x07, 0x39, 0x01, 0xff, 0x0b, 0x39, 0x01, 0xff, 0xa7, 0x39,
+	0x01, 0x39, 0x01, 0xff, 0x6b, 0x39, 0x01, 0xff, 0xa7, 0xb1, 0x03, 0x39, 0x01, 0x4f, 0x39, 0x01, 0x2b, 0x39, 0x01,
+	0x4b, 0x39, 0x01, 0x39, 0x01, 0x4b, 0x39, 0x01, 0xff, 0xef, 0xb1, 0x03, 0x07, 0x39, 0x01, 0x47, 0x39, 0x01, 0xff,
+	0xef, 0x39, 0x01, 0xff, 0x27, 0x39, 0x01, 0x1a, 0x78, 0x99, 0x95, 0xbd, 0xe7, 0x30, 0xd1, 0xdd, 0xea, 0x98, 0xe0,
+	0x62, 0x99, 0xb8, 0x12, 0x5b, 0xa1, 0xf9, 0xaa, 0xd6, 0x50, 0x7b, 0xf5, 0x8d, 0x0c, 0x81, 0x14, 0x00, 0x00, 0x00,
+	0x1a, 0x03, 0xdc, 0xfe, 0x58, 0x00, 0x00, 0x00, 0x00, 0x8e, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xc0, 0x7f, 0x3f, 0x0a
+};
+
+//! Position, normal and texture coordinate of each decoded index of the Edgebreaker test meshes
+static const float test_draco_edgebreaker_values[72][8] = {
+	{58.0f, 59.0f, 40.5f, 0.0f, 0.0f, -1.0f, 0.48828125f, 0.87890625f},
+	{58.0f, 39.0f, 60.5f, 0.0f, -1.0f, 0.0f, 0.68359375f, 0.48828125f},
+	{38.0f, 59.0f, 60.5f, -1.0f, 0.0f, 0.0f, 0.48828125f, 0.48828125f},
+	{38.0f, 59.0f, 60.5f, -1.0f, 0.0f, 0.0f, 0.48828125f, 0.48828125f},
+	{58.0f, 39.0f, 60.5f, 0.0f, -1.0f, 0.0f, 0.68359375f, 0.48828125f},
+	{58.0f, 59.0f, 80.5f, 0.0f, 0.0f, 1.0f, 0.48828125f, 0.09765625f},
+	{58.0f, 59.0f, 80.5f, 0.0f, 0.0f, 1.0f, 0.48828125f, 0.107421875f},
+	{58.0f, 39.0f, 60.5f, 0.0f, -1.0f, 0.0f, 0.68359375f, 0.48828125f},
+	{78.0f, 59.0f, 60.5f, 1.0f, 0.0f, 0.0f, 0.87890625f, 0.48828125f},
+	{58.0f, 39.0f, 60.5f, 0.0f, -1.0f, 0.0f, 0.68359375f, 0.48828125f},
+	{58.0f, 59.0f, 40.5f, 0.0f, 0.0f, -1.0f, 0.48828125f, 0.888671875f},
+	{78.0f, 59.0f, 60.5f, 1.0f, 0.0f, 0.0f, 0.87890625f, 0.48828125f},
+	{78.0f, 59.0f, 60.5f, 1.0f, 0.0f, 0.0f, 0.09765625f, 0.48828125f},
+	{58.0f, 59.0f, 40.5f, 0.0f, 0.0f, -1.0f, 0.48828125f, 0.87890625f},
+	{58.0f, 79.0f, 60.5f, 0.0f, 1.0f, 0.0f, 0.29296875f, 0.48828125f},
+	{58.0f, 59.0f, 40.5f, 0.0f, 0.0f, -1.0f, 0.48828125f, 0.87890625f},
+	{38.0f, 59.0f, 60.5f, -1.0f, 0.0f, 0.0f, 0.48828125f, 0.48828125f},
+	{58.0f, 79.0f, 60.5f, 0.0f, 1.0f, 0.0f, 0.29296875f, 0.48828125f},
+	{38.0f, 59.0f, 60.5f, -1.0f, 0.0f, 0.0f, 0.48828125f, 0.48828125f},
+	{58.0f, 59.0f, 80.5f, 0.0f, 0.0f, 1.0f, 0.48828125f, 0.09765625f},
+	{58.0f, 79.0f, 60.5f, 0.0f, 1.0f, 0.0f, 0.29296875f, 0.48828125f},
+	{-2.0f, -1.0f, 0.5f, -0.049342f, -0.049342f, 0.997562f, 0.0f, 0.0f},
+	{8.0f, 9.0f, 1.5f, -0.073753f, -0.073753f, 0.994546f, 0.29296875f, 0.29296875f},
+	{-2.0f, 9.0f, 0.5f, -0.131199f, -0.033931f, 0.990775f, 0.0f, 0.29296875f},
+	{8.0f, 9.0f, 1.5f, -0.073753f, -0.073753f, 0.994546f, 0.29296875f, 0.29296875f},
+	{8.0f, 19.0f, 2.5f, -0.07887f, 0.07887f, 0.99376f, 0.29296875f, 0.5859375f},
+	{-2.0f, 9.0f, 0.5f, -0.131199f, -0.033931f, 0.990775f, 0.0f, 0.29296875f},
+	{-2.0f, 9.0f, 0.5f, -0.131199f, -0.033931f, 0.990775f, 0.0f, 0.29296875f},
+	{8.0f, 19.0f, 2.5f, -0.07887f, 0.07887f, 0.99376f, 0.29296875f, 0.5859375f},
+	{-2.0f, 19.0f, 0.5f, -0.13234f, 0.065009f, 0.98907f, 0.0f, 0.5859375f},
+	{-2.0f, 29.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.87890625f},
+	{-2.0f, 19.0f, 0.5f, -0.13234f, 0.065009f, 0.98907f, 0.0f, 0.5859375f},
+	{8.0f, 29.0f, 0.5f, -0.065009f, 0.13234f, 0.98907f, 0.29296875f, 0.87890625f},
+	{-2.0f, 19.0f, 0.5f, -0.13234f, 0.065009f, 0.98907f, 0.0f, 0.5859375f},
+	{8.0f, 19.0f, 2.5f, -0.07887f, 0.07887f, 0.99376f, 0.29296875f, 0.5859375f},
+	{8.0f, 29.0f, 0.5f, -0.065009f, 0.13234f, 0.98907f, 0.29296875f, 0.87890625f},
+	{8.0f, 29.0f, 0.5f, -0.065009f, 0.13234f, 0.98907f, 0.29296875f, 0.87890625f},
+	{8.0f, 19.0f, 2.5f, -0.07887f, 0.07887f, 0.99376f, 0.29296875f, 0.5859375f},
+	{18.0f, 29.0f, 0.5f, 0.033931f, 0.131199f, 0.990775f, 0.5859375f, 0.87890625f},
+	{8.0f, 19.0f, 2.5f, -0.07887f, 0.07887f, 0.99376f, 0.29296875f, 0.5859375f},
+	{18.0f, 19.0f, 1.5f, 0.073753f, 0.073753f, 0.994546f, 0.5859375f, 0.5859375f},
+	{18.0f, 29.0f, 0.5f, 0.033931f, 0.131199f, 0.990775f, 0.5859375f, 0.87890625f},
+	{18.0f, 29.0f, 0.5f, 0.033931f, 0.131199f, 0.990775f, 0.5859375f, 0.87890625f},
+	{18.0f, 19.0f, 1.5f, 0.073753f, 0.073753f, 0.994546f, 0.5859375f, 0.5859375f},
+	{28.0f, 29.0f, 0.5f, 0.049342f, 0.049342f, 0.997562f, 0.87890625f, 0.87890625f},
+	{28.0f, 29.0f, 0.5f, 0.049342f, 0.049342f, 0.997562f, 0.87890625f, 0.87890625f},
+	{18.0f, 19.0f, 1.5f, 0.073753f, 0.073753f, 0.994546f, 0.5859375f, 0.5859375f},
+	{28.0f, 19.0f, 0.5f, 0.131199f, 0.033931f, 0.990775f, 0.87890625f, 0.5859375f},
+	{18.0f, 19.0f, 1.5f, 0.073753f, 0.073753f, 0.994546f, 0.5859375f, 0.5859375f},
+	{18.0f, 9.0f, 2.5f, 0.07887f, -0.07887f, 0.99376f, 0.5859375f, 0.29296875f},
+	{28.0f, 19.0f, 0.5f, 0.131199f, 0.033931f, 0.990775f, 0.87890625f, 0.5859375f},
+	{28.0f, 19.0f, 0.5f, 0.131199f, 0.033931f, 0.990775f, 0.87890625f, 0.5859375f},
+	{18.0f, 9.0f, 2.5f, 0.07887f, -0.07887f, 0.99376f, 0.5859375f, 0.29296875f},
+	{28.0f, 9.0f, 0.5f, 0.13234f, -0.065009f, 0.98907f, 0.87890625f, 0.29296875f},
+	{28.0f, -1.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.87890625f, 0.0f},
+	{28.0f, 9.0f, 0.5f, 0.13234f, -0.065009f, 0.98907f, 0.87890625f, 0.29296875f},
+	{18.0f, -1.0f, 0.5f, 0.065009f, -0.13234f, 0.98907f, 0.5859375f, 0.0f},
+	{28.0f, 9.0f, 0.5f, 0.13234f, -0.065009f, 0.98907f, 0.87890625f, 0.29296875f},
+	{18.0f, 9.0f, 2.5f, 0.07887f, -0.07887f, 0.99376f, 0.5859375f, 0.29296875f},
+	{18.0f, -1.0f, 0.5f, 0.065009f, -0.13234f, 0.98907f, 0.5859375f, 0.0f},
+	{18.0f, -1.0f, 0.5f, 0.065009f, -0.13234f, 0.98907f, 0.5859375f, 0.0f},
+	{18.0f, 9.0f, 2.5f, 0.07887f, -0.07887f, 0.99376f, 0.5859375f, 0.29296875f},
+	{8.0f, -1.0f, 0.5f, -0.033931f, -0.131199f, 0.990775f, 0.29296875f, 0.0f},
+	{18.0f, 9.0f, 2.5f, 0.07887f, -0.07887f, 0.99376f, 0.5859375f, 0.29296875f},
+	{8.0f, 9.0f, 1.5f, -0.073753f, -0.073753f, 0.994546f, 0.29296875f, 0.29296875f},
+	{8.0f, -1.0f, 0.5f, -0.033931f, -0.131199f, 0.990775f, 0.29296875f, 0.0f},
+	{8.0f, 9.0f, 1.5f, -0.073753f, -0.073753f, 0.994546f, 0.29296875f, 0.29296875f},
+	{-2.0f, -1.0f, 0.5f, -0.049342f, -0.049342f, 0.997562f, 0.0f, 0.0f},
+	{8.0f, -1.0f, 0.5f, -0.033931f, -0.131199f, 0.990775f, 0.29296875f, 0.0f},
+	{78.0f, 59.0f, 60.5f, 1.0f, 0.0f, 0.0f, 0.09765625f, 0.48828125f},
+	{58.0f, 79.0f, 60.5f, 0.0f, 1.0f, 0.0f, 0.29296875f, 0.48828125f},
+	{58.0f, 59.0f, 80.5f, 0.0f, 0.0f, 1.0f, 0.48828125f, 0.09765625f}
+};
+
+//! Build a glTF document with a single Draco compressed primitive stored in a data URI buffer,
+//! with normals and texture coordinates in accessors 2 and 3 and Draco attributes 1 and 2 if shaded
+static string_t
+test_draco_document(const uint8_t* bitstream, uint size, uint point_count, uint index_count, bool shaded) {
+	size_t encoded_capacity = ((size + 2) / 3) * 4 + 1;
+	char* encoded = memory_allocate(0, encoded_capacity, 0, MEMORY_TEMPORARY);
+	size_t encoded_length = base64_encode(bitstream, size, encoded, encoded_capacity);
+	string_t shading_accessors = string_allocate_format(
+	    STRING_CONST(",{\"componentType\": 5126, \"count\": %u, \"type\": \"VEC3\"},"
+	                 "{\"componentType\": 5126, \"count\": %u, \"type\": \"VEC2\"}"),
+	    point_count, point_count);
+	const char* shading_attributes = shaded ? ", \"NORMAL\": 2, \"TEXCOORD_0\": 3" : "";
+	const char* draco_attributes = shaded ? ", \"NORMAL\": 1, \"TEXCOORD_0\": 2" : "";
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"extensionsUsed\": [\"KHR_draco_mesh_compression\"],"
+	                 "\"extensionsRequired\": [\"KHR_draco_mesh_compression\"],"
+	                 "\"buffers\": [{\"uri\": \"data:application/octet-stream;base64,%.*s\", \"byteLength\": %u}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": %u}],"
+	                 "\"accessors\": [{\"componentType\": 5126, \"count\": %u, \"type\": \"VEC3\"},"
+	                 "{\"componentType\": 5125, \"count\": %u, \"type\": \"SCALAR\"}%.*s],"
+	                 "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0%s}, \"indices\": 1,"
+	                 "\"extensions\": {\"KHR_draco_mesh_compression\": {\"bufferView\": 0,"
+	                 "\"attributes\": {\"POSITION\": 0%s}}}}]}],"
+	                 "\"nodes\": [{\"mesh\": 0}], \"scenes\": [{\"nodes\": [0]}], \"scene\": 0}"),
+	    (int)encoded_length, encoded, size, size, point_count, index_count,
+	    shaded ? (int)shading_accessors.length : 0, shading_accessors.str, shading_attributes, draco_attributes);
+	string_deallocate(shading_accessors.str);
+	memory_deallocate(encoded);
+	return document;
+}
+
+static bool
+test_gltf_read_string(gltf_t* gltf, const char* document, size_t length) {
+	stream_t* stream =
+	    buffer_stream_allocate((void*)document, STREAM_IN | STREAM_BINARY, length, length, false, false);
+	bool success = gltf_read(gltf, stream);
+	stream_deallocate(stream);
+	return success;
+}
+
+//! Encode binary data as a base64 data URI
+static string_t
+test_gltf_data_uri(const void* data, size_t size) {
+	const char prefix[] = "data:application/octet-stream;base64,";
+	size_t capacity = sizeof(prefix) + ((size + 2) / 3) * 4 + 1;
+	string_t uri = string_allocate(0, capacity);
+	memcpy(uri.str, prefix, sizeof(prefix) - 1);
+	uri.length = sizeof(prefix) - 1;
+	uri.length += base64_encode(data, size, uri.str + uri.length, capacity - uri.length);
+	return uri;
+}
+
+//! Compare computed values with a tolerance for rounding in transform chains
+static bool
+test_gltf_near(float value, float expected) {
+	return math_abs(value - expected) < 0.0001f;
 }
 
-DECLARE_TEST(tcp, create) {
-	socket_t* sock = tcp_socket_allocate();
-	socket_deallocate(sock);
+//! Initialize a mesh with vertices spread over a few rows and triangles without material
+static void
+test_gltf_mesh_initialize(mesh_t* mesh, uint vertex_count, uint triangle_count) {
+	memset(mesh, 0, sizeof(mesh_t));
+	bucketarray_initialize(&mesh->coordinate, sizeof(mesh_coordinate_t), 4096);
+	bucketarray_initialize(&mesh->normal, sizeof(mesh_normal_t), 4096);
+	bucketarray_initialize(&mesh->vertex, sizeof(mesh_vertex_t), 4096);
+	bucketarray_initialize(&mesh->triangle, sizeof(mesh_triangle_t), 4096);
+	bucketarray_resize(&mesh->coordinate, vertex_count);
+	bucketarray_resize(&mesh->vertex, vertex_count);
+	bucketarray_resize(&mesh->triangle, triangle_count);
+	for (uint ivertex = 0; ivertex < vertex_count; ++ivertex) {
+		mesh_coordinate_t* coordinate = bucketarray_get(&mesh->coordinate, ivertex);
+		*coordinate = vector((real)ivertex * 0.25f, (real)(ivertex % 7), (real)(ivertex % 3) * 0.5f, 1);
+		mesh_vertex_t* vertex = bucketarray_get(&mesh->vertex, ivertex);
+		memset(vertex, 0, sizeof(mesh_vertex_t));
+		vertex->coordinate = ivertex;
+	}
+	for (uint itri = 0; itri < triangle_count; ++itri) {
+		mesh_triangle_t* triangle = bucketarray_get(&mesh->triangle, itri);
+		triangle->vertex[0] = itri % vertex_count;
+		triangle->vertex[1] = (itri + 1) % vertex_count;
+		triangle->vertex[2] = (itri + 2) % vertex_count;
+		triangle->material = GLTF_INVALID_INDEX;
+	}
+}
+
+static void
+test_gltf_mesh_finalize(mesh_t* mesh) {
+	bucketarray_finalize(&mesh->coordinate);
+	bucketarray_finalize(&mesh->normal);
+	bucketarray_finalize(&mesh->vertex);
+	bucketarray_finalize(&mesh->triangle);
+}
+
+//! Check that the first two accessors of a document hold the positions and indices of a mesh
+//! added with test_gltf_mesh_initialize
+static bool
+test_gltf_mesh_verify(gltf_t* gltf, const mesh_t* mesh) {
+	uint vertex_count = (uint)mesh->vertex.count;
+	uint index_count = (uint)mesh->triangle.count * 3;
+	if ((array_count(gltf->accessors) < 2) || (gltf->accessors[0].count != vertex_count) ||
+	    (gltf->accessors[1].count != index_count))
+		return false;
+	float* positions = memory_allocate(0, sizeof(float) * 3 * vertex_count, 0, MEMORY_PERSISTENT);
+	uint* indices = memory_allocate(0, sizeof(uint) * index_count, 0, MEMORY_PERSISTENT);
+	bool success = gltf_accessor_read_float(gltf, 0, positions, 3) && gltf_accessor_read_uint(gltf, 1, indices, 1);
+	for (uint ivertex = 0; success && (ivertex < vertex_count); ++ivertex) {
+		const mesh_coordinate_t* coordinate = bucketarray_get_const(&mesh->coordinate, ivertex);
+		success = (positions[ivertex * 3] == vector_x(*coordinate)) &&
+		          (positions[(ivertex * 3) + 1] == vector_y(*coordinate)) &&
+		          (positions[(ivertex * 3) + 2] == vector_z(*coordinate));
+	}
+	for (uint itri = 0; success && (itri < mesh->triangle.count); ++itri) {
+		const mesh_triangle_t* triangle = bucketarray_get_const(&mesh->triangle, itri);
+		success = (indices[itri * 3] == triangle->vertex[0]) && (indices[(itri * 3) + 1] == triangle->vertex[1]) &&
+		          (indices[(itri * 3) + 2] == triangle->vertex[2]);
+	}
+	memory_deallocate(positions);
+	memory_deallocate(indices);
+	return success;
+}
+
+//! Write the document to a memory buffer, returning the written bytes
+static char*
+test_gltf_write_memory(gltf_t* gltf, size_t* size) {
+	stream_t* output = buffer_stream_allocate(nullptr, STREAM_IN | STREAM_OUT | STREAM_BINARY, 0, 0, true, true);
+	if (!gltf_write(gltf, output)) {
+		stream_deallocate(output);
+		return nullptr;
+	}
+	*size = stream_size(output);
+	char* written = memory_allocate(0, *size ? *size : 1, 0, MEMORY_PERSISTENT);
+	stream_seek(output, 0, STREAM_SEEK_BEGIN);
+	if (stream_read(output, written, *size) != *size) {
+		memory_deallocate(written);
+		written = nullptr;
+	}
+	stream_deallocate(output);
+	return written;
+}
+
+DECLARE_TEST(animation, read_sample) {
+	const float data[] = {0, 1, 0, 0, 0, 2, 4, 6};
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 32}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 8},"
+	                 "{\"buffer\": 0, \"byteOffset\": 8, \"byteLength\": 24}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 2, \"type\": \"SCALAR\"},"
+	                 "{\"bufferView\": 1, \"componentType\": 5126, \"count\": 2, \"type\": \"VEC3\"}],"
+	                 "\"nodes\": [{\"name\": \"root\"}],"
+	                 "\"animations\": [{\"name\": \"move\","
+	                 "\"channels\": [{\"sampler\": 0, \"target\": {\"node\": 0, \"path\": \"translation\"}}],"
+	                 "\"samplers\": [{\"input\": 0, \"output\": 1, \"interpolation\": \"STEP\"}]}]}"),
+	    STRING_FORMAT(uri));
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	EXPECT_EQ(array_count(gltf.animations), 1);
+	EXPECT_CONSTSTRINGEQ(gltf.animations[0].name, string_const(STRING_CONST("move")));
+	EXPECT_EQ(array_count(gltf.animations[0].channels), 1);
+	EXPECT_EQ(array_count(gltf.animations[0].samplers), 1);
+	EXPECT_EQ(gltf.animations[0].channels[0].sampler, 0);
+	EXPECT_EQ(gltf.animations[0].channels[0].node, 0);
+	EXPECT_EQ(gltf.animations[0].channels[0].path, GLTF_ANIMATION_TRANSLATION);
+	EXPECT_EQ(gltf.animations[0].samplers[0].input, 0);
+	EXPECT_EQ(gltf.animations[0].samplers[0].output, 1);
+	EXPECT_EQ(gltf.animations[0].samplers[0].interpolation, GLTF_INTERPOLATION_STEP);
+
+	// Step interpolation holds the previous keyframe, switch to linear to sample between keyframes
+	gltf.animations[0].samplers[0].interpolation = GLTF_INTERPOLATION_LINEAR;
+	gltf_animation_curves_t curves;
+	gltf_animation_curves_initialize(&curves);
+	EXPECT_TRUE(gltf_animation_curves_build(&curves, &gltf, 0));
+	EXPECT_EQ(curves.channel_count, 1);
+	EXPECT_EQ(curves.output_size, 3);
+	uint cursor = 0;
+	float output[3];
+	gltf_animation_curves_sample(&curves, 0.5f, &cursor, output);
+	EXPECT_REALEQ(output[0], 1.0f);
+	EXPECT_REALEQ(output[1], 2.0f);
+	EXPECT_REALEQ(output[2], 3.0f);
+	gltf_animation_curves_sample(&curves, 2.0f, &cursor, output);
+	EXPECT_REALEQ(output[0], 2.0f);
+	EXPECT_REALEQ(output[2], 6.0f);
+	gltf_animation_curves_finalize(&curves);
+
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
 	return 0;
 }
 
-DECLARE_TEST(tcp, blocking) {
-	socket_t* sock = tcp_socket_allocate();
+DECLARE_TEST(bounds, compute) {
+	// Unit box mesh on a node at (10, 0, 0) with a child at (0, 5, 0) scaled by 2
+	const char document[] = "{\"asset\": {\"version\": \"2.0\"},"
+	                        "\"accessors\": [{\"componentType\": 5126, \"count\": 8, \"type\": \"VEC3\","
+	                        "\"min\": [-1, -1, -1], \"max\": [1, 1, 1]}],"
+	                        "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}}]}],"
+	                        "\"nodes\": [{\"mesh\": 0, \"translation\": [10, 0, 0], \"children\": [1]},"
+	                        "{\"mesh\": 0, \"translation\": [0, 5, 0], \"scale\": [2, 2, 2]}, {}],"
+	                        "\"scenes\": [{\"nodes\": [0]}, {\"nodes\": [2]}], \"scene\": 0}";
 
-	socket_set_blocking(sock, false);
-	EXPECT_FALSE(socket_blocking(sock));
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+	EXPECT_TRUE(gltf_bounds_compute(&gltf));
+	EXPECT_EQ(array_count(gltf.mesh_bounds), 1);
+	EXPECT_EQ(array_count(gltf.node_bounds), 3);
+	EXPECT_EQ(array_count(gltf.scene_bounds), 2);
 
-	socket_set_blocking(sock, true);
-	EXPECT_TRUE(socket_blocking(sock));
+	const gltf_bounds_t* primitive = &gltf.meshes[0].primitives[0].bounds;
+	EXPECT_REALEQ(primitive->min[0], -1.0f);
+	EXPECT_REALEQ(primitive->max[2], 1.0f);
+	EXPECT_TRUE(test_gltf_near(primitive->radius, math_sqrt(3.0f)));
 
-	socket_deallocate(sock);
+	// Child bounds are in world space and merged into the parent
+	const gltf_bounds_t* child = gltf.node_bounds + 1;
+	const float child_min[] = {8, 3, -2};
+	const float child_max[] = {12, 7, 2};
+	const gltf_bounds_t* parent = gltf.node_bounds;
+	const float parent_min[] = {8, -1, -2};
+	const float parent_max[] = {12, 7, 2};
+	for (uint icomp = 0; icomp < 3; ++icomp) {
+		EXPECT_TRUE(test_gltf_near(child->min[icomp], child_min[icomp]));
+		EXPECT_TRUE(test_gltf_near(child->max[icomp], child_max[icomp]));
+		EXPECT_TRUE(test_gltf_near(parent->min[icomp], parent_min[icomp]));
+		EXPECT_TRUE(test_gltf_near(parent->max[icomp], parent_max[icomp]));
+		EXPECT_TRUE(test_gltf_near(gltf.scene_bounds[0].min[icomp], parent_min[icomp]));
+		EXPECT_TRUE(test_gltf_near(gltf.scene_bounds[0].max[icomp], parent_max[icomp]));
+	}
+	EXPECT_TRUE(test_gltf_near(parent->center[0], 10.0f));
+	EXPECT_TRUE(test_gltf_near(parent->center[1], 3.0f));
+	EXPECT_TRUE(test_gltf_near(parent->radius, math_sqrt(24.0f)));
+
+	// Nodes and scenes without meshes have empty bounds
+	EXPECT_TRUE(gltf_bounds_is_empty(gltf.node_bounds + 2));
+	EXPECT_TRUE(gltf_bounds_is_empty(gltf.scene_bounds + 1));
+	EXPECT_FALSE(gltf_bounds_is_empty(gltf.scene_bounds));
 
+	gltf_finalize(&gltf);
 	return 0;
 }
 
-DECLARE_TEST(tcp, bind) {
-	bool has_ipv4 = network_supports_ipv4();
-	bool has_ipv6 = network_supports_ipv6();
-	bool was_bound = false;
-	unsigned int port;
+DECLARE_TEST(bvh, scene_query) {
+	// Grid of 10 by 10 unit box nodes spaced 3 units apart in the xz plane
+	const char document[] = "{\"asset\": {\"version\": \"2.0\"},"
+	                        "\"accessors\": [{\"componentType\": 5126, \"count\": 8, \"type\": \"VEC3\","
+	                        "\"min\": [-1, -1, -1], \"max\": [1, 1, 1]}],"
+	                        "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}}]}]}";
+	const uint grid_size = 10;
 
-	if (has_ipv4) {
-		socket_t* sock = tcp_socket_allocate();
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+	for (uint inode = 0; inode < grid_size * grid_size; ++inode) {
+		matrix_t transform = matrix_identity();
+		transform.frow[3][0] = (float)(3 * (inode / grid_size));
+		transform.frow[3][2] = (float)(3 * (inode % grid_size));
+		gltf_node_add(&gltf, STRING_CONST("box"), 0, &transform);
+	}
 
-		EXPECT_EQ(socket_address_local(sock), 0);
-		EXPECT_EQ(socket_address_remote(sock), 0);
-		EXPECT_EQ(socket_state(sock), SOCKETSTATE_NOTCONNECTED);
+	gltf_bvh_t bvh;
+	gltf_bvh_initialize(&bvh);
+	EXPECT_TRUE(gltf_bvh_build_scene(&bvh, &gltf, GLTF_INVALID_INDEX));
+	EXPECT_EQ(bvh.item_count, grid_size * grid_size);
 
-		for (port = 31890; !was_bound && (port < 32890); ++port) {
-			network_address_ipv4_t address;
-			network_address_ipv4_initialize(&address);
-			network_address_ip_set_port((network_address_t*)&address, port);
+	// Rays down onto each box hit the top face, rays between boxes miss
+	gltf_bvh_ray_t rays[2 * 10 * 10];
+	gltf_bvh_hit_t hits[2 * 10 * 10];
+	uint ray_count = 2 * grid_size * grid_size;
+	for (uint iray = 0; iray < ray_count; ++iray) {
+		uint inode = iray / 2;
+		float offset = (iray & 1) ? 1.5f : 0.25f;
+		rays[iray].origin[0] = (float)(3 * (inode / grid_size)) + offset;
+		rays[iray].origin[1] = 10;
+		rays[iray].origin[2] = (float)(3 * (inode % grid_size));
+		rays[iray].direction[0] = 0;
+		rays[iray].direction[1] = -1;
+		rays[iray].direction[2] = 0;
+		rays[iray].distance = 100;
+	}
+	gltf_bvh_query_rays(&bvh, rays, ray_count, hits, nullptr, nullptr);
+	for (uint iray = 0; iray < ray_count; ++iray) {
+		if (iray & 1) {
+			EXPECT_EQ(hits[iray].item, GLTF_INVALID_INDEX);
+		} else {
+			EXPECT_EQ(hits[iray].item, iray / 2);
+			EXPECT_TRUE(test_gltf_near(hits[iray].distance, 9.0f));
+		}
+	}
 
-			if (socket_bind(sock, (network_address_t*)&address)) {
-				EXPECT_NE(socket_address_local(sock), 0);
-				EXPECT_EQ(socket_address_remote(sock), 0);
-				EXPECT_EQ(socket_state(sock), SOCKETSTATE_NOTCONNECTED);
+	// Box overlapping a single node
+	const float box_min[] = {2.5f, -1, 2.5f};
+	const float box_max[] = {3.5f, 1, 3.5f};
+	uint* items = gltf_bvh_query_box(&bvh, box_min, box_max, nullptr);
+	EXPECT_EQ(array_count(items), 1);
+	EXPECT_EQ(items[0], grid_size + 1);
+	array_clear(items);
 
-				EXPECT_TRUE(network_address_equal(socket_address_local(sock), (network_address_t*)&address));
+	// Slab between x = 2.5 and x = 6.5 contains the second and third columns
+	const float planes[2][4] = {{1, 0, 0, -2.5f}, {-1, 0, 0, 6.5f}};
+	items = gltf_bvh_query_frustum(&bvh, planes, 2, items);
+	EXPECT_EQ(array_count(items), 2 * grid_size);
+	for (uint iitem = 0; iitem < array_count(items); ++iitem) {
+		EXPECT_GE(items[iitem], grid_size);
+		EXPECT_LT(items[iitem], 3 * grid_size);
+	}
+	array_deallocate(items);
+
+	gltf_bvh_finalize(&bvh);
+	gltf_finalize(&gltf);
+	return 0;
+}
+
+DECLARE_TEST(draco, read_write) {
+	const float positions[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0};
+	const uint indices[] = {0, 1, 2, 2, 1, 3};
+	uint8_t* bitstream = test_draco_encode_sequential(positions, 4, indices, 6);
+	string_t document = test_draco_document(bitstream, array_count(bitstream), 4, 6, false);
+	array_deallocate(bitstream);
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	EXPECT_EQ(gltf.meshes[0].primitives[0].draco.buffer_view, GLTF_INVALID_INDEX);
+
+	float decoded_positions[12];
+	uint decoded_indices[6];
+	EXPECT_TRUE(gltf_accessor_read_float(&gltf, 0, decoded_positions, 3));
+	EXPECT_TRUE(gltf_accessor_read_uint(&gltf, 1, decoded_indices, 1));
+	EXPECT_EQ(memcmp(decoded_positions, positions, sizeof(positions)), 0);
+	EXPECT_EQ(memcmp(decoded_indices, indices, sizeof(indices)), 0);
+
+	// Decoded geometry lives in a buffer without uri, which must be written out with the document
+	gltf.file_type = GLTF_FILE_GLTF_EMBED;
+	stream_t* output = buffer_stream_allocate(nullptr, STREAM_IN | STREAM_OUT | STREAM_BINARY, 0, 0, true, true);
+	EXPECT_TRUE(gltf_write(&gltf, output));
+	gltf_finalize(&gltf);
+
+	size_t written_size = stream_size(output);
+	char* written = memory_allocate(0, written_size, 0, MEMORY_PERSISTENT);
+	stream_seek(output, 0, STREAM_SEEK_BEGIN);
+	EXPECT_EQ(stream_read(output, written, written_size), written_size);
+	stream_deallocate(output);
+
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, written, written_size));
+	EXPECT_EQ(gltf.meshes[0].primitives[0].draco.buffer_view, GLTF_INVALID_INDEX);
+	memset(decoded_positions, 0, sizeof(decoded_positions));
+	memset(decoded_indices, 0, sizeof(decoded_indices));
+	EXPECT_TRUE(gltf_accessor_read_float(&gltf, 0, decoded_positions, 3));
+	EXPECT_TRUE(gltf_accessor_read_uint(&gltf, 1, decoded_indices, 1));
+	EXPECT_EQ(memcmp(decoded_positions, positions, sizeof(positions)), 0);
+	EXPECT_EQ(memcmp(decoded_indices, indices, sizeof(indices)), 0);
+	gltf_finalize(&gltf);
+
+	memory_deallocate(written);
+	string_deallocate(document.str);
+	return 0;
+}
 
-				was_bound = true;
+DECLARE_TEST(draco, edgebreaker) {
+	const uint8_t* bitstreams[] = {test_draco_edgebreaker_standard, test_draco_edgebreaker_valence};
+	const uint sizes[] = {sizeof(test_draco_edgebreaker_standard), sizeof(test_draco_edgebreaker_valence)};
+	for (uint istream = 0; istream < 2; ++istream) {
+		string_t document = test_draco_document(bitstreams[istream], sizes[istream], 26, 72, true);
+		gltf_t gltf;
+		gltf_initialize(&gltf);
+		EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+		EXPECT_EQ(gltf.meshes[0].primitives[0].draco.buffer_view, GLTF_INVALID_INDEX);
+
+		// Points are not required to keep the encoder order, compare the values referenced by each index
+		float positions[26 * 3];
+		float normals[26 * 3];
+		float texcoords[26 * 2];
+		uint indices[72];
+		EXPECT_TRUE(gltf_accessor_read_float(&gltf, 0, positions, 3));
+		EXPECT_TRUE(gltf_accessor_read_uint(&gltf, 1, indices, 1));
+		EXPECT_TRUE(gltf_accessor_read_float(&gltf, 2, normals, 3));
+		EXPECT_TRUE(gltf_accessor_read_float(&gltf, 3, texcoords, 2));
+		for (uint iindex = 0; iindex < 72; ++iindex) {
+			const float* expected = test_draco_edgebreaker_values[iindex];
+			uint point = indices[iindex];
+			EXPECT_LT(point, 26);
+			for (uint icomp = 0; icomp < 3; ++icomp) {
+				EXPECT_REALEQ(positions[(point * 3) + icomp], expected[icomp]);
+				EXPECT_TRUE(math_abs(normals[(point * 3) + icomp] - expected[3 + icomp]) < 0.00001f);
 			}
+			EXPECT_REALEQ(texcoords[point * 2], expected[6]);
+			EXPECT_REALEQ(texcoords[(point * 2) + 1], expected[7]);
 		}
-		EXPECT_TRUE(was_bound);
 
-		socket_deallocate(sock);
+		gltf_finalize(&gltf);
+		string_deallocate(document.str);
+	}
+	return 0;
+}
+
+typedef struct test_gltf_extension_t {
+	uint calls;
+	uint level;
+	string_const_t label;
+	gltf_extension_owner owner;
+	void* object;
+} test_gltf_extension_t;
+
+static bool
+test_gltf_extension_parse(gltf_t* gltf, const char* buffer, json_token_t* tokens, size_t itoken,
+                          gltf_extension_owner owner, void* object, void* context) {
+	test_gltf_extension_t* extension = context;
+	if (tokens[itoken].type != JSON_OBJECT)
+		return false;
+	++extension->calls;
+	extension->owner = owner;
+	extension->object = object;
+	size_t ichild = tokens[itoken].child;
+	while (ichild) {
+		string_const_t identifier = json_token_identifier(buffer, tokens + ichild);
+		if (string_equal(STRING_ARGS(identifier), STRING_CONST("level"))) {
+			if (!gltf_token_to_integer(gltf, buffer, tokens, ichild, &extension->level))
+				return false;
+		} else if (string_equal(STRING_ARGS(identifier), STRING_CONST("label"))) {
+			extension->label = json_token_value(buffer, tokens + ichild);
+		}
+		ichild = tokens[ichild].sibling;
 	}
+	return true;
+}
+
+DECLARE_TEST(extension, handler) {
+	const char document[] = "{\"asset\": {\"version\": \"2.0\"},"
+	                        "\"extensionsUsed\": [\"EXT_test\", \"EXT_other\"],"
+	                        "\"nodes\": [{}, {\"extensions\": {\"EXT_other\": {\"level\": 9},"
+	                        "\"EXT_test\": {\"label\": \"second\", \"level\": 7, \"nested\": {\"level\": 1}}}}]}";
 
-	if (has_ipv6) {
-		socket_t* sock = tcp_socket_allocate();
+	test_gltf_extension_t extension;
+	memset(&extension, 0, sizeof(extension));
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	gltf_extension_register(&gltf, STRING_CONST("EXT_test"), test_gltf_extension_parse, &extension);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+	EXPECT_EQ(array_count(gltf.nodes), 2);
+	EXPECT_EQ(extension.calls, 1);
+	EXPECT_EQ(extension.owner, GLTF_EXTENSION_OWNER_NODE);
+	EXPECT_TRUE(extension.object == gltf.nodes + 1);
+	EXPECT_EQ(extension.level, 7);
+	EXPECT_CONSTSTRINGEQ(extension.label, string_const(STRING_CONST("second")));
+	EXPECT_GT(gltf.nodes[1].extensions.length, 0);
 
-		was_bound = false;
-		for (port = 31890; !was_bound && (port < 32890); ++port) {
-			network_address_ipv6_t address;
-			network_address_ipv6_initialize(&address);
-			network_address_ip_set_port((network_address_t*)&address, port);
+	// A handler rejecting the value aborts the read, and unregistered handlers are not called
+	const char invalid[] = "{\"asset\": {\"version\": \"2.0\"},"
+	                       "\"nodes\": [{\"extensions\": {\"EXT_test\": [7]}}]}";
+	gltf_finalize(&gltf);
+	gltf_initialize(&gltf);
+	gltf_extension_register(&gltf, STRING_CONST("EXT_test"), test_gltf_extension_parse, &extension);
+	EXPECT_FALSE(test_gltf_read_string(&gltf, invalid, sizeof(invalid) - 1));
+	gltf_finalize(&gltf);
 
-			if (socket_bind(sock, (network_address_t*)&address)) {
-				EXPECT_NE(socket_address_local(sock), 0);
-				EXPECT_EQ(socket_address_remote(sock), 0);
-				EXPECT_EQ(socket_state(sock), SOCKETSTATE_NOTCONNECTED);
+	memset(&extension, 0, sizeof(extension));
+	gltf_initialize(&gltf);
+	gltf_extension_register(&gltf, STRING_CONST("EXT_test"), test_gltf_extension_parse, &extension);
+	gltf_extension_register(&gltf, STRING_CONST("EXT_test"), nullptr, nullptr);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+	EXPECT_EQ(extension.calls, 0);
+	gltf_finalize(&gltf);
+	return 0;
+}
 
-				EXPECT_TRUE(network_address_equal(socket_address_local(sock), (network_address_t*)&address));
+DECLARE_TEST(hierarchy, world_transform) {
+	// Root rotated 90 degrees around z, a scaled child with a grandchild and a matrix child
+	const char document[] =
+	    "{\"asset\": {\"version\": \"2.0\"},"
+	    "\"nodes\": [{\"translation\": [1, 0, 0], \"rotation\": [0, 0, 0.70710678, 0.70710678], \"children\": [1, 2]},"
+	    "{\"translation\": [0, 1, 0], \"scale\": [2, 2, 2], \"children\": [3]},"
+	    "{\"matrix\": [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 3, 1]}, {\"translation\": [1, 0, 0]},"
+	    "{\"children\": [5]}, {\"children\": [4]}],"
+	    "\"scenes\": [{\"nodes\": [0]}, {\"nodes\": [4]}], \"scene\": 0}";
 
-				was_bound = true;
-			}
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+
+	gltf_hierarchy_t hierarchy;
+	gltf_hierarchy_initialize(&hierarchy);
+	EXPECT_TRUE(gltf_hierarchy_build(&hierarchy, &gltf, 0));
+	EXPECT_EQ(hierarchy.count, 4);
+	for (uint ientry = 0; ientry < hierarchy.count; ++ientry) {
+		EXPECT_EQ(hierarchy.entry[hierarchy.node[ientry]], ientry);
+		if (hierarchy.parent[ientry] != GLTF_INVALID_INDEX)
+			EXPECT_LT(hierarchy.parent[ientry], ientry);
+	}
+	EXPECT_EQ(hierarchy.node[0], 0);
+	EXPECT_EQ(hierarchy.parent[hierarchy.entry[3]], hierarchy.entry[1]);
+	EXPECT_EQ(hierarchy.entry[4], GLTF_INVALID_INDEX);
+	EXPECT_TRUE(hierarchy.has_matrix[hierarchy.entry[2]]);
+
+	// World translations, and the grandchild x axis rotated and scaled
+	const matrix_t* world = hierarchy.world;
+	EXPECT_TRUE(test_gltf_near(world[hierarchy.entry[1]].frow[3][0], 0.0f));
+	EXPECT_TRUE(test_gltf_near(world[hierarchy.entry[1]].frow[3][1], 0.0f));
+	EXPECT_TRUE(test_gltf_near(world[hierarchy.entry[2]].frow[3][0], 1.0f));
+	EXPECT_TRUE(test_gltf_near(world[hierarchy.entry[2]].frow[3][2], 3.0f));
+	const matrix_t* grandchild = world + hierarchy.entry[3];
+	EXPECT_TRUE(test_gltf_near(grandchild->frow[3][0], 0.0f));
+	EXPECT_TRUE(test_gltf_near(grandchild->frow[3][1], 2.0f));
+	EXPECT_TRUE(test_gltf_near(grandchild->frow[0][0], 0.0f));
+	EXPECT_TRUE(test_gltf_near(grandchild->frow[0][1], 2.0f));
+
+	// World transforms are the chained local transforms
+	matrix_t parent_world;
+	gltf_hierarchy_multiply(&parent_world, hierarchy.local + hierarchy.entry[1], hierarchy.local);
+	matrix_t chained;
+	gltf_hierarchy_multiply(&chained, hierarchy.local + hierarchy.entry[3], &parent_world);
+	for (uint irow = 0; irow < 4; ++irow) {
+		for (uint icol = 0; icol < 4; ++icol)
+			EXPECT_TRUE(test_gltf_near(chained.frow[irow][icol], grandchild->frow[irow][icol]));
+	}
+
+	// Updating the root translation moves all descendants
+	hierarchy.translation[0][0] = 5;
+	gltf_hierarchy_update_local(&hierarchy);
+	gltf_hierarchy_update_world(&hierarchy);
+	EXPECT_TRUE(test_gltf_near(grandchild->frow[3][0], 4.0f));
+	EXPECT_TRUE(test_gltf_near(grandchild->frow[3][1], 2.0f));
+	EXPECT_TRUE(test_gltf_near(world[hierarchy.entry[2]].frow[3][0], 5.0f));
+
+	// Nodes forming a cycle are rejected
+	EXPECT_FALSE(gltf_hierarchy_build(&hierarchy, &gltf, 1));
+
+	gltf_hierarchy_finalize(&hierarchy);
+	gltf_finalize(&gltf);
+	return 0;
+}
+
+DECLARE_TEST(mesh, material_buckets) {
+	const uint triangle_count = 1024 * 1024;
+	const uint material_count = 500;
+	const uint vertex_count = 3 * 1024;
+
+	mesh_t mesh;
+	memset(&mesh, 0, sizeof(mesh));
+	bucketarray_initialize(&mesh.coordinate, sizeof(mesh_coordinate_t), 4096);
+	bucketarray_initialize(&mesh.normal, sizeof(mesh_normal_t), 4096);
+	bucketarray_initialize(&mesh.vertex, sizeof(mesh_vertex_t), 4096);
+	bucketarray_initialize(&mesh.triangle, sizeof(mesh_triangle_t), 4096);
+	bucketarray_resize(&mesh.coordinate, vertex_count);
+	bucketarray_resize(&mesh.vertex, vertex_count);
+	bucketarray_resize(&mesh.triangle, triangle_count);
+	for (uint ivertex = 0; ivertex < vertex_count; ++ivertex) {
+		mesh_coordinate_t* coordinate = bucketarray_get(&mesh.coordinate, ivertex);
+		*coordinate = vector((real)ivertex, (real)(ivertex % 3), 0, 1);
+		mesh_vertex_t* vertex = bucketarray_get(&mesh.vertex, ivertex);
+		memset(vertex, 0, sizeof(mesh_vertex_t));
+		vertex->coordinate = ivertex;
+	}
+	// Every 1000th triangle has an invalid material and must end up in a primitive without material
+	uint invalid_count = 0;
+	for (uint itri = 0; itri < triangle_count; ++itri) {
+		mesh_triangle_t* triangle = bucketarray_get(&mesh.triangle, itri);
+		triangle->vertex[0] = (itri * 3) % vertex_count;
+		triangle->vertex[1] = (itri * 3 + 1) % vertex_count;
+		triangle->vertex[2] = (itri * 3 + 2) % vertex_count;
+		triangle->material = (itri % 1000) ? (itri % material_count) : GLTF_INVALID_INDEX;
+		if (triangle->material == GLTF_INVALID_INDEX)
+			++invalid_count;
+	}
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	for (uint imaterial = 0; imaterial < material_count; ++imaterial) {
+		gltf_material_t material;
+		memset(&material, 0, sizeof(material));
+		gltf_material_initialize(&material);
+		array_push(gltf.materials, material);
+	}
+
+	tick_t start = time_current();
+	uint imesh = gltf_mesh_add_mesh(&gltf, &mesh, nullptr);
+	deltatime_t elapsed = time_elapsed(start);
+	log_infof(HASH_TEST, STRING_CONST("Added mesh with %u triangles and %u materials in %.2fms"), triangle_count,
+	          material_count, (double)elapsed * 1000.0);
+
+	EXPECT_EQ(imesh, 0);
+	EXPECT_EQ(array_count(gltf.meshes[imesh].primitives), material_count + 1);
+	uint total_index_count = 0;
+	for (uint iprim = 0; iprim < array_count(gltf.meshes[imesh].primitives); ++iprim) {
+		const gltf_primitive_t* primitive = gltf.meshes[imesh].primitives + iprim;
+		uint index_count = gltf.accessors[primitive->indices].count;
+		if (iprim < material_count) {
+			EXPECT_EQ(primitive->material, iprim);
+		} else {
+			EXPECT_EQ(primitive->material, GLTF_INVALID_INDEX);
+			EXPECT_EQ(index_count, invalid_count * 3);
 		}
-		EXPECT_TRUE(was_bound);
+		total_index_count += index_count;
+	}
+	EXPECT_EQ(total_index_count, triangle_count * 3);
+	gltf_finalize(&gltf);
 
-		socket_deallocate(sock);
+	// Material ids are kept when the mesh is added before the materials
+	gltf_initialize(&gltf);
+	imesh = gltf_mesh_add_mesh(&gltf, &mesh, nullptr);
+	EXPECT_EQ(imesh, 0);
+	EXPECT_EQ(array_count(gltf.meshes[imesh].primitives), material_count + 1);
+	for (uint iprim = 0; iprim < array_count(gltf.meshes[imesh].primitives); ++iprim) {
+		const gltf_primitive_t* primitive = gltf.meshes[imesh].primitives + iprim;
+		EXPECT_EQ(primitive->material, (iprim < material_count) ? iprim : GLTF_INVALID_INDEX);
 	}
+	gltf_finalize(&gltf);
 
+	bucketarray_finalize(&mesh.coordinate);
+	bucketarray_finalize(&mesh.normal);
+	bucketarray_finalize(&mesh.vertex);
+	bucketarray_finalize(&mesh.triangle);
 	return 0;
 }
 
-DECLARE_TEST(udp, create) {
-	socket_t* sock = udp_socket_allocate();
-	socket_deallocate(sock);
+//! Decode an index sequence encoded with the EXT_meshopt_compression index sequence codec
+static bool
+test_meshopt_decode_index(const uint8_t* data, size_t size, uint* indices, size_t index_count) {
+	if (!size || (data[0] != 0xD1))
+		return false;
+	size_t offset = 1;
+	uint last[2] = {0, 0};
+	for (size_t iindex = 0; iindex < index_count; ++iindex) {
+		uint value = 0;
+		uint shift = 0;
+		uint8_t byte;
+		do {
+			if ((offset >= size) || (shift > 28))
+				return false;
+			byte = data[offset++];
+			value |= (uint)(byte & 127) << shift;
+			shift += 7;
+		} while (byte & 128);
+		uint current = value & 1;
+		value >>= 1;
+		uint delta = (value >> 1) ^ (0U - (value & 1));
+		last[current] += delta;
+		indices[iindex] = last[current];
+	}
+	return (offset + 4) == size;
+}
+
+DECLARE_TEST(meshopt, encode) {
+	// Index sequences switch baseline on large jumps and decode back to the source indices
+	const uint indices[] = {0, 1, 2, 2, 1, 3, 1000, 1001, 1002, 3, 4, 5, 70000, 5, 6};
+	const size_t index_count = sizeof(indices) / sizeof(indices[0]);
+	uint8_t encoded[256];
+	uint decoded[sizeof(indices) / sizeof(indices[0])];
+	size_t encoded_size = gltf_meshopt_encode_index(encoded, sizeof(encoded), indices, index_count, 4);
+	EXPECT_GT(encoded_size, 0);
+	EXPECT_LE(encoded_size, gltf_meshopt_encode_index_bound(index_count));
+	EXPECT_TRUE(test_meshopt_decode_index(encoded, encoded_size, decoded, index_count));
+	EXPECT_EQ(memcmp(decoded, indices, sizeof(indices)), 0);
+
+	uint16_t short_indices[sizeof(indices) / sizeof(indices[0])];
+	for (size_t iindex = 0; iindex < index_count; ++iindex)
+		short_indices[iindex] = (uint16_t)(indices[iindex] % 65536);
+	encoded_size = gltf_meshopt_encode_index(encoded, sizeof(encoded), short_indices, index_count, 2);
+	EXPECT_TRUE(test_meshopt_decode_index(encoded, encoded_size, decoded, index_count));
+	for (size_t iindex = 0; iindex < index_count; ++iindex)
+		EXPECT_EQ(decoded[iindex], short_indices[iindex]);
+	EXPECT_EQ(gltf_meshopt_encode_index(encoded, 8, indices, index_count, 4), 0);
+
+	// Smooth attribute data compresses well below its raw size
+	float vertices[256 * 3];
+	for (uint ivertex = 0; ivertex < 256; ++ivertex) {
+		vertices[ivertex * 3] = (float)ivertex;
+		vertices[(ivertex * 3) + 1] = 1.0f;
+		vertices[(ivertex * 3) + 2] = 0.0f;
+	}
+	size_t bound = gltf_meshopt_encode_vertex_bound(256, 12);
+	uint8_t* vertex_encoded = memory_allocate(0, bound, 0, MEMORY_PERSISTENT);
+	encoded_size = gltf_meshopt_encode_vertex(vertex_encoded, bound, vertices, 256, 12);
+	EXPECT_GT(encoded_size, 0);
+	EXPECT_LT(encoded_size, sizeof(vertices) / 2);
+	EXPECT_EQ(vertex_encoded[0], 0xA0);
+	EXPECT_EQ(gltf_meshopt_encode_vertex(vertex_encoded, 16, vertices, 256, 12), 0);
+	memory_deallocate(vertex_encoded);
+
+	// Written documents describe compressed views in a separate buffer and keep the fallback
+	// buffer readable by loaders without the extension
+	mesh_t mesh;
+	test_gltf_mesh_initialize(&mesh, 512, 400);
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_EQ(gltf_mesh_add_mesh(&gltf, &mesh, nullptr), 0);
+	gltf.file_type = GLTF_FILE_GLTF_EMBED;
+	gltf.flags |= GLTF_FLAG_MESHOPT_COMPRESSION | GLTF_FLAG_JSON_MINIFY;
+	size_t written_size = 0;
+	char* written = test_gltf_write_memory(&gltf, &written_size);
+	EXPECT_NE(written, nullptr);
+	gltf_finalize(&gltf);
+
+	const char* expected[] = {"\"extensionsUsed\":[\"EXT_meshopt_compression\"]", "\"mode\":\"ATTRIBUTES\"",
+	                          "\"mode\":\"INDICES\""};
+	for (size_t iexpect = 0; iexpect < sizeof(expected) / sizeof(expected[0]); ++iexpect)
+		EXPECT_SIZENE(
+		    string_find_string(written, written_size, expected[iexpect], string_length(expected[iexpect]), 0),
+		    STRING_NPOS);
+	EXPECT_SIZEEQ(string_find_string(written, written_size, STRING_CONST("extensionsRequired"), 0), STRING_NPOS);
+
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, written, written_size));
+	EXPECT_EQ(array_count(gltf.buffers), 2);
+	EXPECT_EQ(gltf.buffer_views[0].buffer, 1);
+	EXPECT_LT(gltf.buffers[0].byte_length, gltf.buffers[1].byte_length);
+	EXPECT_TRUE(test_gltf_mesh_verify(&gltf, &mesh));
+	gltf_finalize(&gltf);
+
+	memory_deallocate(written);
+	test_gltf_mesh_finalize(&mesh);
 	return 0;
 }
 
-DECLARE_TEST(udp, blocking) {
-	socket_t* sock = udp_socket_allocate();
+DECLARE_TEST(morph, read_blend) {
+	const float data[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 2, 0, 0, 0, 2, 0, 0, 0, 2};
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 72}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 36},"
+	                 "{\"buffer\": 0, \"byteOffset\": 36, \"byteLength\": 36}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	                 "{\"bufferView\": 1, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"}],"
+	                 "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0},"
+	                 "\"targets\": [{\"POSITION\": 1}]}], \"weights\": [0.5]}]}"),
+	    STRING_FORMAT(uri));
 
-	socket_set_blocking(sock, false);
-	EXPECT_FALSE(socket_blocking(sock));
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	EXPECT_EQ(array_count(gltf.meshes), 1);
+	const gltf_primitive_t* primitive = gltf.meshes[0].primitives;
+	EXPECT_EQ(array_count(primitive->targets), 1);
+	EXPECT_EQ(primitive->targets[0].position, 1);
+	EXPECT_EQ(primitive->targets[0].normal, GLTF_INVALID_INDEX);
+	EXPECT_EQ(array_count(gltf.meshes[0].weights), 1);
+	EXPECT_REALEQ(gltf.meshes[0].weights[0], REAL_C(0.5));
 
-	socket_set_blocking(sock, true);
-	EXPECT_TRUE(socket_blocking(sock));
+	gltf_morph_t morph;
+	gltf_morph_initialize(&morph);
+	EXPECT_TRUE(gltf_morph_build(&morph, &gltf, 0, 0));
+	EXPECT_EQ(morph.vertex_count, 3);
+	EXPECT_EQ(morph.target_count, 1);
 
-	socket_deallocate(sock);
+	const float weight = (float)gltf.meshes[0].weights[0];
+	float positions[9];
+	gltf_morph_blend(&morph, &weight, 1, 0, 3, positions, nullptr, nullptr);
+	for (uint ivalue = 0; ivalue < 9; ++ivalue)
+		EXPECT_REALEQ(positions[ivalue], data[ivalue] + (data[9 + ivalue] * 0.5f));
+	gltf_morph_finalize(&morph);
 
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
 	return 0;
 }
 
-DECLARE_TEST(udp, bind) {
-	bool has_ipv4 = network_supports_ipv4();
-	bool has_ipv6 = network_supports_ipv6();
-	bool was_bound = false;
-	unsigned int port;
+DECLARE_TEST(morph, sparse_targets) {
+	// Base positions and normals, a sparse index with position and normal values, and dense deltas
+	float data[34];
+	const float base[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 1};
+	const uint32_t sparse_index = 1;
+	const float sparse_values[] = {0, 0, 2, 1, 0, 0};
+	const uint32_t infinity_bits = 0x7f800000;
+	memcpy(data, base, sizeof(base));
+	memcpy(data + 18, &sparse_index, sizeof(sparse_index));
+	memcpy(data + 19, sparse_values, sizeof(sparse_values));
+	for (uint ivalue = 25; ivalue < 34; ++ivalue)
+		memcpy(data + ivalue, &infinity_bits, sizeof(infinity_bits));
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 136}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 36},"
+	                 "{\"buffer\": 0, \"byteOffset\": 36, \"byteLength\": 36},"
+	                 "{\"buffer\": 0, \"byteOffset\": 72, \"byteLength\": 4},"
+	                 "{\"buffer\": 0, \"byteOffset\": 76, \"byteLength\": 12},"
+	                 "{\"buffer\": 0, \"byteOffset\": 88, \"byteLength\": 12},"
+	                 "{\"buffer\": 0, \"byteOffset\": 100, \"byteLength\": 36}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	                 "{\"bufferView\": 1, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	                 "{\"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", \"sparse\": {\"count\": 1,"
+	                 "\"indices\": {\"bufferView\": 2, \"componentType\": 5125}, \"values\": {\"bufferView\": 3}}},"
+	                 "{\"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", \"sparse\": {\"count\": 1,"
+	                 "\"indices\": {\"bufferView\": 2, \"componentType\": 5125}, \"values\": {\"bufferView\": 4}}},"
+	                 "{\"bufferView\": 5, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"}],"
+	                 "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0, \"NORMAL\": 1},"
+	                 "\"targets\": [{\"POSITION\": 2, \"NORMAL\": 3}, {\"POSITION\": 4}]}], \"weights\": [1, 0]}]}"),
+	    STRING_FORMAT(uri));
 
-	if (has_ipv4) {
-		socket_t* sock = udp_socket_allocate();
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	gltf_morph_t morph;
+	gltf_morph_initialize(&morph);
+	EXPECT_TRUE(gltf_morph_build(&morph, &gltf, 0, 0));
+	EXPECT_EQ(morph.target_count, 2);
 
-		EXPECT_EQ(socket_address_local(sock), 0);
-		EXPECT_EQ(socket_address_remote(sock), 0);
-		EXPECT_EQ(socket_state(sock), SOCKETSTATE_NOTCONNECTED);
+	// The infinite deltas of the zero weight target must not be touched, and the blended normal is
+	// renormalized
+	const float weights[] = {1, 0};
+	float positions[9];
+	float normals[9];
+	gltf_morph_blend(&morph, weights, 2, 0, 3, positions, normals, nullptr);
+	for (uint ivalue = 0; ivalue < 9; ++ivalue)
+		EXPECT_REALEQ(positions[ivalue], base[ivalue] + ((ivalue == 5) ? 2.0f : 0.0f));
+	EXPECT_REALEQ(normals[2], 1.0f);
+	EXPECT_REALEQ(normals[8], 1.0f);
+	EXPECT_TRUE(math_abs(normals[3] - 0.70710678f) < 0.00001f);
+	EXPECT_REALEQ(normals[4], 0.0f);
+	EXPECT_TRUE(math_abs(normals[5] - 0.70710678f) < 0.00001f);
+	gltf_morph_finalize(&morph);
 
-		for (port = 31890; !was_bound && (port < 32890); ++port) {
-			network_address_ipv4_t address;
-			network_address_ipv4_initialize(&address);
-			network_address_ip_set_port((network_address_t*)&address, port);
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
+	return 0;
+}
 
-			if (socket_bind(sock, (network_address_t*)&address)) {
-				EXPECT_NE(socket_address_local(sock), 0);
-				EXPECT_EQ(socket_address_remote(sock), 0);
-				EXPECT_EQ(socket_state(sock), SOCKETSTATE_NOTCONNECTED);
+DECLARE_TEST(node, children) {
+	const char document[] = "{\"asset\": {\"version\": \"2.0\"},"
+	                        "\"nodes\": [{\"children\": [1, 2]}, {\"children\": [3]}, {}, {}, {}]}";
 
-				EXPECT_TRUE(network_address_equal(socket_address_local(sock), (network_address_t*)&address));
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+	EXPECT_EQ(gltf.nodes[0].children_count, 2);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes)[0], 1);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes)[1], 2);
+	EXPECT_EQ(gltf.nodes[1].children_count, 1);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes + 1)[0], 3);
+	EXPECT_EQ(gltf.nodes[2].children_count, 0);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes + 2), nullptr);
 
-				was_bound = true;
-			}
+	// Children added later keep the existing child lists of all nodes intact
+	gltf_node_add_child(&gltf, 0, 4);
+	uint added = gltf_node_add(&gltf, STRING_CONST("added"), GLTF_INVALID_INDEX, nullptr);
+	gltf_node_add_child(&gltf, 2, added);
+	EXPECT_EQ(gltf.nodes[0].children_count, 3);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes)[0], 1);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes)[2], 4);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes + 1)[0], 3);
+	EXPECT_EQ(gltf.nodes[2].children_count, 1);
+	EXPECT_EQ(gltf_node_children(&gltf, gltf.nodes + 2)[0], added);
+
+	gltf_finalize(&gltf);
+	return 0;
+}
+
+DECLARE_TEST(node, read_instancing) {
+	const float data[] = {1, 0, 0, 0, 2, 0};
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"extensionsUsed\": [\"EXT_mesh_gpu_instancing\"],"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 24}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 24}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 2, \"type\": \"VEC3\"}],"
+	                 "\"nodes\": [{\"translation\": [0, 0, 5], \"extensions\": {\"EXT_mesh_gpu_instancing\":"
+	                 "{\"attributes\": {\"TRANSLATION\": 0, \"_ID\": 0}}}}]}"),
+	    STRING_FORMAT(uri));
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	EXPECT_EQ(array_count(gltf.nodes), 1);
+	const gltf_node_t* node = gltf.nodes;
+	EXPECT_TRUE(gltf_node_is_instanced(node));
+	EXPECT_EQ(node->instancing.translation, 0);
+	EXPECT_EQ(node->instancing.rotation, GLTF_INVALID_INDEX);
+	EXPECT_EQ(node->instancing.scale, GLTF_INVALID_INDEX);
+	EXPECT_EQ(array_count(node->instancing.attributes_custom), 1);
+	EXPECT_CONSTSTRINGEQ(node->instancing.attributes_custom[0].semantic, string_const(STRING_CONST("_ID")));
+	EXPECT_EQ(gltf_node_instance_count(&gltf, node), 2);
+
+	// Instance transforms apply before the node transform
+	matrix_t transform = matrix_identity();
+	transform.frow[3][2] = 5;
+	matrix_t matrices[2];
+	EXPECT_TRUE(gltf_node_instance_matrices(&gltf, node, &transform, matrices));
+	EXPECT_REALEQ(matrices[0].frow[3][0], 1.0f);
+	EXPECT_REALEQ(matrices[0].frow[3][2], 5.0f);
+	EXPECT_REALEQ(matrices[1].frow[3][1], 2.0f);
+	EXPECT_REALEQ(matrices[1].frow[3][2], 5.0f);
+	EXPECT_REALEQ(matrices[1].frow[0][0], 1.0f);
+
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
+	return 0;
+}
+
+DECLARE_TEST(node, collapse_instances) {
+	// Triangle positions, then animation times and translations
+	const float data[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0};
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 68}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 36},"
+	                 "{\"buffer\": 0, \"byteOffset\": 36, \"byteLength\": 8},"
+	                 "{\"buffer\": 0, \"byteOffset\": 44, \"byteLength\": 24}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\","
+	                 "\"min\": [0, 0, 0], \"max\": [1, 1, 0]},"
+	                 "{\"bufferView\": 1, \"componentType\": 5126, \"count\": 2, \"type\": \"SCALAR\"},"
+	                 "{\"bufferView\": 2, \"componentType\": 5126, \"count\": 2, \"type\": \"VEC3\"}],"
+	                 "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}}]}],"
+	                 "\"nodes\": [{\"children\": [1, 2, 3, 4, 5]},"
+	                 "{\"mesh\": 0, \"translation\": [1, 0, 0]}, {\"mesh\": 0, \"translation\": [2, 0, 0]},"
+	                 "{\"mesh\": 0}, {\"mesh\": 0, \"translation\": [3, 0, 0]},"
+	                 "{\"mesh\": 0, \"matrix\": [1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1]}, {}],"
+	                 "\"scenes\": [{\"nodes\": [0, 6]}], \"scene\": 0,"
+	                 "\"skins\": [{\"skeleton\": 6, \"joints\": [6]}],"
+	                 "\"animations\": [{\"channels\": [{\"sampler\": 0,"
+	                 "\"target\": {\"node\": 3, \"path\": \"translation\"}}],"
+	                 "\"samplers\": [{\"input\": 1, \"output\": 2}]}]}"),
+	    STRING_FORMAT(uri));
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	EXPECT_TRUE(gltf_bounds_compute(&gltf));
+	EXPECT_EQ(array_count(gltf.node_bounds), 7);
+
+	// Nodes 1, 2 and 4 collapse into node 1, the animated node 3 and the sheared node 5 are kept
+	EXPECT_TRUE(gltf_node_collapse_instances(&gltf, 2));
+	EXPECT_EQ(array_count(gltf.nodes), 5);
+	EXPECT_EQ(array_count(gltf.node_bounds), 0);
+	EXPECT_EQ(array_count(gltf.mesh_bounds), 0);
+
+	const gltf_node_t* root = gltf.nodes;
+	EXPECT_EQ(root->children_count, 3);
+	EXPECT_EQ(gltf.node_children[root->children_offset], 1);
+	EXPECT_EQ(gltf.node_children[root->children_offset + 1], 2);
+	EXPECT_EQ(gltf.node_children[root->children_offset + 2], 3);
+	EXPECT_EQ(array_count(gltf.scenes[0].nodes), 2);
+	EXPECT_EQ(gltf.scenes[0].nodes[1], 4);
+
+	const gltf_node_t* instanced = gltf.nodes + 1;
+	EXPECT_TRUE(gltf_node_is_instanced(instanced));
+	EXPECT_EQ(gltf_node_instance_count(&gltf, instanced), 3);
+	const gltf_accessor_t* translation = gltf.accessors + instanced->instancing.translation;
+	EXPECT_REALEQ(translation->min[0], REAL_C(1.0));
+	EXPECT_REALEQ(translation->max[0], REAL_C(3.0));
+	EXPECT_FALSE(gltf_node_is_instanced(gltf.nodes + 2));
+	EXPECT_FALSE(gltf_node_is_instanced(gltf.nodes + 3));
+	EXPECT_TRUE(gltf.nodes[3].transform.has_matrix);
+
+	EXPECT_EQ(gltf.animations[0].channels[0].node, 2);
+	EXPECT_EQ(gltf.skins[0].joints[0], 4);
+	EXPECT_EQ(gltf.skins[0].skeleton, 4);
+
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
+	return 0;
+}
+
+DECLARE_TEST(query, pointer) {
+	const char document[] = "{\"asset\": {\"version\": \"2.0\"},"
+	                        "\"nodes\": [{\"name\": \"first\"}, {\"name\": \"second\", \"extras\": {\"id\": \"node1\","
+	                        "\"a/b\": 1, \"m~n\": [10, 20, {\"deep\": \"x\"}]}}]}";
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	gltf.flags |= GLTF_FLAG_RETAIN_TOKENS;
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("")), 0);
+	uint node = gltf_query_pointer(&gltf, STRING_CONST("/nodes/1"));
+	EXPECT_NE(node, GLTF_INVALID_INDEX);
+	EXPECT_EQ(node, gltf_query_object(&gltf, STRING_CONST("nodes"), 1));
+	EXPECT_EQ(gltf_query_type(&gltf, node), JSON_OBJECT);
+
+	uint id = gltf_query_pointer(&gltf, STRING_CONST("/nodes/1/extras/id"));
+	EXPECT_CONSTSTRINGEQ(gltf_query_value(&gltf, id), string_const(STRING_CONST("node1")));
+	uint extras = gltf_query_member(&gltf, node, STRING_CONST("extras"));
+	EXPECT_EQ(gltf_query_member_hash(&gltf, extras, string_hash(STRING_CONST("id"))), id);
+	EXPECT_EQ(gltf_query_member(&gltf, extras, STRING_CONST("missing")), GLTF_INVALID_INDEX);
+
+	// "~1" decodes to '/' and "~0" to '~'
+	EXPECT_CONSTSTRINGEQ(gltf_query_value(&gltf, gltf_query_pointer(&gltf, STRING_CONST("/nodes/1/extras/a~1b"))),
+	                     string_const(STRING_CONST("1")));
+	EXPECT_CONSTSTRINGEQ(gltf_query_value(&gltf, gltf_query_pointer(&gltf, STRING_CONST("/nodes/1/extras/m~0n/1"))),
+	                     string_const(STRING_CONST("20")));
+	uint deep = gltf_query_pointer(&gltf, STRING_CONST("/nodes/1/extras/m~0n/2/deep"));
+	EXPECT_CONSTSTRINGEQ(gltf_query_value(&gltf, deep), string_const(STRING_CONST("x")));
+	EXPECT_EQ(gltf_query_type(&gltf, deep), JSON_STRING);
+
+	// Invalid escapes, leading zeros, out of range and non numeric indices do not resolve
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("/nodes/1/extras/m~2n")), GLTF_INVALID_INDEX);
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("/nodes/1/extras/a/b")), GLTF_INVALID_INDEX);
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("/nodes/01")), GLTF_INVALID_INDEX);
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("/nodes/2")), GLTF_INVALID_INDEX);
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("/nodes/-1")), GLTF_INVALID_INDEX);
+	EXPECT_EQ(gltf_query_pointer(&gltf, STRING_CONST("nodes")), GLTF_INVALID_INDEX);
+
+	gltf_finalize(&gltf);
+	return 0;
+}
+
+DECLARE_TEST(skin, read_palette) {
+	// Inverse bind matrices of joints at (1, 0, 0) and (1, 2, 0), column major as stored in accessors
+	float data[32];
+	memset(data, 0, sizeof(data));
+	for (uint ijoint = 0; ijoint < 2; ++ijoint) {
+		float* inverse_bind = data + (ijoint * 16);
+		inverse_bind[0] = inverse_bind[5] = inverse_bind[10] = inverse_bind[15] = 1;
+		inverse_bind[12] = -1;
+		inverse_bind[13] = ijoint ? -2.0f : 0.0f;
+	}
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 128}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 128}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 2, \"type\": \"MAT4\"}],"
+	                 "\"nodes\": [{\"translation\": [1, 0, 0], \"children\": [1]}, {\"translation\": [0, 2, 0]},"
+	                 "{\"skin\": 0}],"
+	                 "\"scenes\": [{\"nodes\": [0, 2]}], \"scene\": 0,"
+	                 "\"skins\": [{\"name\": \"rig\", \"inverseBindMatrices\": 0, \"skeleton\": 0,"
+	                 "\"joints\": [0, 1]}]}"),
+	    STRING_FORMAT(uri));
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+	EXPECT_EQ(array_count(gltf.skins), 1);
+	EXPECT_CONSTSTRINGEQ(gltf.skins[0].name, string_const(STRING_CONST("rig")));
+	EXPECT_EQ(gltf.skins[0].inverse_bind_matrices, 0);
+	EXPECT_EQ(gltf.skins[0].skeleton, 0);
+	EXPECT_EQ(array_count(gltf.skins[0].joints), 2);
+	EXPECT_EQ(gltf.skins[0].joints[1], 1);
+	EXPECT_EQ(gltf.nodes[2].skin, 0);
+
+	gltf_hierarchy_t hierarchy;
+	gltf_hierarchy_initialize(&hierarchy);
+	EXPECT_TRUE(gltf_hierarchy_build(&hierarchy, &gltf, 0));
+
+	gltf_skin_palette_t palette;
+	gltf_skin_palette_initialize(&palette);
+	EXPECT_TRUE(gltf_skin_palette_build(&palette, &gltf, 0, &hierarchy));
+	EXPECT_EQ(palette.joint_count, 2);
+
+	// Joint matrices are identity in bind pose, moving the child joint moves its vertices
+	matrix_t joints[2];
+	gltf_skin_palette_compute(&palette, hierarchy.world, joints);
+	for (uint ijoint = 0; ijoint < 2; ++ijoint) {
+		for (uint irow = 0; irow < 4; ++irow) {
+			for (uint icol = 0; icol < 4; ++icol)
+				EXPECT_REALEQ(joints[ijoint].frow[irow][icol], (irow == icol) ? 1.0f : 0.0f);
 		}
-		EXPECT_TRUE(was_bound);
+	}
+	hierarchy.translation[1][hierarchy.entry[1]] = 3;
+	gltf_hierarchy_update_local(&hierarchy);
+	gltf_hierarchy_update_world(&hierarchy);
+	gltf_skin_palette_compute(&palette, hierarchy.world, joints);
+	EXPECT_REALEQ(joints[0].frow[3][1], 0.0f);
+	EXPECT_REALEQ(joints[1].frow[3][0], 0.0f);
+	EXPECT_REALEQ(joints[1].frow[3][1], 1.0f);
+
+	gltf_skin_palette_finalize(&palette);
+	gltf_hierarchy_finalize(&hierarchy);
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
+	return 0;
+}
+
+DECLARE_TEST(skinning, deform) {
+	// Three vertices bound to the identity joint, both joints and the second joint
+	const float positions[] = {1, 0, 0, 0, 0, 1, 1, 0, 0};
+	const float normals[] = {0, 1, 0, 0, 0, 1, 1, 0, 0};
+	const uint8_t joints[] = {0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0};
+	const float weights[] = {1, 0, 0, 0, 0.5f, 0.5f, 0, 0, 1, 0, 0, 0};
+	uint8_t data[sizeof(positions) + sizeof(normals) + sizeof(joints) + sizeof(weights)];
+	memcpy(data, positions, sizeof(positions));
+	memcpy(data + 36, normals, sizeof(normals));
+	memcpy(data + 72, joints, sizeof(joints));
+	memcpy(data + 84, weights, sizeof(weights));
+	string_t uri = test_gltf_data_uri(data, sizeof(data));
+	string_t document = string_allocate_format(
+	    STRING_CONST("{\"asset\": {\"version\": \"2.0\"},"
+	                 "\"buffers\": [{\"uri\": \"%.*s\", \"byteLength\": 132}],"
+	                 "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 72},"
+	                 "{\"buffer\": 0, \"byteOffset\": 72, \"byteLength\": 12},"
+	                 "{\"buffer\": 0, \"byteOffset\": 84, \"byteLength\": 48}],"
+	                 "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	                 "{\"bufferView\": 0, \"byteOffset\": 36, \"componentType\": 5126, \"count\": 3,"
+	                 "\"type\": \"VEC3\"},"
+	                 "{\"bufferView\": 1, \"componentType\": 5121, \"count\": 3, \"type\": \"VEC4\"},"
+	                 "{\"bufferView\": 2, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC4\"}],"
+	                 "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0, \"NORMAL\": 1,"
+	                 "\"JOINTS_0\": 2, \"WEIGHTS_0\": 3}}]}]}"),
+	    STRING_FORMAT(uri));
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, STRING_ARGS(document)));
+
+	gltf_skinning_t skinning;
+	gltf_skinning_initialize(&skinning);
+	EXPECT_FALSE(gltf_skinning_build(&skinning, &gltf, 0, 0, 1));
+	EXPECT_TRUE(gltf_skinning_build(&skinning, &gltf, 0, 0, 2));
+	EXPECT_EQ(skinning.vertex_count, 3);
+	EXPECT_EQ(skinning.influence_count, 4);
+
+	// Second joint rotates 90 degrees around z and translates by (0, 2, 0)
+	matrix_t matrices[2];
+	matrices[0] = matrix_identity();
+	memset(matrices + 1, 0, sizeof(matrix_t));
+	matrices[1].frow[0][1] = 1;
+	matrices[1].frow[1][0] = -1;
+	matrices[1].frow[2][2] = 1;
+	matrices[1].frow[3][1] = 2;
+	matrices[1].frow[3][3] = 1;
+
+	const float expected_positions[] = {1, 0, 0, 0, 1, 1, 0, 3, 0};
+	const float expected_normals[] = {0, 1, 0, 0, 0, 1, 0, 1, 0};
+	float deformed_positions[9];
+	float deformed_normals[9];
+	gltf_skinning_deform(&skinning, matrices, 0, 3, deformed_positions, deformed_normals);
+	for (uint ivalue = 0; ivalue < 9; ++ivalue) {
+		EXPECT_TRUE(test_gltf_near(deformed_positions[ivalue], expected_positions[ivalue]));
+		EXPECT_TRUE(test_gltf_near(deformed_normals[ivalue], expected_normals[ivalue]));
+	}
 
-		socket_deallocate(sock);
+	// Parallel deformation gives the same result, and ranges only write their own vertices
+	float parallel_positions[9];
+	gltf_skinning_deform_parallel(&skinning, matrices, parallel_positions, nullptr);
+	EXPECT_EQ(memcmp(parallel_positions, deformed_positions, sizeof(deformed_positions)), 0);
+	memset(parallel_positions, 0, sizeof(parallel_positions));
+	gltf_skinning_deform(&skinning, matrices, 2, 3, parallel_positions, nullptr);
+	EXPECT_REALEQ(parallel_positions[0], 0.0f);
+	EXPECT_TRUE(test_gltf_near(parallel_positions[7], 3.0f));
+
+	gltf_skinning_finalize(&skinning);
+	gltf_finalize(&gltf);
+	string_deallocate(document.str);
+	string_deallocate(uri.str);
+	return 0;
+}
+
+DECLARE_TEST(triangle, ray_query) {
+	// Two parallel grid layers at heights 0 and -1, rays must report the closest layer
+	const uint grid_size = 256;
+	const uint grid_vertex_count = (grid_size + 1) * (grid_size + 1);
+	const uint grid_triangle_count = grid_size * grid_size * 2;
+	const uint vertex_count = grid_vertex_count * 2;
+	const uint triangle_count = grid_triangle_count * 2;
+
+	mesh_t mesh;
+	memset(&mesh, 0, sizeof(mesh));
+	bucketarray_initialize(&mesh.coordinate, sizeof(mesh_coordinate_t), 4096);
+	bucketarray_initialize(&mesh.normal, sizeof(mesh_normal_t), 4096);
+	bucketarray_initialize(&mesh.vertex, sizeof(mesh_vertex_t), 4096);
+	bucketarray_initialize(&mesh.triangle, sizeof(mesh_triangle_t), 4096);
+	bucketarray_resize(&mesh.coordinate, vertex_count);
+	bucketarray_resize(&mesh.vertex, vertex_count);
+	bucketarray_resize(&mesh.triangle, triangle_count);
+	for (uint ivertex = 0; ivertex < vertex_count; ++ivertex) {
+		uint ilayer = ivertex / grid_vertex_count;
+		uint igrid = ivertex % grid_vertex_count;
+		mesh_coordinate_t* coordinate = bucketarray_get(&mesh.coordinate, ivertex);
+		*coordinate = vector((real)(igrid % (grid_size + 1)), -(real)ilayer, (real)(igrid / (grid_size + 1)), 1);
+		mesh_vertex_t* vertex = bucketarray_get(&mesh.vertex, ivertex);
+		memset(vertex, 0, sizeof(mesh_vertex_t));
+		vertex->coordinate = ivertex;
+	}
+	for (uint itri = 0; itri < triangle_count; ++itri) {
+		uint ilayer = itri / grid_triangle_count;
+		uint iquad = (itri % grid_triangle_count) / 2;
+		uint corner = (ilayer * grid_vertex_count) + ((iquad / grid_size) * (grid_size + 1)) + (iquad % grid_size);
+		mesh_triangle_t* triangle = bucketarray_get(&mesh.triangle, itri);
+		triangle->vertex[0] = corner;
+		triangle->vertex[1] = (itri & 1) ? corner + grid_size + 2 : corner + 1;
+		triangle->vertex[2] = (itri & 1) ? corner + grid_size + 1 : corner + grid_size + 2;
+		triangle->material = GLTF_INVALID_INDEX;
 	}
 
-	if (has_ipv6) {
-		socket_t* sock = udp_socket_allocate();
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	uint imesh = gltf_mesh_add_mesh(&gltf, &mesh, nullptr);
+	EXPECT_EQ(imesh, 0);
 
-		was_bound = false;
-		for (port = 31890; !was_bound && (port < 32890); ++port) {
-			network_address_ipv6_t address;
-			network_address_ipv6_initialize(&address);
-			network_address_ip_set_port((network_address_t*)&address, port);
+	tick_t start = time_current();
+	const gltf_triangle_bvh_t* triangles = gltf_primitive_triangle_bvh(&gltf, imesh, 0);
+	deltatime_t build_time = time_elapsed(start);
+	EXPECT_NE(triangles, nullptr);
+	EXPECT_EQ(triangles->triangle_count, triangle_count);
+	EXPECT_EQ(gltf_primitive_triangle_bvh(&gltf, imesh, 0), triangles);
 
-			if (socket_bind(sock, (network_address_t*)&address)) {
-				EXPECT_NE(socket_address_local(sock), 0);
-				EXPECT_EQ(socket_address_remote(sock), 0);
-				EXPECT_EQ(socket_state(sock), SOCKETSTATE_NOTCONNECTED);
+	// Rays down from above hit the top layer, rays up from below hit the bottom layer, and rays
+	// outside the grid miss
+	const uint ray_count = 65536;
+	gltf_bvh_ray_t* rays = memory_allocate(0, sizeof(gltf_bvh_ray_t) * ray_count, 0, MEMORY_PERSISTENT);
+	gltf_bvh_hit_t* hits = memory_allocate(0, sizeof(gltf_bvh_hit_t) * ray_count, 0, MEMORY_PERSISTENT);
+	for (uint iray = 0; iray < ray_count; ++iray) {
+		gltf_bvh_ray_t* ray = rays + iray;
+		bool outside = ((iray % 8) == 7);
+		bool up = (iray & 1);
+		ray->origin[0] = outside ? -1.5f : ((float)(iray % 251) + 0.3f);
+		ray->origin[1] = up ? -10.0f : 10.0f;
+		ray->origin[2] = (float)(iray % 241) + 0.6f;
+		ray->direction[0] = 0;
+		ray->direction[1] = up ? 1.0f : -1.0f;
+		ray->direction[2] = 0;
+		ray->distance = 100.0f;
+	}
 
-				EXPECT_TRUE(network_address_equal(socket_address_local(sock), (network_address_t*)&address));
+	start = time_current();
+	gltf_triangle_bvh_query_rays(triangles, rays, ray_count, hits);
+	deltatime_t query_time = time_elapsed(start);
+	log_infof(HASH_TEST, STRING_CONST("Built triangle hierarchy over %u triangles in %.2fms, %u rays in %.2fms"),
+	          triangle_count, (double)build_time * 1000.0, ray_count, (double)query_time * 1000.0);
 
-				was_bound = true;
-			}
+	for (uint iray = 0; iray < ray_count; ++iray) {
+		if ((iray % 8) == 7) {
+			EXPECT_EQ(hits[iray].item, GLTF_INVALID_INDEX);
+			EXPECT_REALEQ(hits[iray].distance, 100.0f);
+			continue;
 		}
-		EXPECT_TRUE(was_bound);
+		EXPECT_LT(hits[iray].item, triangle_count);
+		EXPECT_REALEQ(hits[iray].distance, (iray & 1) ? 9.0f : 10.0f);
+	}
+
+	memory_deallocate(rays);
+	memory_deallocate(hits);
+	gltf_finalize(&gltf);
+	bucketarray_finalize(&mesh.coordinate);
+	bucketarray_finalize(&mesh.normal);
+	bucketarray_finalize(&mesh.vertex);
+	bucketarray_finalize(&mesh.triangle);
+	return 0;
+}
+
+DECLARE_TEST(writer, base64) {
+	// Sizes cover every remainder and pieces larger than one writer block
+	const size_t sizes[] = {0, 1, 2, 3, 4, 5, 196607, 196608, 196609, 600001};
+	uint8_t* data = memory_allocate(0, 600001, 0, MEMORY_PERSISTENT);
+	for (size_t ibyte = 0; ibyte < 600001; ++ibyte)
+		data[ibyte] = (uint8_t)((ibyte * 131) ^ (ibyte >> 8));
+	for (size_t isize = 0; isize < sizeof(sizes) / sizeof(sizes[0]); ++isize) {
+		size_t capacity = ((sizes[isize] + 2) / 3) * 4 + 1;
+		char* expected = memory_allocate(0, capacity, 0, MEMORY_PERSISTENT);
+		size_t expected_length = base64_encode(data, sizes[isize], expected, capacity);
 
-		socket_deallocate(sock);
+		gltf_writer_t writer;
+		gltf_writer_initialize(&writer, nullptr);
+		gltf_writer_base64(&writer, data, sizes[isize]);
+		EXPECT_SIZEEQ(writer.size, expected_length);
+		EXPECT_EQ(memcmp(writer.block, expected, expected_length), 0);
+		gltf_writer_finalize(&writer);
+		memory_deallocate(expected);
 	}
+	memory_deallocate(data);
+	return 0;
+}
+
+DECLARE_TEST(writer, embed_roundtrip) {
+	// Large enough for the embedded data to span several writer blocks
+	mesh_t mesh;
+	test_gltf_mesh_initialize(&mesh, 20000, 10000);
+
+	const gltf_file_type file_types[] = {GLTF_FILE_GLTF_EMBED, GLTF_FILE_GLB_EMBED};
+	for (size_t itype = 0; itype < sizeof(file_types) / sizeof(file_types[0]); ++itype) {
+		gltf_t gltf;
+		gltf_initialize(&gltf);
+		EXPECT_EQ(gltf_mesh_add_mesh(&gltf, &mesh, nullptr), 0);
+		gltf.file_type = file_types[itype];
+		size_t written_size = 0;
+		char* written = test_gltf_write_memory(&gltf, &written_size);
+		EXPECT_NE(written, nullptr);
+		gltf_finalize(&gltf);
+
+		if (file_types[itype] == GLTF_FILE_GLB_EMBED) {
+			// Header length matches the sequentially written chunks, each four byte aligned
+			uint32_t header[5];
+			memcpy(header, written, sizeof(header));
+			EXPECT_EQ(header[0], 0x46546C67);
+			EXPECT_EQ(header[1], 2);
+			EXPECT_SIZEEQ((size_t)header[2], written_size);
+			EXPECT_EQ(header[3] % 4, 0);
+			EXPECT_EQ(header[4], 0x4E4F534A);
+			uint32_t binary_header[2];
+			memcpy(binary_header, written + 20 + header[3], sizeof(binary_header));
+			EXPECT_EQ(binary_header[1], 0x004E4942);
+			EXPECT_EQ(binary_header[0], (20000 * 12) + (10000 * 12));
+			EXPECT_SIZEEQ(28 + (size_t)header[3] + binary_header[0], written_size);
+		} else {
+			EXPECT_SIZENE(string_find_string(written, written_size,
+			                                 STRING_CONST("\"uri\": \"data:application/octet-stream;base64,"), 0),
+			              STRING_NPOS);
+		}
 
+		gltf_initialize(&gltf);
+		EXPECT_TRUE(test_gltf_read_string(&gltf, written, written_size));
+		EXPECT_EQ(array_count(gltf.buffers), 1);
+		EXPECT_TRUE(test_gltf_mesh_verify(&gltf, &mesh));
+		gltf_finalize(&gltf);
+		memory_deallocate(written);
+	}
+
+	test_gltf_mesh_finalize(&mesh);
 	return 0;
 }
 
-static void
-test_socket_declare(void) {
-	ADD_TEST(tcp, create);
-	ADD_TEST(tcp, blocking);
-	ADD_TEST(tcp, bind);
+DECLARE_TEST(writer, dirty_roundtrip) {
+	const char document[] =
+	    "{\"asset\": {\"version\": \"2.0\"},"
+	    "\"accessors\": [{\"componentType\": 5121, \"count\": 2, \"type\": \"VEC4\", \"normalized\": true,"
+	    "\"name\": \"colors\", \"extras\": {\"id\": 7}}],"
+	    "\"meshes\": [{\"name\": \"lines\", \"primitives\": [{\"attributes\": {\"COLOR_0\": 0}, \"mode\": 1,"
+	    "\"extras\": {\"tag\": 3}}], \"extras\": {\"lod\": 1}}],"
+	    "\"cameras\": [{\"type\": \"perspective\", \"perspective\": {\"yfov\": 1, \"znear\": 0.1}}],"
+	    "\"nodes\": [{\"name\": \"node\", \"mesh\": 0, \"camera\": 0, \"extras\": {\"note\": \"keep\"}}],"
+	    "\"scenes\": [{\"nodes\": [0]}], \"scene\": 0}";
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+
+	// Objects written from fields keep the members without a field from the source text
+	gltf.accessors[0].dirty = true;
+	gltf.meshes[0].dirty = true;
+	gltf.nodes[0].dirty = true;
+	stream_t* output = buffer_stream_allocate(nullptr, STREAM_IN | STREAM_OUT | STREAM_BINARY, 0, 0, true, true);
+	EXPECT_TRUE(gltf_write(&gltf, output));
+	gltf_finalize(&gltf);
+
+	size_t written_size = stream_size(output);
+	char* written = memory_allocate(0, written_size, 0, MEMORY_PERSISTENT);
+	stream_seek(output, 0, STREAM_SEEK_BEGIN);
+	EXPECT_EQ(stream_read(output, written, written_size), written_size);
+	stream_deallocate(output);
 
-	ADD_TEST(udp, create);
-	ADD_TEST(udp, blocking);
-	ADD_TEST(udp, bind);
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, written, written_size));
+	EXPECT_EQ(array_count(gltf.accessors), 1);
+	EXPECT_TRUE(gltf.accessors[0].normalized);
+	EXPECT_CONSTSTRINGEQ(gltf.accessors[0].name, string_const(STRING_CONST("colors")));
+	EXPECT_EQ(array_count(gltf.meshes), 1);
+	EXPECT_EQ(gltf.meshes[0].primitives[0].mode, GLTF_LINES);
+	EXPECT_EQ(gltf.meshes[0].primitives[0].attributes[GLTF_COLOR_0], 0);
+	EXPECT_EQ(array_count(gltf.nodes), 1);
+	EXPECT_EQ(gltf.nodes[0].mesh, 0);
+	gltf_finalize(&gltf);
+
+	const char* expected[] = {"\"extras\": {\"id\": 7}", "\"extras\": {\"tag\": 3}", "\"extras\": {\"lod\": 1}",
+	                          "\"camera\": 0", "\"extras\": {\"note\": \"keep\"}"};
+	for (size_t iexpect = 0; iexpect < sizeof(expected) / sizeof(expected[0]); ++iexpect)
+		EXPECT_SIZENE(
+		    string_find_string(written, written_size, expected[iexpect], string_length(expected[iexpect]), 0),
+		    STRING_NPOS);
+
+	memory_deallocate(written);
+	return 0;
+}
+
+DECLARE_TEST(writer, format_float) {
+	const float values[] = {1.0f, 0.1f, 3.14159265f, 100.0f, 1e-5f, 123456789.0f, 1e10f, -0.3f, 2.5e-6f, 1e-45f};
+	const char* expected[] = {"1",         "0.1",  "3.1415927", "100",    "0.00001",
+	                          "123456790", "1e10", "-0.3",      "2.5e-6", "1e-45"};
+	char buffer[16];
+	for (size_t ivalue = 0; ivalue < sizeof(values) / sizeof(values[0]); ++ivalue) {
+		string_const_t formatted = string_const(buffer, gltf_writer_format_float(buffer, values[ivalue]));
+		EXPECT_CONSTSTRINGEQ(formatted, string_const(expected[ivalue], string_length(expected[ivalue])));
+	}
+	return 0;
+}
+
+DECLARE_TEST(writer, minify_source) {
+	const char document[] = "{\n\t\"asset\": {\"version\": \"2.0\"},\n"
+	                        "\t\"nodes\": [ {\"name\": \"a \\\" b\", \"extras\": { \"note\": \" x \" } } ],\n"
+	                        "\t\"scenes\": [ { \"nodes\": [ 0 ] } ],\n"
+	                        "\t\"custom\": { \"value\": [ 1, 2 ] }\n}";
+
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	EXPECT_TRUE(test_gltf_read_string(&gltf, document, sizeof(document) - 1));
+
+	gltf.flags |= GLTF_FLAG_JSON_MINIFY;
+	stream_t* output = buffer_stream_allocate(nullptr, STREAM_IN | STREAM_OUT | STREAM_BINARY, 0, 0, true, true);
+	EXPECT_TRUE(gltf_write(&gltf, output));
+	gltf_finalize(&gltf);
+
+	size_t written_size = stream_size(output);
+	char* written = memory_allocate(0, written_size, 0, MEMORY_PERSISTENT);
+	stream_seek(output, 0, STREAM_SEEK_BEGIN);
+	EXPECT_EQ(stream_read(output, written, written_size), written_size);
+	stream_deallocate(output);
+
+	// Verbatim source spans are minified while whitespace inside strings is kept
+	const char expected_node[] = "{\"name\":\"a \\\" b\",\"extras\":{\"note\":\" x \"}}";
+	const char expected_member[] = "\"custom\":{\"value\":[1,2]}";
+	EXPECT_SIZENE(string_find_string(written, written_size, expected_node, sizeof(expected_node) - 1, 0), STRING_NPOS);
+	EXPECT_SIZENE(string_find_string(written, written_size, expected_member, sizeof(expected_member) - 1, 0),
+	              STRING_NPOS);
+	EXPECT_SIZEEQ(string_find_first_of(written, written_size, STRING_CONST("\n\t"), 0), STRING_NPOS);
+
+	memory_deallocate(written);
+	return 0;
+}
+
+DECLARE_TEST(writer, parallel_identical) {
+	// Enough nodes to pass the parallel threshold and split each section in several chunks
+	const uint node_count = 6000;
+	gltf_t gltf;
+	gltf_initialize(&gltf);
+	uint root = gltf_node_add(&gltf, STRING_CONST("root"), GLTF_INVALID_INDEX, nullptr);
+	for (uint inode = 1; inode < node_count; ++inode) {
+		char name_buffer[32];
+		string_t name = string_format(name_buffer, sizeof(name_buffer), STRING_CONST("node%u"), inode);
+		matrix_t transform = matrix_identity();
+		transform.frow[3][0] = (float)inode * 0.1f;
+		transform.frow[3][1] = 1.0f / (float)inode;
+		transform.frow[3][2] = -(float)inode;
+		uint child = gltf_node_add(&gltf, STRING_ARGS(name), GLTF_INVALID_INDEX, &transform);
+		gltf_node_add_child(&gltf, (inode % 2) ? root : (inode - 1), child);
+	}
+
+	size_t single_size = 0;
+	size_t parallel_size = 0;
+	gltf.flags |= GLTF_FLAG_WRITE_SINGLE_THREAD;
+	char* single = test_gltf_write_memory(&gltf, &single_size);
+	gltf.flags &= ~(uint)GLTF_FLAG_WRITE_SINGLE_THREAD;
+	char* parallel = test_gltf_write_memory(&gltf, &parallel_size);
+	EXPECT_NE(single, nullptr);
+	EXPECT_NE(parallel, nullptr);
+	EXPECT_SIZEEQ(single_size, parallel_size);
+	EXPECT_EQ(memcmp(single, parallel, single_size), 0);
+
+	// Minified output takes the same paths
+	gltf.flags |= GLTF_FLAG_JSON_MINIFY;
+	memory_deallocate(parallel);
+	parallel = test_gltf_write_memory(&gltf, &parallel_size);
+	memory_deallocate(single);
+	gltf.flags |= GLTF_FLAG_WRITE_SINGLE_THREAD;
+	single = test_gltf_write_memory(&gltf, &single_size);
+	EXPECT_SIZEEQ(single_size, parallel_size);
+	EXPECT_EQ(memcmp(single, parallel, single_size), 0);
+
+	memory_deallocate(single);
+	memory_deallocate(parallel);
+	gltf_finalize(&gltf);
+	return 0;
+}
+
+static void
+test_gltf_declare(void) {
+	ADD_TEST(animation, read_sample);
+	ADD_TEST(bounds, compute);
+	ADD_TEST(bvh, scene_query);
+	ADD_TEST(draco, read_write);
+	ADD_TEST(draco, edgebreaker);
+	ADD_TEST(extension, handler);
+	ADD_TEST(hierarchy, world_transform);
+	ADD_TEST(mesh, material_buckets);
+	ADD_TEST(meshopt, encode);
+	ADD_TEST(morph, read_blend);
+	ADD_TEST(morph, sparse_targets);
+	ADD_TEST(node, children);
+	ADD_TEST(node, read_instancing);
+	ADD_TEST(node, collapse_instances);
+	ADD_TEST(query, pointer);
+	ADD_TEST(skin, read_palette);
+	ADD_TEST(skinning, deform);
+	ADD_TEST(triangle, ray_query);
+	ADD_TEST(writer, base64);
+	ADD_TEST(writer, embed_roundtrip);
+	ADD_TEST(writer, dirty_roundtrip);
+	ADD_TEST(writer, format_float);
+	ADD_TEST(writer, minify_source);
+	ADD_TEST(writer, parallel_identical);
 }
 
-static test_suite_t test_socket_suite = {test_socket_application,
-                                         test_socket_memory_system,
-                                         test_socket_foundation_config,
-                                         test_socket_declare,
-                                         test_socket_initialize,
-                                         test_socket_finalize,
-                                         0};
+static test_suite_t test_gltf_suite = {test_gltf_application,
+                                       test_gltf_memory_system,
+                                       test_gltf_foundation_config,
+                                       test_gltf_declare,
+                                       test_gltf_initialize,
+                                       test_gltf_finalize,
+                                       0};
 
 #if BUILD_MONOLITHIC
 
 int
-test_socket_run(void);
+test_gltf_run(void);
 
 int
-test_socket_run(void) {
-	test_suite = test_socket_suite;
+test_gltf_run(void) {
+	test_suite = test_gltf_suite;
 	return test_run_all();
 }
 
@@ -249,7 +1744,7 @@ test_suite_define(void);
 
 test_suite_t
 test_suite_define(void) {
-	return test_socket_suite;
+	return test_gltf_suite;
 }
 
 #endif